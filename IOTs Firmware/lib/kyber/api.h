@@ -1,18 +1,122 @@
 #ifndef PQCLEAN_MLKEM768_CLEAN_API_H
 #define PQCLEAN_MLKEM768_CLEAN_API_H
 
+#include "encstream.h"
+#include <stddef.h>
 #include <stdint.h>
 
+#define PQCLEAN_MLKEM512_CLEAN_CRYPTO_SECRETKEYBYTES  1632
+#define PQCLEAN_MLKEM512_CLEAN_CRYPTO_PUBLICKEYBYTES  800
+#define PQCLEAN_MLKEM512_CLEAN_CRYPTO_CIPHERTEXTBYTES 768
+#define PQCLEAN_MLKEM512_CLEAN_CRYPTO_BYTES           32
+#define PQCLEAN_MLKEM512_CLEAN_CRYPTO_EXPANDEDPKBYTES 2336
+#define PQCLEAN_MLKEM512_CLEAN_CRYPTO_EXPANDEDSKBYTES 3136
+#define PQCLEAN_MLKEM512_CLEAN_CRYPTO_ALGNAME "ML-KEM-512"
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_keypair_derand(uint8_t *pk, uint8_t *sk, const uint8_t *coins);
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_keypair(uint8_t *pk, uint8_t *sk);
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_derand(uint8_t *ct, uint8_t *ss, const uint8_t *pk, const uint8_t *coins);
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc(uint8_t *ct, uint8_t *ss, const uint8_t *pk);
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_expand_pk(uint8_t *epk, const uint8_t *pk);
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_expanded_derand(uint8_t *ct, uint8_t *ss, const uint8_t *epk, const uint8_t *coins);
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_expanded(uint8_t *ct, uint8_t *ss, const uint8_t *epk);
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_dec(uint8_t *ss, const uint8_t *ct, const uint8_t *sk);
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_expand_sk(uint8_t *esk, const uint8_t *sk);
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_dec_expanded(uint8_t *ss, const uint8_t *ct, const uint8_t *esk);
+
+void PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_stream_init(mlkem_enc_stream *st);
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_stream_absorb(mlkem_enc_stream *st, const uint8_t *pk, size_t pklen);
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_stream_start_derand(mlkem_enc_stream *st, uint8_t *ss, const uint8_t *coins);
+
+int PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_stream_start(mlkem_enc_stream *st, uint8_t *ss);
+
+size_t PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_stream_emit(mlkem_enc_stream *st, uint8_t *ct);
+
 #define PQCLEAN_MLKEM768_CLEAN_CRYPTO_SECRETKEYBYTES  2400
 #define PQCLEAN_MLKEM768_CLEAN_CRYPTO_PUBLICKEYBYTES  1184
 #define PQCLEAN_MLKEM768_CLEAN_CRYPTO_CIPHERTEXTBYTES 1088
 #define PQCLEAN_MLKEM768_CLEAN_CRYPTO_BYTES           32
+#define PQCLEAN_MLKEM768_CLEAN_CRYPTO_EXPANDEDPKBYTES 4640
+#define PQCLEAN_MLKEM768_CLEAN_CRYPTO_EXPANDEDSKBYTES 5824
 #define PQCLEAN_MLKEM768_CLEAN_CRYPTO_ALGNAME "ML-KEM-768"
 
+int PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair_derand(uint8_t *pk, uint8_t *sk, const uint8_t *coins);
+
 int PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair(uint8_t *pk, uint8_t *sk);
 
+int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_derand(uint8_t *ct, uint8_t *ss, const uint8_t *pk, const uint8_t *coins);
+
 int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc(uint8_t *ct, uint8_t *ss, const uint8_t *pk);
 
+int PQCLEAN_MLKEM768_CLEAN_crypto_kem_expand_pk(uint8_t *epk, const uint8_t *pk);
+
+int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_expanded_derand(uint8_t *ct, uint8_t *ss, const uint8_t *epk, const uint8_t *coins);
+
+int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_expanded(uint8_t *ct, uint8_t *ss, const uint8_t *epk);
+
 int PQCLEAN_MLKEM768_CLEAN_crypto_kem_dec(uint8_t *ss, const uint8_t *ct, const uint8_t *sk);
 
+int PQCLEAN_MLKEM768_CLEAN_crypto_kem_expand_sk(uint8_t *esk, const uint8_t *sk);
+
+int PQCLEAN_MLKEM768_CLEAN_crypto_kem_dec_expanded(uint8_t *ss, const uint8_t *ct, const uint8_t *esk);
+
+void PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_stream_init(mlkem_enc_stream *st);
+
+int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_stream_absorb(mlkem_enc_stream *st, const uint8_t *pk, size_t pklen);
+
+int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_stream_start_derand(mlkem_enc_stream *st, uint8_t *ss, const uint8_t *coins);
+
+int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_stream_start(mlkem_enc_stream *st, uint8_t *ss);
+
+size_t PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_stream_emit(mlkem_enc_stream *st, uint8_t *ct);
+
+#define PQCLEAN_MLKEM1024_CLEAN_CRYPTO_SECRETKEYBYTES  3168
+#define PQCLEAN_MLKEM1024_CLEAN_CRYPTO_PUBLICKEYBYTES  1568
+#define PQCLEAN_MLKEM1024_CLEAN_CRYPTO_CIPHERTEXTBYTES 1568
+#define PQCLEAN_MLKEM1024_CLEAN_CRYPTO_BYTES           32
+#define PQCLEAN_MLKEM1024_CLEAN_CRYPTO_EXPANDEDPKBYTES 7712
+#define PQCLEAN_MLKEM1024_CLEAN_CRYPTO_EXPANDEDSKBYTES 9280
+#define PQCLEAN_MLKEM1024_CLEAN_CRYPTO_ALGNAME "ML-KEM-1024"
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_keypair_derand(uint8_t *pk, uint8_t *sk, const uint8_t *coins);
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_keypair(uint8_t *pk, uint8_t *sk);
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_derand(uint8_t *ct, uint8_t *ss, const uint8_t *pk, const uint8_t *coins);
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc(uint8_t *ct, uint8_t *ss, const uint8_t *pk);
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_expand_pk(uint8_t *epk, const uint8_t *pk);
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_expanded_derand(uint8_t *ct, uint8_t *ss, const uint8_t *epk, const uint8_t *coins);
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_expanded(uint8_t *ct, uint8_t *ss, const uint8_t *epk);
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_dec(uint8_t *ss, const uint8_t *ct, const uint8_t *sk);
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_expand_sk(uint8_t *esk, const uint8_t *sk);
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_dec_expanded(uint8_t *ss, const uint8_t *ct, const uint8_t *esk);
+
+void PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_stream_init(mlkem_enc_stream *st);
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_stream_absorb(mlkem_enc_stream *st, const uint8_t *pk, size_t pklen);
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_stream_start_derand(mlkem_enc_stream *st, uint8_t *ss, const uint8_t *coins);
+
+int PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_stream_start(mlkem_enc_stream *st, uint8_t *ss);
+
+size_t PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_stream_emit(mlkem_enc_stream *st, uint8_t *ct);
+
 #endif
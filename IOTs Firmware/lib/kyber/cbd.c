@@ -1,5 +1,6 @@
 #include "cbd.h"
 #include "params.h"
+#include "poly_avx2.h"
 #include <stdint.h>
 
 /*************************************************
@@ -32,10 +33,16 @@ static uint32_t load32_littleendian(const uint8_t x[4]) {
 *
 * Returns 32-bit unsigned integer loaded from x (most significant byte is zero)
 **************************************************/
-
+static uint32_t load24_littleendian(const uint8_t x[3]) {
+    uint32_t r;
+    r  = (uint32_t)x[0];
+    r |= (uint32_t)x[1] << 8;
+    r |= (uint32_t)x[2] << 16;
+    return r;
+}
 
 /*************************************************
-* Name:        cbd2
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_cbd2
 *
 * Description: Given an array of uniformly random bytes, compute
 *              polynomial with coefficients distributed according to
@@ -44,26 +51,32 @@ static uint32_t load32_littleendian(const uint8_t x[4]) {
 * Arguments:   - poly *r: pointer to output polynomial
 *              - const uint8_t *buf: pointer to input byte array
 **************************************************/
-static void cbd2(poly *r, const uint8_t buf[2 * KYBER_N / 4]) {
+void PQCLEAN_MLKEM768_CLEAN_poly_cbd2(poly *r, const uint8_t buf[2 * KYBER_N / 4]) {
     unsigned int i, j;
     uint32_t t, d;
-    int16_t a, b;
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        PQCLEAN_MLKEM768_CLEAN_poly_cbd2_avx2(r->coeffs, buf);
+        return;
+    }
+#endif
 
     for (i = 0; i < KYBER_N / 8; i++) {
         t  = load32_littleendian(buf + 4 * i);
         d  = t & 0x55555555;
         d += (t >> 1) & 0x55555555;
+        // a - b + 3 in every nibble; lies in 1..5, so no borrows
+        d  = (d & 0x33333333) + 0x33333333 - ((d >> 2) & 0x33333333);
 
         for (j = 0; j < 8; j++) {
-            a = (d >> (4 * j + 0)) & 0x3;
-            b = (d >> (4 * j + 2)) & 0x3;
-            r->coeffs[8 * i + j] = a - b;
+            r->coeffs[8 * i + j] = (int16_t)((d >> (4 * j)) & 0xF) - 3;
         }
     }
 }
 
 /*************************************************
-* Name:        cbd3
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_cbd3
 *
 * Description: Given an array of uniformly random bytes, compute
 *              polynomial with coefficients distributed according to
@@ -73,11 +86,20 @@ static void cbd2(poly *r, const uint8_t buf[2 * KYBER_N / 4]) {
 * Arguments:   - poly *r: pointer to output polynomial
 *              - const uint8_t *buf: pointer to input byte array
 **************************************************/
+void PQCLEAN_MLKEM768_CLEAN_poly_cbd3(poly *r, const uint8_t buf[3 * KYBER_N / 4]) {
+    unsigned int i, j;
+    uint32_t t, d;
 
-void PQCLEAN_MLKEM768_CLEAN_poly_cbd_eta1(poly *r, const uint8_t buf[KYBER_ETA1 * KYBER_N / 4]) {
-    cbd2(r, buf);
-}
+    for (i = 0; i < KYBER_N / 4; i++) {
+        t  = load24_littleendian(buf + 3 * i);
+        d  = t & 0x00249249;
+        d += (t >> 1) & 0x00249249;
+        d += (t >> 2) & 0x00249249;
+        // a - b + 3 in every 6-bit field; lies in 0..6, so no borrows
+        d  = (d & 0x001C71C7) + 0x000C30C3 - ((d >> 3) & 0x001C71C7);
 
-void PQCLEAN_MLKEM768_CLEAN_poly_cbd_eta2(poly *r, const uint8_t buf[KYBER_ETA2 * KYBER_N / 4]) {
-    cbd2(r, buf);
+        for (j = 0; j < 4; j++) {
+            r->coeffs[4 * i + j] = (int16_t)((d >> (6 * j)) & 0x7) - 3;
+        }
+    }
 }
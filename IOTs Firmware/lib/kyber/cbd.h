@@ -4,8 +4,15 @@
 #include "poly.h"
 #include <stdint.h>
 
-void PQCLEAN_MLKEM768_CLEAN_poly_cbd_eta1(poly *r, const uint8_t buf[KYBER_ETA1 * KYBER_N / 4]);
+void PQCLEAN_MLKEM768_CLEAN_poly_cbd2(poly *r, const uint8_t buf[2 * KYBER_N / 4]);
 
-void PQCLEAN_MLKEM768_CLEAN_poly_cbd_eta2(poly *r, const uint8_t buf[KYBER_ETA2 * KYBER_N / 4]);
+void PQCLEAN_MLKEM768_CLEAN_poly_cbd3(poly *r, const uint8_t buf[3 * KYBER_N / 4]);
+
+#if KYBER_ETA1 == 3
+#define poly_cbd_eta1(R, BUF) PQCLEAN_MLKEM768_CLEAN_poly_cbd3(R, BUF)
+#else
+#define poly_cbd_eta1(R, BUF) PQCLEAN_MLKEM768_CLEAN_poly_cbd2(R, BUF)
+#endif
+#define poly_cbd_eta2(R, BUF) PQCLEAN_MLKEM768_CLEAN_poly_cbd2(R, BUF)
 
 #endif
@@ -0,0 +1,37 @@
+#ifndef PQCLEAN_MLKEM_CLEAN_ENCSTREAM_H
+#define PQCLEAN_MLKEM_CLEAN_ENCSTREAM_H
+#include "fips202.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * State of a streaming encapsulation (crypto_kem_enc_stream_*), sized for
+ * the largest parameter set so that one state serves all three.
+ *
+ * The public key is taken in pieces of any size as it arrives: it is
+ * hashed for H(pk) on the way, and each polynomial of t is unpacked as
+ * soon as its 384 bytes are complete. Once the whole key is in, start
+ * samples s and returns the shared secret, and every emit call computes
+ * and writes the next piece of the ciphertext: the K compressed
+ * polynomials of u, then v. The ciphertext and shared secret are the same
+ * as crypto_kem_enc_derand gives for the same coins.
+ */
+#define PQCLEAN_MLKEM_CLEAN_ENCSTREAM_MAXK     4
+/* Largest piece written by one emit call */
+#define PQCLEAN_MLKEM_CLEAN_ENCSTREAM_MAXCHUNK 352
+
+typedef struct {
+    sha3_256incctx hpk;
+    /* t in NTT domain, unpacked */
+    int16_t t[PQCLEAN_MLKEM_CLEAN_ENCSTREAM_MAXK][256];
+    /* s in NTT domain, packed */
+    uint8_t sp[PQCLEAN_MLKEM_CLEAN_ENCSTREAM_MAXK * 384];
+    /* Key bytes of the polynomial not yet complete, then the seed rho */
+    uint8_t part[384];
+    uint8_t m[32];
+    uint8_t coins[32];
+    size_t pkbytes;
+    unsigned int row;
+} mlkem_enc_stream;
+
+#endif
@@ -7,7 +7,6 @@
 
 #include <stddef.h>
 #include <stdint.h>
-#include <stdlib.h>
 #include <string.h>
 
 #include "fips202.h"
@@ -15,6 +14,16 @@
 #define NROUNDS 24
 #define ROL(a, offset) (((a) << (offset)) ^ ((a) >> (64 - (offset))))
 
+/* The fixed-shape absorb (keccak_absorb_once_32) takes the rate, domain
+ * byte and suffix length as arguments, and every caller passes constants.
+ * Forcing it inline gives each call site its own straight-line copy with
+ * the lane counts and padding positions folded at compile time. */
+#if defined(__GNUC__) || defined(__clang__)
+#define KECCAK_INLINE static inline __attribute__((always_inline))
+#else
+#define KECCAK_INLINE static inline
+#endif
+
 /*************************************************
  * Name:        load64
  *
@@ -25,12 +34,19 @@
  * Returns the loaded 64-bit unsigned integer
  **************************************************/
 static uint64_t load64(const uint8_t *x) {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    /* Single (possibly unaligned) word load on little-endian targets */
+    uint64_t r;
+    memcpy(&r, x, sizeof(r));
+    return r;
+#else
     uint64_t r = 0;
     for (size_t i = 0; i < 8; ++i) {
         r |= (uint64_t)x[i] << 8 * i;
     }
 
     return r;
+#endif
 }
 
 /*************************************************
@@ -42,11 +58,614 @@ static uint64_t load64(const uint8_t *x) {
  *              - uint64_t u: input 64-bit unsigned integer
  **************************************************/
 static void store64(uint8_t *x, uint64_t u) {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    memcpy(x, &u, sizeof(u));
+#else
     for (size_t i = 0; i < 8; ++i) {
         x[i] = (uint8_t) (u >> 8 * i);
     }
+#endif
+}
+
+/*************************************************
+ * Name:        load64_partial
+ *
+ * Description: Load fewer than 8 bytes into the low end of a uint64_t in
+ *              little-endian order
+ *
+ * Arguments:   - const uint8_t *x: pointer to input byte array
+ *              - size_t n: number of bytes to load (less than 8)
+ *
+ * Returns the loaded 64-bit unsigned integer
+ **************************************************/
+static uint64_t load64_partial(const uint8_t *x, size_t n) {
+    uint64_t r = 0;
+    for (size_t i = 0; i < n; ++i) {
+        r |= (uint64_t)x[i] << 8 * i;
+    }
+
+    return r;
+}
+
+#if defined(KECCAK_BITINTERLEAVED)
+/* 32-bit backend: lanes are kept bit-interleaved for the whole lifetime of
+ * the state, i.e. state[i] holds the odd bits of lane i in its upper half
+ * and the even bits in its lower half. Inputs are interleaved on the way in
+ * and outputs de-interleaved on the way out by the helpers below. */
+#define ROL32(a, offset) (((a) << (offset)) ^ ((a) >> (32 - (offset))))
+
+/*************************************************
+ * Name:        unshuffle32
+ *
+ * Description: Moves the even bits of x to the lower 16 bits and the odd
+ *              bits to the upper 16 bits, keeping their relative order
+ *
+ * Arguments:   - uint32_t x: input word
+ *
+ * Returns the unshuffled word
+ **************************************************/
+static uint32_t unshuffle32(uint32_t x) {
+    uint32_t t;
+
+    t = (x ^ (x >> 1)) & 0x22222222UL;
+    x = x ^ t ^ (t << 1);
+    t = (x ^ (x >> 2)) & 0x0C0C0C0CUL;
+    x = x ^ t ^ (t << 2);
+    t = (x ^ (x >> 4)) & 0x00F000F0UL;
+    x = x ^ t ^ (t << 4);
+    t = (x ^ (x >> 8)) & 0x0000FF00UL;
+    x = x ^ t ^ (t << 8);
+    return x;
+}
+
+/*************************************************
+ * Name:        shuffle32
+ *
+ * Description: Inverse of unshuffle32
+ *
+ * Arguments:   - uint32_t x: input word
+ *
+ * Returns the shuffled word
+ **************************************************/
+static uint32_t shuffle32(uint32_t x) {
+    uint32_t t;
+
+    t = (x ^ (x >> 8)) & 0x0000FF00UL;
+    x = x ^ t ^ (t << 8);
+    t = (x ^ (x >> 4)) & 0x00F000F0UL;
+    x = x ^ t ^ (t << 4);
+    t = (x ^ (x >> 2)) & 0x0C0C0C0CUL;
+    x = x ^ t ^ (t << 2);
+    t = (x ^ (x >> 1)) & 0x22222222UL;
+    x = x ^ t ^ (t << 1);
+    return x;
+}
+
+/*************************************************
+ * Name:        bitinterleave
+ *
+ * Description: Converts a 64-bit lane to bit-interleaved form
+ *
+ * Arguments:   - uint64_t x: lane in standard representation
+ *
+ * Returns the lane with the even bits in the lower and the odd bits in
+ * the upper 32 bits
+ **************************************************/
+static uint64_t bitinterleave(uint64_t x) {
+    uint32_t lo = unshuffle32((uint32_t)x);
+    uint32_t hi = unshuffle32((uint32_t)(x >> 32));
+    uint32_t even = (lo & 0x0000FFFFUL) | (hi << 16);
+    uint32_t odd = (lo >> 16) | (hi & 0xFFFF0000UL);
+
+    return ((uint64_t)odd << 32) | even;
+}
+
+/*************************************************
+ * Name:        bitdeinterleave
+ *
+ * Description: Inverse of bitinterleave
+ *
+ * Arguments:   - uint64_t x: lane in bit-interleaved representation
+ *
+ * Returns the lane in standard representation
+ **************************************************/
+static uint64_t bitdeinterleave(uint64_t x) {
+    uint32_t even = (uint32_t)x;
+    uint32_t odd = (uint32_t)(x >> 32);
+    uint32_t lo = (even & 0x0000FFFFUL) | (odd << 16);
+    uint32_t hi = (even >> 16) | (odd & 0xFFFF0000UL);
+
+    return ((uint64_t)shuffle32(hi) << 32) | shuffle32(lo);
+}
+
+/* Keccak round constants, bit-interleaved: even-bit word, odd-bit word */
+static const uint32_t KeccakF_RoundConstants[2 * NROUNDS] = {
+    0x00000001UL, 0x00000000UL, 0x00000000UL, 0x00000089UL,
+    0x00000000UL, 0x8000008bUL, 0x00000000UL, 0x80008080UL,
+    0x00000001UL, 0x0000008bUL, 0x00000001UL, 0x00008000UL,
+    0x00000001UL, 0x80008088UL, 0x00000001UL, 0x80000082UL,
+    0x00000000UL, 0x0000000bUL, 0x00000000UL, 0x0000000aUL,
+    0x00000001UL, 0x00008082UL, 0x00000000UL, 0x00008003UL,
+    0x00000001UL, 0x0000808bUL, 0x00000001UL, 0x8000000bUL,
+    0x00000001UL, 0x8000008aUL, 0x00000001UL, 0x80000081UL,
+    0x00000000UL, 0x80000081UL, 0x00000000UL, 0x80000008UL,
+    0x00000000UL, 0x00000083UL, 0x00000000UL, 0x80008003UL,
+    0x00000001UL, 0x80008088UL, 0x00000000UL, 0x80000088UL,
+    0x00000001UL, 0x00008000UL, 0x00000000UL, 0x80008082UL
+};
+
+/*************************************************
+ * Name:        KeccakF1600_StatePermute
+ *
+ * Description: The Keccak F1600 Permutation on a bit-interleaved state.
+ *              Every 64-bit lane is held as two 32-bit words (even bits,
+ *              odd bits), so each 64-bit rotation becomes two 32-bit ones.
+ *
+ * Arguments:   - uint64_t *state: pointer to input/output Keccak state
+ **************************************************/
+static void KeccakF1600_StatePermute(uint64_t *state) {
+    int round;
+
+    uint32_t Aba0, Aba1, Abe0, Abe1, Abi0, Abi1, Abo0, Abo1, Abu0, Abu1;
+    uint32_t Aga0, Aga1, Age0, Age1, Agi0, Agi1, Ago0, Ago1, Agu0, Agu1;
+    uint32_t Aka0, Aka1, Ake0, Ake1, Aki0, Aki1, Ako0, Ako1, Aku0, Aku1;
+    uint32_t Ama0, Ama1, Ame0, Ame1, Ami0, Ami1, Amo0, Amo1, Amu0, Amu1;
+    uint32_t Asa0, Asa1, Ase0, Ase1, Asi0, Asi1, Aso0, Aso1, Asu0, Asu1;
+    uint32_t BCa0, BCa1, BCe0, BCe1, BCi0, BCi1, BCo0, BCo1, BCu0, BCu1;
+    uint32_t Da0, Da1, De0, De1, Di0, Di1, Do0, Do1, Du0, Du1;
+    uint32_t Eba0, Eba1, Ebe0, Ebe1, Ebi0, Ebi1, Ebo0, Ebo1, Ebu0, Ebu1;
+    uint32_t Ega0, Ega1, Ege0, Ege1, Egi0, Egi1, Ego0, Ego1, Egu0, Egu1;
+    uint32_t Eka0, Eka1, Eke0, Eke1, Eki0, Eki1, Eko0, Eko1, Eku0, Eku1;
+    uint32_t Ema0, Ema1, Eme0, Eme1, Emi0, Emi1, Emo0, Emo1, Emu0, Emu1;
+    uint32_t Esa0, Esa1, Ese0, Ese1, Esi0, Esi1, Eso0, Eso1, Esu0, Esu1;
+
+    // copyFromState(A, state)
+    Aba0 = (uint32_t)state[0];
+    Aba1 = (uint32_t)(state[0] >> 32);
+    Abe0 = (uint32_t)state[1];
+    Abe1 = (uint32_t)(state[1] >> 32);
+    Abi0 = (uint32_t)state[2];
+    Abi1 = (uint32_t)(state[2] >> 32);
+    Abo0 = (uint32_t)state[3];
+    Abo1 = (uint32_t)(state[3] >> 32);
+    Abu0 = (uint32_t)state[4];
+    Abu1 = (uint32_t)(state[4] >> 32);
+    Aga0 = (uint32_t)state[5];
+    Aga1 = (uint32_t)(state[5] >> 32);
+    Age0 = (uint32_t)state[6];
+    Age1 = (uint32_t)(state[6] >> 32);
+    Agi0 = (uint32_t)state[7];
+    Agi1 = (uint32_t)(state[7] >> 32);
+    Ago0 = (uint32_t)state[8];
+    Ago1 = (uint32_t)(state[8] >> 32);
+    Agu0 = (uint32_t)state[9];
+    Agu1 = (uint32_t)(state[9] >> 32);
+    Aka0 = (uint32_t)state[10];
+    Aka1 = (uint32_t)(state[10] >> 32);
+    Ake0 = (uint32_t)state[11];
+    Ake1 = (uint32_t)(state[11] >> 32);
+    Aki0 = (uint32_t)state[12];
+    Aki1 = (uint32_t)(state[12] >> 32);
+    Ako0 = (uint32_t)state[13];
+    Ako1 = (uint32_t)(state[13] >> 32);
+    Aku0 = (uint32_t)state[14];
+    Aku1 = (uint32_t)(state[14] >> 32);
+    Ama0 = (uint32_t)state[15];
+    Ama1 = (uint32_t)(state[15] >> 32);
+    Ame0 = (uint32_t)state[16];
+    Ame1 = (uint32_t)(state[16] >> 32);
+    Ami0 = (uint32_t)state[17];
+    Ami1 = (uint32_t)(state[17] >> 32);
+    Amo0 = (uint32_t)state[18];
+    Amo1 = (uint32_t)(state[18] >> 32);
+    Amu0 = (uint32_t)state[19];
+    Amu1 = (uint32_t)(state[19] >> 32);
+    Asa0 = (uint32_t)state[20];
+    Asa1 = (uint32_t)(state[20] >> 32);
+    Ase0 = (uint32_t)state[21];
+    Ase1 = (uint32_t)(state[21] >> 32);
+    Asi0 = (uint32_t)state[22];
+    Asi1 = (uint32_t)(state[22] >> 32);
+    Aso0 = (uint32_t)state[23];
+    Aso1 = (uint32_t)(state[23] >> 32);
+    Asu0 = (uint32_t)state[24];
+    Asu1 = (uint32_t)(state[24] >> 32);
+
+    for (round = 0; round < NROUNDS; round += 2) {
+        //    prepareTheta
+        BCa0 = Aba0 ^ Aga0 ^ Aka0 ^ Ama0 ^ Asa0;
+        BCa1 = Aba1 ^ Aga1 ^ Aka1 ^ Ama1 ^ Asa1;
+        BCe0 = Abe0 ^ Age0 ^ Ake0 ^ Ame0 ^ Ase0;
+        BCe1 = Abe1 ^ Age1 ^ Ake1 ^ Ame1 ^ Ase1;
+        BCi0 = Abi0 ^ Agi0 ^ Aki0 ^ Ami0 ^ Asi0;
+        BCi1 = Abi1 ^ Agi1 ^ Aki1 ^ Ami1 ^ Asi1;
+        BCo0 = Abo0 ^ Ago0 ^ Ako0 ^ Amo0 ^ Aso0;
+        BCo1 = Abo1 ^ Ago1 ^ Ako1 ^ Amo1 ^ Aso1;
+        BCu0 = Abu0 ^ Agu0 ^ Aku0 ^ Amu0 ^ Asu0;
+        BCu1 = Abu1 ^ Agu1 ^ Aku1 ^ Amu1 ^ Asu1;
+
+        // thetaRhoPiChiIotaPrepareTheta(round, A, E)
+        Da0 = BCu0 ^ ROL32(BCe1, 1);
+        Da1 = BCu1 ^ BCe0;
+        De0 = BCa0 ^ ROL32(BCi1, 1);
+        De1 = BCa1 ^ BCi0;
+        Di0 = BCe0 ^ ROL32(BCo1, 1);
+        Di1 = BCe1 ^ BCo0;
+        Do0 = BCi0 ^ ROL32(BCu1, 1);
+        Do1 = BCi1 ^ BCu0;
+        Du0 = BCo0 ^ ROL32(BCa1, 1);
+        Du1 = BCo1 ^ BCa0;
+
+        Aba0 ^= Da0;
+        Aba1 ^= Da1;
+        BCa0 = Aba0;
+        BCa1 = Aba1;
+        Age0 ^= De0;
+        Age1 ^= De1;
+        BCe0 = ROL32(Age0, 22);
+        BCe1 = ROL32(Age1, 22);
+        Aki0 ^= Di0;
+        Aki1 ^= Di1;
+        BCi0 = ROL32(Aki1, 22);
+        BCi1 = ROL32(Aki0, 21);
+        Amo0 ^= Do0;
+        Amo1 ^= Do1;
+        BCo0 = ROL32(Amo1, 11);
+        BCo1 = ROL32(Amo0, 10);
+        Asu0 ^= Du0;
+        Asu1 ^= Du1;
+        BCu0 = ROL32(Asu0, 7);
+        BCu1 = ROL32(Asu1, 7);
+        Eba0 = BCa0 ^ ((~BCe0) & BCi0);
+        Eba1 = BCa1 ^ ((~BCe1) & BCi1);
+        Eba0 ^= KeccakF_RoundConstants[2 * (round)];
+        Eba1 ^= KeccakF_RoundConstants[2 * (round) + 1];
+        Ebe0 = BCe0 ^ ((~BCi0) & BCo0);
+        Ebe1 = BCe1 ^ ((~BCi1) & BCo1);
+        Ebi0 = BCi0 ^ ((~BCo0) & BCu0);
+        Ebi1 = BCi1 ^ ((~BCo1) & BCu1);
+        Ebo0 = BCo0 ^ ((~BCu0) & BCa0);
+        Ebo1 = BCo1 ^ ((~BCu1) & BCa1);
+        Ebu0 = BCu0 ^ ((~BCa0) & BCe0);
+        Ebu1 = BCu1 ^ ((~BCa1) & BCe1);
+
+        Abo0 ^= Do0;
+        Abo1 ^= Do1;
+        BCa0 = ROL32(Abo0, 14);
+        BCa1 = ROL32(Abo1, 14);
+        Agu0 ^= Du0;
+        Agu1 ^= Du1;
+        BCe0 = ROL32(Agu0, 10);
+        BCe1 = ROL32(Agu1, 10);
+        Aka0 ^= Da0;
+        Aka1 ^= Da1;
+        BCi0 = ROL32(Aka1, 2);
+        BCi1 = ROL32(Aka0, 1);
+        Ame0 ^= De0;
+        Ame1 ^= De1;
+        BCo0 = ROL32(Ame1, 23);
+        BCo1 = ROL32(Ame0, 22);
+        Asi0 ^= Di0;
+        Asi1 ^= Di1;
+        BCu0 = ROL32(Asi1, 31);
+        BCu1 = ROL32(Asi0, 30);
+        Ega0 = BCa0 ^ ((~BCe0) & BCi0);
+        Ega1 = BCa1 ^ ((~BCe1) & BCi1);
+        Ege0 = BCe0 ^ ((~BCi0) & BCo0);
+        Ege1 = BCe1 ^ ((~BCi1) & BCo1);
+        Egi0 = BCi0 ^ ((~BCo0) & BCu0);
+        Egi1 = BCi1 ^ ((~BCo1) & BCu1);
+        Ego0 = BCo0 ^ ((~BCu0) & BCa0);
+        Ego1 = BCo1 ^ ((~BCu1) & BCa1);
+        Egu0 = BCu0 ^ ((~BCa0) & BCe0);
+        Egu1 = BCu1 ^ ((~BCa1) & BCe1);
+
+        Abe0 ^= De0;
+        Abe1 ^= De1;
+        BCa0 = ROL32(Abe1, 1);
+        BCa1 = Abe0;
+        Agi0 ^= Di0;
+        Agi1 ^= Di1;
+        BCe0 = ROL32(Agi0, 3);
+        BCe1 = ROL32(Agi1, 3);
+        Ako0 ^= Do0;
+        Ako1 ^= Do1;
+        BCi0 = ROL32(Ako1, 13);
+        BCi1 = ROL32(Ako0, 12);
+        Amu0 ^= Du0;
+        Amu1 ^= Du1;
+        BCo0 = ROL32(Amu0, 4);
+        BCo1 = ROL32(Amu1, 4);
+        Asa0 ^= Da0;
+        Asa1 ^= Da1;
+        BCu0 = ROL32(Asa0, 9);
+        BCu1 = ROL32(Asa1, 9);
+        Eka0 = BCa0 ^ ((~BCe0) & BCi0);
+        Eka1 = BCa1 ^ ((~BCe1) & BCi1);
+        Eke0 = BCe0 ^ ((~BCi0) & BCo0);
+        Eke1 = BCe1 ^ ((~BCi1) & BCo1);
+        Eki0 = BCi0 ^ ((~BCo0) & BCu0);
+        Eki1 = BCi1 ^ ((~BCo1) & BCu1);
+        Eko0 = BCo0 ^ ((~BCu0) & BCa0);
+        Eko1 = BCo1 ^ ((~BCu1) & BCa1);
+        Eku0 = BCu0 ^ ((~BCa0) & BCe0);
+        Eku1 = BCu1 ^ ((~BCa1) & BCe1);
+
+        Abu0 ^= Du0;
+        Abu1 ^= Du1;
+        BCa0 = ROL32(Abu1, 14);
+        BCa1 = ROL32(Abu0, 13);
+        Aga0 ^= Da0;
+        Aga1 ^= Da1;
+        BCe0 = ROL32(Aga0, 18);
+        BCe1 = ROL32(Aga1, 18);
+        Ake0 ^= De0;
+        Ake1 ^= De1;
+        BCi0 = ROL32(Ake0, 5);
+        BCi1 = ROL32(Ake1, 5);
+        Ami0 ^= Di0;
+        Ami1 ^= Di1;
+        BCo0 = ROL32(Ami1, 8);
+        BCo1 = ROL32(Ami0, 7);
+        Aso0 ^= Do0;
+        Aso1 ^= Do1;
+        BCu0 = ROL32(Aso0, 28);
+        BCu1 = ROL32(Aso1, 28);
+        Ema0 = BCa0 ^ ((~BCe0) & BCi0);
+        Ema1 = BCa1 ^ ((~BCe1) & BCi1);
+        Eme0 = BCe0 ^ ((~BCi0) & BCo0);
+        Eme1 = BCe1 ^ ((~BCi1) & BCo1);
+        Emi0 = BCi0 ^ ((~BCo0) & BCu0);
+        Emi1 = BCi1 ^ ((~BCo1) & BCu1);
+        Emo0 = BCo0 ^ ((~BCu0) & BCa0);
+        Emo1 = BCo1 ^ ((~BCu1) & BCa1);
+        Emu0 = BCu0 ^ ((~BCa0) & BCe0);
+        Emu1 = BCu1 ^ ((~BCa1) & BCe1);
+
+        Abi0 ^= Di0;
+        Abi1 ^= Di1;
+        BCa0 = ROL32(Abi0, 31);
+        BCa1 = ROL32(Abi1, 31);
+        Ago0 ^= Do0;
+        Ago1 ^= Do1;
+        BCe0 = ROL32(Ago1, 28);
+        BCe1 = ROL32(Ago0, 27);
+        Aku0 ^= Du0;
+        Aku1 ^= Du1;
+        BCi0 = ROL32(Aku1, 20);
+        BCi1 = ROL32(Aku0, 19);
+        Ama0 ^= Da0;
+        Ama1 ^= Da1;
+        BCo0 = ROL32(Ama1, 21);
+        BCo1 = ROL32(Ama0, 20);
+        Ase0 ^= De0;
+        Ase1 ^= De1;
+        BCu0 = ROL32(Ase0, 1);
+        BCu1 = ROL32(Ase1, 1);
+        Esa0 = BCa0 ^ ((~BCe0) & BCi0);
+        Esa1 = BCa1 ^ ((~BCe1) & BCi1);
+        Ese0 = BCe0 ^ ((~BCi0) & BCo0);
+        Ese1 = BCe1 ^ ((~BCi1) & BCo1);
+        Esi0 = BCi0 ^ ((~BCo0) & BCu0);
+        Esi1 = BCi1 ^ ((~BCo1) & BCu1);
+        Eso0 = BCo0 ^ ((~BCu0) & BCa0);
+        Eso1 = BCo1 ^ ((~BCu1) & BCa1);
+        Esu0 = BCu0 ^ ((~BCa0) & BCe0);
+        Esu1 = BCu1 ^ ((~BCa1) & BCe1);
+
+        //    prepareTheta
+        BCa0 = Eba0 ^ Ega0 ^ Eka0 ^ Ema0 ^ Esa0;
+        BCa1 = Eba1 ^ Ega1 ^ Eka1 ^ Ema1 ^ Esa1;
+        BCe0 = Ebe0 ^ Ege0 ^ Eke0 ^ Eme0 ^ Ese0;
+        BCe1 = Ebe1 ^ Ege1 ^ Eke1 ^ Eme1 ^ Ese1;
+        BCi0 = Ebi0 ^ Egi0 ^ Eki0 ^ Emi0 ^ Esi0;
+        BCi1 = Ebi1 ^ Egi1 ^ Eki1 ^ Emi1 ^ Esi1;
+        BCo0 = Ebo0 ^ Ego0 ^ Eko0 ^ Emo0 ^ Eso0;
+        BCo1 = Ebo1 ^ Ego1 ^ Eko1 ^ Emo1 ^ Eso1;
+        BCu0 = Ebu0 ^ Egu0 ^ Eku0 ^ Emu0 ^ Esu0;
+        BCu1 = Ebu1 ^ Egu1 ^ Eku1 ^ Emu1 ^ Esu1;
+
+        // thetaRhoPiChiIotaPrepareTheta(round + 1, E, A)
+        Da0 = BCu0 ^ ROL32(BCe1, 1);
+        Da1 = BCu1 ^ BCe0;
+        De0 = BCa0 ^ ROL32(BCi1, 1);
+        De1 = BCa1 ^ BCi0;
+        Di0 = BCe0 ^ ROL32(BCo1, 1);
+        Di1 = BCe1 ^ BCo0;
+        Do0 = BCi0 ^ ROL32(BCu1, 1);
+        Do1 = BCi1 ^ BCu0;
+        Du0 = BCo0 ^ ROL32(BCa1, 1);
+        Du1 = BCo1 ^ BCa0;
+
+        Eba0 ^= Da0;
+        Eba1 ^= Da1;
+        BCa0 = Eba0;
+        BCa1 = Eba1;
+        Ege0 ^= De0;
+        Ege1 ^= De1;
+        BCe0 = ROL32(Ege0, 22);
+        BCe1 = ROL32(Ege1, 22);
+        Eki0 ^= Di0;
+        Eki1 ^= Di1;
+        BCi0 = ROL32(Eki1, 22);
+        BCi1 = ROL32(Eki0, 21);
+        Emo0 ^= Do0;
+        Emo1 ^= Do1;
+        BCo0 = ROL32(Emo1, 11);
+        BCo1 = ROL32(Emo0, 10);
+        Esu0 ^= Du0;
+        Esu1 ^= Du1;
+        BCu0 = ROL32(Esu0, 7);
+        BCu1 = ROL32(Esu1, 7);
+        Aba0 = BCa0 ^ ((~BCe0) & BCi0);
+        Aba1 = BCa1 ^ ((~BCe1) & BCi1);
+        Aba0 ^= KeccakF_RoundConstants[2 * (round + 1)];
+        Aba1 ^= KeccakF_RoundConstants[2 * (round + 1) + 1];
+        Abe0 = BCe0 ^ ((~BCi0) & BCo0);
+        Abe1 = BCe1 ^ ((~BCi1) & BCo1);
+        Abi0 = BCi0 ^ ((~BCo0) & BCu0);
+        Abi1 = BCi1 ^ ((~BCo1) & BCu1);
+        Abo0 = BCo0 ^ ((~BCu0) & BCa0);
+        Abo1 = BCo1 ^ ((~BCu1) & BCa1);
+        Abu0 = BCu0 ^ ((~BCa0) & BCe0);
+        Abu1 = BCu1 ^ ((~BCa1) & BCe1);
+
+        Ebo0 ^= Do0;
+        Ebo1 ^= Do1;
+        BCa0 = ROL32(Ebo0, 14);
+        BCa1 = ROL32(Ebo1, 14);
+        Egu0 ^= Du0;
+        Egu1 ^= Du1;
+        BCe0 = ROL32(Egu0, 10);
+        BCe1 = ROL32(Egu1, 10);
+        Eka0 ^= Da0;
+        Eka1 ^= Da1;
+        BCi0 = ROL32(Eka1, 2);
+        BCi1 = ROL32(Eka0, 1);
+        Eme0 ^= De0;
+        Eme1 ^= De1;
+        BCo0 = ROL32(Eme1, 23);
+        BCo1 = ROL32(Eme0, 22);
+        Esi0 ^= Di0;
+        Esi1 ^= Di1;
+        BCu0 = ROL32(Esi1, 31);
+        BCu1 = ROL32(Esi0, 30);
+        Aga0 = BCa0 ^ ((~BCe0) & BCi0);
+        Aga1 = BCa1 ^ ((~BCe1) & BCi1);
+        Age0 = BCe0 ^ ((~BCi0) & BCo0);
+        Age1 = BCe1 ^ ((~BCi1) & BCo1);
+        Agi0 = BCi0 ^ ((~BCo0) & BCu0);
+        Agi1 = BCi1 ^ ((~BCo1) & BCu1);
+        Ago0 = BCo0 ^ ((~BCu0) & BCa0);
+        Ago1 = BCo1 ^ ((~BCu1) & BCa1);
+        Agu0 = BCu0 ^ ((~BCa0) & BCe0);
+        Agu1 = BCu1 ^ ((~BCa1) & BCe1);
+
+        Ebe0 ^= De0;
+        Ebe1 ^= De1;
+        BCa0 = ROL32(Ebe1, 1);
+        BCa1 = Ebe0;
+        Egi0 ^= Di0;
+        Egi1 ^= Di1;
+        BCe0 = ROL32(Egi0, 3);
+        BCe1 = ROL32(Egi1, 3);
+        Eko0 ^= Do0;
+        Eko1 ^= Do1;
+        BCi0 = ROL32(Eko1, 13);
+        BCi1 = ROL32(Eko0, 12);
+        Emu0 ^= Du0;
+        Emu1 ^= Du1;
+        BCo0 = ROL32(Emu0, 4);
+        BCo1 = ROL32(Emu1, 4);
+        Esa0 ^= Da0;
+        Esa1 ^= Da1;
+        BCu0 = ROL32(Esa0, 9);
+        BCu1 = ROL32(Esa1, 9);
+        Aka0 = BCa0 ^ ((~BCe0) & BCi0);
+        Aka1 = BCa1 ^ ((~BCe1) & BCi1);
+        Ake0 = BCe0 ^ ((~BCi0) & BCo0);
+        Ake1 = BCe1 ^ ((~BCi1) & BCo1);
+        Aki0 = BCi0 ^ ((~BCo0) & BCu0);
+        Aki1 = BCi1 ^ ((~BCo1) & BCu1);
+        Ako0 = BCo0 ^ ((~BCu0) & BCa0);
+        Ako1 = BCo1 ^ ((~BCu1) & BCa1);
+        Aku0 = BCu0 ^ ((~BCa0) & BCe0);
+        Aku1 = BCu1 ^ ((~BCa1) & BCe1);
+
+        Ebu0 ^= Du0;
+        Ebu1 ^= Du1;
+        BCa0 = ROL32(Ebu1, 14);
+        BCa1 = ROL32(Ebu0, 13);
+        Ega0 ^= Da0;
+        Ega1 ^= Da1;
+        BCe0 = ROL32(Ega0, 18);
+        BCe1 = ROL32(Ega1, 18);
+        Eke0 ^= De0;
+        Eke1 ^= De1;
+        BCi0 = ROL32(Eke0, 5);
+        BCi1 = ROL32(Eke1, 5);
+        Emi0 ^= Di0;
+        Emi1 ^= Di1;
+        BCo0 = ROL32(Emi1, 8);
+        BCo1 = ROL32(Emi0, 7);
+        Eso0 ^= Do0;
+        Eso1 ^= Do1;
+        BCu0 = ROL32(Eso0, 28);
+        BCu1 = ROL32(Eso1, 28);
+        Ama0 = BCa0 ^ ((~BCe0) & BCi0);
+        Ama1 = BCa1 ^ ((~BCe1) & BCi1);
+        Ame0 = BCe0 ^ ((~BCi0) & BCo0);
+        Ame1 = BCe1 ^ ((~BCi1) & BCo1);
+        Ami0 = BCi0 ^ ((~BCo0) & BCu0);
+        Ami1 = BCi1 ^ ((~BCo1) & BCu1);
+        Amo0 = BCo0 ^ ((~BCu0) & BCa0);
+        Amo1 = BCo1 ^ ((~BCu1) & BCa1);
+        Amu0 = BCu0 ^ ((~BCa0) & BCe0);
+        Amu1 = BCu1 ^ ((~BCa1) & BCe1);
+
+        Ebi0 ^= Di0;
+        Ebi1 ^= Di1;
+        BCa0 = ROL32(Ebi0, 31);
+        BCa1 = ROL32(Ebi1, 31);
+        Ego0 ^= Do0;
+        Ego1 ^= Do1;
+        BCe0 = ROL32(Ego1, 28);
+        BCe1 = ROL32(Ego0, 27);
+        Eku0 ^= Du0;
+        Eku1 ^= Du1;
+        BCi0 = ROL32(Eku1, 20);
+        BCi1 = ROL32(Eku0, 19);
+        Ema0 ^= Da0;
+        Ema1 ^= Da1;
+        BCo0 = ROL32(Ema1, 21);
+        BCo1 = ROL32(Ema0, 20);
+        Ese0 ^= De0;
+        Ese1 ^= De1;
+        BCu0 = ROL32(Ese0, 1);
+        BCu1 = ROL32(Ese1, 1);
+        Asa0 = BCa0 ^ ((~BCe0) & BCi0);
+        Asa1 = BCa1 ^ ((~BCe1) & BCi1);
+        Ase0 = BCe0 ^ ((~BCi0) & BCo0);
+        Ase1 = BCe1 ^ ((~BCi1) & BCo1);
+        Asi0 = BCi0 ^ ((~BCo0) & BCu0);
+        Asi1 = BCi1 ^ ((~BCo1) & BCu1);
+        Aso0 = BCo0 ^ ((~BCu0) & BCa0);
+        Aso1 = BCo1 ^ ((~BCu1) & BCa1);
+        Asu0 = BCu0 ^ ((~BCa0) & BCe0);
+        Asu1 = BCu1 ^ ((~BCa1) & BCe1);
+    }
+
+    // copyToState(state, A)
+    state[0] = ((uint64_t)Aba1 << 32) | Aba0;
+    state[1] = ((uint64_t)Abe1 << 32) | Abe0;
+    state[2] = ((uint64_t)Abi1 << 32) | Abi0;
+    state[3] = ((uint64_t)Abo1 << 32) | Abo0;
+    state[4] = ((uint64_t)Abu1 << 32) | Abu0;
+    state[5] = ((uint64_t)Aga1 << 32) | Aga0;
+    state[6] = ((uint64_t)Age1 << 32) | Age0;
+    state[7] = ((uint64_t)Agi1 << 32) | Agi0;
+    state[8] = ((uint64_t)Ago1 << 32) | Ago0;
+    state[9] = ((uint64_t)Agu1 << 32) | Agu0;
+    state[10] = ((uint64_t)Aka1 << 32) | Aka0;
+    state[11] = ((uint64_t)Ake1 << 32) | Ake0;
+    state[12] = ((uint64_t)Aki1 << 32) | Aki0;
+    state[13] = ((uint64_t)Ako1 << 32) | Ako0;
+    state[14] = ((uint64_t)Aku1 << 32) | Aku0;
+    state[15] = ((uint64_t)Ama1 << 32) | Ama0;
+    state[16] = ((uint64_t)Ame1 << 32) | Ame0;
+    state[17] = ((uint64_t)Ami1 << 32) | Ami0;
+    state[18] = ((uint64_t)Amo1 << 32) | Amo0;
+    state[19] = ((uint64_t)Amu1 << 32) | Amu0;
+    state[20] = ((uint64_t)Asa1 << 32) | Asa0;
+    state[21] = ((uint64_t)Ase1 << 32) | Ase0;
+    state[22] = ((uint64_t)Asi1 << 32) | Asi0;
+    state[23] = ((uint64_t)Aso1 << 32) | Aso0;
+    state[24] = ((uint64_t)Asu1 << 32) | Asu0;
 }
 
+
+#else
+
 /* Keccak round constants */
 static const uint64_t KeccakF_RoundConstants[NROUNDS] = {
     0x0000000000000001ULL, 0x0000000000008082ULL,
@@ -333,50 +952,302 @@ static void KeccakF1600_StatePermute(uint64_t *state) {
     state[24] = Asu;
 }
 
+#endif
+
 /*************************************************
- * Name:        keccak_absorb
+ * Name:        keccak_xor_lane
  *
- * Description: Absorb step of Keccak;
- *              non-incremental, starts by zeroeing the state.
+ * Description: XOR a 64-bit lane into the state
  *
- * Arguments:   - uint64_t *s: pointer to (uninitialized) output Keccak state
+ * Arguments:   - uint64_t *s: pointer to input/output Keccak state
+ *              - size_t i: index of the lane
+ *              - uint64_t x: lane in standard representation
+ **************************************************/
+static void keccak_xor_lane(uint64_t *s, size_t i, uint64_t x) {
+#if defined(KECCAK_BITINTERLEAVED)
+    s[i] ^= bitinterleave(x);
+#else
+    s[i] ^= x;
+#endif
+}
+
+/*************************************************
+ * Name:        keccak_extract_lane
+ *
+ * Description: Read a 64-bit lane from the state
+ *
+ * Arguments:   - const uint64_t *s: pointer to Keccak state
+ *              - size_t i: index of the lane
+ *
+ * Returns the lane in standard representation
+ **************************************************/
+static uint64_t keccak_extract_lane(const uint64_t *s, size_t i) {
+#if defined(KECCAK_BITINTERLEAVED)
+    return bitdeinterleave(s[i]);
+#else
+    return s[i];
+#endif
+}
+
+/*************************************************
+ * Name:        keccak_xor_byte
+ *
+ * Description: XOR a single byte into the state
+ *
+ * Arguments:   - uint64_t *s: pointer to input/output Keccak state
+ *              - size_t pos: byte offset into the state (little-endian lanes)
+ *              - uint8_t b: byte to XOR in
+ **************************************************/
+static void keccak_xor_byte(uint64_t *s, size_t pos, uint8_t b) {
+#if defined(KECCAK_BITINTERLEAVED)
+    unsigned int sh = 4 * (pos & 0x07);
+    uint32_t e = b & 0x55;
+    uint32_t o = (b >> 1) & 0x55;
+
+    e = (e | (e >> 1)) & 0x33;
+    e = (e | (e >> 2)) & 0x0F;
+    o = (o | (o >> 1)) & 0x33;
+    o = (o | (o >> 2)) & 0x0F;
+    s[pos >> 3] ^= ((uint64_t)(o << sh) << 32) | (e << sh);
+#else
+    s[pos >> 3] ^= (uint64_t)b << (8 * (pos & 0x07));
+#endif
+}
+
+/*************************************************
+ * Name:        keccak_extract_byte
+ *
+ * Description: Read a single byte from the state
+ *
+ * Arguments:   - const uint64_t *s: pointer to Keccak state
+ *              - size_t pos: byte offset into the state (little-endian lanes)
+ *
+ * Returns the byte at offset pos
+ **************************************************/
+static uint8_t keccak_extract_byte(const uint64_t *s, size_t pos) {
+#if defined(KECCAK_BITINTERLEAVED)
+    unsigned int sh = 4 * (pos & 0x07);
+    uint32_t e = ((uint32_t)s[pos >> 3] >> sh) & 0x0F;
+    uint32_t o = ((uint32_t)(s[pos >> 3] >> 32) >> sh) & 0x0F;
+
+    e = (e | (e << 2)) & 0x33;
+    e = (e | (e << 1)) & 0x55;
+    o = (o | (o << 2)) & 0x33;
+    o = (o | (o << 1)) & 0x55;
+    return (uint8_t)(e | (o << 1));
+#else
+    return (uint8_t)(s[pos >> 3] >> (8 * (pos & 0x07)));
+#endif
+}
+
+/*************************************************
+ * Name:        keccak_absorb_bytes
+ *
+ * Description: XOR a fragment of input into the rate part of the state,
+ *              starting at byte offset pos, and permute whenever a full
+ *              block has been absorbed. Whole lanes are absorbed a word at
+ *              a time; only the bytes before the first and after the last
+ *              lane boundary go through keccak_xor_byte.
+ *
+ * Arguments:   - uint64_t *s: pointer to input/output Keccak state
  *              - uint32_t r: rate in bytes (e.g., 168 for SHAKE128)
+ *              - size_t pos: number of bytes already absorbed into the
+ *                            current block (less than r)
  *              - const uint8_t *m: pointer to input to be absorbed into s
  *              - size_t mlen: length of input in bytes
+ *
+ * Returns the new number of bytes absorbed into the current block (less than r)
+ **************************************************/
+static size_t keccak_absorb_bytes(uint64_t *s, uint32_t r, size_t pos,
+                                  const uint8_t *m, size_t mlen) {
+    while (mlen > 0 && (pos & 0x07) != 0) {
+        keccak_xor_byte(s, pos++, *m++);
+        mlen--;
+        if (pos == r) {
+            KeccakF1600_StatePermute(s);
+            pos = 0;
+        }
+    }
+
+    while (mlen >= 8) {
+        keccak_xor_lane(s, pos >> 3, load64(m));
+        pos += 8;
+        m += 8;
+        mlen -= 8;
+        if (pos == r) {
+            KeccakF1600_StatePermute(s);
+            pos = 0;
+        }
+    }
+
+    /* pos is lane-aligned here and r is a multiple of 8,
+       so the remaining bytes cannot complete a block */
+    while (mlen > 0) {
+        keccak_xor_byte(s, pos++, *m++);
+        mlen--;
+    }
+
+    return pos;
+}
+
+/*************************************************
+ * Name:        keccak_squeeze_bytes
+ *
+ * Description: Squeeze outlen bytes directly into the output, starting at
+ *              byte offset pos of the current block, and permute whenever
+ *              the current block is used up. Whole lanes are written a word
+ *              at a time.
+ *
+ * Arguments:   - uint8_t *h: pointer to output bytes
+ *              - size_t outlen: number of bytes to be squeezed
+ *              - uint64_t *s: pointer to input/output Keccak state
+ *              - uint32_t r: rate in bytes (e.g., 168 for SHAKE128)
+ *              - size_t pos: number of bytes of the current block already
+ *                            squeezed; r means none are left
+ *
+ * Returns the new number of squeezed bytes of the current block
+ **************************************************/
+static size_t keccak_squeeze_bytes(uint8_t *h, size_t outlen,
+                                   uint64_t *s, uint32_t r, size_t pos) {
+    while (outlen > 0) {
+        if (pos == r) {
+            KeccakF1600_StatePermute(s);
+            pos = 0;
+        }
+        if ((pos & 0x07) == 0 && outlen >= 8) {
+            store64(h, keccak_extract_lane(s, pos >> 3));
+            h += 8;
+            pos += 8;
+            outlen -= 8;
+        } else {
+            *h++ = keccak_extract_byte(s, pos++);
+            outlen--;
+        }
+    }
+
+    return pos;
+}
+
+/*************************************************
+ * Name:        keccak_absorb_iov_generic
+ *
+ * Description: Absorb step of Keccak over a list of input fragments of any
+ *              length; non-incremental, starts by zeroeing the state.
+ *
+ * Arguments:   - uint64_t *s: pointer to (uninitialized) output Keccak state
+ *              - uint32_t r: rate in bytes (e.g., 168 for SHAKE128)
+ *              - const keccak_iovec *iov: pointer to the input fragments
+ *              - size_t iovcnt: number of fragments
  *              - uint8_t p: domain-separation byte for different
  *                                 Keccak-derived functions
  **************************************************/
-static void keccak_absorb(uint64_t *s, uint32_t r, const uint8_t *m,
-                          size_t mlen, uint8_t p) {
-    size_t i;
-    uint8_t t[200];
+static void keccak_absorb_iov_generic(uint64_t *s, uint32_t r, const keccak_iovec *iov,
+                                      size_t iovcnt, uint8_t p) {
+    size_t i, pos = 0;
 
     /* Zero state */
     for (i = 0; i < 25; ++i) {
         s[i] = 0;
     }
 
-    while (mlen >= r) {
-        for (i = 0; i < r / 8; ++i) {
-            s[i] ^= load64(m + 8 * i);
-        }
-
-        KeccakF1600_StatePermute(s);
-        mlen -= r;
-        m += r;
+    for (i = 0; i < iovcnt; ++i) {
+        pos = keccak_absorb_bytes(s, r, pos, iov[i].base, iov[i].len);
     }
 
-    for (i = 0; i < r; ++i) {
-        t[i] = 0;
+    keccak_xor_byte(s, pos, p);
+    keccak_xor_byte(s, r - 1, 128);
+}
+
+/*************************************************
+ * Name:        keccak_absorb_once_32
+ *
+ * Description: Single-block absorb of a 32-byte prefix followed by a blen-byte
+ *              suffix, the input shape of every short hash in ML-KEM
+ *              (seed || x || y, key || nonce, m || H(pk), d || k).
+ *              Non-incremental, overwrites the whole state. With r, blen and
+ *              p constant this is straight-line lane loads and the padding.
+ *
+ * Arguments:   - uint64_t *s: pointer to (uninitialized) output Keccak state
+ *              - uint32_t r: rate in bytes; must exceed 32 + blen
+ *              - const uint8_t *a: pointer to the 32-byte prefix
+ *              - const uint8_t *b: pointer to the suffix
+ *              - size_t blen: length of the suffix in bytes
+ *              - uint8_t p: domain-separation byte for different
+ *                                 Keccak-derived functions
+ **************************************************/
+KECCAK_INLINE void keccak_absorb_once_32(uint64_t *s, uint32_t r, const uint8_t *a,
+                                         const uint8_t *b, size_t blen, uint8_t p) {
+    size_t i;
+
+    for (i = 0; i < 25; ++i) {
+        s[i] = 0;
+    }
+    for (i = 0; i < 4; ++i) {
+        keccak_xor_lane(s, i, load64(a + 8 * i));
     }
-    for (i = 0; i < mlen; ++i) {
-        t[i] = m[i];
+    for (i = 0; i < blen / 8; ++i) {
+        keccak_xor_lane(s, 4 + i, load64(b + 8 * i));
     }
-    t[i] = p;
-    t[r - 1] |= 128;
-    for (i = 0; i < r / 8; ++i) {
-        s[i] ^= load64(t + 8 * i);
+    keccak_xor_lane(s, 4 + i, load64_partial(b + 8 * i, blen & 0x07) ^ ((uint64_t)p << 8 * (blen & 0x07)));
+    keccak_xor_lane(s, r / 8 - 1, (uint64_t)1 << 63);
+}
+
+/*************************************************
+ * Name:        keccak_absorb_iov
+ *
+ * Description: Absorb step of Keccak over a list of input fragments;
+ *              non-incremental, starts by zeroeing the state. The result
+ *              is the same as absorbing the concatenation of all fragments.
+ *              Inputs of the fixed ML-KEM shapes take keccak_absorb_once_32.
+ *
+ * Arguments:   - uint64_t *s: pointer to (uninitialized) output Keccak state
+ *              - uint32_t r: rate in bytes (e.g., 168 for SHAKE128)
+ *              - const keccak_iovec *iov: pointer to the input fragments
+ *              - size_t iovcnt: number of fragments
+ *              - uint8_t p: domain-separation byte for different
+ *                                 Keccak-derived functions
+ **************************************************/
+KECCAK_INLINE void keccak_absorb_iov(uint64_t *s, uint32_t r, const keccak_iovec *iov,
+                                     size_t iovcnt, uint8_t p) {
+    if (iovcnt == 2 && iov[0].len == 32) {
+        switch (iov[1].len) {
+        case 1:
+            keccak_absorb_once_32(s, r, iov[0].base, iov[1].base, 1, p);
+            return;
+        case 2:
+            keccak_absorb_once_32(s, r, iov[0].base, iov[1].base, 2, p);
+            return;
+        case 32:
+            keccak_absorb_once_32(s, r, iov[0].base, iov[1].base, 32, p);
+            return;
+        default:
+            break;
+        }
     }
+
+    keccak_absorb_iov_generic(s, r, iov, iovcnt, p);
+}
+
+/*************************************************
+ * Name:        keccak_absorb
+ *
+ * Description: Absorb step of Keccak;
+ *              non-incremental, starts by zeroeing the state.
+ *
+ * Arguments:   - uint64_t *s: pointer to (uninitialized) output Keccak state
+ *              - uint32_t r: rate in bytes (e.g., 168 for SHAKE128)
+ *              - const uint8_t *m: pointer to input to be absorbed into s
+ *              - size_t mlen: length of input in bytes
+ *              - uint8_t p: domain-separation byte for different
+ *                                 Keccak-derived functions
+ **************************************************/
+static void keccak_absorb(uint64_t *s, uint32_t r, const uint8_t *m,
+                          size_t mlen, uint8_t p) {
+    keccak_iovec iov;
+
+    iov.base = m;
+    iov.len = mlen;
+    keccak_absorb_iov_generic(s, r, &iov, 1, p);
 }
 
 /*************************************************
@@ -397,13 +1268,29 @@ static void keccak_squeezeblocks(uint8_t *h, size_t nblocks,
     while (nblocks > 0) {
         KeccakF1600_StatePermute(s);
         for (size_t i = 0; i < (r >> 3); i++) {
-            store64(h + 8 * i, s[i]);
+            store64(h + 8 * i, keccak_extract_lane(s, i));
         }
         h += r;
         nblocks--;
     }
 }
 
+/*************************************************
+ * Name:        keccak_squeeze
+ *
+ * Description: Squeeze step of Keccak for an arbitrary output length,
+ *              written directly to the output. Not incremental: must be
+ *              called exactly once after absorbing.
+ *
+ * Arguments:   - uint8_t *h: pointer to output bytes
+ *              - size_t outlen: number of bytes to be squeezed
+ *              - uint64_t *s: pointer to input/output Keccak state
+ *              - uint32_t r: rate in bytes (e.g., 168 for SHAKE128)
+ **************************************************/
+static void keccak_squeeze(uint8_t *h, size_t outlen, uint64_t *s, uint32_t r) {
+    keccak_squeeze_bytes(h, outlen, s, r, r);
+}
+
 /*************************************************
  * Name:        keccak_inc_init
  *
@@ -439,26 +1326,8 @@ static void keccak_inc_init(uint64_t *s_inc) {
  **************************************************/
 static void keccak_inc_absorb(uint64_t *s_inc, uint32_t r, const uint8_t *m,
                               size_t mlen) {
-    size_t i;
-
     /* Recall that s_inc[25] is the non-absorbed bytes xored into the state */
-    while (mlen + s_inc[25] >= r) {
-        for (i = 0; i < r - (uint32_t)s_inc[25]; i++) {
-            /* Take the i'th byte from message
-               xor with the s_inc[25] + i'th byte of the state; little-endian */
-            s_inc[(s_inc[25] + i) >> 3] ^= (uint64_t)m[i] << (8 * ((s_inc[25] + i) & 0x07));
-        }
-        mlen -= (size_t)(r - s_inc[25]);
-        m += r - s_inc[25];
-        s_inc[25] = 0;
-
-        KeccakF1600_StatePermute(s_inc);
-    }
-
-    for (i = 0; i < mlen; i++) {
-        s_inc[(s_inc[25] + i) >> 3] ^= (uint64_t)m[i] << (8 * ((s_inc[25] + i) & 0x07));
-    }
-    s_inc[25] += mlen;
+    s_inc[25] = keccak_absorb_bytes(s_inc, r, (size_t)s_inc[25], m, mlen);
 }
 
 /*************************************************
@@ -477,8 +1346,8 @@ static void keccak_inc_absorb(uint64_t *s_inc, uint32_t r, const uint8_t *m,
 static void keccak_inc_finalize(uint64_t *s_inc, uint32_t r, uint8_t p) {
     /* After keccak_inc_absorb, we are guaranteed that s_inc[25] < r,
        so we can always use one more byte for p in the current state. */
-    s_inc[s_inc[25] >> 3] ^= (uint64_t)p << (8 * (s_inc[25] & 0x07));
-    s_inc[(r - 1) >> 3] ^= (uint64_t)128 << (8 * ((r - 1) & 0x07));
+    keccak_xor_byte(s_inc, (size_t)s_inc[25], p);
+    keccak_xor_byte(s_inc, r - 1, 128);
     s_inc[25] = 0;
 }
 
@@ -497,36 +1366,28 @@ static void keccak_inc_finalize(uint64_t *s_inc, uint32_t r, uint8_t p) {
  **************************************************/
 static void keccak_inc_squeeze(uint8_t *h, size_t outlen,
                                uint64_t *s_inc, uint32_t r) {
-    size_t i;
-
-    /* First consume any bytes we still have sitting around */
-    for (i = 0; i < outlen && i < s_inc[25]; i++) {
-        /* There are s_inc[25] bytes left, so r - s_inc[25] is the first
-           available byte. We consume from there, i.e., up to r. */
-        h[i] = (uint8_t)(s_inc[(r - s_inc[25] + i) >> 3] >> (8 * ((r - s_inc[25] + i) & 0x07)));
-    }
-    h += i;
-    outlen -= i;
-    s_inc[25] -= i;
-
-    /* Then squeeze the remaining necessary blocks */
-    while (outlen > 0) {
-        KeccakF1600_StatePermute(s_inc);
+    /* There are s_inc[25] bytes left, so r - s_inc[25] is the first
+       available byte. */
+    s_inc[25] = r - keccak_squeeze_bytes(h, outlen, s_inc, r, (size_t)(r - s_inc[25]));
+}
 
-        for (i = 0; i < outlen && i < r; i++) {
-            h[i] = (uint8_t)(s_inc[i >> 3] >> (8 * (i & 0x07)));
-        }
-        h += i;
-        outlen -= i;
-        s_inc[25] = r - i;
+/*************************************************
+ * Name:        keccak_ctx_wipe
+ *
+ * Description: Clears a caller-owned Keccak context. The volatile stores keep
+ *              the compiler from dropping the wipe as a dead store.
+ *
+ * Arguments:   - uint64_t *s: pointer to the context words
+ *              - size_t nwords: number of 64-bit words in the context
+ **************************************************/
+static void keccak_ctx_wipe(uint64_t *s, size_t nwords) {
+    volatile uint64_t *v = s;
+    for (size_t i = 0; i < nwords; ++i) {
+        v[i] = 0;
     }
 }
 
 void shake128_inc_init(shake128incctx *state) {
-    state->ctx = malloc(PQC_SHAKEINCCTX_BYTES);
-    if (state->ctx == NULL) {
-        exit(111);
-    }
     keccak_inc_init(state->ctx);
 }
 
@@ -543,22 +1404,14 @@ void shake128_inc_squeeze(uint8_t *output, size_t outlen, shake128incctx *state)
 }
 
 void shake128_inc_ctx_clone(shake128incctx *dest, const shake128incctx *src) {
-    dest->ctx = malloc(PQC_SHAKEINCCTX_BYTES);
-    if (dest->ctx == NULL) {
-        exit(111);
-    }
     memcpy(dest->ctx, src->ctx, PQC_SHAKEINCCTX_BYTES);
 }
 
 void shake128_inc_ctx_release(shake128incctx *state) {
-    free(state->ctx);
+    keccak_ctx_wipe(state->ctx, sizeof(state->ctx) / sizeof(state->ctx[0]));
 }
 
 void shake256_inc_init(shake256incctx *state) {
-    state->ctx = malloc(PQC_SHAKEINCCTX_BYTES);
-    if (state->ctx == NULL) {
-        exit(111);
-    }
     keccak_inc_init(state->ctx);
 }
 
@@ -575,15 +1428,11 @@ void shake256_inc_squeeze(uint8_t *output, size_t outlen, shake256incctx *state)
 }
 
 void shake256_inc_ctx_clone(shake256incctx *dest, const shake256incctx *src) {
-    dest->ctx = malloc(PQC_SHAKEINCCTX_BYTES);
-    if (dest->ctx == NULL) {
-        exit(111);
-    }
     memcpy(dest->ctx, src->ctx, PQC_SHAKEINCCTX_BYTES);
 }
 
 void shake256_inc_ctx_release(shake256incctx *state) {
-    free(state->ctx);
+    keccak_ctx_wipe(state->ctx, sizeof(state->ctx) / sizeof(state->ctx[0]));
 }
 
 /*************************************************
@@ -598,13 +1447,23 @@ void shake256_inc_ctx_release(shake256incctx *state) {
  *              - size_t inlen: length of input in bytes
  **************************************************/
 void shake128_absorb(shake128ctx *state, const uint8_t *input, size_t inlen) {
-    state->ctx = malloc(PQC_SHAKECTX_BYTES);
-    if (state->ctx == NULL) {
-        exit(111);
-    }
     keccak_absorb(state->ctx, SHAKE128_RATE, input, inlen, 0x1F);
 }
 
+/*************************************************
+ * Name:        shake128_absorb_iov
+ *
+ * Description: Absorb step of the SHAKE128 XOF over a list of fragments.
+ *              non-incremental, starts by zeroeing the state.
+ *
+ * Arguments:   - shake128ctx *state: pointer to (uninitialized) output Keccak state
+ *              - const keccak_iovec *iov: pointer to the input fragments
+ *              - size_t iovcnt: number of fragments
+ **************************************************/
+void shake128_absorb_iov(shake128ctx *state, const keccak_iovec *iov, size_t iovcnt) {
+    keccak_absorb_iov(state->ctx, SHAKE128_RATE, iov, iovcnt, 0x1F);
+}
+
 /*************************************************
  * Name:        shake128_squeezeblocks
  *
@@ -622,16 +1481,12 @@ void shake128_squeezeblocks(uint8_t *output, size_t nblocks, shake128ctx *state)
 }
 
 void shake128_ctx_clone(shake128ctx *dest, const shake128ctx *src) {
-    dest->ctx = malloc(PQC_SHAKECTX_BYTES);
-    if (dest->ctx == NULL) {
-        exit(111);
-    }
     memcpy(dest->ctx, src->ctx, PQC_SHAKECTX_BYTES);
 }
 
-/** Release the allocated state. Call only once. */
+/** Wipe the state; the context itself is owned by the caller. */
 void shake128_ctx_release(shake128ctx *state) {
-    free(state->ctx);
+    keccak_ctx_wipe(state->ctx, sizeof(state->ctx) / sizeof(state->ctx[0]));
 }
 
 /*************************************************
@@ -646,13 +1501,23 @@ void shake128_ctx_release(shake128ctx *state) {
  *              - size_t inlen: length of input in bytes
  **************************************************/
 void shake256_absorb(shake256ctx *state, const uint8_t *input, size_t inlen) {
-    state->ctx = malloc(PQC_SHAKECTX_BYTES);
-    if (state->ctx == NULL) {
-        exit(111);
-    }
     keccak_absorb(state->ctx, SHAKE256_RATE, input, inlen, 0x1F);
 }
 
+/*************************************************
+ * Name:        shake256_absorb_iov
+ *
+ * Description: Absorb step of the SHAKE256 XOF over a list of fragments.
+ *              non-incremental, starts by zeroeing the state.
+ *
+ * Arguments:   - shake256ctx *state: pointer to (uninitialized) output Keccak state
+ *              - const keccak_iovec *iov: pointer to the input fragments
+ *              - size_t iovcnt: number of fragments
+ **************************************************/
+void shake256_absorb_iov(shake256ctx *state, const keccak_iovec *iov, size_t iovcnt) {
+    keccak_absorb_iov(state->ctx, SHAKE256_RATE, iov, iovcnt, 0x1F);
+}
+
 /*************************************************
  * Name:        shake256_squeezeblocks
  *
@@ -670,16 +1535,12 @@ void shake256_squeezeblocks(uint8_t *output, size_t nblocks, shake256ctx *state)
 }
 
 void shake256_ctx_clone(shake256ctx *dest, const shake256ctx *src) {
-    dest->ctx = malloc(PQC_SHAKECTX_BYTES);
-    if (dest->ctx == NULL) {
-        exit(111);
-    }
     memcpy(dest->ctx, src->ctx, PQC_SHAKECTX_BYTES);
 }
 
-/** Release the allocated state. Call only once. */
+/** Wipe the state; the context itself is owned by the caller. */
 void shake256_ctx_release(shake256ctx *state) {
-    free(state->ctx);
+    keccak_ctx_wipe(state->ctx, sizeof(state->ctx) / sizeof(state->ctx[0]));
 }
 
 /*************************************************
@@ -694,22 +1555,10 @@ void shake256_ctx_release(shake256ctx *state) {
  **************************************************/
 void shake128(uint8_t *output, size_t outlen,
               const uint8_t *input, size_t inlen) {
-    size_t nblocks = outlen / SHAKE128_RATE;
-    uint8_t t[SHAKE128_RATE];
     shake128ctx s;
 
     shake128_absorb(&s, input, inlen);
-    shake128_squeezeblocks(output, nblocks, &s);
-
-    output += nblocks * SHAKE128_RATE;
-    outlen -= nblocks * SHAKE128_RATE;
-
-    if (outlen) {
-        shake128_squeezeblocks(t, 1, &s);
-        for (size_t i = 0; i < outlen; ++i) {
-            output[i] = t[i];
-        }
-    }
+    keccak_squeeze(output, outlen, s.ctx, SHAKE128_RATE);
     shake128_ctx_release(&s);
 }
 
@@ -725,43 +1574,43 @@ void shake128(uint8_t *output, size_t outlen,
  **************************************************/
 void shake256(uint8_t *output, size_t outlen,
               const uint8_t *input, size_t inlen) {
-    size_t nblocks = outlen / SHAKE256_RATE;
-    uint8_t t[SHAKE256_RATE];
     shake256ctx s;
 
     shake256_absorb(&s, input, inlen);
-    shake256_squeezeblocks(output, nblocks, &s);
+    keccak_squeeze(output, outlen, s.ctx, SHAKE256_RATE);
+    shake256_ctx_release(&s);
+}
 
-    output += nblocks * SHAKE256_RATE;
-    outlen -= nblocks * SHAKE256_RATE;
+/*************************************************
+ * Name:        shake256_iov
+ *
+ * Description: SHAKE256 XOF with non-incremental API over a list of
+ *              input fragments
+ *
+ * Arguments:   - uint8_t *output: pointer to output
+ *              - size_t outlen: requested output length in bytes
+ *              - const keccak_iovec *iov: pointer to the input fragments
+ *              - size_t iovcnt: number of fragments
+ **************************************************/
+void shake256_iov(uint8_t *output, size_t outlen,
+                  const keccak_iovec *iov, size_t iovcnt) {
+    shake256ctx s;
 
-    if (outlen) {
-        shake256_squeezeblocks(t, 1, &s);
-        for (size_t i = 0; i < outlen; ++i) {
-            output[i] = t[i];
-        }
-    }
+    shake256_absorb_iov(&s, iov, iovcnt);
+    keccak_squeeze(output, outlen, s.ctx, SHAKE256_RATE);
     shake256_ctx_release(&s);
 }
 
 void sha3_256_inc_init(sha3_256incctx *state) {
-    state->ctx = malloc(PQC_SHAKEINCCTX_BYTES);
-    if (state->ctx == NULL) {
-        exit(111);
-    }
     keccak_inc_init(state->ctx);
 }
 
 void sha3_256_inc_ctx_clone(sha3_256incctx *dest, const sha3_256incctx *src) {
-    dest->ctx = malloc(PQC_SHAKEINCCTX_BYTES);
-    if (dest->ctx == NULL) {
-        exit(111);
-    }
     memcpy(dest->ctx, src->ctx, PQC_SHAKEINCCTX_BYTES);
 }
 
 void sha3_256_inc_ctx_release(sha3_256incctx *state) {
-    free(state->ctx);
+    keccak_ctx_wipe(state->ctx, sizeof(state->ctx) / sizeof(state->ctx[0]));
 }
 
 void sha3_256_inc_absorb(sha3_256incctx *state, const uint8_t *input, size_t inlen) {
@@ -769,16 +1618,11 @@ void sha3_256_inc_absorb(sha3_256incctx *state, const uint8_t *input, size_t inl
 }
 
 void sha3_256_inc_finalize(uint8_t *output, sha3_256incctx *state) {
-    uint8_t t[SHA3_256_RATE];
     keccak_inc_finalize(state->ctx, SHA3_256_RATE, 0x06);
 
-    keccak_squeezeblocks(t, 1, state->ctx, SHA3_256_RATE);
+    keccak_squeeze(output, 32, state->ctx, SHA3_256_RATE);
 
     sha3_256_inc_ctx_release(state);
-
-    for (size_t i = 0; i < 32; i++) {
-        output[i] = t[i];
-    }
 }
 
 /*************************************************
@@ -792,32 +1636,39 @@ void sha3_256_inc_finalize(uint8_t *output, sha3_256incctx *state) {
  **************************************************/
 void sha3_256(uint8_t *output, const uint8_t *input, size_t inlen) {
     uint64_t s[25];
-    uint8_t t[SHA3_256_RATE];
 
     /* Absorb input */
     keccak_absorb(s, SHA3_256_RATE, input, inlen, 0x06);
 
     /* Squeeze output */
-    keccak_squeezeblocks(t, 1, s, SHA3_256_RATE);
+    keccak_squeeze(output, 32, s, SHA3_256_RATE);
+}
 
-    for (size_t i = 0; i < 32; i++) {
-        output[i] = t[i];
-    }
+/*************************************************
+ * Name:        sha3_256_iov
+ *
+ * Description: SHA3-256 with non-incremental API over a list of
+ *              input fragments
+ *
+ * Arguments:   - uint8_t *output:            pointer to output
+ *              - const keccak_iovec *iov:    pointer to the input fragments
+ *              - size_t iovcnt:              number of fragments
+ **************************************************/
+void sha3_256_iov(uint8_t *output, const keccak_iovec *iov, size_t iovcnt) {
+    uint64_t s[25];
+
+    /* Absorb input */
+    keccak_absorb_iov(s, SHA3_256_RATE, iov, iovcnt, 0x06);
+
+    /* Squeeze output */
+    keccak_squeeze(output, 32, s, SHA3_256_RATE);
 }
 
 void sha3_384_inc_init(sha3_384incctx *state) {
-    state->ctx = malloc(PQC_SHAKEINCCTX_BYTES);
-    if (state->ctx == NULL) {
-        exit(111);
-    }
     keccak_inc_init(state->ctx);
 }
 
 void sha3_384_inc_ctx_clone(sha3_384incctx *dest, const sha3_384incctx *src) {
-    dest->ctx = malloc(PQC_SHAKEINCCTX_BYTES);
-    if (dest->ctx == NULL) {
-        exit(111);
-    }
     memcpy(dest->ctx, src->ctx, PQC_SHAKEINCCTX_BYTES);
 }
 
@@ -826,20 +1677,15 @@ void sha3_384_inc_absorb(sha3_384incctx *state, const uint8_t *input, size_t inl
 }
 
 void sha3_384_inc_ctx_release(sha3_384incctx *state) {
-    free(state->ctx);
+    keccak_ctx_wipe(state->ctx, sizeof(state->ctx) / sizeof(state->ctx[0]));
 }
 
 void sha3_384_inc_finalize(uint8_t *output, sha3_384incctx *state) {
-    uint8_t t[SHA3_384_RATE];
     keccak_inc_finalize(state->ctx, SHA3_384_RATE, 0x06);
 
-    keccak_squeezeblocks(t, 1, state->ctx, SHA3_384_RATE);
+    keccak_squeeze(output, 48, state->ctx, SHA3_384_RATE);
 
     sha3_384_inc_ctx_release(state);
-
-    for (size_t i = 0; i < 48; i++) {
-        output[i] = t[i];
-    }
 }
 
 /*************************************************
@@ -853,32 +1699,19 @@ void sha3_384_inc_finalize(uint8_t *output, sha3_384incctx *state) {
  **************************************************/
 void sha3_384(uint8_t *output, const uint8_t *input, size_t inlen) {
     uint64_t s[25];
-    uint8_t t[SHA3_384_RATE];
 
     /* Absorb input */
     keccak_absorb(s, SHA3_384_RATE, input, inlen, 0x06);
 
     /* Squeeze output */
-    keccak_squeezeblocks(t, 1, s, SHA3_384_RATE);
-
-    for (size_t i = 0; i < 48; i++) {
-        output[i] = t[i];
-    }
+    keccak_squeeze(output, 48, s, SHA3_384_RATE);
 }
 
 void sha3_512_inc_init(sha3_512incctx *state) {
-    state->ctx = malloc(PQC_SHAKEINCCTX_BYTES);
-    if (state->ctx == NULL) {
-        exit(111);
-    }
     keccak_inc_init(state->ctx);
 }
 
 void sha3_512_inc_ctx_clone(sha3_512incctx *dest, const sha3_512incctx *src) {
-    dest->ctx = malloc(PQC_SHAKEINCCTX_BYTES);
-    if (dest->ctx == NULL) {
-        exit(111);
-    }
     memcpy(dest->ctx, src->ctx, PQC_SHAKEINCCTX_BYTES);
 }
 
@@ -887,20 +1720,15 @@ void sha3_512_inc_absorb(sha3_512incctx *state, const uint8_t *input, size_t inl
 }
 
 void sha3_512_inc_ctx_release(sha3_512incctx *state) {
-    free(state->ctx);
+    keccak_ctx_wipe(state->ctx, sizeof(state->ctx) / sizeof(state->ctx[0]));
 }
 
 void sha3_512_inc_finalize(uint8_t *output, sha3_512incctx *state) {
-    uint8_t t[SHA3_512_RATE];
     keccak_inc_finalize(state->ctx, SHA3_512_RATE, 0x06);
 
-    keccak_squeezeblocks(t, 1, state->ctx, SHA3_512_RATE);
+    keccak_squeeze(output, 64, state->ctx, SHA3_512_RATE);
 
     sha3_512_inc_ctx_release(state);
-
-    for (size_t i = 0; i < 64; i++) {
-        output[i] = t[i];
-    }
 }
 
 /*************************************************
@@ -914,15 +1742,30 @@ void sha3_512_inc_finalize(uint8_t *output, sha3_512incctx *state) {
  **************************************************/
 void sha3_512(uint8_t *output, const uint8_t *input, size_t inlen) {
     uint64_t s[25];
-    uint8_t t[SHA3_512_RATE];
 
     /* Absorb input */
     keccak_absorb(s, SHA3_512_RATE, input, inlen, 0x06);
 
     /* Squeeze output */
-    keccak_squeezeblocks(t, 1, s, SHA3_512_RATE);
+    keccak_squeeze(output, 64, s, SHA3_512_RATE);
+}
 
-    for (size_t i = 0; i < 64; i++) {
-        output[i] = t[i];
-    }
+/*************************************************
+ * Name:        sha3_512_iov
+ *
+ * Description: SHA3-512 with non-incremental API over a list of
+ *              input fragments
+ *
+ * Arguments:   - uint8_t *output:            pointer to output
+ *              - const keccak_iovec *iov:    pointer to the input fragments
+ *              - size_t iovcnt:              number of fragments
+ **************************************************/
+void sha3_512_iov(uint8_t *output, const keccak_iovec *iov, size_t iovcnt) {
+    uint64_t s[25];
+
+    /* Absorb input */
+    keccak_absorb_iov(s, SHA3_512_RATE, iov, iovcnt, 0x06);
+
+    /* Squeeze output */
+    keccak_squeeze(output, 64, s, SHA3_512_RATE);
 }
@@ -13,39 +13,52 @@
 #define PQC_SHAKEINCCTX_BYTES (sizeof(uint64_t)*26)
 #define PQC_SHAKECTX_BYTES (sizeof(uint64_t)*25)
 
+/* The contexts below carry the Keccak state inline, so they live wherever
+ * the caller puts them (stack, static storage or an arena) and none of the
+ * functions in this file touch the heap. The *_ctx_release functions are
+ * kept for API compatibility; they only wipe the state. */
+
+/* One fragment of a scatter/gather input. Absorbing a list of fragments
+ * gives the same result as absorbing their concatenation, without the
+ * caller assembling them into one buffer first. */
+typedef struct {
+    const uint8_t *base;
+    size_t len;
+} keccak_iovec;
+
 // Context for incremental API
 typedef struct {
-    uint64_t *ctx;
+    uint64_t ctx[PQC_SHAKEINCCTX_BYTES / sizeof(uint64_t)];
 } shake128incctx;
 
 // Context for non-incremental API
 typedef struct {
-    uint64_t *ctx;
+    uint64_t ctx[PQC_SHAKECTX_BYTES / sizeof(uint64_t)];
 } shake128ctx;
 
 // Context for incremental API
 typedef struct {
-    uint64_t *ctx;
+    uint64_t ctx[PQC_SHAKEINCCTX_BYTES / sizeof(uint64_t)];
 } shake256incctx;
 
 // Context for non-incremental API
 typedef struct {
-    uint64_t *ctx;
+    uint64_t ctx[PQC_SHAKECTX_BYTES / sizeof(uint64_t)];
 } shake256ctx;
 
 // Context for incremental API
 typedef struct {
-    uint64_t *ctx;
+    uint64_t ctx[PQC_SHAKEINCCTX_BYTES / sizeof(uint64_t)];
 } sha3_256incctx;
 
 // Context for incremental API
 typedef struct {
-    uint64_t *ctx;
+    uint64_t ctx[PQC_SHAKEINCCTX_BYTES / sizeof(uint64_t)];
 } sha3_384incctx;
 
 // Context for incremental API
 typedef struct {
-    uint64_t *ctx;
+    uint64_t ctx[PQC_SHAKEINCCTX_BYTES / sizeof(uint64_t)];
 } sha3_512incctx;
 
 /* Initialize the state and absorb the provided input.
@@ -54,12 +67,14 @@ typedef struct {
  * with the same state.
  */
 void shake128_absorb(shake128ctx *state, const uint8_t *input, size_t inlen);
+/* As shake128_absorb, over a list of input fragments */
+void shake128_absorb_iov(shake128ctx *state, const keccak_iovec *iov, size_t iovcnt);
 /* Squeeze output out of the sponge.
  *
  * Supports being called multiple times
  */
 void shake128_squeezeblocks(uint8_t *output, size_t nblocks, shake128ctx *state);
-/* Free the state */
+/* Wipe the state */
 void shake128_ctx_release(shake128ctx *state);
 /* Copy the state. */
 void shake128_ctx_clone(shake128ctx *dest, const shake128ctx *src);
@@ -80,7 +95,7 @@ void shake128_inc_finalize(shake128incctx *state);
 void shake128_inc_squeeze(uint8_t *output, size_t outlen, shake128incctx *state);
 /* Copy the context of the SHAKE128 XOF */
 void shake128_inc_ctx_clone(shake128incctx *dest, const shake128incctx *src);
-/* Free the context of the SHAKE128 XOF */
+/* Wipe the context of the SHAKE128 XOF */
 void shake128_inc_ctx_release(shake128incctx *state);
 
 /* Initialize the state and absorb the provided input.
@@ -89,12 +104,14 @@ void shake128_inc_ctx_release(shake128incctx *state);
  * with the same state.
  */
 void shake256_absorb(shake256ctx *state, const uint8_t *input, size_t inlen);
+/* As shake256_absorb, over a list of input fragments */
+void shake256_absorb_iov(shake256ctx *state, const keccak_iovec *iov, size_t iovcnt);
 /* Squeeze output out of the sponge.
  *
  * Supports being called multiple times
  */
 void shake256_squeezeblocks(uint8_t *output, size_t nblocks, shake256ctx *state);
-/* Free the context held by this XOF */
+/* Wipe the context held by this XOF */
 void shake256_ctx_release(shake256ctx *state);
 /* Copy the context held by this XOF */
 void shake256_ctx_clone(shake256ctx *dest, const shake256ctx *src);
@@ -111,7 +128,7 @@ void shake256_inc_finalize(shake256incctx *state);
 void shake256_inc_squeeze(uint8_t *output, size_t outlen, shake256incctx *state);
 /* Copy the state */
 void shake256_inc_ctx_clone(shake256incctx *dest, const shake256incctx *src);
-/* Free the state */
+/* Wipe the state */
 void shake256_inc_ctx_release(shake256incctx *state);
 
 /* One-stop SHAKE128 call */
@@ -121,12 +138,15 @@ void shake128(uint8_t *output, size_t outlen,
 /* One-stop SHAKE256 call */
 void shake256(uint8_t *output, size_t outlen,
               const uint8_t *input, size_t inlen);
+/* One-stop SHAKE256 call over a list of input fragments */
+void shake256_iov(uint8_t *output, size_t outlen,
+                  const keccak_iovec *iov, size_t iovcnt);
 
 /* Initialize the incremental hashing state */
 void sha3_256_inc_init(sha3_256incctx *state);
 /* Absorb blocks into SHA3 */
 void sha3_256_inc_absorb(sha3_256incctx *state, const uint8_t *input, size_t inlen);
-/* Obtain the output of the function and free `state` */
+/* Obtain the output of the function and wipe `state` */
 void sha3_256_inc_finalize(uint8_t *output, sha3_256incctx *state);
 /* Copy the context */
 void sha3_256_inc_ctx_clone(sha3_256incctx *dest, const sha3_256incctx *src);
@@ -134,12 +154,14 @@ void sha3_256_inc_ctx_clone(sha3_256incctx *dest, const sha3_256incctx *src);
 void sha3_256_inc_ctx_release(sha3_256incctx *state);
 
 void sha3_256(uint8_t *output, const uint8_t *input, size_t inlen);
+/* SHA3-256 over a list of input fragments */
+void sha3_256_iov(uint8_t *output, const keccak_iovec *iov, size_t iovcnt);
 
 /* Initialize the incremental hashing state */
 void sha3_384_inc_init(sha3_384incctx *state);
 /* Absorb blocks into SHA3 */
 void sha3_384_inc_absorb(sha3_384incctx *state, const uint8_t *input, size_t inlen);
-/* Obtain the output of the function and free `state` */
+/* Obtain the output of the function and wipe `state` */
 void sha3_384_inc_finalize(uint8_t *output, sha3_384incctx *state);
 /* Copy the context */
 void sha3_384_inc_ctx_clone(sha3_384incctx *dest, const sha3_384incctx *src);
@@ -153,7 +175,7 @@ void sha3_384(uint8_t *output, const uint8_t *input, size_t inlen);
 void sha3_512_inc_init(sha3_512incctx *state);
 /* Absorb blocks into SHA3 */
 void sha3_512_inc_absorb(sha3_512incctx *state, const uint8_t *input, size_t inlen);
-/* Obtain the output of the function and free `state` */
+/* Obtain the output of the function and wipe `state` */
 void sha3_512_inc_finalize(uint8_t *output, sha3_512incctx *state);
 /* Copy the context */
 void sha3_512_inc_ctx_clone(sha3_512incctx *dest, const sha3_512incctx *src);
@@ -162,5 +184,7 @@ void sha3_512_inc_ctx_release(sha3_512incctx *state);
 
 /* One-stop SHA3-512 shop */
 void sha3_512(uint8_t *output, const uint8_t *input, size_t inlen);
+/* SHA3-512 over a list of input fragments */
+void sha3_512_iov(uint8_t *output, const keccak_iovec *iov, size_t iovcnt);
 
 #endif
@@ -0,0 +1,615 @@
+/* Four-way SHAKE on top of fips202.c. The AVX2 permutation follows the
+ * structure of KeccakF1600_StatePermute in fips202.c with every lane
+ * replaced by a vector holding that lane for four independent states. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "fips202.h"
+#include "fips202x4.h"
+
+#if defined(__AVX2__)
+
+#define NROUNDS 24
+#define XOR(a, b) _mm256_xor_si256(a, b)
+#define ANDNOT(a, b) _mm256_andnot_si256(a, b)
+#define XOR5(a, b, c, d, e) XOR(XOR(XOR(a, b), XOR(c, d)), e)
+#define ROL(a, offset) _mm256_or_si256(_mm256_slli_epi64(a, offset), _mm256_srli_epi64(a, 64 - (offset)))
+
+/* Keccak round constants */
+static const uint64_t KeccakF_RoundConstants[NROUNDS] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL,
+    0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL,
+    0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL,
+    0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL,
+    0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL,
+    0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL,
+    0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+/*************************************************
+ * Name:        KeccakF1600_StatePermute4x
+ *
+ * Description: Four Keccak F1600 permutations in parallel
+ *
+ * Arguments:   - __m256i *s: pointer to input/output four-way Keccak state
+ **************************************************/
+static void KeccakF1600_StatePermute4x(__m256i *s) {
+    int round;
+
+    __m256i Aba, Abe, Abi, Abo, Abu;
+    __m256i Aga, Age, Agi, Ago, Agu;
+    __m256i Aka, Ake, Aki, Ako, Aku;
+    __m256i Ama, Ame, Ami, Amo, Amu;
+    __m256i Asa, Ase, Asi, Aso, Asu;
+    __m256i BCa, BCe, BCi, BCo, BCu;
+    __m256i Da, De, Di, Do, Du;
+    __m256i Eba, Ebe, Ebi, Ebo, Ebu;
+    __m256i Ega, Ege, Egi, Ego, Egu;
+    __m256i Eka, Eke, Eki, Eko, Eku;
+    __m256i Ema, Eme, Emi, Emo, Emu;
+    __m256i Esa, Ese, Esi, Eso, Esu;
+
+    // copyFromState(A, state)
+    Aba = s[0];
+    Abe = s[1];
+    Abi = s[2];
+    Abo = s[3];
+    Abu = s[4];
+    Aga = s[5];
+    Age = s[6];
+    Agi = s[7];
+    Ago = s[8];
+    Agu = s[9];
+    Aka = s[10];
+    Ake = s[11];
+    Aki = s[12];
+    Ako = s[13];
+    Aku = s[14];
+    Ama = s[15];
+    Ame = s[16];
+    Ami = s[17];
+    Amo = s[18];
+    Amu = s[19];
+    Asa = s[20];
+    Ase = s[21];
+    Asi = s[22];
+    Aso = s[23];
+    Asu = s[24];
+
+    for (round = 0; round < NROUNDS; round += 2) {
+        //    prepareTheta
+        BCa = XOR5(Aba, Aga, Aka, Ama, Asa);
+        BCe = XOR5(Abe, Age, Ake, Ame, Ase);
+        BCi = XOR5(Abi, Agi, Aki, Ami, Asi);
+        BCo = XOR5(Abo, Ago, Ako, Amo, Aso);
+        BCu = XOR5(Abu, Agu, Aku, Amu, Asu);
+
+        // thetaRhoPiChiIotaPrepareTheta(round, A, E)
+        Da = XOR(BCu, ROL(BCe, 1));
+        De = XOR(BCa, ROL(BCi, 1));
+        Di = XOR(BCe, ROL(BCo, 1));
+        Do = XOR(BCi, ROL(BCu, 1));
+        Du = XOR(BCo, ROL(BCa, 1));
+
+        Aba = XOR(Aba, Da);
+        BCa = Aba;
+        Age = XOR(Age, De);
+        BCe = ROL(Age, 44);
+        Aki = XOR(Aki, Di);
+        BCi = ROL(Aki, 43);
+        Amo = XOR(Amo, Do);
+        BCo = ROL(Amo, 21);
+        Asu = XOR(Asu, Du);
+        BCu = ROL(Asu, 14);
+        Eba = XOR(BCa, ANDNOT(BCe, BCi));
+        Eba = XOR(Eba, _mm256_set1_epi64x((long long)KeccakF_RoundConstants[round]));
+        Ebe = XOR(BCe, ANDNOT(BCi, BCo));
+        Ebi = XOR(BCi, ANDNOT(BCo, BCu));
+        Ebo = XOR(BCo, ANDNOT(BCu, BCa));
+        Ebu = XOR(BCu, ANDNOT(BCa, BCe));
+
+        Abo = XOR(Abo, Do);
+        BCa = ROL(Abo, 28);
+        Agu = XOR(Agu, Du);
+        BCe = ROL(Agu, 20);
+        Aka = XOR(Aka, Da);
+        BCi = ROL(Aka, 3);
+        Ame = XOR(Ame, De);
+        BCo = ROL(Ame, 45);
+        Asi = XOR(Asi, Di);
+        BCu = ROL(Asi, 61);
+        Ega = XOR(BCa, ANDNOT(BCe, BCi));
+        Ege = XOR(BCe, ANDNOT(BCi, BCo));
+        Egi = XOR(BCi, ANDNOT(BCo, BCu));
+        Ego = XOR(BCo, ANDNOT(BCu, BCa));
+        Egu = XOR(BCu, ANDNOT(BCa, BCe));
+
+        Abe = XOR(Abe, De);
+        BCa = ROL(Abe, 1);
+        Agi = XOR(Agi, Di);
+        BCe = ROL(Agi, 6);
+        Ako = XOR(Ako, Do);
+        BCi = ROL(Ako, 25);
+        Amu = XOR(Amu, Du);
+        BCo = ROL(Amu, 8);
+        Asa = XOR(Asa, Da);
+        BCu = ROL(Asa, 18);
+        Eka = XOR(BCa, ANDNOT(BCe, BCi));
+        Eke = XOR(BCe, ANDNOT(BCi, BCo));
+        Eki = XOR(BCi, ANDNOT(BCo, BCu));
+        Eko = XOR(BCo, ANDNOT(BCu, BCa));
+        Eku = XOR(BCu, ANDNOT(BCa, BCe));
+
+        Abu = XOR(Abu, Du);
+        BCa = ROL(Abu, 27);
+        Aga = XOR(Aga, Da);
+        BCe = ROL(Aga, 36);
+        Ake = XOR(Ake, De);
+        BCi = ROL(Ake, 10);
+        Ami = XOR(Ami, Di);
+        BCo = ROL(Ami, 15);
+        Aso = XOR(Aso, Do);
+        BCu = ROL(Aso, 56);
+        Ema = XOR(BCa, ANDNOT(BCe, BCi));
+        Eme = XOR(BCe, ANDNOT(BCi, BCo));
+        Emi = XOR(BCi, ANDNOT(BCo, BCu));
+        Emo = XOR(BCo, ANDNOT(BCu, BCa));
+        Emu = XOR(BCu, ANDNOT(BCa, BCe));
+
+        Abi = XOR(Abi, Di);
+        BCa = ROL(Abi, 62);
+        Ago = XOR(Ago, Do);
+        BCe = ROL(Ago, 55);
+        Aku = XOR(Aku, Du);
+        BCi = ROL(Aku, 39);
+        Ama = XOR(Ama, Da);
+        BCo = ROL(Ama, 41);
+        Ase = XOR(Ase, De);
+        BCu = ROL(Ase, 2);
+        Esa = XOR(BCa, ANDNOT(BCe, BCi));
+        Ese = XOR(BCe, ANDNOT(BCi, BCo));
+        Esi = XOR(BCi, ANDNOT(BCo, BCu));
+        Eso = XOR(BCo, ANDNOT(BCu, BCa));
+        Esu = XOR(BCu, ANDNOT(BCa, BCe));
+
+        //    prepareTheta
+        BCa = XOR5(Eba, Ega, Eka, Ema, Esa);
+        BCe = XOR5(Ebe, Ege, Eke, Eme, Ese);
+        BCi = XOR5(Ebi, Egi, Eki, Emi, Esi);
+        BCo = XOR5(Ebo, Ego, Eko, Emo, Eso);
+        BCu = XOR5(Ebu, Egu, Eku, Emu, Esu);
+
+        // thetaRhoPiChiIotaPrepareTheta(round + 1, E, A)
+        Da = XOR(BCu, ROL(BCe, 1));
+        De = XOR(BCa, ROL(BCi, 1));
+        Di = XOR(BCe, ROL(BCo, 1));
+        Do = XOR(BCi, ROL(BCu, 1));
+        Du = XOR(BCo, ROL(BCa, 1));
+
+        Eba = XOR(Eba, Da);
+        BCa = Eba;
+        Ege = XOR(Ege, De);
+        BCe = ROL(Ege, 44);
+        Eki = XOR(Eki, Di);
+        BCi = ROL(Eki, 43);
+        Emo = XOR(Emo, Do);
+        BCo = ROL(Emo, 21);
+        Esu = XOR(Esu, Du);
+        BCu = ROL(Esu, 14);
+        Aba = XOR(BCa, ANDNOT(BCe, BCi));
+        Aba = XOR(Aba, _mm256_set1_epi64x((long long)KeccakF_RoundConstants[round + 1]));
+        Abe = XOR(BCe, ANDNOT(BCi, BCo));
+        Abi = XOR(BCi, ANDNOT(BCo, BCu));
+        Abo = XOR(BCo, ANDNOT(BCu, BCa));
+        Abu = XOR(BCu, ANDNOT(BCa, BCe));
+
+        Ebo = XOR(Ebo, Do);
+        BCa = ROL(Ebo, 28);
+        Egu = XOR(Egu, Du);
+        BCe = ROL(Egu, 20);
+        Eka = XOR(Eka, Da);
+        BCi = ROL(Eka, 3);
+        Eme = XOR(Eme, De);
+        BCo = ROL(Eme, 45);
+        Esi = XOR(Esi, Di);
+        BCu = ROL(Esi, 61);
+        Aga = XOR(BCa, ANDNOT(BCe, BCi));
+        Age = XOR(BCe, ANDNOT(BCi, BCo));
+        Agi = XOR(BCi, ANDNOT(BCo, BCu));
+        Ago = XOR(BCo, ANDNOT(BCu, BCa));
+        Agu = XOR(BCu, ANDNOT(BCa, BCe));
+
+        Ebe = XOR(Ebe, De);
+        BCa = ROL(Ebe, 1);
+        Egi = XOR(Egi, Di);
+        BCe = ROL(Egi, 6);
+        Eko = XOR(Eko, Do);
+        BCi = ROL(Eko, 25);
+        Emu = XOR(Emu, Du);
+        BCo = ROL(Emu, 8);
+        Esa = XOR(Esa, Da);
+        BCu = ROL(Esa, 18);
+        Aka = XOR(BCa, ANDNOT(BCe, BCi));
+        Ake = XOR(BCe, ANDNOT(BCi, BCo));
+        Aki = XOR(BCi, ANDNOT(BCo, BCu));
+        Ako = XOR(BCo, ANDNOT(BCu, BCa));
+        Aku = XOR(BCu, ANDNOT(BCa, BCe));
+
+        Ebu = XOR(Ebu, Du);
+        BCa = ROL(Ebu, 27);
+        Ega = XOR(Ega, Da);
+        BCe = ROL(Ega, 36);
+        Eke = XOR(Eke, De);
+        BCi = ROL(Eke, 10);
+        Emi = XOR(Emi, Di);
+        BCo = ROL(Emi, 15);
+        Eso = XOR(Eso, Do);
+        BCu = ROL(Eso, 56);
+        Ama = XOR(BCa, ANDNOT(BCe, BCi));
+        Ame = XOR(BCe, ANDNOT(BCi, BCo));
+        Ami = XOR(BCi, ANDNOT(BCo, BCu));
+        Amo = XOR(BCo, ANDNOT(BCu, BCa));
+        Amu = XOR(BCu, ANDNOT(BCa, BCe));
+
+        Ebi = XOR(Ebi, Di);
+        BCa = ROL(Ebi, 62);
+        Ego = XOR(Ego, Do);
+        BCe = ROL(Ego, 55);
+        Eku = XOR(Eku, Du);
+        BCi = ROL(Eku, 39);
+        Ema = XOR(Ema, Da);
+        BCo = ROL(Ema, 41);
+        Ese = XOR(Ese, De);
+        BCu = ROL(Ese, 2);
+        Asa = XOR(BCa, ANDNOT(BCe, BCi));
+        Ase = XOR(BCe, ANDNOT(BCi, BCo));
+        Asi = XOR(BCi, ANDNOT(BCo, BCu));
+        Aso = XOR(BCo, ANDNOT(BCu, BCa));
+        Asu = XOR(BCu, ANDNOT(BCa, BCe));
+    }
+
+    // copyToState(state, A)
+    s[0] = Aba;
+    s[1] = Abe;
+    s[2] = Abi;
+    s[3] = Abo;
+    s[4] = Abu;
+    s[5] = Aga;
+    s[6] = Age;
+    s[7] = Agi;
+    s[8] = Ago;
+    s[9] = Agu;
+    s[10] = Aka;
+    s[11] = Ake;
+    s[12] = Aki;
+    s[13] = Ako;
+    s[14] = Aku;
+    s[15] = Ama;
+    s[16] = Ame;
+    s[17] = Ami;
+    s[18] = Amo;
+    s[19] = Amu;
+    s[20] = Asa;
+    s[21] = Ase;
+    s[22] = Asi;
+    s[23] = Aso;
+    s[24] = Asu;
+}
+
+
+/*************************************************
+ * Name:        load64_partial
+ *
+ * Description: Load fewer than 8 bytes into the low end of a uint64_t in
+ *              little-endian order
+ *
+ * Arguments:   - const uint8_t *x: pointer to input byte array
+ *              - size_t n: number of bytes to load (less than 8)
+ *
+ * Returns the loaded 64-bit unsigned integer
+ **************************************************/
+static uint64_t load64_partial(const uint8_t *x, size_t n) {
+    uint64_t r = 0;
+    for (size_t i = 0; i < n; ++i) {
+        r |= (uint64_t)x[i] << 8 * i;
+    }
+
+    return r;
+}
+
+/*************************************************
+ * Name:        keccakx4_absorb_once
+ *
+ * Description: Absorb step of four Keccak sponges;
+ *              non-incremental, starts by zeroeing the state.
+ *
+ * Arguments:   - __m256i *s: pointer to (uninitialized) output state
+ *              - uint32_t r: rate in bytes (e.g., 168 for SHAKE128)
+ *              - const uint8_t **in: pointers to the four inputs
+ *              - size_t inlen: length of each input in bytes
+ *              - uint8_t p: domain-separation byte for different
+ *                           Keccak-derived functions
+ **************************************************/
+static void keccakx4_absorb_once(__m256i *s, uint32_t r, const uint8_t **in,
+                                 size_t inlen, uint8_t p) {
+    size_t i, pos = 0;
+    uint64_t w[4];
+    __m256i t;
+
+    for (i = 0; i < 25; ++i) {
+        s[i] = _mm256_setzero_si256();
+    }
+
+    while (inlen >= r) {
+        for (i = 0; i < r / 8; ++i) {
+            memcpy(&w[0], in[0] + pos, 8);
+            memcpy(&w[1], in[1] + pos, 8);
+            memcpy(&w[2], in[2] + pos, 8);
+            memcpy(&w[3], in[3] + pos, 8);
+            t = _mm256_loadu_si256((const __m256i *)w);
+            s[i] = XOR(s[i], t);
+            pos += 8;
+        }
+        inlen -= r;
+
+        KeccakF1600_StatePermute4x(s);
+    }
+
+    for (i = 0; i < inlen / 8; ++i) {
+        memcpy(&w[0], in[0] + pos, 8);
+        memcpy(&w[1], in[1] + pos, 8);
+        memcpy(&w[2], in[2] + pos, 8);
+        memcpy(&w[3], in[3] + pos, 8);
+        t = _mm256_loadu_si256((const __m256i *)w);
+        s[i] = XOR(s[i], t);
+        pos += 8;
+    }
+    inlen -= 8 * i;
+
+    w[0] = load64_partial(in[0] + pos, inlen) ^ ((uint64_t)p << 8 * inlen);
+    w[1] = load64_partial(in[1] + pos, inlen) ^ ((uint64_t)p << 8 * inlen);
+    w[2] = load64_partial(in[2] + pos, inlen) ^ ((uint64_t)p << 8 * inlen);
+    w[3] = load64_partial(in[3] + pos, inlen) ^ ((uint64_t)p << 8 * inlen);
+    t = _mm256_loadu_si256((const __m256i *)w);
+    s[i] = XOR(s[i], t);
+
+    w[0] = w[1] = w[2] = w[3] = (uint64_t)1 << 63;
+    t = _mm256_loadu_si256((const __m256i *)w);
+    s[r / 8 - 1] = XOR(s[r / 8 - 1], t);
+}
+
+/*************************************************
+ * Name:        keccakx4_squeezeblocks
+ *
+ * Description: Squeeze step of four Keccak sponges. Squeezes full blocks of
+ *              r bytes per lane. Can be called multiple times.
+ *
+ * Arguments:   - uint8_t **out: pointers to the output blocks of each lane
+ *              - unsigned int nlanes: number of lanes to write out (2 or 4)
+ *              - size_t nblocks: number of blocks to be squeezed
+ *              - uint32_t r: rate in bytes (e.g., 168 for SHAKE128)
+ *              - __m256i *s: pointer to input/output state
+ **************************************************/
+static void keccakx4_squeezeblocks(uint8_t **out, unsigned int nlanes,
+                                   size_t nblocks, uint32_t r, __m256i *s) {
+    unsigned int l;
+    size_t i, pos = 0;
+    uint64_t w[4];
+
+    while (nblocks > 0) {
+        KeccakF1600_StatePermute4x(s);
+        for (i = 0; i < r / 8; ++i) {
+            _mm256_storeu_si256((__m256i *)w, s[i]);
+            for (l = 0; l < nlanes; ++l) {
+                memcpy(out[l] + pos + 8 * i, &w[l], 8);
+            }
+        }
+        pos += r;
+        nblocks--;
+    }
+}
+
+void shake128x4_absorb_once(keccakx4_state *state,
+                            const uint8_t *in0, const uint8_t *in1,
+                            const uint8_t *in2, const uint8_t *in3,
+                            size_t inlen) {
+    const uint8_t *in[4] = { in0, in1, in2, in3 };
+    keccakx4_absorb_once(state->s, SHAKE128_RATE, in, inlen, 0x1F);
+}
+
+void shake128x4_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              uint8_t *out2, uint8_t *out3,
+                              size_t nblocks, keccakx4_state *state) {
+    uint8_t *out[4] = { out0, out1, out2, out3 };
+    keccakx4_squeezeblocks(out, 4, nblocks, SHAKE128_RATE, state->s);
+}
+
+void shake256x4_absorb_once(keccakx4_state *state,
+                            const uint8_t *in0, const uint8_t *in1,
+                            const uint8_t *in2, const uint8_t *in3,
+                            size_t inlen) {
+    const uint8_t *in[4] = { in0, in1, in2, in3 };
+    keccakx4_absorb_once(state->s, SHAKE256_RATE, in, inlen, 0x1F);
+}
+
+void shake256x4_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              uint8_t *out2, uint8_t *out3,
+                              size_t nblocks, keccakx4_state *state) {
+    uint8_t *out[4] = { out0, out1, out2, out3 };
+    keccakx4_squeezeblocks(out, 4, nblocks, SHAKE256_RATE, state->s);
+}
+
+/* The two-lane variants run the four-way permutation with the upper two
+ * lanes mirroring the lower two and only write out the lower two. */
+void shake128x2_absorb_once(keccakx2_state *state,
+                            const uint8_t *in0, const uint8_t *in1,
+                            size_t inlen) {
+    const uint8_t *in[4] = { in0, in1, in0, in1 };
+    keccakx4_absorb_once(state->s, SHAKE128_RATE, in, inlen, 0x1F);
+}
+
+void shake128x2_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              size_t nblocks, keccakx2_state *state) {
+    uint8_t *out[4] = { out0, out1, NULL, NULL };
+    keccakx4_squeezeblocks(out, 2, nblocks, SHAKE128_RATE, state->s);
+}
+
+void shake256x2_absorb_once(keccakx2_state *state,
+                            const uint8_t *in0, const uint8_t *in1,
+                            size_t inlen) {
+    const uint8_t *in[4] = { in0, in1, in0, in1 };
+    keccakx4_absorb_once(state->s, SHAKE256_RATE, in, inlen, 0x1F);
+}
+
+void shake256x2_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              size_t nblocks, keccakx2_state *state) {
+    uint8_t *out[4] = { out0, out1, NULL, NULL };
+    keccakx4_squeezeblocks(out, 2, nblocks, SHAKE256_RATE, state->s);
+}
+
+#else
+
+/* Portable fallback: each lane is a regular fips202 context. */
+void shake128x4_absorb_once(keccakx4_state *state,
+                            const uint8_t *in0, const uint8_t *in1,
+                            const uint8_t *in2, const uint8_t *in3,
+                            size_t inlen) {
+    shake128_absorb(&state->lane.shake128[0], in0, inlen);
+    shake128_absorb(&state->lane.shake128[1], in1, inlen);
+    shake128_absorb(&state->lane.shake128[2], in2, inlen);
+    shake128_absorb(&state->lane.shake128[3], in3, inlen);
+}
+
+void shake128x4_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              uint8_t *out2, uint8_t *out3,
+                              size_t nblocks, keccakx4_state *state) {
+    shake128_squeezeblocks(out0, nblocks, &state->lane.shake128[0]);
+    shake128_squeezeblocks(out1, nblocks, &state->lane.shake128[1]);
+    shake128_squeezeblocks(out2, nblocks, &state->lane.shake128[2]);
+    shake128_squeezeblocks(out3, nblocks, &state->lane.shake128[3]);
+}
+
+void shake256x4_absorb_once(keccakx4_state *state,
+                            const uint8_t *in0, const uint8_t *in1,
+                            const uint8_t *in2, const uint8_t *in3,
+                            size_t inlen) {
+    shake256_absorb(&state->lane.shake256[0], in0, inlen);
+    shake256_absorb(&state->lane.shake256[1], in1, inlen);
+    shake256_absorb(&state->lane.shake256[2], in2, inlen);
+    shake256_absorb(&state->lane.shake256[3], in3, inlen);
+}
+
+void shake256x4_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              uint8_t *out2, uint8_t *out3,
+                              size_t nblocks, keccakx4_state *state) {
+    shake256_squeezeblocks(out0, nblocks, &state->lane.shake256[0]);
+    shake256_squeezeblocks(out1, nblocks, &state->lane.shake256[1]);
+    shake256_squeezeblocks(out2, nblocks, &state->lane.shake256[2]);
+    shake256_squeezeblocks(out3, nblocks, &state->lane.shake256[3]);
+}
+
+void shake128x2_absorb_once(keccakx2_state *state,
+                            const uint8_t *in0, const uint8_t *in1,
+                            size_t inlen) {
+    shake128_absorb(&state->lane.shake128[0], in0, inlen);
+    shake128_absorb(&state->lane.shake128[1], in1, inlen);
+}
+
+void shake128x2_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              size_t nblocks, keccakx2_state *state) {
+    shake128_squeezeblocks(out0, nblocks, &state->lane.shake128[0]);
+    shake128_squeezeblocks(out1, nblocks, &state->lane.shake128[1]);
+}
+
+void shake256x2_absorb_once(keccakx2_state *state,
+                            const uint8_t *in0, const uint8_t *in1,
+                            size_t inlen) {
+    shake256_absorb(&state->lane.shake256[0], in0, inlen);
+    shake256_absorb(&state->lane.shake256[1], in1, inlen);
+}
+
+void shake256x2_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              size_t nblocks, keccakx2_state *state) {
+    shake256_squeezeblocks(out0, nblocks, &state->lane.shake256[0]);
+    shake256_squeezeblocks(out1, nblocks, &state->lane.shake256[1]);
+}
+
+#endif
+
+/*************************************************
+ * Name:        shake256x4
+ *
+ * Description: Four SHAKE256 XOF calls with non-incremental API
+ *
+ * Arguments:   - uint8_t *out0..out3: pointers to the outputs
+ *              - size_t outlen: requested output length in bytes per lane
+ *              - const uint8_t *in0..in3: pointers to the inputs
+ *              - size_t inlen: length of each input in bytes
+ **************************************************/
+void shake256x4(uint8_t *out0, uint8_t *out1, uint8_t *out2, uint8_t *out3,
+                size_t outlen,
+                const uint8_t *in0, const uint8_t *in1,
+                const uint8_t *in2, const uint8_t *in3,
+                size_t inlen) {
+    size_t nblocks = outlen / SHAKE256_RATE;
+    uint8_t t[4][SHAKE256_RATE];
+    keccakx4_state state;
+
+    shake256x4_absorb_once(&state, in0, in1, in2, in3, inlen);
+    shake256x4_squeezeblocks(out0, out1, out2, out3, nblocks, &state);
+
+    out0 += nblocks * SHAKE256_RATE;
+    out1 += nblocks * SHAKE256_RATE;
+    out2 += nblocks * SHAKE256_RATE;
+    out3 += nblocks * SHAKE256_RATE;
+    outlen -= nblocks * SHAKE256_RATE;
+
+    if (outlen) {
+        shake256x4_squeezeblocks(t[0], t[1], t[2], t[3], 1, &state);
+        for (size_t i = 0; i < outlen; ++i) {
+            out0[i] = t[0][i];
+            out1[i] = t[1][i];
+            out2[i] = t[2][i];
+            out3[i] = t[3][i];
+        }
+    }
+}
+
+/*************************************************
+ * Name:        shake256x2
+ *
+ * Description: Two SHAKE256 XOF calls with non-incremental API
+ *
+ * Arguments:   - uint8_t *out0, *out1: pointers to the outputs
+ *              - size_t outlen: requested output length in bytes per lane
+ *              - const uint8_t *in0, *in1: pointers to the inputs
+ *              - size_t inlen: length of each input in bytes
+ **************************************************/
+void shake256x2(uint8_t *out0, uint8_t *out1, size_t outlen,
+                const uint8_t *in0, const uint8_t *in1, size_t inlen) {
+    size_t nblocks = outlen / SHAKE256_RATE;
+    uint8_t t[2][SHAKE256_RATE];
+    keccakx2_state state;
+
+    shake256x2_absorb_once(&state, in0, in1, inlen);
+    shake256x2_squeezeblocks(out0, out1, nblocks, &state);
+
+    out0 += nblocks * SHAKE256_RATE;
+    out1 += nblocks * SHAKE256_RATE;
+    outlen -= nblocks * SHAKE256_RATE;
+
+    if (outlen) {
+        shake256x2_squeezeblocks(t[0], t[1], 1, &state);
+        for (size_t i = 0; i < outlen; ++i) {
+            out0[i] = t[0][i];
+            out1[i] = t[1][i];
+        }
+    }
+}
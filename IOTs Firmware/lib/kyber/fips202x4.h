@@ -0,0 +1,82 @@
+#ifndef FIPS202X4_H
+#define FIPS202X4_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fips202.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/* Batched SHAKE: four (or two) independent sponges that are absorbed and
+ * squeezed in lockstep. All lanes of one call share the input and output
+ * lengths. With AVX2 the lanes are the 64-bit elements of 256-bit vectors
+ * and share one permutation call; otherwise every lane is an ordinary
+ * fips202 context processed one after the other. Like the contexts in
+ * fips202.h, these never touch the heap. */
+typedef struct {
+#if defined(__AVX2__)
+    __m256i s[25];
+#else
+    union {
+        shake128ctx shake128[4];
+        shake256ctx shake256[4];
+    } lane;
+#endif
+} keccakx4_state;
+
+typedef struct {
+#if defined(__AVX2__)
+    __m256i s[25];
+#else
+    union {
+        shake128ctx shake128[2];
+        shake256ctx shake256[2];
+    } lane;
+#endif
+} keccakx2_state;
+
+/* Initialize the four states and absorb one input per lane */
+void shake128x4_absorb_once(keccakx4_state *state,
+                            const uint8_t *in0, const uint8_t *in1,
+                            const uint8_t *in2, const uint8_t *in3,
+                            size_t inlen);
+/* Squeeze nblocks blocks per lane; supports being called multiple times */
+void shake128x4_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              uint8_t *out2, uint8_t *out3,
+                              size_t nblocks, keccakx4_state *state);
+
+void shake256x4_absorb_once(keccakx4_state *state,
+                            const uint8_t *in0, const uint8_t *in1,
+                            const uint8_t *in2, const uint8_t *in3,
+                            size_t inlen);
+void shake256x4_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              uint8_t *out2, uint8_t *out3,
+                              size_t nblocks, keccakx4_state *state);
+
+/* Four SHAKE256 calls with equal input and output lengths */
+void shake256x4(uint8_t *out0, uint8_t *out1, uint8_t *out2, uint8_t *out3,
+                size_t outlen,
+                const uint8_t *in0, const uint8_t *in1,
+                const uint8_t *in2, const uint8_t *in3,
+                size_t inlen);
+
+/* Two-lane variants of the above */
+void shake128x2_absorb_once(keccakx2_state *state,
+                            const uint8_t *in0, const uint8_t *in1,
+                            size_t inlen);
+void shake128x2_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              size_t nblocks, keccakx2_state *state);
+
+void shake256x2_absorb_once(keccakx2_state *state,
+                            const uint8_t *in0, const uint8_t *in1,
+                            size_t inlen);
+void shake256x2_squeezeblocks(uint8_t *out0, uint8_t *out1,
+                              size_t nblocks, keccakx2_state *state);
+
+void shake256x2(uint8_t *out0, uint8_t *out1, size_t outlen,
+                const uint8_t *in0, const uint8_t *in1, size_t inlen);
+
+#endif
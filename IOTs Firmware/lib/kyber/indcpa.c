@@ -1,7 +1,10 @@
+#include "encstream.h"
 #include "indcpa.h"
 #include "ntt.h"
+#include "parallel.h"
 #include "params.h"
 #include "poly.h"
+#include "poly_avx2.h"
 #include "polyvec.h"
 #include "randombytes.h"
 #include "symmetric.h"
@@ -23,10 +26,11 @@
 static void pack_pk(uint8_t r[KYBER_INDCPA_PUBLICKEYBYTES],
                     polyvec *pk,
                     const uint8_t seed[KYBER_SYMBYTES]) {
-    PQCLEAN_MLKEM768_CLEAN_polyvec_tobytes(r, pk);
+    KYBER_NAMESPACE(polyvec_tobytes)(r, pk);
     memcpy(r + KYBER_POLYVECBYTES, seed, KYBER_SYMBYTES);
 }
 
+#if !defined(KYBER_LOWSTACK)
 /*************************************************
 * Name:        unpack_pk
 *
@@ -40,9 +44,10 @@ static void pack_pk(uint8_t r[KYBER_INDCPA_PUBLICKEYBYTES],
 static void unpack_pk(polyvec *pk,
                       uint8_t seed[KYBER_SYMBYTES],
                       const uint8_t packedpk[KYBER_INDCPA_PUBLICKEYBYTES]) {
-    PQCLEAN_MLKEM768_CLEAN_polyvec_frombytes(pk, packedpk);
+    KYBER_NAMESPACE(polyvec_frombytes)(pk, packedpk);
     memcpy(seed, packedpk + KYBER_POLYVECBYTES, KYBER_SYMBYTES);
 }
+#endif
 
 /*************************************************
 * Name:        pack_sk
@@ -53,7 +58,7 @@ static void unpack_pk(polyvec *pk,
 *              - polyvec *sk: pointer to input vector of polynomials (secret key)
 **************************************************/
 static void pack_sk(uint8_t r[KYBER_INDCPA_SECRETKEYBYTES], polyvec *sk) {
-    PQCLEAN_MLKEM768_CLEAN_polyvec_tobytes(r, sk);
+    KYBER_NAMESPACE(polyvec_tobytes)(r, sk);
 }
 
 /*************************************************
@@ -65,38 +70,7 @@ static void pack_sk(uint8_t r[KYBER_INDCPA_SECRETKEYBYTES], polyvec *sk) {
 *              - const uint8_t *packedsk: pointer to input serialized secret key
 **************************************************/
 static void unpack_sk(polyvec *sk, const uint8_t packedsk[KYBER_INDCPA_SECRETKEYBYTES]) {
-    PQCLEAN_MLKEM768_CLEAN_polyvec_frombytes(sk, packedsk);
-}
-
-/*************************************************
-* Name:        pack_ciphertext
-*
-* Description: Serialize the ciphertext as concatenation of the
-*              compressed and serialized vector of polynomials b
-*              and the compressed and serialized polynomial v
-*
-* Arguments:   uint8_t *r: pointer to the output serialized ciphertext
-*              poly *pk: pointer to the input vector of polynomials b
-*              poly *v: pointer to the input polynomial v
-**************************************************/
-static void pack_ciphertext(uint8_t r[KYBER_INDCPA_BYTES], polyvec *b, poly *v) {
-    PQCLEAN_MLKEM768_CLEAN_polyvec_compress(r, b);
-    PQCLEAN_MLKEM768_CLEAN_poly_compress(r + KYBER_POLYVECCOMPRESSEDBYTES, v);
-}
-
-/*************************************************
-* Name:        unpack_ciphertext
-*
-* Description: De-serialize and decompress ciphertext from a byte array;
-*              approximate inverse of pack_ciphertext
-*
-* Arguments:   - polyvec *b: pointer to the output vector of polynomials b
-*              - poly *v: pointer to the output polynomial v
-*              - const uint8_t *c: pointer to the input serialized ciphertext
-**************************************************/
-static void unpack_ciphertext(polyvec *b, poly *v, const uint8_t c[KYBER_INDCPA_BYTES]) {
-    PQCLEAN_MLKEM768_CLEAN_polyvec_decompress(b, c);
-    PQCLEAN_MLKEM768_CLEAN_poly_decompress(v, c + KYBER_POLYVECCOMPRESSEDBYTES);
+    KYBER_NAMESPACE(polyvec_frombytes)(sk, packedsk);
 }
 
 /*************************************************
@@ -117,9 +91,41 @@ static unsigned int rej_uniform(int16_t *r,
                                 const uint8_t *buf,
                                 unsigned int buflen) {
     unsigned int ctr, pos;
-    uint16_t val0, val1;
+    uint32_t t0, t1;
+    uint16_t val0, val1, val2, val3;
 
     ctr = pos = 0;
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        ctr = PQCLEAN_MLKEM768_CLEAN_rej_uniform_avx2(r, len, buf, buflen, &pos);
+    }
+#endif
+
+    // Branch-free while four outputs are certainly in bounds: every
+    // candidate is written and the counter only advances if it is below q
+    while (ctr + 4 <= len && pos + 6 <= buflen) {
+        t0  = (uint32_t)buf[pos + 0];
+        t0 |= (uint32_t)buf[pos + 1] << 8;
+        t0 |= (uint32_t)buf[pos + 2] << 16;
+        t1  = (uint32_t)buf[pos + 3];
+        t1 |= (uint32_t)buf[pos + 4] << 8;
+        t1 |= (uint32_t)buf[pos + 5] << 16;
+        pos += 6;
+
+        val0 = t0 & 0xFFF;
+        val1 = t0 >> 12;
+        val2 = t1 & 0xFFF;
+        val3 = t1 >> 12;
+        r[ctr] = val0;
+        ctr += (uint32_t)(val0 - KYBER_Q) >> 31;
+        r[ctr] = val1;
+        ctr += (uint32_t)(val1 - KYBER_Q) >> 31;
+        r[ctr] = val2;
+        ctr += (uint32_t)(val2 - KYBER_Q) >> 31;
+        r[ctr] = val3;
+        ctr += (uint32_t)(val3 - KYBER_Q) >> 31;
+    }
+
     while (ctr < len && pos + 3 <= buflen) {
         val0 = ((buf[pos + 0] >> 0) | ((uint16_t)buf[pos + 1] << 8)) & 0xFFF;
         val1 = ((buf[pos + 1] >> 4) | ((uint16_t)buf[pos + 2] << 4)) & 0xFFF;
@@ -136,11 +142,8 @@ static unsigned int rej_uniform(int16_t *r,
     return ctr;
 }
 
-#define gen_a(A,B)  PQCLEAN_MLKEM768_CLEAN_gen_matrix(A,B,0)
-#define gen_at(A,B) PQCLEAN_MLKEM768_CLEAN_gen_matrix(A,B,1)
-
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_gen_matrix
+* Name:        gen_matrix
 *
 * Description: Deterministically generate matrix A (or the transpose of A)
 *              from a seed. Entries of the matrix are polynomials that look
@@ -153,37 +156,325 @@ static unsigned int rej_uniform(int16_t *r,
 **************************************************/
 
 #define GEN_MATRIX_NBLOCKS ((12*KYBER_N/8*(1 << 12)/KYBER_Q + XOF_BLOCKBYTES)/XOF_BLOCKBYTES)
-// Not static for benchmarking
-void PQCLEAN_MLKEM768_CLEAN_gen_matrix(polyvec *a, const uint8_t seed[KYBER_SYMBYTES], int transposed) {
-    unsigned int ctr, i, j;
+
+/*************************************************
+* Name:        gen_matrix_x1
+*
+* Description: Sample a single matrix entry from seed || x || y
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *seed: pointer to input seed
+*              - const uint8_t *xy: pointer to the two index bytes
+**************************************************/
+static void gen_matrix_x1(poly *r, const uint8_t seed[KYBER_SYMBYTES], const uint8_t xy[2]) {
+    unsigned int ctr;
     unsigned int buflen;
     uint8_t buf[GEN_MATRIX_NBLOCKS * XOF_BLOCKBYTES];
     xof_state state;
 
-    for (i = 0; i < KYBER_K; i++) {
-        for (j = 0; j < KYBER_K; j++) {
-            if (transposed) {
-                xof_absorb(&state, seed, (uint8_t)i, (uint8_t)j);
-            } else {
-                xof_absorb(&state, seed, (uint8_t)j, (uint8_t)i);
-            }
-
-            xof_squeezeblocks(buf, GEN_MATRIX_NBLOCKS, &state);
-            buflen = GEN_MATRIX_NBLOCKS * XOF_BLOCKBYTES;
-            ctr = rej_uniform(a[i].vec[j].coeffs, KYBER_N, buf, buflen);
-
-            while (ctr < KYBER_N) {
-                xof_squeezeblocks(buf, 1, &state);
-                buflen = XOF_BLOCKBYTES;
-                ctr += rej_uniform(a[i].vec[j].coeffs + ctr, KYBER_N - ctr, buf, buflen);
-            }
-            xof_ctx_release(&state);
+    xof_absorb(&state, seed, xy[0], xy[1]);
+
+    xof_squeezeblocks(buf, GEN_MATRIX_NBLOCKS, &state);
+    buflen = GEN_MATRIX_NBLOCKS * XOF_BLOCKBYTES;
+    ctr = rej_uniform(r->coeffs, KYBER_N, buf, buflen);
+
+    while (ctr < KYBER_N) {
+        xof_squeezeblocks(buf, 1, &state);
+        buflen = XOF_BLOCKBYTES;
+        ctr += rej_uniform(r->coeffs + ctr, KYBER_N - ctr, buf, buflen);
+    }
+    xof_ctx_release(&state);
+}
+
+/*************************************************
+* Name:        gen_matrix_x2
+*
+* Description: Sample two matrix entries with the two-way XOF; lanes that
+*              finish early are carried along until both are done
+*
+* Arguments:   - poly **r: pointers to the two output polynomials
+*              - const uint8_t *seed: pointer to input seed
+*              - const uint8_t *xy: pointer to the index bytes of both entries
+**************************************************/
+static void gen_matrix_x2(poly **r, const uint8_t seed[KYBER_SYMBYTES], const uint8_t xy[4]) {
+    unsigned int ctr[2], k;
+    uint8_t buf[2][GEN_MATRIX_NBLOCKS * XOF_BLOCKBYTES];
+    xof_x2_state state;
+
+    xof_x2_absorb(&state, seed, xy);
+
+    xof_x2_squeezeblocks(buf[0], buf[1], GEN_MATRIX_NBLOCKS, &state);
+    for (k = 0; k < 2; k++) {
+        ctr[k] = rej_uniform(r[k]->coeffs, KYBER_N, buf[k], sizeof(buf[k]));
+    }
+
+    while (ctr[0] < KYBER_N || ctr[1] < KYBER_N) {
+        xof_x2_squeezeblocks(buf[0], buf[1], 1, &state);
+        for (k = 0; k < 2; k++) {
+            ctr[k] += rej_uniform(r[k]->coeffs + ctr[k], KYBER_N - ctr[k], buf[k], XOF_BLOCKBYTES);
+        }
+    }
+}
+
+/*************************************************
+* Name:        gen_matrix_x4
+*
+* Description: Sample four matrix entries with the four-way XOF; lanes that
+*              finish early are carried along until all are done
+*
+* Arguments:   - poly **r: pointers to the four output polynomials
+*              - const uint8_t *seed: pointer to input seed
+*              - const uint8_t *xy: pointer to the index bytes of all entries
+**************************************************/
+static void gen_matrix_x4(poly **r, const uint8_t seed[KYBER_SYMBYTES], const uint8_t xy[8]) {
+    unsigned int ctr[4], k;
+    uint8_t buf[4][GEN_MATRIX_NBLOCKS * XOF_BLOCKBYTES];
+    xof_x4_state state;
+
+    xof_x4_absorb(&state, seed, xy);
+
+    xof_x4_squeezeblocks(buf[0], buf[1], buf[2], buf[3], GEN_MATRIX_NBLOCKS, &state);
+    for (k = 0; k < 4; k++) {
+        ctr[k] = rej_uniform(r[k]->coeffs, KYBER_N, buf[k], sizeof(buf[k]));
+    }
+
+    while (ctr[0] < KYBER_N || ctr[1] < KYBER_N || ctr[2] < KYBER_N || ctr[3] < KYBER_N) {
+        xof_x4_squeezeblocks(buf[0], buf[1], buf[2], buf[3], 1, &state);
+        for (k = 0; k < 4; k++) {
+            ctr[k] += rej_uniform(r[k]->coeffs + ctr[k], KYBER_N - ctr[k], buf[k], XOF_BLOCKBYTES);
+        }
+    }
+}
+
+/*************************************************
+* Name:        gen_matrix_range
+*
+* Description: Generate the entries lo..hi-1 of A (or A^T), counted row by
+*              row, in groups of four where possible
+*
+* Arguments:   - polyvec *a: pointer to ouptput matrix A
+*              - const uint8_t *seed: pointer to input seed
+*              - int transposed: boolean deciding whether A or A^T is generated
+*              - unsigned int lo: index of the first entry
+*              - unsigned int hi: index past the last entry
+**************************************************/
+static void gen_matrix_range(polyvec *a, const uint8_t seed[KYBER_SYMBYTES], int transposed,
+                             unsigned int lo, unsigned int hi) {
+    unsigned int i, j, k, n;
+    poly *r[4];
+    uint8_t xy[8];
+
+    // Entries are sampled in groups of four, the remainder in a group of
+    // two and a single one, so that K*K = 9 runs as 4 + 4 + 1.
+    n = 0;
+    for (k = lo; k < hi; k++) {
+        i = k / KYBER_K;
+        j = k % KYBER_K;
+        r[n] = &a[i].vec[j];
+        if (transposed) {
+            xy[2 * n + 0] = (uint8_t)i;
+            xy[2 * n + 1] = (uint8_t)j;
+        } else {
+            xy[2 * n + 0] = (uint8_t)j;
+            xy[2 * n + 1] = (uint8_t)i;
+        }
+        if (++n == 4) {
+            gen_matrix_x4(r, seed, xy);
+            n = 0;
         }
     }
+
+    if (n >= 2) {
+        gen_matrix_x2(r, seed, xy);
+        n -= 2;
+        r[0] = r[2];
+        xy[0] = xy[4];
+        xy[1] = xy[5];
+    }
+    if (n == 1) {
+        gen_matrix_x1(r[0], seed, xy);
+    }
+}
+
+// Not static for benchmarking
+void KYBER_NAMESPACE(gen_matrix)(polyvec *a, const uint8_t seed[KYBER_SYMBYTES], int transposed) {
+    gen_matrix_range(a, seed, transposed, 0, KYBER_K * KYBER_K);
+}
+
+#if defined(KYBER_LOWSTACK)
+/*************************************************
+* Name:        gen_at_entry
+*
+* Description: Sample the single entry (i, j) of A^T from the seed,
+*              squeezing one XOF block at a time. Gives the same
+*              polynomial as gen_matrix with a third of its buffer
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *seed: pointer to input seed
+*              - uint8_t i: row of A^T
+*              - uint8_t j: column of A^T
+**************************************************/
+static void gen_at_entry(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t i, uint8_t j) {
+    unsigned int ctr = 0;
+    uint8_t buf[XOF_BLOCKBYTES];
+    xof_state state;
+
+    xof_absorb(&state, seed, i, j);
+    while (ctr < KYBER_N) {
+        xof_squeezeblocks(buf, 1, &state);
+        ctr += rej_uniform(r->coeffs + ctr, KYBER_N - ctr, buf, XOF_BLOCKBYTES);
+    }
+    xof_ctx_release(&state);
+}
+#else
+/*************************************************
+* Name:        gen_at_row
+*
+* Description: Sample row i of A^T from the seed, its K entries together
+*              on the multi-way XOF
+*
+* Arguments:   - polyvec *row: pointer to output row
+*              - const uint8_t *seed: pointer to input seed
+*              - uint8_t i: index of the row
+**************************************************/
+static void gen_at_row(polyvec *row, const uint8_t seed[KYBER_SYMBYTES], uint8_t i) {
+    unsigned int j;
+    poly *r[KYBER_K];
+    uint8_t xy[2 * KYBER_K];
+
+    for (j = 0; j < KYBER_K; j++) {
+        r[j] = &row->vec[j];
+        xy[2 * j + 0] = i;
+        xy[2 * j + 1] = (uint8_t)j;
+    }
+#if KYBER_K == 4
+    gen_matrix_x4(r, seed, xy);
+#else
+    gen_matrix_x2(r, seed, xy);
+#if KYBER_K == 3
+    gen_matrix_x1(r[2], seed, xy + 4);
+#endif
+#endif
+}
+#endif
+
+/*************************************************
+* Name:        getnoise_eta1_batch
+*
+* Description: Sample n polynomials with parameter KYBER_ETA1 from
+*              consecutive nonces, four or two at a time where possible
+*
+* Arguments:   - poly **r: pointers to the n output polynomials
+*              - unsigned int n: number of polynomials
+*              - const uint8_t *seed: pointer to input seed
+*              - uint8_t nonce: nonce of the first polynomial
+**************************************************/
+static void getnoise_eta1_batch(poly **r, unsigned int n, const uint8_t seed[KYBER_SYMBYTES], uint8_t nonce) {
+    for (; n >= 4; n -= 4, r += 4, nonce += 4) {
+        KYBER_NAMESPACE(poly_getnoise_eta1_4x)(r[0], r[1], r[2], r[3], seed,
+                nonce, nonce + 1, nonce + 2, nonce + 3);
+    }
+    if (n >= 2) {
+        KYBER_NAMESPACE(poly_getnoise_eta1_2x)(r[0], r[1], seed, nonce, nonce + 1);
+        n -= 2;
+        r += 2;
+        nonce += 2;
+    }
+    if (n == 1) {
+        KYBER_NAMESPACE(poly_getnoise_eta1)(r[0], seed, nonce);
+    }
+}
+
+/*************************************************
+* Name:        getnoise_eta2_batch
+*
+* Description: Sample n polynomials with parameter KYBER_ETA2 from
+*              consecutive nonces, four or two at a time where possible
+*
+* Arguments:   - poly **r: pointers to the n output polynomials
+*              - unsigned int n: number of polynomials
+*              - const uint8_t *seed: pointer to input seed
+*              - uint8_t nonce: nonce of the first polynomial
+**************************************************/
+static void getnoise_eta2_batch(poly **r, unsigned int n, const uint8_t seed[KYBER_SYMBYTES], uint8_t nonce) {
+    for (; n >= 4; n -= 4, r += 4, nonce += 4) {
+        PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2_4x(r[0], r[1], r[2], r[3], seed,
+                nonce, nonce + 1, nonce + 2, nonce + 3);
+    }
+    if (n >= 2) {
+        PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2_2x(r[0], r[1], seed, nonce, nonce + 1);
+        n -= 2;
+        r += 2;
+        nonce += 2;
+    }
+    if (n == 1) {
+        PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2(r[0], seed, nonce);
+    }
+}
+
+/*
+ * The sampling of key generation and encryption: the entries of the matrix
+ * (if a is not NULL) and n1 + n2 noise polynomials, n1 with parameter
+ * KYBER_ETA1 and nonces 0..n1-1 and then n2 with KYBER_ETA2 and nonces
+ * n1..n1+n2-1. Each of the njobs jobs samples a contiguous slice of all
+ * three, so the result does not depend on how the jobs are scheduled.
+ */
+typedef struct {
+    polyvec *a;
+    const uint8_t *seed;
+    int transposed;
+    poly **noise;
+    unsigned int n1, n2;
+    const uint8_t *noiseseed;
+    unsigned int njobs;
+} sample_job;
+
+/*************************************************
+* Name:        sample_slice
+*
+* Description: Job t of a sample_job
+*
+* Arguments:   - void *arg: pointer to the sample_job
+*              - unsigned int t: index of the job
+**************************************************/
+static void sample_slice(void *arg, unsigned int t) {
+    const sample_job *s = arg;
+    unsigned int lo, hi;
+
+    if (s->a != NULL) {
+        lo = t * KYBER_K * KYBER_K / s->njobs;
+        hi = (t + 1) * KYBER_K * KYBER_K / s->njobs;
+        gen_matrix_range(s->a, s->seed, s->transposed, lo, hi);
+    }
+
+    lo = t * s->n1 / s->njobs;
+    hi = (t + 1) * s->n1 / s->njobs;
+    if (lo < hi) {
+        getnoise_eta1_batch(s->noise + lo, hi - lo, s->noiseseed, (uint8_t)lo);
+    }
+
+    lo = t * s->n2 / s->njobs;
+    hi = (t + 1) * s->n2 / s->njobs;
+    if (lo < hi) {
+        getnoise_eta2_batch(s->noise + s->n1 + lo, hi - lo, s->noiseseed, (uint8_t)(s->n1 + lo));
+    }
+}
+
+/*************************************************
+* Name:        sample_all
+*
+* Description: Run a sample_job, split over the threads of the installed
+*              executor if there is one
+*
+* Arguments:   - sample_job *s: pointer to the job; njobs is set here
+**************************************************/
+static void sample_all(sample_job *s) {
+    s->njobs = PQCLEAN_MLKEM_CLEAN_parallel_threads();
+    PQCLEAN_MLKEM_CLEAN_parallel_for(sample_slice, s, s->njobs);
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_indcpa_keypair_derand
+* Name:        indcpa_keypair_derand
 *
 * Description: Generates public and private key for the CPA-secure
 *              public-key encryption scheme underlying Kyber
@@ -195,48 +486,234 @@ void PQCLEAN_MLKEM768_CLEAN_gen_matrix(polyvec *a, const uint8_t seed[KYBER_SYMB
 *              - const uint8_t *coins: pointer to input randomness
 *                             (of length KYBER_SYMBYTES bytes)
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_indcpa_keypair_derand(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+void KYBER_NAMESPACE(indcpa_keypair_derand)(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
         uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES],
         const uint8_t coins[KYBER_SYMBYTES]) {
     unsigned int i;
     uint8_t buf[2 * KYBER_SYMBYTES];
     const uint8_t *publicseed = buf;
     const uint8_t *noiseseed = buf + KYBER_SYMBYTES;
-    uint8_t nonce = 0;
+    const uint8_t k = KYBER_K;
+    keccak_iovec in[2];
     polyvec a[KYBER_K], e, pkpv, skpv;
+    polyvec_mulcache skpv_cache;
+    poly *noise[2 * KYBER_K];
+    sample_job job;
 
-    memcpy(buf, coins, KYBER_SYMBYTES);
-    buf[KYBER_SYMBYTES] = KYBER_K;
-    hash_g(buf, buf, KYBER_SYMBYTES + 1);
-
-    gen_a(a, publicseed);
+    in[0].base = coins;
+    in[0].len = KYBER_SYMBYTES;
+    in[1].base = &k;
+    in[1].len = 1;
+    hash_g_iov(buf, in, 2);
 
+    // skpv takes nonces 0..K-1 and e takes K..2K-1
     for (i = 0; i < KYBER_K; i++) {
-        PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta1(&skpv.vec[i], noiseseed, nonce++);
-    }
-    for (i = 0; i < KYBER_K; i++) {
-        PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta1(&e.vec[i], noiseseed, nonce++);
+        noise[i] = &skpv.vec[i];
+        noise[KYBER_K + i] = &e.vec[i];
     }
-
-    PQCLEAN_MLKEM768_CLEAN_polyvec_ntt(&skpv);
-    PQCLEAN_MLKEM768_CLEAN_polyvec_ntt(&e);
+    job.a = a;
+    job.seed = publicseed;
+    job.transposed = 0;
+    job.noise = noise;
+    job.n1 = 2 * KYBER_K;
+    job.n2 = 0;
+    job.noiseseed = noiseseed;
+    sample_all(&job);
+
+    KYBER_NAMESPACE(polyvec_ntt)(&skpv);
+    KYBER_NAMESPACE(polyvec_ntt)(&e);
+    KYBER_NAMESPACE(polyvec_mulcache_compute)(&skpv_cache, &skpv);
 
     // matrix-vector multiplication
     for (i = 0; i < KYBER_K; i++) {
-        PQCLEAN_MLKEM768_CLEAN_polyvec_basemul_acc_montgomery(&pkpv.vec[i], &a[i], &skpv);
+        KYBER_NAMESPACE(polyvec_basemul_acc_montgomery_cached)(&pkpv.vec[i], &a[i], &skpv, &skpv_cache);
         PQCLEAN_MLKEM768_CLEAN_poly_tomont(&pkpv.vec[i]);
     }
 
-    PQCLEAN_MLKEM768_CLEAN_polyvec_add(&pkpv, &pkpv, &e);
-    PQCLEAN_MLKEM768_CLEAN_polyvec_reduce(&pkpv);
+    KYBER_NAMESPACE(polyvec_add)(&pkpv, &pkpv, &e);
+    KYBER_NAMESPACE(polyvec_reduce)(&pkpv);
 
     pack_sk(sk, &skpv);
     pack_pk(pk, &pkpv, publicseed);
 }
 
 
+#if defined(KYBER_LOWSTACK)
+/*
+ * Shared state of the jobs of indcpa_enc_rows: s, packed, is written by
+ * K noise jobs and then read by K+1 row jobs, each of which writes its
+ * own part of the ciphertext
+ */
+typedef struct {
+    uint8_t *c;
+    const uint8_t *m;
+    const uint8_t *t;
+    const uint8_t *seed;
+    const uint8_t *at;
+    const uint8_t *coins;
+    uint8_t sp[KYBER_POLYVECBYTES];
+} enc_rows_job;
+
+/* Fails to compile if the job, the two polynomials of enc_rows_row and
+ * the XOF state and block of gen_at_entry exceed KYBER_LOWSTACK_BUDGET */
+typedef char enc_rows_budget_check[(sizeof(enc_rows_job) + 2 * sizeof(poly) + sizeof(xof_state) + XOF_BLOCKBYTES
+                                    <= KYBER_LOWSTACK_BUDGET) ? 1 : -1];
+
+/*************************************************
+* Name:        enc_rows_noise
+*
+* Description: Sample entry j of s, transform it and store it packed
+*
+* Arguments:   - void *arg: pointer to the enc_rows_job
+*              - unsigned int j: index of the entry
+**************************************************/
+static void enc_rows_noise(void *arg, unsigned int j) {
+    enc_rows_job *job = arg;
+    poly a;
+
+    KYBER_NAMESPACE(poly_getnoise_eta1)(&a, job->coins, (uint8_t)j);
+    PQCLEAN_MLKEM768_CLEAN_poly_ntt(&a);
+    PQCLEAN_MLKEM768_CLEAN_poly_tobytes(job->sp + j * KYBER_POLYBYTES, &a);
+}
+
+/*************************************************
+* Name:        enc_rows_row
+*
+* Description: Compute entry i of u = A^T s + e1, or v = t^T s + e2 for
+*              i = K, and compress it into the ciphertext. The noise of
+*              row i has nonce K+i
+*
+* Arguments:   - void *arg: pointer to the enc_rows_job
+*              - unsigned int i: index of the row
+**************************************************/
+static void enc_rows_row(void *arg, unsigned int i) {
+    const enc_rows_job *job = arg;
+    unsigned int j;
+    poly a, acc;
+
+    memset(&acc, 0, sizeof(acc));
+    for (j = 0; j < KYBER_K; j++) {
+        if (i == KYBER_K) {
+            PQCLEAN_MLKEM768_CLEAN_poly_frombytes(&a, job->t + j * KYBER_POLYBYTES);
+        } else if (job->at != NULL) {
+            PQCLEAN_MLKEM768_CLEAN_poly_frombytes(&a, job->at + (i * KYBER_K + j) * KYBER_POLYBYTES);
+        } else {
+            gen_at_entry(&a, job->seed, (uint8_t)i, (uint8_t)j);
+        }
+        PQCLEAN_MLKEM768_CLEAN_poly_basemul_acc_frombytes(&acc, &a, job->sp + j * KYBER_POLYBYTES);
+    }
+    PQCLEAN_MLKEM768_CLEAN_poly_reduce(&acc);
+
+    PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2(&a, job->coins, (uint8_t)(KYBER_K + i));
+    if (i < KYBER_K) {
+        KYBER_NAMESPACE(poly_invntt_add_compress_du)(job->c + i * (KYBER_POLYVECCOMPRESSEDBYTES / KYBER_K), &acc, &a);
+    } else {
+        KYBER_NAMESPACE(poly_invntt_add_compress)(job->c + KYBER_POLYVECCOMPRESSEDBYTES, &acc, &a, job->m);
+    }
+}
+
+/*************************************************
+* Name:        indcpa_enc_rows
+*
+* Description: Encryption that keeps only s in memory, packed, and computes
+*              one entry of u = A^T s + e1, and then v = t^T s + e2, at a
+*              time: each entry of A^T is sampled or unpacked, multiplied
+*              into an accumulator and dropped, and the accumulator is
+*              compressed straight into the ciphertext. Same output as
+*              indcpa_enc_at with a fraction of its stack
+*
+* Arguments:   - uint8_t *c: pointer to output ciphertext
+*                            (of length KYBER_INDCPA_BYTES bytes)
+*              - const uint8_t *m: pointer to input message
+*                                  (of length KYBER_INDCPA_MSGBYTES bytes)
+*              - const uint8_t *t: pointer to serialized public-key polyvec t
+*              - const uint8_t *seed: pointer to the public seed of A
+*              - const uint8_t *at: pointer to A^T as stored by
+*                                   indcpa_expand_pk, or NULL to sample it
+*                                   from seed
+*              - const uint8_t *coins: pointer to input random coins used as seed
+*                                      (of length KYBER_SYMBYTES)
+**************************************************/
+static void indcpa_enc_rows(uint8_t c[KYBER_INDCPA_BYTES],
+                            const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                            const uint8_t t[KYBER_POLYVECBYTES],
+                            const uint8_t seed[KYBER_SYMBYTES],
+                            const uint8_t *at,
+                            const uint8_t coins[KYBER_SYMBYTES]) {
+    enc_rows_job job;
+
+    job.c = c;
+    job.m = m;
+    job.t = t;
+    job.seed = seed;
+    job.at = at;
+    job.coins = coins;
+    PQCLEAN_MLKEM_CLEAN_parallel_for(enc_rows_noise, &job, KYBER_K);
+    PQCLEAN_MLKEM_CLEAN_parallel_for(enc_rows_row, &job, KYBER_K + 1);
+}
+#else
+/*************************************************
+* Name:        indcpa_enc_at
+*
+* Description: Encryption with the public key already unpacked
+*
+* Arguments:   - uint8_t *c: pointer to output ciphertext
+*                            (of length KYBER_INDCPA_BYTES bytes)
+*              - const uint8_t *m: pointer to input message
+*                                  (of length KYBER_INDCPA_MSGBYTES bytes)
+*              - const polyvec *pkpv: pointer to public-key polyvec t
+*              - polyvec *at: pointer to the K rows of A^T; generated
+*                             here from seed unless seed is NULL
+*              - const uint8_t *seed: pointer to the public seed of A, or NULL
+*              - const uint8_t *coins: pointer to input random coins used as seed
+*                                      (of length KYBER_SYMBYTES)
+**************************************************/
+static void indcpa_enc_at(uint8_t c[KYBER_INDCPA_BYTES],
+                          const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                          const polyvec *pkpv,
+                          polyvec at[KYBER_K],
+                          const uint8_t *seed,
+                          const uint8_t coins[KYBER_SYMBYTES]) {
+    unsigned int i;
+    polyvec sp, ep, b;
+    polyvec_mulcache sp_cache;
+    poly v, epp;
+    poly *noise[2 * KYBER_K + 1];
+    sample_job job;
+
+    // sp takes nonces 0..K-1, ep takes K..2K-1 and epp takes 2K
+    for (i = 0; i < KYBER_K; i++) {
+        noise[i] = sp.vec + i;
+        noise[KYBER_K + i] = ep.vec + i;
+    }
+    noise[2 * KYBER_K] = &epp;
+    job.a = seed != NULL ? at : NULL;
+    job.seed = seed;
+    job.transposed = 1;
+    job.noise = noise;
+    job.n1 = KYBER_K;
+    job.n2 = KYBER_K + 1;
+    job.noiseseed = coins;
+    sample_all(&job);
+
+    KYBER_NAMESPACE(polyvec_ntt)(&sp);
+    KYBER_NAMESPACE(polyvec_mulcache_compute)(&sp_cache, &sp);
+
+    // matrix-vector multiplication
+    for (i = 0; i < KYBER_K; i++) {
+        KYBER_NAMESPACE(polyvec_basemul_acc_montgomery_cached)(&b.vec[i], &at[i], &sp, &sp_cache);
+    }
+
+    KYBER_NAMESPACE(polyvec_basemul_acc_montgomery_cached)(&v, pkpv, &sp, &sp_cache);
+
+    // invntt, add noise (and message), reduce and compress in one pass
+    KYBER_NAMESPACE(polyvec_invntt_add_compress)(c, &b, &ep);
+    KYBER_NAMESPACE(poly_invntt_add_compress)(c + KYBER_POLYVECCOMPRESSEDBYTES, &v, &epp, m);
+}
+#endif
+
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_indcpa_enc
+* Name:        indcpa_enc
 *
 * Description: Encryption function of the CPA-secure
 *              public-key encryption scheme underlying Kyber.
@@ -251,51 +728,221 @@ void PQCLEAN_MLKEM768_CLEAN_indcpa_keypair_derand(uint8_t pk[KYBER_INDCPA_PUBLIC
 *                                      (of length KYBER_SYMBYTES) to deterministically
 *                                      generate all randomness
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_indcpa_enc(uint8_t c[KYBER_INDCPA_BYTES],
+void KYBER_NAMESPACE(indcpa_enc)(uint8_t c[KYBER_INDCPA_BYTES],
                                        const uint8_t m[KYBER_INDCPA_MSGBYTES],
                                        const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
                                        const uint8_t coins[KYBER_SYMBYTES]) {
-    unsigned int i;
+#if defined(KYBER_LOWSTACK)
+    indcpa_enc_rows(c, m, pk, pk + KYBER_POLYVECBYTES, NULL, coins);
+#else
     uint8_t seed[KYBER_SYMBYTES];
-    uint8_t nonce = 0;
-    polyvec sp, pkpv, ep, at[KYBER_K], b;
-    poly v, k, epp;
+    polyvec pkpv, at[KYBER_K];
 
     unpack_pk(&pkpv, seed, pk);
-    PQCLEAN_MLKEM768_CLEAN_poly_frommsg(&k, m);
-    gen_at(at, seed);
+    indcpa_enc_at(c, m, &pkpv, at, seed, coins);
+#endif
+}
 
+/*************************************************
+* Name:        indcpa_expand_pk
+*
+* Description: Precomputes the public-key dependent part of indcpa_enc:
+*              t is copied as it is in the public key and A^T is generated
+*              from the seed and stored row by row, 12 bits per coefficient
+*
+* Arguments:   - uint8_t *epk: pointer to output expanded public key
+*                              (of length KYBER_INDCPA_EXPANDEDPKBYTES)
+*              - const uint8_t *pk: pointer to input public key
+*                                   (of length KYBER_INDCPA_PUBLICKEYBYTES)
+**************************************************/
+void KYBER_NAMESPACE(indcpa_expand_pk)(uint8_t epk[KYBER_INDCPA_EXPANDEDPKBYTES],
+        const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES]) {
+#if defined(KYBER_LOWSTACK)
+    unsigned int i, j;
+    poly a;
+
+    memcpy(epk, pk, KYBER_POLYVECBYTES);
     for (i = 0; i < KYBER_K; i++) {
-        PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta1(sp.vec + i, coins, nonce++);
+        for (j = 0; j < KYBER_K; j++) {
+            gen_at_entry(&a, pk + KYBER_POLYVECBYTES, (uint8_t)i, (uint8_t)j);
+            PQCLEAN_MLKEM768_CLEAN_poly_tobytes(epk + (i + 1) * KYBER_POLYVECBYTES + j * KYBER_POLYBYTES, &a);
+        }
     }
+#else
+    unsigned int i;
+    polyvec at[KYBER_K];
+    sample_job job;
+
+    memcpy(epk, pk, KYBER_POLYVECBYTES);
+    job.a = at;
+    job.seed = pk + KYBER_POLYVECBYTES;
+    job.transposed = 1;
+    job.noise = NULL;
+    job.n1 = 0;
+    job.n2 = 0;
+    job.noiseseed = NULL;
+    sample_all(&job);
     for (i = 0; i < KYBER_K; i++) {
-        PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2(ep.vec + i, coins, nonce++);
+        KYBER_NAMESPACE(polyvec_tobytes)(epk + (i + 1) * KYBER_POLYVECBYTES, &at[i]);
     }
-    PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2(&epp, coins, nonce++);
+#endif
+}
 
-    PQCLEAN_MLKEM768_CLEAN_polyvec_ntt(&sp);
+/*************************************************
+* Name:        indcpa_enc_expanded
+*
+* Description: Same as indcpa_enc, but takes the public key in the form
+*              produced by indcpa_expand_pk and so skips generating A^T
+*
+* Arguments:   - uint8_t *c: pointer to output ciphertext
+*                            (of length KYBER_INDCPA_BYTES bytes)
+*              - const uint8_t *m: pointer to input message
+*                                  (of length KYBER_INDCPA_MSGBYTES bytes)
+*              - const uint8_t *epk: pointer to input expanded public key
+*                                    (of length KYBER_INDCPA_EXPANDEDPKBYTES)
+*              - const uint8_t *coins: pointer to input random coins used as seed
+*                                      (of length KYBER_SYMBYTES)
+**************************************************/
+void KYBER_NAMESPACE(indcpa_enc_expanded)(uint8_t c[KYBER_INDCPA_BYTES],
+        const uint8_t m[KYBER_INDCPA_MSGBYTES],
+        const uint8_t epk[KYBER_INDCPA_EXPANDEDPKBYTES],
+        const uint8_t coins[KYBER_SYMBYTES]) {
+#if defined(KYBER_LOWSTACK)
+    indcpa_enc_rows(c, m, epk, NULL, epk + KYBER_POLYVECBYTES, coins);
+#else
+    unsigned int i;
+    polyvec pkpv, at[KYBER_K];
 
-    // matrix-vector multiplication
+    KYBER_NAMESPACE(polyvec_frombytes)(&pkpv, epk);
     for (i = 0; i < KYBER_K; i++) {
-        PQCLEAN_MLKEM768_CLEAN_polyvec_basemul_acc_montgomery(&b.vec[i], &at[i], &sp);
+        KYBER_NAMESPACE(polyvec_frombytes)(&at[i], epk + (i + 1) * KYBER_POLYVECBYTES);
+    }
+
+    indcpa_enc_at(c, m, &pkpv, at, NULL, coins);
+#endif
+}
+
+/*************************************************
+* Name:        indcpa_enc_stream_absorb
+*
+* Description: Take the next inlen bytes of the public key into a
+*              streaming encryption, unpacking every polynomial of t
+*              whose bytes are complete. The caller makes sure that no
+*              more than KYBER_INDCPA_PUBLICKEYBYTES come in overall
+*
+* Arguments:   - mlkem_enc_stream *st: pointer to the stream state
+*              - const uint8_t *in: pointer to the next public key bytes
+*              - size_t inlen: number of bytes
+**************************************************/
+void KYBER_NAMESPACE(indcpa_enc_stream_absorb)(mlkem_enc_stream *st, const uint8_t *in, size_t inlen) {
+    size_t i, off, n;
+
+    while (inlen > 0) {
+        // Bytes of polynomial i of t, or of the seed once i reaches K
+        i = st->pkbytes / KYBER_POLYBYTES;
+        off = st->pkbytes % KYBER_POLYBYTES;
+        n = (i < KYBER_K ? KYBER_POLYBYTES : KYBER_SYMBYTES) - off;
+        if (n > inlen) {
+            n = inlen;
+        }
+        memcpy(st->part + off, in, n);
+        st->pkbytes += n;
+        in += n;
+        inlen -= n;
+        if (i < KYBER_K && off + n == KYBER_POLYBYTES) {
+            PQCLEAN_MLKEM768_CLEAN_poly_frombytes((poly *)st->t[i], st->part);
+        }
     }
+}
 
-    PQCLEAN_MLKEM768_CLEAN_polyvec_basemul_acc_montgomery(&v, &pkpv, &sp);
+/*************************************************
+* Name:        indcpa_enc_stream_start
+*
+* Description: Start producing the ciphertext of a streaming encryption
+*              whose public key is complete: sample s, transform it and
+*              keep it packed with the message and coins for emit
+*
+* Arguments:   - mlkem_enc_stream *st: pointer to the stream state
+*              - const uint8_t *m: pointer to input message
+*                                  (of length KYBER_INDCPA_MSGBYTES bytes)
+*              - const uint8_t *coins: pointer to input random coins used as seed
+*                                      (of length KYBER_SYMBYTES)
+**************************************************/
+void KYBER_NAMESPACE(indcpa_enc_stream_start)(mlkem_enc_stream *st,
+        const uint8_t m[KYBER_INDCPA_MSGBYTES],
+        const uint8_t coins[KYBER_SYMBYTES]) {
+    unsigned int j;
+    poly a;
+
+    for (j = 0; j < KYBER_K; j++) {
+        KYBER_NAMESPACE(poly_getnoise_eta1)(&a, coins, (uint8_t)j);
+        PQCLEAN_MLKEM768_CLEAN_poly_ntt(&a);
+        PQCLEAN_MLKEM768_CLEAN_poly_tobytes(st->sp + j * KYBER_POLYBYTES, &a);
+    }
+    memcpy(st->m, m, KYBER_INDCPA_MSGBYTES);
+    memcpy(st->coins, coins, KYBER_SYMBYTES);
+    st->row = 0;
+}
 
-    PQCLEAN_MLKEM768_CLEAN_polyvec_invntt_tomont(&b);
-    PQCLEAN_MLKEM768_CLEAN_poly_invntt_tomont(&v);
+/*************************************************
+* Name:        indcpa_enc_stream_emit
+*
+* Description: Compute the next entry of u = A^T s + e1, or v = t^T s + e2
+*              after the last one, and write it compressed. Only row i of
+*              A^T is sampled, one entry at a time with KYBER_LOWSTACK
+*
+* Arguments:   - mlkem_enc_stream *st: pointer to the stream state
+*              - uint8_t *out: pointer to output ciphertext piece (of
+*                              length PQCLEAN_MLKEM_CLEAN_ENCSTREAM_MAXCHUNK)
+*
+* Returns the number of bytes written, 0 once the ciphertext is complete
+**************************************************/
+size_t KYBER_NAMESPACE(indcpa_enc_stream_emit)(mlkem_enc_stream *st, uint8_t *out) {
+    unsigned int i = st->row, j;
+    poly a, acc;
+#if !defined(KYBER_LOWSTACK)
+    polyvec at;
+#endif
+
+    if (i > KYBER_K) {
+        return 0;
+    }
 
-    PQCLEAN_MLKEM768_CLEAN_polyvec_add(&b, &b, &ep);
-    PQCLEAN_MLKEM768_CLEAN_poly_add(&v, &v, &epp);
-    PQCLEAN_MLKEM768_CLEAN_poly_add(&v, &v, &k);
-    PQCLEAN_MLKEM768_CLEAN_polyvec_reduce(&b);
-    PQCLEAN_MLKEM768_CLEAN_poly_reduce(&v);
+    memset(&acc, 0, sizeof(acc));
+    if (i == KYBER_K) {
+        for (j = 0; j < KYBER_K; j++) {
+            PQCLEAN_MLKEM768_CLEAN_poly_basemul_acc_frombytes(&acc, (const poly *)st->t[j], st->sp + j * KYBER_POLYBYTES);
+        }
+    } else {
+#if defined(KYBER_LOWSTACK)
+        for (j = 0; j < KYBER_K; j++) {
+            gen_at_entry(&a, st->part, (uint8_t)i, (uint8_t)j);
+            PQCLEAN_MLKEM768_CLEAN_poly_basemul_acc_frombytes(&acc, &a, st->sp + j * KYBER_POLYBYTES);
+        }
+#else
+        gen_at_row(&at, st->part, (uint8_t)i);
+        for (j = 0; j < KYBER_K; j++) {
+            PQCLEAN_MLKEM768_CLEAN_poly_basemul_acc_frombytes(&acc, &at.vec[j], st->sp + j * KYBER_POLYBYTES);
+        }
+#endif
+    }
+    PQCLEAN_MLKEM768_CLEAN_poly_reduce(&acc);
 
-    pack_ciphertext(c, &b, &v);
+    PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2(&a, st->coins, (uint8_t)(KYBER_K + i));
+    st->row++;
+    if (i < KYBER_K) {
+        KYBER_NAMESPACE(poly_invntt_add_compress_du)(out, &acc, &a);
+        return KYBER_POLYVECCOMPRESSEDBYTES / KYBER_K;
+    }
+    KYBER_NAMESPACE(poly_invntt_add_compress)(out, &acc, &a, st->m);
+    memset(st->sp, 0, sizeof(st->sp));
+    memset(st->m, 0, sizeof(st->m));
+    memset(st->coins, 0, sizeof(st->coins));
+    return KYBER_POLYCOMPRESSEDBYTES;
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_indcpa_dec
+* Name:        indcpa_dec
 *
 * Description: Decryption function of the CPA-secure
 *              public-key encryption scheme underlying Kyber.
@@ -307,21 +954,18 @@ void PQCLEAN_MLKEM768_CLEAN_indcpa_enc(uint8_t c[KYBER_INDCPA_BYTES],
 *              - const uint8_t *sk: pointer to input secret key
 *                                   (of length KYBER_INDCPA_SECRETKEYBYTES)
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_indcpa_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
+void KYBER_NAMESPACE(indcpa_dec)(uint8_t m[KYBER_INDCPA_MSGBYTES],
                                        const uint8_t c[KYBER_INDCPA_BYTES],
                                        const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES]) {
     polyvec b, skpv;
-    poly v, mp;
+    polyvec_mulcache b_cache;
+    poly mp;
 
-    unpack_ciphertext(&b, &v, c);
+    KYBER_NAMESPACE(polyvec_decompress_ntt)(&b, c);
     unpack_sk(&skpv, sk);
 
-    PQCLEAN_MLKEM768_CLEAN_polyvec_ntt(&b);
-    PQCLEAN_MLKEM768_CLEAN_polyvec_basemul_acc_montgomery(&mp, &skpv, &b);
-    PQCLEAN_MLKEM768_CLEAN_poly_invntt_tomont(&mp);
-
-    PQCLEAN_MLKEM768_CLEAN_poly_sub(&mp, &v, &mp);
-    PQCLEAN_MLKEM768_CLEAN_poly_reduce(&mp);
+    KYBER_NAMESPACE(polyvec_mulcache_compute)(&b_cache, &b);
+    KYBER_NAMESPACE(polyvec_basemul_acc_montgomery_cached)(&mp, &skpv, &b, &b_cache);
 
-    PQCLEAN_MLKEM768_CLEAN_poly_tomsg(m, &mp);
+    KYBER_NAMESPACE(poly_invntt_sub_tomsg)(m, &mp, c + KYBER_POLYVECCOMPRESSEDBYTES);
 }
@@ -1,21 +1,39 @@
 #ifndef PQCLEAN_MLKEM768_CLEAN_INDCPA_H
 #define PQCLEAN_MLKEM768_CLEAN_INDCPA_H
+#include "encstream.h"
 #include "params.h"
 #include "polyvec.h"
+#include <stddef.h>
 #include <stdint.h>
 
-void PQCLEAN_MLKEM768_CLEAN_gen_matrix(polyvec *a, const uint8_t seed[KYBER_SYMBYTES], int transposed);
+void KYBER_NAMESPACE(gen_matrix)(polyvec *a, const uint8_t seed[KYBER_SYMBYTES], int transposed);
 
-void PQCLEAN_MLKEM768_CLEAN_indcpa_keypair_derand(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+void KYBER_NAMESPACE(indcpa_keypair_derand)(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
         uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES],
         const uint8_t coins[KYBER_SYMBYTES]);
 
-void PQCLEAN_MLKEM768_CLEAN_indcpa_enc(uint8_t c[KYBER_INDCPA_BYTES],
+void KYBER_NAMESPACE(indcpa_enc)(uint8_t c[KYBER_INDCPA_BYTES],
                                        const uint8_t m[KYBER_INDCPA_MSGBYTES],
                                        const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
                                        const uint8_t coins[KYBER_SYMBYTES]);
 
-void PQCLEAN_MLKEM768_CLEAN_indcpa_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
+void KYBER_NAMESPACE(indcpa_expand_pk)(uint8_t epk[KYBER_INDCPA_EXPANDEDPKBYTES],
+        const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES]);
+
+void KYBER_NAMESPACE(indcpa_enc_expanded)(uint8_t c[KYBER_INDCPA_BYTES],
+        const uint8_t m[KYBER_INDCPA_MSGBYTES],
+        const uint8_t epk[KYBER_INDCPA_EXPANDEDPKBYTES],
+        const uint8_t coins[KYBER_SYMBYTES]);
+
+void KYBER_NAMESPACE(indcpa_enc_stream_absorb)(mlkem_enc_stream *st, const uint8_t *in, size_t inlen);
+
+void KYBER_NAMESPACE(indcpa_enc_stream_start)(mlkem_enc_stream *st,
+        const uint8_t m[KYBER_INDCPA_MSGBYTES],
+        const uint8_t coins[KYBER_SYMBYTES]);
+
+size_t KYBER_NAMESPACE(indcpa_enc_stream_emit)(mlkem_enc_stream *st, uint8_t *out);
+
+void KYBER_NAMESPACE(indcpa_dec)(uint8_t m[KYBER_INDCPA_MSGBYTES],
                                        const uint8_t c[KYBER_INDCPA_BYTES],
                                        const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES]);
 
@@ -8,7 +8,7 @@
 #include <stdint.h>
 #include <string.h>
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair_derand
+* Name:        crypto_kem_keypair_derand
 *
 * Description: Generates public and private key
 *              for CCA-secure Kyber key encapsulation mechanism
@@ -22,10 +22,10 @@
 **
 * Returns 0 (success)
 **************************************************/
-int PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair_derand(uint8_t *pk,
+int KYBER_NAMESPACE(crypto_kem_keypair_derand)(uint8_t *pk,
         uint8_t *sk,
         const uint8_t *coins) {
-    PQCLEAN_MLKEM768_CLEAN_indcpa_keypair_derand(pk, sk, coins);
+    KYBER_NAMESPACE(indcpa_keypair_derand)(pk, sk, coins);
     memcpy(sk + KYBER_INDCPA_SECRETKEYBYTES, pk, KYBER_PUBLICKEYBYTES);
     hash_h(sk + KYBER_SECRETKEYBYTES - 2 * KYBER_SYMBYTES, pk, KYBER_PUBLICKEYBYTES);
     /* Value z for pseudo-random output on reject */
@@ -34,7 +34,7 @@ int PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair_derand(uint8_t *pk,
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair
+* Name:        crypto_kem_keypair
 *
 * Description: Generates public and private key
 *              for CCA-secure Kyber key encapsulation mechanism
@@ -46,16 +46,16 @@ int PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair_derand(uint8_t *pk,
 *
 * Returns 0 (success)
 **************************************************/
-int PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair(uint8_t *pk,
+int KYBER_NAMESPACE(crypto_kem_keypair)(uint8_t *pk,
         uint8_t *sk) {
     uint8_t coins[2 * KYBER_SYMBYTES];
     randombytes(coins, 2 * KYBER_SYMBYTES);
-    PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair_derand(pk, sk, coins);
+    KYBER_NAMESPACE(crypto_kem_keypair_derand)(pk, sk, coins);
     return 0;
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_derand
+* Name:        crypto_kem_enc_derand
 *
 * Description: Generates cipher text and shared
 *              secret for given public key
@@ -71,29 +71,32 @@ int PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair(uint8_t *pk,
 **
 * Returns 0 (success)
 **************************************************/
-int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_derand(uint8_t *ct,
+int KYBER_NAMESPACE(crypto_kem_enc_derand)(uint8_t *ct,
         uint8_t *ss,
         const uint8_t *pk,
         const uint8_t *coins) {
-    uint8_t buf[2 * KYBER_SYMBYTES];
+    uint8_t h[KYBER_SYMBYTES];
     /* Will contain key, coins */
     uint8_t kr[2 * KYBER_SYMBYTES];
-
-    memcpy(buf, coins, KYBER_SYMBYTES);
+    keccak_iovec in[2];
 
     /* Multitarget countermeasure for coins + contributory KEM */
-    hash_h(buf + KYBER_SYMBYTES, pk, KYBER_PUBLICKEYBYTES);
-    hash_g(kr, buf, 2 * KYBER_SYMBYTES);
+    hash_h(h, pk, KYBER_PUBLICKEYBYTES);
+    in[0].base = coins;
+    in[0].len = KYBER_SYMBYTES;
+    in[1].base = h;
+    in[1].len = KYBER_SYMBYTES;
+    hash_g_iov(kr, in, 2);
 
     /* coins are in kr+KYBER_SYMBYTES */
-    PQCLEAN_MLKEM768_CLEAN_indcpa_enc(ct, buf, pk, kr + KYBER_SYMBYTES);
+    KYBER_NAMESPACE(indcpa_enc)(ct, coins, pk, kr + KYBER_SYMBYTES);
 
     memcpy(ss, kr, KYBER_SYMBYTES);
     return 0;
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc
+* Name:        crypto_kem_enc
 *
 * Description: Generates cipher text and shared
 *              secret for given public key
@@ -107,17 +110,104 @@ int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_derand(uint8_t *ct,
 *
 * Returns 0 (success)
 **************************************************/
-int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc(uint8_t *ct,
+int KYBER_NAMESPACE(crypto_kem_enc)(uint8_t *ct,
         uint8_t *ss,
         const uint8_t *pk) {
     uint8_t coins[KYBER_SYMBYTES];
     randombytes(coins, KYBER_SYMBYTES);
-    PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_derand(ct, ss, pk, coins);
+    KYBER_NAMESPACE(crypto_kem_enc_derand)(ct, ss, pk, coins);
+    return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_expand_pk
+*
+* Description: Precomputes everything crypto_kem_enc derives from the
+*              public key alone: H(pk), t and the matrix A^T. The result
+*              can be kept and reused for any number of encapsulations
+*              to the same key with crypto_kem_enc_expanded.
+*
+* Arguments:   - uint8_t *epk: pointer to output expanded public key
+*                (an already allocated array of KYBER_EXPANDEDPKBYTES bytes)
+*              - const uint8_t *pk: pointer to input public key
+*                (an already allocated array of KYBER_PUBLICKEYBYTES bytes)
+*
+* Returns 0 (success)
+**************************************************/
+int KYBER_NAMESPACE(crypto_kem_expand_pk)(uint8_t *epk,
+        const uint8_t *pk) {
+    hash_h(epk, pk, KYBER_PUBLICKEYBYTES);
+    KYBER_NAMESPACE(indcpa_expand_pk)(epk + KYBER_SYMBYTES, pk);
     return 0;
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_crypto_kem_dec
+* Name:        crypto_kem_enc_expanded_derand
+*
+* Description: Same as crypto_kem_enc_derand, for a public key expanded
+*              with crypto_kem_expand_pk; ciphertext and shared secret
+*              are identical
+*
+* Arguments:   - uint8_t *ct: pointer to output cipher text
+*                (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+*              - uint8_t *ss: pointer to output shared secret
+*                (an already allocated array of KYBER_SSBYTES bytes)
+*              - const uint8_t *epk: pointer to input expanded public key
+*                (an already allocated array of KYBER_EXPANDEDPKBYTES bytes)
+*              - const uint8_t *coins: pointer to input randomness
+*                (an already allocated array filled with KYBER_SYMBYTES random bytes)
+**
+* Returns 0 (success)
+**************************************************/
+int KYBER_NAMESPACE(crypto_kem_enc_expanded_derand)(uint8_t *ct,
+        uint8_t *ss,
+        const uint8_t *epk,
+        const uint8_t *coins) {
+    /* Will contain key, coins */
+    uint8_t kr[2 * KYBER_SYMBYTES];
+    keccak_iovec in[2];
+
+    /* Multitarget countermeasure for coins + contributory KEM; H(pk) is
+     * the first KYBER_SYMBYTES bytes of epk */
+    in[0].base = coins;
+    in[0].len = KYBER_SYMBYTES;
+    in[1].base = epk;
+    in[1].len = KYBER_SYMBYTES;
+    hash_g_iov(kr, in, 2);
+
+    /* coins are in kr+KYBER_SYMBYTES */
+    KYBER_NAMESPACE(indcpa_enc_expanded)(ct, coins, epk + KYBER_SYMBYTES, kr + KYBER_SYMBYTES);
+
+    memcpy(ss, kr, KYBER_SYMBYTES);
+    return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_expanded
+*
+* Description: Same as crypto_kem_enc, for a public key expanded with
+*              crypto_kem_expand_pk
+*
+* Arguments:   - uint8_t *ct: pointer to output cipher text
+*                (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+*              - uint8_t *ss: pointer to output shared secret
+*                (an already allocated array of KYBER_SSBYTES bytes)
+*              - const uint8_t *epk: pointer to input expanded public key
+*                (an already allocated array of KYBER_EXPANDEDPKBYTES bytes)
+*
+* Returns 0 (success)
+**************************************************/
+int KYBER_NAMESPACE(crypto_kem_enc_expanded)(uint8_t *ct,
+        uint8_t *ss,
+        const uint8_t *epk) {
+    uint8_t coins[KYBER_SYMBYTES];
+    randombytes(coins, KYBER_SYMBYTES);
+    KYBER_NAMESPACE(crypto_kem_enc_expanded_derand)(ct, ss, epk, coins);
+    return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_dec
 *
 * Description: Generates shared secret for given
 *              cipher text and private key
@@ -133,24 +223,28 @@ int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc(uint8_t *ct,
 *
 * On failure, ss will contain a pseudo-random value.
 **************************************************/
-int PQCLEAN_MLKEM768_CLEAN_crypto_kem_dec(uint8_t *ss,
+int KYBER_NAMESPACE(crypto_kem_dec)(uint8_t *ss,
         const uint8_t *ct,
         const uint8_t *sk) {
     int fail;
-    uint8_t buf[2 * KYBER_SYMBYTES];
+    uint8_t buf[KYBER_SYMBYTES];
     /* Will contain key, coins */
     uint8_t kr[2 * KYBER_SYMBYTES];
     uint8_t cmp[KYBER_CIPHERTEXTBYTES + KYBER_SYMBYTES];
     const uint8_t *pk = sk + KYBER_INDCPA_SECRETKEYBYTES;
+    keccak_iovec in[2];
 
-    PQCLEAN_MLKEM768_CLEAN_indcpa_dec(buf, ct, sk);
+    KYBER_NAMESPACE(indcpa_dec)(buf, ct, sk);
 
     /* Multitarget countermeasure for coins + contributory KEM */
-    memcpy(buf + KYBER_SYMBYTES, sk + KYBER_SECRETKEYBYTES - 2 * KYBER_SYMBYTES, KYBER_SYMBYTES);
-    hash_g(kr, buf, 2 * KYBER_SYMBYTES);
+    in[0].base = buf;
+    in[0].len = KYBER_SYMBYTES;
+    in[1].base = sk + KYBER_SECRETKEYBYTES - 2 * KYBER_SYMBYTES;
+    in[1].len = KYBER_SYMBYTES;
+    hash_g_iov(kr, in, 2);
 
     /* coins are in kr+KYBER_SYMBYTES */
-    PQCLEAN_MLKEM768_CLEAN_indcpa_enc(cmp, buf, pk, kr + KYBER_SYMBYTES);
+    KYBER_NAMESPACE(indcpa_enc)(cmp, buf, pk, kr + KYBER_SYMBYTES);
 
     fail = PQCLEAN_MLKEM768_CLEAN_verify(ct, cmp, KYBER_CIPHERTEXTBYTES);
 
@@ -162,3 +256,196 @@ int PQCLEAN_MLKEM768_CLEAN_crypto_kem_dec(uint8_t *ss,
 
     return 0;
 }
+
+/*************************************************
+* Name:        crypto_kem_expand_sk
+*
+* Description: Precomputes everything crypto_kem_dec derives from the
+*              secret key alone, that is the expanded public key needed
+*              for the re-encryption, and keeps it together with the
+*              IND-CPA secret key and z for crypto_kem_dec_expanded.
+*
+* Arguments:   - uint8_t *esk: pointer to output expanded secret key
+*                (an already allocated array of KYBER_EXPANDEDSKBYTES bytes)
+*              - const uint8_t *sk: pointer to input private key
+*                (an already allocated array of KYBER_SECRETKEYBYTES bytes)
+*
+* Returns 0 (success)
+**************************************************/
+int KYBER_NAMESPACE(crypto_kem_expand_sk)(uint8_t *esk,
+        const uint8_t *sk) {
+    uint8_t *epk = esk + KYBER_INDCPA_SECRETKEYBYTES;
+
+    memcpy(esk, sk, KYBER_INDCPA_SECRETKEYBYTES);
+    /* H(pk) is already stored in sk */
+    memcpy(epk, sk + KYBER_SECRETKEYBYTES - 2 * KYBER_SYMBYTES, KYBER_SYMBYTES);
+    KYBER_NAMESPACE(indcpa_expand_pk)(epk + KYBER_SYMBYTES, sk + KYBER_INDCPA_SECRETKEYBYTES);
+    memcpy(esk + KYBER_EXPANDEDSKBYTES - KYBER_SYMBYTES, sk + KYBER_SECRETKEYBYTES - KYBER_SYMBYTES, KYBER_SYMBYTES);
+    return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_dec_expanded
+*
+* Description: Same as crypto_kem_dec, for a secret key expanded with
+*              crypto_kem_expand_sk
+*
+* Arguments:   - uint8_t *ss: pointer to output shared secret
+*                (an already allocated array of KYBER_SSBYTES bytes)
+*              - const uint8_t *ct: pointer to input cipher text
+*                (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+*              - const uint8_t *esk: pointer to input expanded secret key
+*                (an already allocated array of KYBER_EXPANDEDSKBYTES bytes)
+*
+* Returns 0.
+*
+* On failure, ss will contain a pseudo-random value.
+**************************************************/
+int KYBER_NAMESPACE(crypto_kem_dec_expanded)(uint8_t *ss,
+        const uint8_t *ct,
+        const uint8_t *esk) {
+    int fail;
+    uint8_t buf[KYBER_SYMBYTES];
+    /* Will contain key, coins */
+    uint8_t kr[2 * KYBER_SYMBYTES];
+    uint8_t cmp[KYBER_CIPHERTEXTBYTES + KYBER_SYMBYTES];
+    const uint8_t *epk = esk + KYBER_INDCPA_SECRETKEYBYTES;
+    keccak_iovec in[2];
+
+    KYBER_NAMESPACE(indcpa_dec)(buf, ct, esk);
+
+    /* Multitarget countermeasure for coins + contributory KEM; H(pk) is
+     * the first KYBER_SYMBYTES bytes of epk */
+    in[0].base = buf;
+    in[0].len = KYBER_SYMBYTES;
+    in[1].base = epk;
+    in[1].len = KYBER_SYMBYTES;
+    hash_g_iov(kr, in, 2);
+
+    /* coins are in kr+KYBER_SYMBYTES */
+    KYBER_NAMESPACE(indcpa_enc_expanded)(cmp, buf, epk + KYBER_SYMBYTES, kr + KYBER_SYMBYTES);
+
+    fail = PQCLEAN_MLKEM768_CLEAN_verify(ct, cmp, KYBER_CIPHERTEXTBYTES);
+
+    /* Compute rejection key */
+    rkprf(ss, esk + KYBER_EXPANDEDSKBYTES - KYBER_SYMBYTES, ct);
+
+    /* Copy true key to return buffer if fail is false */
+    PQCLEAN_MLKEM768_CLEAN_cmov(ss, kr, KYBER_SYMBYTES, (uint8_t) (1 - fail));
+
+    return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_stream_init
+*
+* Description: Start a streaming encapsulation; see encstream.h
+*
+* Arguments:   - mlkem_enc_stream *st: pointer to the stream state
+**************************************************/
+void KYBER_NAMESPACE(crypto_kem_enc_stream_init)(mlkem_enc_stream *st) {
+    sha3_256_inc_init(&st->hpk);
+    st->pkbytes = 0;
+    st->row = KYBER_K + 1;
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_stream_absorb
+*
+* Description: Take the next pklen bytes of the public key, in order
+*
+* Arguments:   - mlkem_enc_stream *st: pointer to the stream state
+*              - const uint8_t *pk: pointer to the next public key bytes
+*              - size_t pklen: number of bytes, any amount
+*
+* Returns 0, or -1 if the key would exceed KYBER_PUBLICKEYBYTES
+**************************************************/
+int KYBER_NAMESPACE(crypto_kem_enc_stream_absorb)(mlkem_enc_stream *st,
+        const uint8_t *pk,
+        size_t pklen) {
+    if (pklen > KYBER_PUBLICKEYBYTES - st->pkbytes) {
+        return -1;
+    }
+    sha3_256_inc_absorb(&st->hpk, pk, pklen);
+    KYBER_NAMESPACE(indcpa_enc_stream_absorb)(st, pk, pklen);
+    return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_stream_start_derand
+*
+* Description: Derive the shared secret once the whole public key is in;
+*              the ciphertext then comes out of crypto_kem_enc_stream_emit
+*
+* Arguments:   - mlkem_enc_stream *st: pointer to the stream state
+*              - uint8_t *ss: pointer to output shared secret
+*                (an already allocated array of KYBER_SSBYTES bytes)
+*              - const uint8_t *coins: pointer to input randomness
+*                (an already allocated array filled with KYBER_SYMBYTES random bytes)
+*
+* Returns 0, or -1 if the public key is not complete
+**************************************************/
+int KYBER_NAMESPACE(crypto_kem_enc_stream_start_derand)(mlkem_enc_stream *st,
+        uint8_t *ss,
+        const uint8_t *coins) {
+    uint8_t h[KYBER_SYMBYTES];
+    /* Will contain key, coins */
+    uint8_t kr[2 * KYBER_SYMBYTES];
+    keccak_iovec in[2];
+
+    if (st->pkbytes != KYBER_PUBLICKEYBYTES) {
+        return -1;
+    }
+
+    /* Multitarget countermeasure for coins + contributory KEM */
+    sha3_256_inc_finalize(h, &st->hpk);
+    in[0].base = coins;
+    in[0].len = KYBER_SYMBYTES;
+    in[1].base = h;
+    in[1].len = KYBER_SYMBYTES;
+    hash_g_iov(kr, in, 2);
+
+    /* coins are in kr+KYBER_SYMBYTES */
+    KYBER_NAMESPACE(indcpa_enc_stream_start)(st, coins, kr + KYBER_SYMBYTES);
+
+    memcpy(ss, kr, KYBER_SYMBYTES);
+    return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_stream_start
+*
+* Description: Same as crypto_kem_enc_stream_start_derand, with fresh
+*              randomness
+*
+* Arguments:   - mlkem_enc_stream *st: pointer to the stream state
+*              - uint8_t *ss: pointer to output shared secret
+*                (an already allocated array of KYBER_SSBYTES bytes)
+*
+* Returns 0, or -1 if the public key is not complete
+**************************************************/
+int KYBER_NAMESPACE(crypto_kem_enc_stream_start)(mlkem_enc_stream *st,
+        uint8_t *ss) {
+    uint8_t coins[KYBER_SYMBYTES];
+    randombytes(coins, KYBER_SYMBYTES);
+    return KYBER_NAMESPACE(crypto_kem_enc_stream_start_derand)(st, ss, coins);
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_stream_emit
+*
+* Description: Compute and write the next piece of the ciphertext. The
+*              pieces are the K compressed polynomials of u and then v,
+*              and concatenated give the crypto_kem_enc ciphertext
+*
+* Arguments:   - mlkem_enc_stream *st: pointer to the stream state
+*              - uint8_t *ct: pointer to output piece (an already allocated
+*                array of PQCLEAN_MLKEM_CLEAN_ENCSTREAM_MAXCHUNK bytes)
+*
+* Returns the length of the piece, 0 once the ciphertext is complete or
+* before the stream is started
+**************************************************/
+size_t KYBER_NAMESPACE(crypto_kem_enc_stream_emit)(mlkem_enc_stream *st,
+        uint8_t *ct) {
+    return KYBER_NAMESPACE(indcpa_enc_stream_emit)(st, ct);
+}
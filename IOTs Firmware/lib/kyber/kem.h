@@ -1,23 +1,47 @@
 #ifndef PQCLEAN_MLKEM768_CLEAN_KEM_H
 #define PQCLEAN_MLKEM768_CLEAN_KEM_H
+#include "encstream.h"
 #include "params.h"
+#include <stddef.h>
 #include <stdint.h>
 
-#define PQCLEAN_MLKEM768_CLEAN_CRYPTO_SECRETKEYBYTES  KYBER_SECRETKEYBYTES
-#define PQCLEAN_MLKEM768_CLEAN_CRYPTO_PUBLICKEYBYTES  KYBER_PUBLICKEYBYTES
-#define PQCLEAN_MLKEM768_CLEAN_CRYPTO_CIPHERTEXTBYTES KYBER_CIPHERTEXTBYTES
-#define PQCLEAN_MLKEM768_CLEAN_CRYPTO_BYTES           KYBER_SSBYTES
+#define CRYPTO_SECRETKEYBYTES  KYBER_SECRETKEYBYTES
+#define CRYPTO_PUBLICKEYBYTES  KYBER_PUBLICKEYBYTES
+#define CRYPTO_CIPHERTEXTBYTES KYBER_CIPHERTEXTBYTES
+#define CRYPTO_BYTES           KYBER_SSBYTES
+#define CRYPTO_EXPANDEDPKBYTES KYBER_EXPANDEDPKBYTES
+#define CRYPTO_EXPANDEDSKBYTES KYBER_EXPANDEDSKBYTES
 
-#define PQCLEAN_MLKEM768_CLEAN_CRYPTO_ALGNAME "ML-KEM-768"
+#define CRYPTO_ALGNAME KYBER_ALGNAME
 
-int PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair_derand(uint8_t *pk, uint8_t *sk, const uint8_t *coins);
+int KYBER_NAMESPACE(crypto_kem_keypair_derand)(uint8_t *pk, uint8_t *sk, const uint8_t *coins);
 
-int PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair(uint8_t *pk, uint8_t *sk);
+int KYBER_NAMESPACE(crypto_kem_keypair)(uint8_t *pk, uint8_t *sk);
 
-int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_derand(uint8_t *ct, uint8_t *ss, const uint8_t *pk, const uint8_t *coins);
+int KYBER_NAMESPACE(crypto_kem_enc_derand)(uint8_t *ct, uint8_t *ss, const uint8_t *pk, const uint8_t *coins);
 
-int PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc(uint8_t *ct, uint8_t *ss, const uint8_t *pk);
+int KYBER_NAMESPACE(crypto_kem_enc)(uint8_t *ct, uint8_t *ss, const uint8_t *pk);
 
-int PQCLEAN_MLKEM768_CLEAN_crypto_kem_dec(uint8_t *ss, const uint8_t *ct, const uint8_t *sk);
+int KYBER_NAMESPACE(crypto_kem_expand_pk)(uint8_t *epk, const uint8_t *pk);
+
+int KYBER_NAMESPACE(crypto_kem_enc_expanded_derand)(uint8_t *ct, uint8_t *ss, const uint8_t *epk, const uint8_t *coins);
+
+int KYBER_NAMESPACE(crypto_kem_enc_expanded)(uint8_t *ct, uint8_t *ss, const uint8_t *epk);
+
+int KYBER_NAMESPACE(crypto_kem_dec)(uint8_t *ss, const uint8_t *ct, const uint8_t *sk);
+
+int KYBER_NAMESPACE(crypto_kem_expand_sk)(uint8_t *esk, const uint8_t *sk);
+
+int KYBER_NAMESPACE(crypto_kem_dec_expanded)(uint8_t *ss, const uint8_t *ct, const uint8_t *esk);
+
+void KYBER_NAMESPACE(crypto_kem_enc_stream_init)(mlkem_enc_stream *st);
+
+int KYBER_NAMESPACE(crypto_kem_enc_stream_absorb)(mlkem_enc_stream *st, const uint8_t *pk, size_t pklen);
+
+int KYBER_NAMESPACE(crypto_kem_enc_stream_start_derand)(mlkem_enc_stream *st, uint8_t *ss, const uint8_t *coins);
+
+int KYBER_NAMESPACE(crypto_kem_enc_stream_start)(mlkem_enc_stream *st, uint8_t *ss);
+
+size_t KYBER_NAMESPACE(crypto_kem_enc_stream_emit)(mlkem_enc_stream *st, uint8_t *ct);
 
 #endif
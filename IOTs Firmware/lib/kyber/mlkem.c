@@ -0,0 +1,214 @@
+#include "api.h"
+#include "mlkem.h"
+#include <stddef.h>
+
+static const mlkem_params param_sets[] = {
+    {
+        512, PQCLEAN_MLKEM512_CLEAN_CRYPTO_ALGNAME,
+        PQCLEAN_MLKEM512_CLEAN_CRYPTO_SECRETKEYBYTES,
+        PQCLEAN_MLKEM512_CLEAN_CRYPTO_PUBLICKEYBYTES,
+        PQCLEAN_MLKEM512_CLEAN_CRYPTO_CIPHERTEXTBYTES,
+        PQCLEAN_MLKEM512_CLEAN_CRYPTO_EXPANDEDPKBYTES,
+        PQCLEAN_MLKEM512_CLEAN_CRYPTO_EXPANDEDSKBYTES,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_keypair_derand,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_keypair,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_derand,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_dec,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_expand_pk,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_expanded_derand,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_expanded,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_expand_sk,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_dec_expanded,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_stream_init,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_stream_absorb,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_stream_start_derand,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_stream_start,
+        PQCLEAN_MLKEM512_CLEAN_crypto_kem_enc_stream_emit
+    },
+    {
+        768, PQCLEAN_MLKEM768_CLEAN_CRYPTO_ALGNAME,
+        PQCLEAN_MLKEM768_CLEAN_CRYPTO_SECRETKEYBYTES,
+        PQCLEAN_MLKEM768_CLEAN_CRYPTO_PUBLICKEYBYTES,
+        PQCLEAN_MLKEM768_CLEAN_CRYPTO_CIPHERTEXTBYTES,
+        PQCLEAN_MLKEM768_CLEAN_CRYPTO_EXPANDEDPKBYTES,
+        PQCLEAN_MLKEM768_CLEAN_CRYPTO_EXPANDEDSKBYTES,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair_derand,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_keypair,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_derand,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_dec,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_expand_pk,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_expanded_derand,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_expanded,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_expand_sk,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_dec_expanded,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_stream_init,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_stream_absorb,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_stream_start_derand,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_stream_start,
+        PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc_stream_emit
+    },
+    {
+        1024, PQCLEAN_MLKEM1024_CLEAN_CRYPTO_ALGNAME,
+        PQCLEAN_MLKEM1024_CLEAN_CRYPTO_SECRETKEYBYTES,
+        PQCLEAN_MLKEM1024_CLEAN_CRYPTO_PUBLICKEYBYTES,
+        PQCLEAN_MLKEM1024_CLEAN_CRYPTO_CIPHERTEXTBYTES,
+        PQCLEAN_MLKEM1024_CLEAN_CRYPTO_EXPANDEDPKBYTES,
+        PQCLEAN_MLKEM1024_CLEAN_CRYPTO_EXPANDEDSKBYTES,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_keypair_derand,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_keypair,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_derand,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_dec,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_expand_pk,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_expanded_derand,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_expanded,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_expand_sk,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_dec_expanded,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_stream_init,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_stream_absorb,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_stream_start_derand,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_stream_start,
+        PQCLEAN_MLKEM1024_CLEAN_crypto_kem_enc_stream_emit
+    }
+};
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM_CLEAN_params
+*
+* Description: Look up a parameter set by its id
+*
+* Arguments:   - unsigned int id: 512, 768 or 1024
+*
+* Returns pointer to the parameter set, or NULL if id is not supported
+**************************************************/
+const mlkem_params *PQCLEAN_MLKEM_CLEAN_params(unsigned int id) {
+    size_t i;
+    for (i = 0; i < sizeof(param_sets) / sizeof(param_sets[0]); i++) {
+        if (param_sets[i].id == id) {
+            return &param_sets[i];
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    const mlkem_params *params;
+    uint8_t *out;
+    uint8_t *out2;
+    const uint8_t *in;
+    const uint8_t *key;
+    size_t keystride;
+} batch_job;
+
+static void keypair_job(void *arg, unsigned int i) {
+    const batch_job *b = arg;
+    b->params->keypair(b->out + i * b->params->publickeybytes,
+                       b->out2 + i * b->params->secretkeybytes);
+}
+
+static void enc_job(void *arg, unsigned int i) {
+    const batch_job *b = arg;
+    b->params->enc(b->out + i * b->params->ciphertextbytes,
+                   b->out2 + i * PQCLEAN_MLKEM_CLEAN_BYTES,
+                   b->key + i * b->keystride);
+}
+
+static void dec_job(void *arg, unsigned int i) {
+    const batch_job *b = arg;
+    b->params->dec(b->out + i * PQCLEAN_MLKEM_CLEAN_BYTES,
+                   b->in + i * b->params->ciphertextbytes,
+                   b->key + i * b->keystride);
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM_CLEAN_keypair_batch
+*
+* Description: Generates n key pairs, spread over the installed executor
+*
+* Arguments:   - const mlkem_params *params: parameter set
+*              - uint8_t *pk: pointer to output public keys
+*                (n * params->publickeybytes bytes)
+*              - uint8_t *sk: pointer to output private keys
+*                (n * params->secretkeybytes bytes)
+*              - unsigned int n: number of key pairs
+*
+* Returns 0 (success)
+**************************************************/
+int PQCLEAN_MLKEM_CLEAN_keypair_batch(const mlkem_params *params, uint8_t *pk, uint8_t *sk, unsigned int n) {
+    batch_job b = {NULL, NULL, NULL, NULL, NULL, 0};
+
+    b.params = params;
+    b.out = pk;
+    b.out2 = sk;
+    PQCLEAN_MLKEM_CLEAN_parallel_for(keypair_job, &b, n);
+    return 0;
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM_CLEAN_enc_batch
+*
+* Description: Generates n cipher texts and shared secrets, spread over
+*              the installed executor
+*
+* Arguments:   - const mlkem_params *params: parameter set
+*              - uint8_t *ct: pointer to output cipher texts
+*                (n * params->ciphertextbytes bytes)
+*              - uint8_t *ss: pointer to output shared secrets
+*                (n * PQCLEAN_MLKEM_CLEAN_BYTES bytes)
+*              - const uint8_t *pk: pointer to input public key of item 0
+*              - size_t pkstride: distance between the public keys of
+*                consecutive items, params->publickeybytes for one key per
+*                item or 0 for the same key
+*              - unsigned int n: number of encapsulations
+*
+* Returns 0 (success)
+**************************************************/
+int PQCLEAN_MLKEM_CLEAN_enc_batch(const mlkem_params *params, uint8_t *ct, uint8_t *ss,
+                                  const uint8_t *pk, size_t pkstride, unsigned int n) {
+    batch_job b = {NULL, NULL, NULL, NULL, NULL, 0};
+
+    b.params = params;
+    b.out = ct;
+    b.out2 = ss;
+    b.key = pk;
+    b.keystride = pkstride;
+    PQCLEAN_MLKEM_CLEAN_parallel_for(enc_job, &b, n);
+    return 0;
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM_CLEAN_dec_batch
+*
+* Description: Decapsulates n cipher texts, spread over the installed
+*              executor
+*
+* Arguments:   - const mlkem_params *params: parameter set
+*              - uint8_t *ss: pointer to output shared secrets
+*                (n * PQCLEAN_MLKEM_CLEAN_BYTES bytes)
+*              - const uint8_t *ct: pointer to input cipher texts
+*                (n * params->ciphertextbytes bytes)
+*              - const uint8_t *sk: pointer to input private key of item 0
+*              - size_t skstride: distance between the private keys of
+*                consecutive items, params->secretkeybytes for one key per
+*                item or 0 for the same key
+*              - unsigned int n: number of decapsulations
+*
+* Returns 0.
+*
+* On failure, the shared secret of that item will contain a pseudo-random
+* value.
+**************************************************/
+int PQCLEAN_MLKEM_CLEAN_dec_batch(const mlkem_params *params, uint8_t *ss, const uint8_t *ct,
+                                  const uint8_t *sk, size_t skstride, unsigned int n) {
+    batch_job b = {NULL, NULL, NULL, NULL, NULL, 0};
+
+    b.params = params;
+    b.out = ss;
+    b.in = ct;
+    b.key = sk;
+    b.keystride = skstride;
+    PQCLEAN_MLKEM_CLEAN_parallel_for(dec_job, &b, n);
+    return 0;
+}
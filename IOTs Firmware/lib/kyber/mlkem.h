@@ -0,0 +1,58 @@
+#ifndef PQCLEAN_MLKEM_CLEAN_MLKEM_H
+#define PQCLEAN_MLKEM_CLEAN_MLKEM_H
+#include "encstream.h"
+#include "parallel.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Run-time selection between ML-KEM-512, ML-KEM-768 and ML-KEM-1024, which
+ * are all linked into the same library. A parameter set is identified by
+ * its number (512, 768 or 1024), the same id that goes over the wire.
+ */
+#define PQCLEAN_MLKEM_CLEAN_MAX_SECRETKEYBYTES  3168
+#define PQCLEAN_MLKEM_CLEAN_MAX_PUBLICKEYBYTES  1568
+#define PQCLEAN_MLKEM_CLEAN_MAX_CIPHERTEXTBYTES 1568
+#define PQCLEAN_MLKEM_CLEAN_MAX_EXPANDEDPKBYTES 7712
+#define PQCLEAN_MLKEM_CLEAN_MAX_EXPANDEDSKBYTES 9280
+#define PQCLEAN_MLKEM_CLEAN_BYTES               32
+
+typedef struct {
+    unsigned int id;
+    const char *algname;
+    size_t secretkeybytes;
+    size_t publickeybytes;
+    size_t ciphertextbytes;
+    size_t expandedpkbytes;
+    size_t expandedskbytes;
+    int (*keypair_derand)(uint8_t *pk, uint8_t *sk, const uint8_t *coins);
+    int (*keypair)(uint8_t *pk, uint8_t *sk);
+    int (*enc_derand)(uint8_t *ct, uint8_t *ss, const uint8_t *pk, const uint8_t *coins);
+    int (*enc)(uint8_t *ct, uint8_t *ss, const uint8_t *pk);
+    int (*dec)(uint8_t *ss, const uint8_t *ct, const uint8_t *sk);
+    int (*expand_pk)(uint8_t *epk, const uint8_t *pk);
+    int (*enc_expanded_derand)(uint8_t *ct, uint8_t *ss, const uint8_t *epk, const uint8_t *coins);
+    int (*enc_expanded)(uint8_t *ct, uint8_t *ss, const uint8_t *epk);
+    int (*expand_sk)(uint8_t *esk, const uint8_t *sk);
+    int (*dec_expanded)(uint8_t *ss, const uint8_t *ct, const uint8_t *esk);
+    void (*enc_stream_init)(mlkem_enc_stream *st);
+    int (*enc_stream_absorb)(mlkem_enc_stream *st, const uint8_t *pk, size_t pklen);
+    int (*enc_stream_start_derand)(mlkem_enc_stream *st, uint8_t *ss, const uint8_t *coins);
+    int (*enc_stream_start)(mlkem_enc_stream *st, uint8_t *ss);
+    size_t (*enc_stream_emit)(mlkem_enc_stream *st, uint8_t *ct);
+} mlkem_params;
+
+const mlkem_params *PQCLEAN_MLKEM_CLEAN_params(unsigned int id);
+
+/*
+ * n operations of one parameter set spread over the installed executor,
+ * one operation per job. Arrays hold n items back to back; a key stride of
+ * 0 uses the same key for every item.
+ */
+int PQCLEAN_MLKEM_CLEAN_keypair_batch(const mlkem_params *params, uint8_t *pk, uint8_t *sk, unsigned int n);
+int PQCLEAN_MLKEM_CLEAN_enc_batch(const mlkem_params *params, uint8_t *ct, uint8_t *ss,
+                                  const uint8_t *pk, size_t pkstride, unsigned int n);
+int PQCLEAN_MLKEM_CLEAN_dec_batch(const mlkem_params *params, uint8_t *ss, const uint8_t *ct,
+                                  const uint8_t *sk, size_t skstride, unsigned int n);
+
+#endif
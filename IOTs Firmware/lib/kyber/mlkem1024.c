@@ -0,0 +1,10 @@
+/*
+ * ML-KEM-1024 instance of the parameter-set specific part of the library.
+ * The shared code (poly.c, ntt.c, cbd.c, ...) is compiled only once.
+ */
+#define KYBER_K 4
+
+#include "poly_k.c"
+#include "polyvec.c"
+#include "indcpa.c"
+#include "kem.c"
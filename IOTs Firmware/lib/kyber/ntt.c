@@ -1,7 +1,9 @@
 #include "ntt.h"
 #include "params.h"
+#include "poly_avx2.h"
 #include "reduce.h"
 #include <stdint.h>
+#include <string.h>
 
 /* Code to generate PQCLEAN_MLKEM768_CLEAN_zetas and zetas_inv used in the number-theoretic transform:
 
@@ -55,29 +57,348 @@ const int16_t PQCLEAN_MLKEM768_CLEAN_zetas[128] = {
     -108,  -308,   996,   991,   958, -1460,  1522,  1628
 };
 
+/* fqmul and the packed helpers below sit in the innermost loops of the
+ * transforms; forcing them inline avoids a call per coefficient on targets
+ * built with -Os (ESP-IDF, Arduino). */
+#if defined(__GNUC__) || defined(__clang__)
+#define NTT_INLINE static inline __attribute__((always_inline))
+#else
+#define NTT_INLINE static inline
+#endif
+
 /*************************************************
 * Name:        fqmul
 *
-* Description: Multiplication followed by Montgomery reduction
+* Description: Multiplication followed by Montgomery reduction;
+*              same arithmetic as PQCLEAN_MLKEM768_CLEAN_montgomery_reduce,
+*              kept local so that it is inlined
 *
 * Arguments:   - int16_t a: first factor
 *              - int16_t b: second factor
 *
 * Returns 16-bit integer congruent to a*b*R^{-1} mod q
 **************************************************/
-static int16_t fqmul(int16_t a, int16_t b) {
-    return PQCLEAN_MLKEM768_CLEAN_montgomery_reduce((int32_t)a * b);
+NTT_INLINE int16_t fqmul(int16_t a, int16_t b) {
+    int32_t p = (int32_t)a * b;
+    int16_t t;
+
+    t = (int16_t)p * QINV;
+    t = (p - (int32_t)t * KYBER_Q) >> 16;
+    return t;
 }
 
+#if !defined(KYBER_NTT_PER_LAYER)
+/* Merged-layer transforms. Two neighbouring coefficients always share a
+ * twiddle factor (the smallest butterfly distance is 2), so they are moved
+ * as one 32-bit word: additions and subtractions run on both 16-bit halves
+ * at once and only the Montgomery multiplications are done per half. The
+ * seven layers are grouped 3 + 3 + 1 so that the eight words a group
+ * touches stay in registers on a 32-bit core with 16 general registers.
+ *
+ * All packed operations act on both halves identically, so the code does
+ * not depend on byte order. */
+
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_ntt
+* Name:        load32
 *
-* Description: Inplace number-theoretic transform (NTT) in Rq.
-*              input is in standard order, output is in bitreversed order
+* Description: Load two adjacent coefficients as one 32-bit word
+**************************************************/
+NTT_INLINE uint32_t load32(const int16_t *x) {
+    uint32_t w;
+    memcpy(&w, x, sizeof(w));
+    return w;
+}
+
+/*************************************************
+* Name:        store32
+*
+* Description: Store one 32-bit word as two adjacent coefficients
+**************************************************/
+NTT_INLINE void store32(int16_t *x, uint32_t w) {
+    memcpy(x, &w, sizeof(w));
+}
+
+/*************************************************
+* Name:        add2
+*
+* Description: Lane-wise a + b on two 16-bit lanes, wrapping like int16_t
+**************************************************/
+NTT_INLINE uint32_t add2(uint32_t a, uint32_t b) {
+    return ((a & 0x7FFF7FFF) + (b & 0x7FFF7FFF)) ^ ((a ^ b) & 0x80008000);
+}
+
+/*************************************************
+* Name:        sub2
+*
+* Description: Lane-wise a - b on two 16-bit lanes, wrapping like int16_t
+**************************************************/
+NTT_INLINE uint32_t sub2(uint32_t a, uint32_t b) {
+    return ((a | 0x80008000) - (b & 0x7FFF7FFF)) ^ ((a ^ ~b) & 0x80008000);
+}
+
+/*************************************************
+* Name:        fqmul2
+*
+* Description: fqmul of both 16-bit lanes of w by zeta
+**************************************************/
+NTT_INLINE uint32_t fqmul2(uint32_t w, int16_t zeta) {
+    uint16_t lo = (uint16_t)fqmul((int16_t)(w & 0xFFFF), zeta);
+    uint16_t hi = (uint16_t)fqmul((int16_t)(w >> 16), zeta);
+    return lo | ((uint32_t)hi << 16);
+}
+
+/*************************************************
+* Name:        barrett2
+*
+* Description: Barrett reduction of both 16-bit lanes of w; same arithmetic
+*              as PQCLEAN_MLKEM768_CLEAN_barrett_reduce
+**************************************************/
+NTT_INLINE uint32_t barrett2(uint32_t w) {
+    const int32_t v = ((1 << 26) + KYBER_Q / 2) / KYBER_Q;
+    int16_t lo = (int16_t)(w & 0xFFFF);
+    int16_t hi = (int16_t)(w >> 16);
+
+    lo -= (int16_t)(((v * lo + (1 << 25)) >> 26) * KYBER_Q);
+    hi -= (int16_t)(((v * hi + (1 << 25)) >> 26) * KYBER_Q);
+    return (uint16_t)lo | ((uint32_t)(uint16_t)hi << 16);
+}
+
+/* Cooley-Tukey butterfly (forward) and Gentleman-Sande butterfly without
+ * reduction of the sum (inverse) on packed words */
+#define CT2(a, b, zeta) do {        \
+        uint32_t t_ = fqmul2((b), (zeta)); \
+        (b) = sub2((a), t_);        \
+        (a) = add2((a), t_);        \
+    } while (0)
+
+#define GS2(a, b, zeta) do {        \
+        uint32_t t_ = (a);          \
+        (a) = add2(t_, (b));        \
+        (b) = fqmul2(sub2((b), t_), (zeta)); \
+    } while (0)
+
+/*************************************************
+* Name:        ntt_top
+*
+* Description: First three layers of the forward transform (len = 128, 64
+*              and 32) on eight words that are 32 coefficients apart
+*
+* Arguments:   - uint32_t x[8]: words of coefficients j + 32*i, j + 1 + 32*i
+**************************************************/
+NTT_INLINE void ntt_top(uint32_t x[8]) {
+    const int16_t *z = PQCLEAN_MLKEM768_CLEAN_zetas;
+
+    CT2(x[0], x[4], z[1]);
+    CT2(x[1], x[5], z[1]);
+    CT2(x[2], x[6], z[1]);
+    CT2(x[3], x[7], z[1]);
+    CT2(x[0], x[2], z[2]);
+    CT2(x[1], x[3], z[2]);
+    CT2(x[4], x[6], z[3]);
+    CT2(x[5], x[7], z[3]);
+    CT2(x[0], x[1], z[4]);
+    CT2(x[2], x[3], z[5]);
+    CT2(x[4], x[5], z[6]);
+    CT2(x[6], x[7], z[7]);
+}
+
+/*************************************************
+* Name:        ntt_bottom
+*
+* Description: Remaining four layers of the forward transform
+*              (len = 16, 8, 4 and 2)
 *
 * Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_ntt(int16_t r[256]) {
+static void ntt_bottom(int16_t r[256]) {
+    unsigned int i, j;
+    uint32_t x[8];
+    const int16_t *z = PQCLEAN_MLKEM768_CLEAN_zetas;
+
+    /* len = 16, 8, 4: per 32-coefficient block, eight words 4 apart */
+    for (j = 0; j < 16; j++) {
+        const unsigned int b = j / 2;
+        int16_t *p = &r[32 * b + 2 * (j & 1)];
+        for (i = 0; i < 8; i++) {
+            x[i] = load32(&p[4 * i]);
+        }
+        CT2(x[0], x[4], z[8 + b]);
+        CT2(x[1], x[5], z[8 + b]);
+        CT2(x[2], x[6], z[8 + b]);
+        CT2(x[3], x[7], z[8 + b]);
+        CT2(x[0], x[2], z[16 + 2 * b]);
+        CT2(x[1], x[3], z[16 + 2 * b]);
+        CT2(x[4], x[6], z[17 + 2 * b]);
+        CT2(x[5], x[7], z[17 + 2 * b]);
+        CT2(x[0], x[1], z[32 + 4 * b]);
+        CT2(x[2], x[3], z[33 + 4 * b]);
+        CT2(x[4], x[5], z[34 + 4 * b]);
+        CT2(x[6], x[7], z[35 + 4 * b]);
+        for (i = 0; i < 8; i++) {
+            store32(&p[4 * i], x[i]);
+        }
+    }
+
+    /* len = 2 */
+    for (j = 0; j < 64; j++) {
+        x[0] = load32(&r[4 * j]);
+        x[1] = load32(&r[4 * j + 2]);
+        CT2(x[0], x[1], z[64 + j]);
+        store32(&r[4 * j], x[0]);
+        store32(&r[4 * j + 2], x[1]);
+    }
+}
+
+/*************************************************
+* Name:        ntt_merged
+*
+* Description: Merged-layer version of the forward transform. Performs
+*              exactly the same operations as the layer-by-layer loop, so
+*              the output is identical.
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+static void ntt_merged(int16_t r[256]) {
+    unsigned int i, j;
+    uint32_t x[8];
+
+    for (j = 0; j < 32; j += 2) {
+        for (i = 0; i < 8; i++) {
+            x[i] = load32(&r[j + 32 * i]);
+        }
+        ntt_top(x);
+        for (i = 0; i < 8; i++) {
+            store32(&r[j + 32 * i], x[i]);
+        }
+    }
+    ntt_bottom(r);
+}
+
+/*************************************************
+* Name:        invntt_bottom
+*
+* Description: First four layers of the inverse transform (len = 2, 4, 8
+*              and 16). Sums are Barrett-reduced after the len = 4 layer.
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+static void invntt_bottom(int16_t r[256]) {
+    unsigned int i, j;
+    uint32_t x[8];
+    const int16_t *z = PQCLEAN_MLKEM768_CLEAN_zetas;
+
+    /* len = 2 */
+    for (j = 0; j < 64; j++) {
+        x[0] = load32(&r[4 * j]);
+        x[1] = load32(&r[4 * j + 2]);
+        GS2(x[0], x[1], z[127 - j]);
+        store32(&r[4 * j], x[0]);
+        store32(&r[4 * j + 2], x[1]);
+    }
+
+    /* len = 4, 8, 16: per 32-coefficient block, eight words 4 apart */
+    for (j = 0; j < 16; j++) {
+        const unsigned int b = j / 2;
+        int16_t *p = &r[32 * b + 2 * (j & 1)];
+        for (i = 0; i < 8; i++) {
+            x[i] = load32(&p[4 * i]);
+        }
+        GS2(x[0], x[1], z[63 - 4 * b]);
+        GS2(x[2], x[3], z[62 - 4 * b]);
+        GS2(x[4], x[5], z[61 - 4 * b]);
+        GS2(x[6], x[7], z[60 - 4 * b]);
+        x[0] = barrett2(x[0]);
+        x[2] = barrett2(x[2]);
+        x[4] = barrett2(x[4]);
+        x[6] = barrett2(x[6]);
+        GS2(x[0], x[2], z[31 - 2 * b]);
+        GS2(x[1], x[3], z[31 - 2 * b]);
+        GS2(x[4], x[6], z[30 - 2 * b]);
+        GS2(x[5], x[7], z[30 - 2 * b]);
+        GS2(x[0], x[4], z[15 - b]);
+        GS2(x[1], x[5], z[15 - b]);
+        GS2(x[2], x[6], z[15 - b]);
+        GS2(x[3], x[7], z[15 - b]);
+        for (i = 0; i < 8; i++) {
+            store32(&p[4 * i], x[i]);
+        }
+    }
+}
+
+/*************************************************
+* Name:        invntt_top
+*
+* Description: Last three layers of the inverse transform (len = 32, 64
+*              and 128) and the multiplication by mont^2/128 on eight words
+*              that are 32 coefficients apart. Sums are Barrett-reduced
+*              after the len = 32 layer.
+*
+* Arguments:   - uint32_t x[8]: words of coefficients j + 32*i, j + 1 + 32*i
+**************************************************/
+NTT_INLINE void invntt_top(uint32_t x[8]) {
+    unsigned int i;
+    const int16_t *z = PQCLEAN_MLKEM768_CLEAN_zetas;
+    const int16_t f = 1441; // mont^2/128
+
+    GS2(x[0], x[1], z[7]);
+    GS2(x[2], x[3], z[6]);
+    GS2(x[4], x[5], z[5]);
+    GS2(x[6], x[7], z[4]);
+    x[0] = barrett2(x[0]);
+    x[2] = barrett2(x[2]);
+    x[4] = barrett2(x[4]);
+    x[6] = barrett2(x[6]);
+    GS2(x[0], x[2], z[3]);
+    GS2(x[1], x[3], z[3]);
+    GS2(x[4], x[6], z[2]);
+    GS2(x[5], x[7], z[2]);
+    GS2(x[0], x[4], z[1]);
+    GS2(x[1], x[5], z[1]);
+    GS2(x[2], x[6], z[1]);
+    GS2(x[3], x[7], z[1]);
+    for (i = 0; i < 8; i++) {
+        x[i] = fqmul2(x[i], f);
+    }
+}
+
+/*************************************************
+* Name:        invntt_merged
+*
+* Description: Merged-layer version of the inverse transform, including the
+*              multiplication by mont^2/128, which is folded into the last
+*              group. Sums are Barrett-reduced only after the len = 4 and
+*              len = 32 layers instead of after every layer. fqmul outputs
+*              stay below 0.75q, so for inputs below 2^13 in absolute value
+*              every intermediate still fits in an int16_t. The result is congruent
+*              to the layer-by-layer output and, like it, bounded by q in
+*              absolute value, but not necessarily the same representative.
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+static void invntt_merged(int16_t r[256]) {
+    unsigned int i, j;
+    uint32_t x[8];
+
+    invntt_bottom(r);
+    for (j = 0; j < 32; j += 2) {
+        for (i = 0; i < 8; i++) {
+            x[i] = load32(&r[j + 32 * i]);
+        }
+        invntt_top(x);
+        for (i = 0; i < 8; i++) {
+            store32(&r[j + 32 * i], x[i]);
+        }
+    }
+}
+#else
+/*************************************************
+* Name:        ntt_layers
+*
+* Description: Layer-by-layer forward transform
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+static void ntt_layers(int16_t r[256]) {
     unsigned int len, start, j, k;
     int16_t t, zeta;
 
@@ -95,15 +416,13 @@ void PQCLEAN_MLKEM768_CLEAN_ntt(int16_t r[256]) {
 }
 
 /*************************************************
-* Name:        invntt_tomont
+* Name:        invntt_layers
 *
-* Description: Inplace inverse number-theoretic transform in Rq and
-*              multiplication by Montgomery factor 2^16.
-*              Input is in bitreversed order, output is in standard order
+* Description: Layer-by-layer inverse transform, reducing every sum
 *
 * Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_invntt(int16_t r[256]) {
+static void invntt_layers(int16_t r[256]) {
     unsigned int start, len, j, k;
     int16_t t, zeta;
     const int16_t f = 1441; // mont^2/128
@@ -125,6 +444,166 @@ void PQCLEAN_MLKEM768_CLEAN_invntt(int16_t r[256]) {
         r[j] = fqmul(r[j], f);
     }
 }
+#endif
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_ntt
+*
+* Description: Inplace number-theoretic transform (NTT) in Rq.
+*              input is in standard order, output is in bitreversed order
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_ntt(int16_t r[256]) {
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        PQCLEAN_MLKEM768_CLEAN_ntt_avx2(r);
+        return;
+    }
+#endif
+
+#if !defined(KYBER_NTT_PER_LAYER)
+    ntt_merged(r);
+#else
+    ntt_layers(r);
+#endif
+}
+
+/*************************************************
+* Name:        invntt_tomont
+*
+* Description: Inplace inverse number-theoretic transform in Rq and
+*              multiplication by Montgomery factor 2^16.
+*              Input is in bitreversed order, output is in standard order.
+*              Input coefficients must be below 2^13 in absolute value.
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_invntt(int16_t r[256]) {
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        PQCLEAN_MLKEM768_CLEAN_invntt_avx2(r);
+        return;
+    }
+#endif
+
+#if !defined(KYBER_NTT_PER_LAYER)
+    invntt_merged(r);
+#else
+    invntt_layers(r);
+#endif
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_ntt_head
+*
+* Description: First part of a forward transform whose input is supplied
+*              in column blocks, so that it can be produced on the fly
+*              (e.g. by decompression) instead of in a separate pass.
+*              Must be called for j = 0, 8, 16, 24 and followed by
+*              PQCLEAN_MLKEM768_CLEAN_ntt_tail; the result is identical to
+*              PQCLEAN_MLKEM768_CLEAN_ntt on the assembled input.
+*              Portable code only, not dispatched to AVX2.
+*
+* Arguments:   - int16_t r[256]: pointer to output vector
+*              - const int16_t a[8][8]: input coefficients, a[i][c] being
+*                coefficient 32*i + j + c
+*              - unsigned int j: first column of the block
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_ntt_head(int16_t r[256], const int16_t a[8][8], unsigned int j) {
+    unsigned int i, c;
+#if !defined(KYBER_NTT_PER_LAYER)
+    uint32_t x[8];
+
+    for (c = 0; c < 8; c += 2) {
+        for (i = 0; i < 8; i++) {
+            x[i] = load32(&a[i][c]);
+        }
+        ntt_top(x);
+        for (i = 0; i < 8; i++) {
+            store32(&r[j + c + 32 * i], x[i]);
+        }
+    }
+#else
+    for (i = 0; i < 8; i++) {
+        for (c = 0; c < 8; c++) {
+            r[32 * i + j + c] = a[i][c];
+        }
+    }
+#endif
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_ntt_tail
+*
+* Description: Second part of the forward transform started by
+*              PQCLEAN_MLKEM768_CLEAN_ntt_head
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_ntt_tail(int16_t r[256]) {
+#if !defined(KYBER_NTT_PER_LAYER)
+    ntt_bottom(r);
+#else
+    ntt_layers(r);
+#endif
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_invntt_head
+*
+* Description: First part of an inverse transform whose output is taken in
+*              column blocks by PQCLEAN_MLKEM768_CLEAN_invntt_tail, so that
+*              it can be consumed on the fly (e.g. by compression) instead
+*              of in a separate pass. Same input bound as
+*              PQCLEAN_MLKEM768_CLEAN_invntt. Portable code only, not
+*              dispatched to AVX2.
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_invntt_head(int16_t r[256]) {
+#if !defined(KYBER_NTT_PER_LAYER)
+    invntt_bottom(r);
+#else
+    invntt_layers(r);
+#endif
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_invntt_tail
+*
+* Description: Finishes the inverse transform started by
+*              PQCLEAN_MLKEM768_CLEAN_invntt_head for one column block.
+*              Over j = 0, 8, 16, 24 the blocks hold the same coefficients
+*              as the output of PQCLEAN_MLKEM768_CLEAN_invntt.
+*
+* Arguments:   - int16_t a[8][8]: output coefficients, a[i][c] being
+*                coefficient 32*i + j + c
+*              - const int16_t r[256]: pointer to vector after the head
+*              - unsigned int j: first column of the block
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_invntt_tail(int16_t a[8][8], const int16_t r[256], unsigned int j) {
+    unsigned int i, c;
+#if !defined(KYBER_NTT_PER_LAYER)
+    uint32_t x[8];
+
+    for (c = 0; c < 8; c += 2) {
+        for (i = 0; i < 8; i++) {
+            x[i] = load32(&r[j + c + 32 * i]);
+        }
+        invntt_top(x);
+        for (i = 0; i < 8; i++) {
+            store32(&a[i][c], x[i]);
+        }
+    }
+#else
+    for (i = 0; i < 8; i++) {
+        for (c = 0; c < 8; c++) {
+            a[i][c] = r[32 * i + j + c];
+        }
+    }
+#endif
+}
 
 /*************************************************
 * Name:        PQCLEAN_MLKEM768_CLEAN_basemul
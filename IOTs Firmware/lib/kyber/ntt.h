@@ -9,6 +9,11 @@ void PQCLEAN_MLKEM768_CLEAN_ntt(int16_t r[256]);
 
 void PQCLEAN_MLKEM768_CLEAN_invntt(int16_t r[256]);
 
+void PQCLEAN_MLKEM768_CLEAN_ntt_head(int16_t r[256], const int16_t a[8][8], unsigned int j);
+void PQCLEAN_MLKEM768_CLEAN_ntt_tail(int16_t r[256]);
+void PQCLEAN_MLKEM768_CLEAN_invntt_head(int16_t r[256]);
+void PQCLEAN_MLKEM768_CLEAN_invntt_tail(int16_t a[8][8], const int16_t r[256], unsigned int j);
+
 void PQCLEAN_MLKEM768_CLEAN_basemul(int16_t r[2], const int16_t a[2], const int16_t b[2], int16_t zeta);
 
 #endif
@@ -0,0 +1,80 @@
+#include "parallel.h"
+#include <stddef.h>
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+static const mlkem_executor *executor = NULL;
+
+/* Set while this thread runs a job handed out by parallel_for. A KEM call
+ * inside a batch job then samples serially instead of calling back into
+ * the executor that is busy running the batch. */
+static THREAD_LOCAL int in_job = 0;
+
+typedef struct {
+    void (*job)(void *arg, unsigned int i);
+    void *arg;
+} job_call;
+
+static void run_job(void *arg, unsigned int i) {
+    const job_call *call = arg;
+    in_job = 1;
+    call->job(call->arg, i);
+    in_job = 0;
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM_CLEAN_set_executor
+*
+* Description: Install the executor used for parallel sampling
+*
+* Arguments:   - const mlkem_executor *exec: pointer to executor, or NULL
+*                                            to sample on the calling thread;
+*                                            must outlive its use
+**************************************************/
+void PQCLEAN_MLKEM_CLEAN_set_executor(const mlkem_executor *exec) {
+    executor = exec;
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM_CLEAN_parallel_threads
+*
+* Description: Number of threads sampling work is spread over
+*
+* Returns the nthreads of the installed executor, 1 without one or when
+* called from inside a job
+**************************************************/
+unsigned int PQCLEAN_MLKEM_CLEAN_parallel_threads(void) {
+    if (executor == NULL || executor->nthreads < 2 || in_job) {
+        return 1;
+    }
+    return executor->nthreads;
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM_CLEAN_parallel_for
+*
+* Description: Run job(arg, 0), ..., job(arg, njobs - 1) on the installed
+*              executor, or one after the other on the calling thread
+*
+* Arguments:   - job: function to run
+*              - void *arg: argument passed to every call
+*              - unsigned int njobs: number of calls
+**************************************************/
+void PQCLEAN_MLKEM_CLEAN_parallel_for(void (*job)(void *arg, unsigned int i), void *arg, unsigned int njobs) {
+    unsigned int i;
+    job_call call;
+
+    if (PQCLEAN_MLKEM_CLEAN_parallel_threads() < 2 || njobs < 2) {
+        for (i = 0; i < njobs; i++) {
+            job(arg, i);
+        }
+        return;
+    }
+    call.job = job;
+    call.arg = arg;
+    executor->run(executor->ctx, run_job, &call, njobs);
+}
@@ -0,0 +1,34 @@
+#ifndef PQCLEAN_MLKEM_CLEAN_PARALLEL_H
+#define PQCLEAN_MLKEM_CLEAN_PARALLEL_H
+
+/*
+ * Optional executor for the independent XOF and PRF expansions of key
+ * generation and encryption (matrix entries and noise polynomials), and
+ * for the operations of the batch calls in mlkem.h. Calls made from inside
+ * a job do not reach the executor again; they run on the job's thread.
+ * run must call job(arg, i) exactly once for every i < njobs, on any
+ * threads and in any order, and return only once all calls have
+ * returned. nthreads is the number of threads run spreads the jobs over,
+ * counting the calling one; the work is split into that many slices.
+ *
+ * The sampled values do not depend on the executor, so keys, ciphertexts
+ * and shared secrets are the same bytes with or without one.
+ */
+typedef struct {
+    unsigned int nthreads;
+    void (*run)(void *ctx, void (*job)(void *arg, unsigned int i), void *arg, unsigned int njobs);
+    void *ctx;
+} mlkem_executor;
+
+/* Install exec for all parameter sets, or go back to serial with NULL.
+ * Not synchronised with running KEM calls; set it up front. */
+void PQCLEAN_MLKEM_CLEAN_set_executor(const mlkem_executor *exec);
+
+unsigned int PQCLEAN_MLKEM_CLEAN_parallel_threads(void);
+void PQCLEAN_MLKEM_CLEAN_parallel_for(void (*job)(void *arg, unsigned int i), void *arg, unsigned int njobs);
+
+/* Two-core executor for ESP32 builds, see parallel_freertos.c; std::thread
+ * pool for host builds in parallel_std.hpp */
+const mlkem_executor *PQCLEAN_MLKEM_CLEAN_freertos_executor(void);
+
+#endif
@@ -0,0 +1,67 @@
+// ESP32 executor for the parallel sampling of parallel.h: the calling task
+// and one worker task pinned to the other core share the jobs.
+#include "parallel.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stddef.h>
+
+// Deepest job is a slice of gen_matrix (four-way XOF buffers and state)
+#define WORKER_STACK_BYTES 8192
+
+static TaskHandle_t worker_task = NULL;
+static TaskHandle_t caller_task = NULL;
+static void (*job_fn)(void *arg, unsigned int i);
+static void *job_arg;
+static unsigned int job_count;
+static unsigned int job_next;
+
+static void drain(void) {
+    unsigned int i;
+    while ((i = __atomic_fetch_add(&job_next, 1, __ATOMIC_RELAXED)) < job_count) {
+        job_fn(job_arg, i);
+    }
+}
+
+static void worker(void *unused) {
+    (void)unused;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        drain();
+        xTaskNotifyGive(caller_task);
+    }
+}
+
+// The task notifications order the job_* writes with the worker's reads
+// and its results with the caller's return.
+static void run(void *ctx, void (*job)(void *arg, unsigned int i), void *arg, unsigned int njobs) {
+    (void)ctx;
+    job_fn = job;
+    job_arg = arg;
+    job_count = njobs;
+    __atomic_store_n(&job_next, 0, __ATOMIC_RELAXED);
+    caller_task = xTaskGetCurrentTaskHandle();
+    xTaskNotifyGive(worker_task);
+    drain();
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+static const mlkem_executor freertos_executor = {2, run, NULL};
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM_CLEAN_freertos_executor
+*
+* Description: Start the worker task, on the core the caller is not
+*              running on and at its priority, and return the executor.
+*              KEM calls must then all come from the same task.
+*
+* Returns the executor, or NULL if the task could not be created
+**************************************************/
+const mlkem_executor *PQCLEAN_MLKEM_CLEAN_freertos_executor(void) {
+    if (worker_task == NULL &&
+            xTaskCreatePinnedToCore(worker, "mlkem", WORKER_STACK_BYTES, NULL, uxTaskPriorityGet(NULL),
+                                    &worker_task, 1 - xPortGetCoreID()) != pdPASS) {
+        worker_task = NULL;
+        return NULL;
+    }
+    return &freertos_executor;
+}
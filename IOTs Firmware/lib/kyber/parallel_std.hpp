@@ -0,0 +1,184 @@
+#ifndef PQCLEAN_MLKEM_CLEAN_PARALLEL_STD_HPP
+#define PQCLEAN_MLKEM_CLEAN_PARALLEL_STD_HPP
+
+/*
+ * mlkem_executor on std::thread for host builds. The worker threads are
+ * started once and wait for work between calls, since a KEM operation is
+ * far shorter than starting a thread. The calling thread takes jobs too,
+ * so a pool of n threads starts n - 1 workers.
+ *
+ *   MlkemThreadPool pool(std::thread::hardware_concurrency());
+ *   PQCLEAN_MLKEM_CLEAN_set_executor(pool.executor());
+ *
+ * Calls from several threads at once are run one after the other.
+ *
+ * Each thread starts on its own contiguous share of the jobs and takes
+ * them from the front; a thread that runs out steals the back half of the
+ * largest share left. Sampling slices are all the same size, but the
+ * operations of a batch are not (decapsulation failures, preemption), and
+ * stealing keeps the threads busy until the last job. Jobs only use their
+ * thread's stack, so there is no allocation on this path.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "parallel.h"
+}
+
+class MlkemThreadPool {
+public:
+    explicit MlkemThreadPool(unsigned int nthreads) {
+        if (nthreads < 1) nthreads = 1;
+        exec_.nthreads = nthreads;
+        exec_.run = &MlkemThreadPool::run;
+        exec_.ctx = this;
+        shares_.reset(new Share[nthreads]);
+        for (unsigned int i = 1; i < nthreads; i++) {
+            workers_.emplace_back(&MlkemThreadPool::worker, this, i);
+        }
+    }
+
+    ~MlkemThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &t : workers_) t.join();
+    }
+
+    MlkemThreadPool(const MlkemThreadPool &) = delete;
+    MlkemThreadPool &operator=(const MlkemThreadPool &) = delete;
+
+    const mlkem_executor *executor() const { return &exec_; }
+
+private:
+    static void run(void *ctx, void (*job)(void *, unsigned int), void *arg, unsigned int njobs) {
+        MlkemThreadPool *self = static_cast<MlkemThreadPool *>(ctx);
+        unsigned int n = self->exec_.nthreads;
+        std::lock_guard<std::mutex> serial(self->run_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            self->job_ = job;
+            self->arg_ = arg;
+            for (unsigned int w = 0; w < n; w++) {
+                uint64_t lo = static_cast<uint64_t>(njobs) * w / n;
+                uint64_t hi = static_cast<uint64_t>(njobs) * (w + 1) / n;
+                self->shares_[w].range.store(pack(lo, hi), std::memory_order_relaxed);
+            }
+            self->busy_ = static_cast<unsigned int>(self->workers_.size());
+            self->generation_++;
+        }
+        self->wake_.notify_all();
+        self->drain(0, job, arg);
+
+        std::unique_lock<std::mutex> lock(self->mutex_);
+        self->done_.wait(lock, [self] { return self->busy_ == 0; });
+    }
+
+    // A share is the job range [lo, hi) packed as hi << 32 | lo. The owner
+    // takes from lo, thieves from hi, both by compare-and-swap. Padded
+    // rather than alignas(64), which new[] only honours from C++17: the
+    // ranges of two shares are then never on the same cache line.
+    struct Share {
+        std::atomic<uint64_t> range{0};
+        char pad[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    static uint64_t pack(uint64_t lo, uint64_t hi) { return hi << 32 | lo; }
+    static unsigned int lo_of(uint64_t r) { return static_cast<unsigned int>(r); }
+    static unsigned int hi_of(uint64_t r) { return static_cast<unsigned int>(r >> 32); }
+
+    bool take(unsigned int self, unsigned int *i) {
+        std::atomic<uint64_t> &range = shares_[self].range;
+        uint64_t r = range.load(std::memory_order_relaxed);
+        while (lo_of(r) < hi_of(r)) {
+            if (range.compare_exchange_weak(r, pack(lo_of(r) + 1, hi_of(r)), std::memory_order_relaxed)) {
+                *i = lo_of(r);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool steal(unsigned int self) {
+        unsigned int n = exec_.nthreads;
+        for (;;) {
+            unsigned int victim = n, most = 0;
+            for (unsigned int w = 0; w < n; w++) {
+                uint64_t r = shares_[w].range.load(std::memory_order_relaxed);
+                if (w != self && hi_of(r) - lo_of(r) > most) {
+                    most = hi_of(r) - lo_of(r);
+                    victim = w;
+                }
+            }
+            if (victim == n) {
+                return false;
+            }
+            std::atomic<uint64_t> &range = shares_[victim].range;
+            uint64_t r = range.load(std::memory_order_relaxed);
+            unsigned int lo = lo_of(r), hi = hi_of(r);
+            if (lo >= hi) {
+                continue;
+            }
+            unsigned int mid = hi - (hi - lo + 1) / 2;
+            if (range.compare_exchange_strong(r, pack(lo, mid), std::memory_order_relaxed)) {
+                // Own share is empty, so no thief is competing for it
+                shares_[self].range.store(pack(mid, hi), std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    void drain(unsigned int self, void (*job)(void *, unsigned int), void *arg) {
+        unsigned int i;
+        do {
+            while (take(self, &i)) {
+                job(arg, i);
+            }
+        } while (steal(self));
+    }
+
+    void worker(unsigned int self) {
+        unsigned long seen = 0;
+        for (;;) {
+            void (*job)(void *, unsigned int);
+            void *arg;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+                job = job_;
+                arg = arg_;
+            }
+            drain(self, job, arg);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--busy_ == 0) done_.notify_one();
+            }
+        }
+    }
+
+    mlkem_executor exec_;
+    std::vector<std::thread> workers_;
+    std::mutex run_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::unique_ptr<Share[]> shares_;
+    void (*job_)(void *, unsigned int) = nullptr;
+    void *arg_ = nullptr;
+    unsigned int busy_ = 0;
+    unsigned long generation_ = 0;
+    bool stop_ = false;
+};
+
+#endif
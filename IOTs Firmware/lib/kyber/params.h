@@ -1,9 +1,36 @@
 #ifndef PQCLEAN_MLKEM768_CLEAN_PARAMS_H
 #define PQCLEAN_MLKEM768_CLEAN_PARAMS_H
 
+/*
+ * The parameter set is chosen by KYBER_K (2: ML-KEM-512, 3: ML-KEM-768,
+ * 4: ML-KEM-1024). Only polyvec.c, indcpa.c, kem.c and poly_k.c depend on
+ * it; they are compiled once per parameter set (mlkem512.c and mlkem1024.c
+ * instantiate the other two sets) and name their exported symbols with
+ * KYBER_NAMESPACE. Everything else is shared by all three sets.
+ */
+#ifndef KYBER_K
+#define KYBER_K 3
+#endif
 
-
-
+/*
+ * Stack budget in bytes, with KYBER_LOWSTACK. The streaming encapsulation
+ * (enc_stream_*, whose state the caller holds) stays within it for the
+ * whole call; test/stack.c fails if it does not. It peaks at 2568, 2552
+ * and 2552 bytes for ML-KEM-512, -768 and -1024 on x86-64 -O3. A caller
+ * that has to stay under a budget of about 3 KB should encapsulate that
+ * way.
+ *
+ * enc, enc_expanded and expand_pk are not held to it as a whole. Only
+ * their buffers are: the packed s, the accumulator and one entry of A^T,
+ * and the XOF state and block the entry is sampled from. indcpa.c does not
+ * compile for a set whose buffers exceed the budget; on a 64-bit host
+ * they take 2208, 2592 and 2976 bytes. The frames of the calls made from
+ * there come on top (Keccak, hashing the key, the transforms), and enc
+ * peaks at 3560, 3976 and 4344 bytes.
+ */
+#ifndef KYBER_LOWSTACK_BUDGET
+#define KYBER_LOWSTACK_BUDGET 3072
+#endif
 
 /* Don't change parameters below this line */
 
@@ -16,10 +43,27 @@
 #define KYBER_POLYBYTES     384
 #define KYBER_POLYVECBYTES  (KYBER_K * KYBER_POLYBYTES)
 
-#define KYBER_K 3
+#if KYBER_K == 2
+#define KYBER_NAMESPACE(s) PQCLEAN_MLKEM512_CLEAN_##s
+#define KYBER_ALGNAME "ML-KEM-512"
+#define KYBER_ETA1 3
+#define KYBER_POLYCOMPRESSEDBYTES    128
+#define KYBER_POLYVECCOMPRESSEDBYTES (KYBER_K * 320)
+#elif KYBER_K == 3
+#define KYBER_NAMESPACE(s) PQCLEAN_MLKEM768_CLEAN_##s
+#define KYBER_ALGNAME "ML-KEM-768"
 #define KYBER_ETA1 2
 #define KYBER_POLYCOMPRESSEDBYTES    128
 #define KYBER_POLYVECCOMPRESSEDBYTES (KYBER_K * 320)
+#elif KYBER_K == 4
+#define KYBER_NAMESPACE(s) PQCLEAN_MLKEM1024_CLEAN_##s
+#define KYBER_ALGNAME "ML-KEM-1024"
+#define KYBER_ETA1 2
+#define KYBER_POLYCOMPRESSEDBYTES    160
+#define KYBER_POLYVECCOMPRESSEDBYTES (KYBER_K * 352)
+#else
+#error "KYBER_K must be in {2,3,4}"
+#endif
 
 #define KYBER_ETA2 2
 
@@ -27,10 +71,16 @@
 #define KYBER_INDCPA_PUBLICKEYBYTES (KYBER_POLYVECBYTES + KYBER_SYMBYTES)
 #define KYBER_INDCPA_SECRETKEYBYTES (KYBER_POLYVECBYTES)
 #define KYBER_INDCPA_BYTES          (KYBER_POLYVECCOMPRESSEDBYTES + KYBER_POLYCOMPRESSEDBYTES)
+/* t as in the public key, followed by the K rows of A^T, 12 bits per coefficient */
+#define KYBER_INDCPA_EXPANDEDPKBYTES ((KYBER_K + 1) * KYBER_POLYVECBYTES)
 
 #define KYBER_PUBLICKEYBYTES  (KYBER_INDCPA_PUBLICKEYBYTES)
 /* 32 bytes of additional space to save H(pk) */
 #define KYBER_SECRETKEYBYTES  (KYBER_INDCPA_SECRETKEYBYTES + KYBER_INDCPA_PUBLICKEYBYTES + 2*KYBER_SYMBYTES)
 #define KYBER_CIPHERTEXTBYTES (KYBER_INDCPA_BYTES)
+/* H(pk) followed by the expanded IND-CPA public key */
+#define KYBER_EXPANDEDPKBYTES (KYBER_SYMBYTES + KYBER_INDCPA_EXPANDEDPKBYTES)
+/* IND-CPA secret key, expanded public key (starting with H(pk)) and z */
+#define KYBER_EXPANDEDSKBYTES (KYBER_INDCPA_SECRETKEYBYTES + KYBER_EXPANDEDPKBYTES + KYBER_SYMBYTES)
 
 #endif
@@ -2,26 +2,34 @@
 #include "ntt.h"
 #include "params.h"
 #include "poly.h"
+#include "poly_avx2.h"
 #include "reduce.h"
 #include "symmetric.h"
 #include "verify.h"
 #include <stdint.h>
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_poly_compress
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_compress_d4
 *
-* Description: Compression and subsequent serialization of a polynomial
+* Description: Compression to 4 bits per coefficient and subsequent
+*              serialization of a polynomial (ML-KEM-512 and ML-KEM-768)
 *
 * Arguments:   - uint8_t *r: pointer to output byte array
-*                            (of length KYBER_POLYCOMPRESSEDBYTES)
+*                            (of length 128)
 *              - const poly *a: pointer to input polynomial
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_poly_compress(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const poly *a) {
+void PQCLEAN_MLKEM768_CLEAN_poly_compress_d4(uint8_t r[128], const poly *a) {
     unsigned int i, j;
     int16_t u;
     uint32_t d0;
     uint8_t t[8];
 
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        PQCLEAN_MLKEM768_CLEAN_poly_compress4_avx2(r, a->coeffs);
+        return;
+    }
+#endif
 
     for (i = 0; i < KYBER_N / 8; i++) {
         for (j = 0; j < 8; j++) {
@@ -45,18 +53,25 @@ void PQCLEAN_MLKEM768_CLEAN_poly_compress(uint8_t r[KYBER_POLYCOMPRESSEDBYTES],
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_poly_decompress
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_decompress_d4
 *
 * Description: De-serialization and subsequent decompression of a polynomial;
-*              approximate inverse of PQCLEAN_MLKEM768_CLEAN_poly_compress
+*              approximate inverse of PQCLEAN_MLKEM768_CLEAN_poly_compress_d4
 *
 * Arguments:   - poly *r: pointer to output polynomial
 *              - const uint8_t *a: pointer to input byte array
-*                                  (of length KYBER_POLYCOMPRESSEDBYTES bytes)
+*                                  (of length 128 bytes)
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_poly_decompress(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES]) {
+void PQCLEAN_MLKEM768_CLEAN_poly_decompress_d4(poly *r, const uint8_t a[128]) {
     size_t i;
 
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        PQCLEAN_MLKEM768_CLEAN_poly_decompress4_avx2(r->coeffs, a);
+        return;
+    }
+#endif
+
     for (i = 0; i < KYBER_N / 2; i++) {
         r->coeffs[2 * i + 0] = (((uint16_t)(a[0] & 15) * KYBER_Q) + 8) >> 4;
         r->coeffs[2 * i + 1] = (((uint16_t)(a[0] >> 4) * KYBER_Q) + 8) >> 4;
@@ -64,6 +79,75 @@ void PQCLEAN_MLKEM768_CLEAN_poly_decompress(poly *r, const uint8_t a[KYBER_POLYC
     }
 }
 
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_compress_d5
+*
+* Description: Compression to 5 bits per coefficient and subsequent
+*              serialization of a polynomial (ML-KEM-1024)
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (of length 160)
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_poly_compress_d5(uint8_t r[160], const poly *a) {
+    unsigned int i, j;
+    int16_t u;
+    uint32_t d0;
+    uint8_t t[8];
+
+    for (i = 0; i < KYBER_N / 8; i++) {
+        for (j = 0; j < 8; j++) {
+            // map to positive standard representatives
+            u  = a->coeffs[8 * i + j];
+            u += (u >> 15) & KYBER_Q;
+            /*    t[j] = ((((uint32_t)u << 5) + KYBER_Q/2)/KYBER_Q) & 31; */
+            d0 = u << 5;
+            d0 += 1664;
+            d0 *= 40318;
+            d0 >>= 27;
+            t[j] = d0 & 0x1f;
+        }
+
+        r[0] = (t[0] >> 0) | (t[1] << 5);
+        r[1] = (t[1] >> 3) | (t[2] << 2) | (t[3] << 7);
+        r[2] = (t[3] >> 1) | (t[4] << 4);
+        r[3] = (t[4] >> 4) | (t[5] << 1) | (t[6] << 6);
+        r[4] = (t[6] >> 2) | (t[7] << 3);
+        r += 5;
+    }
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_decompress_d5
+*
+* Description: De-serialization and subsequent decompression of a polynomial;
+*              approximate inverse of PQCLEAN_MLKEM768_CLEAN_poly_compress_d5
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *a: pointer to input byte array
+*                                  (of length 160 bytes)
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_poly_decompress_d5(poly *r, const uint8_t a[160]) {
+    unsigned int i, j;
+    uint8_t t[8];
+
+    for (i = 0; i < KYBER_N / 8; i++) {
+        t[0] = (a[0] >> 0);
+        t[1] = (a[0] >> 5) | (a[1] << 3);
+        t[2] = (a[1] >> 2);
+        t[3] = (a[1] >> 7) | (a[2] << 1);
+        t[4] = (a[2] >> 4) | (a[3] << 4);
+        t[5] = (a[3] >> 1);
+        t[6] = (a[3] >> 6) | (a[4] << 2);
+        t[7] = (a[4] >> 3);
+        a += 5;
+
+        for (j = 0; j < 8; j++) {
+            r->coeffs[8 * i + j] = ((uint32_t)(t[j] & 31) * KYBER_Q + 16) >> 5;
+        }
+    }
+}
+
 /*************************************************
 * Name:        PQCLEAN_MLKEM768_CLEAN_poly_tobytes
 *
@@ -155,39 +239,63 @@ void PQCLEAN_MLKEM768_CLEAN_poly_tomsg(uint8_t msg[KYBER_INDCPA_MSGBYTES], const
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta1
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2
 *
 * Description: Sample a polynomial deterministically from a seed and a nonce,
 *              with output polynomial close to centered binomial distribution
-*              with parameter KYBER_ETA1
+*              with parameter KYBER_ETA2
 *
 * Arguments:   - poly *r: pointer to output polynomial
 *              - const uint8_t *seed: pointer to input seed
 *                                     (of length KYBER_SYMBYTES bytes)
 *              - uint8_t nonce: one-byte input nonce
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta1(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t nonce) {
-    uint8_t buf[KYBER_ETA1 * KYBER_N / 4];
+void PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t nonce) {
+    uint8_t buf[KYBER_ETA2 * KYBER_N / 4];
     prf(buf, sizeof(buf), seed, nonce);
-    PQCLEAN_MLKEM768_CLEAN_poly_cbd_eta1(r, buf);
+    poly_cbd_eta2(r, buf);
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2_4x
 *
-* Description: Sample a polynomial deterministically from a seed and a nonce,
-*              with output polynomial close to centered binomial distribution
-*              with parameter KYBER_ETA2
+* Description: Sample four polynomials with parameter KYBER_ETA2 from the
+*              same seed and four different nonces; the output is identical
+*              to four calls of PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2
 *
-* Arguments:   - poly *r: pointer to output polynomial
+* Arguments:   - poly *r0..r3: pointers to output polynomials
 *              - const uint8_t *seed: pointer to input seed
 *                                     (of length KYBER_SYMBYTES bytes)
-*              - uint8_t nonce: one-byte input nonce
+*              - uint8_t nonce0..nonce3: one-byte input nonces
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t nonce) {
-    uint8_t buf[KYBER_ETA2 * KYBER_N / 4];
-    prf(buf, sizeof(buf), seed, nonce);
-    PQCLEAN_MLKEM768_CLEAN_poly_cbd_eta2(r, buf);
+void PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2_4x(poly *r0, poly *r1, poly *r2, poly *r3,
+        const uint8_t seed[KYBER_SYMBYTES],
+        uint8_t nonce0, uint8_t nonce1, uint8_t nonce2, uint8_t nonce3) {
+    uint8_t buf[4][KYBER_ETA2 * KYBER_N / 4];
+    prf_x4(buf[0], buf[1], buf[2], buf[3], sizeof(buf[0]), seed, nonce0, nonce1, nonce2, nonce3);
+    poly_cbd_eta2(r0, buf[0]);
+    poly_cbd_eta2(r1, buf[1]);
+    poly_cbd_eta2(r2, buf[2]);
+    poly_cbd_eta2(r3, buf[3]);
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2_2x
+*
+* Description: Two-way variant of PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2_4x
+*
+* Arguments:   - poly *r0, *r1: pointers to output polynomials
+*              - const uint8_t *seed: pointer to input seed
+*                                     (of length KYBER_SYMBYTES bytes)
+*              - uint8_t nonce0, nonce1: one-byte input nonces
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2_2x(poly *r0, poly *r1,
+        const uint8_t seed[KYBER_SYMBYTES],
+        uint8_t nonce0, uint8_t nonce1) {
+    uint8_t buf[2][KYBER_ETA2 * KYBER_N / 4];
+    prf_x2(buf[0], buf[1], sizeof(buf[0]), seed, nonce0, nonce1);
+    poly_cbd_eta2(r0, buf[0]);
+    poly_cbd_eta2(r1, buf[1]);
 }
 
 
@@ -229,12 +337,81 @@ void PQCLEAN_MLKEM768_CLEAN_poly_invntt_tomont(poly *r) {
 **************************************************/
 void PQCLEAN_MLKEM768_CLEAN_poly_basemul_montgomery(poly *r, const poly *a, const poly *b) {
     size_t i;
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        PQCLEAN_MLKEM768_CLEAN_basemul_montgomery_avx2(r->coeffs, a->coeffs, b->coeffs);
+        return;
+    }
+#endif
+
     for (i = 0; i < KYBER_N / 4; i++) {
         PQCLEAN_MLKEM768_CLEAN_basemul(&r->coeffs[4 * i], &a->coeffs[4 * i], &b->coeffs[4 * i], PQCLEAN_MLKEM768_CLEAN_zetas[64 + i]);
         PQCLEAN_MLKEM768_CLEAN_basemul(&r->coeffs[4 * i + 2], &a->coeffs[4 * i + 2], &b->coeffs[4 * i + 2], -PQCLEAN_MLKEM768_CLEAN_zetas[64 + i]);
     }
 }
 
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_basemul_acc_frombytes
+*
+* Description: Multiplication of two polynomials in NTT domain, the second
+*              one given serialized as by poly_tobytes, added to r.
+*              Each product is reduced once per output coefficient, so it
+*              is below q in absolute value and up to four of them can be
+*              summed before r has to be reduced
+*
+* Arguments:   - poly *r: pointer to in/output polynomial
+*              - const poly *a: pointer to first input polynomial,
+*                               coefficients below 2^12 in absolute value
+*              - const uint8_t *b: pointer to second input polynomial
+*                                  (of length KYBER_POLYBYTES)
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_poly_basemul_acc_frombytes(poly *r, const poly *a, const uint8_t b[KYBER_POLYBYTES]) {
+    size_t i;
+    int16_t b0, b1, zeta;
+    int32_t a0, a1;
+
+    for (i = 0; i < KYBER_N / 2; i++) {
+        b0 = ((b[3 * i + 0] >> 0) | ((uint16_t)b[3 * i + 1] << 8)) & 0xFFF;
+        b1 = ((b[3 * i + 1] >> 4) | ((uint16_t)b[3 * i + 2] << 4)) & 0xFFF;
+        a0 = a->coeffs[2 * i];
+        a1 = a->coeffs[2 * i + 1];
+        zeta = PQCLEAN_MLKEM768_CLEAN_zetas[64 + i / 2];
+        if (i & 1) {
+            zeta = -zeta;
+        }
+        r->coeffs[2 * i] += PQCLEAN_MLKEM768_CLEAN_montgomery_reduce(a0 * b0
+                            + (int32_t)PQCLEAN_MLKEM768_CLEAN_montgomery_reduce(a1 * b1) * zeta);
+        r->coeffs[2 * i + 1] += PQCLEAN_MLKEM768_CLEAN_montgomery_reduce(a0 * b1 + a1 * b0);
+    }
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_mulcache_compute
+*
+* Description: Precompute the products of the odd coefficients of a
+*              polynomial in NTT domain with the zetas of
+*              PQCLEAN_MLKEM768_CLEAN_poly_basemul_montgomery
+*
+* Arguments:   - poly_mulcache *x: pointer to output cache
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_poly_mulcache_compute(poly_mulcache *x, const poly *a) {
+    size_t i;
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        PQCLEAN_MLKEM768_CLEAN_poly_mulcache_compute_avx2(x->coeffs, a->coeffs);
+        return;
+    }
+#endif
+
+    for (i = 0; i < KYBER_N / 4; i++) {
+        x->coeffs[2 * i] = PQCLEAN_MLKEM768_CLEAN_montgomery_reduce((int32_t)a->coeffs[4 * i + 1] * PQCLEAN_MLKEM768_CLEAN_zetas[64 + i]);
+        x->coeffs[2 * i + 1] = PQCLEAN_MLKEM768_CLEAN_montgomery_reduce((int32_t)a->coeffs[4 * i + 3] * -PQCLEAN_MLKEM768_CLEAN_zetas[64 + i]);
+    }
+}
+
 /*************************************************
 * Name:        PQCLEAN_MLKEM768_CLEAN_poly_tomont
 *
@@ -246,6 +423,14 @@ void PQCLEAN_MLKEM768_CLEAN_poly_basemul_montgomery(poly *r, const poly *a, cons
 void PQCLEAN_MLKEM768_CLEAN_poly_tomont(poly *r) {
     size_t i;
     const int16_t f = (1ULL << 32) % KYBER_Q;
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        PQCLEAN_MLKEM768_CLEAN_poly_tomont_avx2(r->coeffs);
+        return;
+    }
+#endif
+
     for (i = 0; i < KYBER_N; i++) {
         r->coeffs[i] = PQCLEAN_MLKEM768_CLEAN_montgomery_reduce((int32_t)r->coeffs[i] * f);
     }
@@ -261,6 +446,14 @@ void PQCLEAN_MLKEM768_CLEAN_poly_tomont(poly *r) {
 **************************************************/
 void PQCLEAN_MLKEM768_CLEAN_poly_reduce(poly *r) {
     size_t i;
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        PQCLEAN_MLKEM768_CLEAN_poly_reduce_avx2(r->coeffs);
+        return;
+    }
+#endif
+
     for (i = 0; i < KYBER_N; i++) {
         r->coeffs[i] = PQCLEAN_MLKEM768_CLEAN_barrett_reduce(r->coeffs[i]);
     }
@@ -11,8 +11,27 @@ typedef struct {
     int16_t coeffs[KYBER_N];
 } poly;
 
-void PQCLEAN_MLKEM768_CLEAN_poly_compress(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const poly *a);
-void PQCLEAN_MLKEM768_CLEAN_poly_decompress(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES]);
+/*
+ * Precomputed products b[2i+1]*zeta_i of a polynomial b in NTT domain, one
+ * per pair of coefficients, so that repeated multiplications by b do not
+ * redo them (see polyvec_basemul_acc_montgomery_cached)
+ */
+typedef struct {
+    int16_t coeffs[KYBER_N / 2];
+} poly_mulcache;
+
+void PQCLEAN_MLKEM768_CLEAN_poly_compress_d4(uint8_t r[128], const poly *a);
+void PQCLEAN_MLKEM768_CLEAN_poly_decompress_d4(poly *r, const uint8_t a[128]);
+void PQCLEAN_MLKEM768_CLEAN_poly_compress_d5(uint8_t r[160], const poly *a);
+void PQCLEAN_MLKEM768_CLEAN_poly_decompress_d5(poly *r, const uint8_t a[160]);
+
+/* Parameter-set specific, see poly_k.c */
+void KYBER_NAMESPACE(poly_compress)(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const poly *a);
+void KYBER_NAMESPACE(poly_decompress)(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES]);
+void KYBER_NAMESPACE(poly_invntt_add_compress)(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], poly *a, const poly *e,
+        const uint8_t msg[KYBER_INDCPA_MSGBYTES]);
+void KYBER_NAMESPACE(poly_invntt_sub_tomsg)(uint8_t msg[KYBER_INDCPA_MSGBYTES], poly *a,
+        const uint8_t v[KYBER_POLYCOMPRESSEDBYTES]);
 
 void PQCLEAN_MLKEM768_CLEAN_poly_tobytes(uint8_t r[KYBER_POLYBYTES], const poly *a);
 void PQCLEAN_MLKEM768_CLEAN_poly_frombytes(poly *r, const uint8_t a[KYBER_POLYBYTES]);
@@ -20,13 +39,29 @@ void PQCLEAN_MLKEM768_CLEAN_poly_frombytes(poly *r, const uint8_t a[KYBER_POLYBY
 void PQCLEAN_MLKEM768_CLEAN_poly_frommsg(poly *r, const uint8_t msg[KYBER_INDCPA_MSGBYTES]);
 void PQCLEAN_MLKEM768_CLEAN_poly_tomsg(uint8_t msg[KYBER_INDCPA_MSGBYTES], const poly *a);
 
-void PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta1(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t nonce);
+void KYBER_NAMESPACE(poly_getnoise_eta1)(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t nonce);
 
 void PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t nonce);
 
+void KYBER_NAMESPACE(poly_getnoise_eta1_4x)(poly *r0, poly *r1, poly *r2, poly *r3,
+        const uint8_t seed[KYBER_SYMBYTES],
+        uint8_t nonce0, uint8_t nonce1, uint8_t nonce2, uint8_t nonce3);
+void KYBER_NAMESPACE(poly_getnoise_eta1_2x)(poly *r0, poly *r1,
+        const uint8_t seed[KYBER_SYMBYTES],
+        uint8_t nonce0, uint8_t nonce1);
+
+void PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2_4x(poly *r0, poly *r1, poly *r2, poly *r3,
+        const uint8_t seed[KYBER_SYMBYTES],
+        uint8_t nonce0, uint8_t nonce1, uint8_t nonce2, uint8_t nonce3);
+void PQCLEAN_MLKEM768_CLEAN_poly_getnoise_eta2_2x(poly *r0, poly *r1,
+        const uint8_t seed[KYBER_SYMBYTES],
+        uint8_t nonce0, uint8_t nonce1);
+
 void PQCLEAN_MLKEM768_CLEAN_poly_ntt(poly *r);
 void PQCLEAN_MLKEM768_CLEAN_poly_invntt_tomont(poly *r);
 void PQCLEAN_MLKEM768_CLEAN_poly_basemul_montgomery(poly *r, const poly *a, const poly *b);
+void PQCLEAN_MLKEM768_CLEAN_poly_basemul_acc_frombytes(poly *r, const poly *a, const uint8_t b[KYBER_POLYBYTES]);
+void PQCLEAN_MLKEM768_CLEAN_poly_mulcache_compute(poly_mulcache *x, const poly *a);
 void PQCLEAN_MLKEM768_CLEAN_poly_tomont(poly *r);
 
 void PQCLEAN_MLKEM768_CLEAN_poly_reduce(poly *r);
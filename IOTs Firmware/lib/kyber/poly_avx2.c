@@ -0,0 +1,962 @@
+#include "ntt.h"
+#include "params.h"
+#include "poly_avx2.h"
+#include "reduce.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(KYBER_AVX2_DISPATCH)
+#include <immintrin.h>
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_have_avx2
+*
+* Description: Reports whether the AVX2 kernels may be used in this process.
+*              The CPU is queried once and the answer cached.
+*
+* Returns 1 if AVX2 (and POPCNT, used by the sampler) is available,
+* 0 otherwise
+**************************************************/
+int PQCLEAN_MLKEM768_CLEAN_have_avx2(void) {
+#if defined(__AVX2__) && defined(__POPCNT__)
+    return 1;
+#else
+    static int have = -1;
+    if (have < 0) {
+        __builtin_cpu_init();
+        have = (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) ? 1 : 0;
+    }
+    return have;
+#endif
+}
+
+/* Per 32-coefficient chunk: zetas of the len = 8, 4 and 2 layers, each
+ * expanded to one 16-lane vector in the order the lanes are arranged in */
+static const int16_t zetas_ntt_avx2[384] = {
+    573, 573, 573, 573, 573, 573, 573, 573, -1325, -1325, -1325, -1325, -1325, -1325, -1325, -1325,
+    1223, 1223, 1223, 1223, 652, 652, 652, 652, -552, -552, -552, -552, 1015, 1015, 1015, 1015,
+    -1103, -1103, 430, 430, 555, 555, 843, 843, -1251, -1251, 871, 871, 1550, 1550, 105, 105,
+    264, 264, 264, 264, 264, 264, 264, 264, 383, 383, 383, 383, 383, 383, 383, 383,
+    -1293, -1293, -1293, -1293, 1491, 1491, 1491, 1491, -282, -282, -282, -282, -1544, -1544, -1544, -1544,
+    422, 422, 587, 587, 177, 177, -235, -235, -291, -291, -460, -460, 1574, 1574, 1653, 1653,
+    -829, -829, -829, -829, -829, -829, -829, -829, 1458, 1458, 1458, 1458, 1458, 1458, 1458, 1458,
+    516, 516, 516, 516, -8, -8, -8, -8, -320, -320, -320, -320, -666, -666, -666, -666,
+    -246, -246, 778, 778, 1159, 1159, -147, -147, -777, -777, 1483, 1483, -602, -602, 1119, 1119,
+    -1602, -1602, -1602, -1602, -1602, -1602, -1602, -1602, -130, -130, -130, -130, -130, -130, -130, -130,
+    -1618, -1618, -1618, -1618, -1162, -1162, -1162, -1162, 126, 126, 126, 126, 1469, 1469, 1469, 1469,
+    -1590, -1590, 644, 644, -872, -872, 349, 349, 418, 418, 329, 329, -156, -156, -75, -75,
+    -681, -681, -681, -681, -681, -681, -681, -681, 1017, 1017, 1017, 1017, 1017, 1017, 1017, 1017,
+    -853, -853, -853, -853, -90, -90, -90, -90, -271, -271, -271, -271, 830, 830, 830, 830,
+    817, 817, 1097, 1097, 603, 603, 610, 610, 1322, 1322, -1285, -1285, -1465, -1465, 384, 384,
+    732, 732, 732, 732, 732, 732, 732, 732, 608, 608, 608, 608, 608, 608, 608, 608,
+    107, 107, 107, 107, -1421, -1421, -1421, -1421, -247, -247, -247, -247, -951, -951, -951, -951,
+    -1215, -1215, -136, -136, 1218, 1218, -1335, -1335, -874, -874, 220, 220, -1187, -1187, -1659, -1659,
+    -1542, -1542, -1542, -1542, -1542, -1542, -1542, -1542, 411, 411, 411, 411, 411, 411, 411, 411,
+    -398, -398, -398, -398, 961, 961, 961, 961, -1508, -1508, -1508, -1508, -725, -725, -725, -725,
+    -1185, -1185, -1530, -1530, -1278, -1278, 794, 794, -1510, -1510, -854, -854, -870, -870, 478, 478,
+    -205, -205, -205, -205, -205, -205, -205, -205, -1571, -1571, -1571, -1571, -1571, -1571, -1571, -1571,
+    448, 448, 448, 448, -1065, -1065, -1065, -1065, 677, 677, 677, 677, -1275, -1275, -1275, -1275,
+    -108, -108, -308, -308, 996, 996, 991, 991, 958, 958, -1460, -1460, 1522, 1522, 1628, 1628
+};
+
+/* Per 32-coefficient chunk: zetas of the len = 2, 4 and 8 layers of the
+ * inverse transform, expanded as above */
+static const int16_t zetas_invntt_avx2[384] = {
+    1628, 1628, 1522, 1522, -1460, -1460, 958, 958, 991, 991, 996, 996, -308, -308, -108, -108,
+    -1275, -1275, -1275, -1275, 677, 677, 677, 677, -1065, -1065, -1065, -1065, 448, 448, 448, 448,
+    -1571, -1571, -1571, -1571, -1571, -1571, -1571, -1571, -205, -205, -205, -205, -205, -205, -205, -205,
+    478, 478, -870, -870, -854, -854, -1510, -1510, 794, 794, -1278, -1278, -1530, -1530, -1185, -1185,
+    -725, -725, -725, -725, -1508, -1508, -1508, -1508, 961, 961, 961, 961, -398, -398, -398, -398,
+    411, 411, 411, 411, 411, 411, 411, 411, -1542, -1542, -1542, -1542, -1542, -1542, -1542, -1542,
+    -1659, -1659, -1187, -1187, 220, 220, -874, -874, -1335, -1335, 1218, 1218, -136, -136, -1215, -1215,
+    -951, -951, -951, -951, -247, -247, -247, -247, -1421, -1421, -1421, -1421, 107, 107, 107, 107,
+    608, 608, 608, 608, 608, 608, 608, 608, 732, 732, 732, 732, 732, 732, 732, 732,
+    384, 384, -1465, -1465, -1285, -1285, 1322, 1322, 610, 610, 603, 603, 1097, 1097, 817, 817,
+    830, 830, 830, 830, -271, -271, -271, -271, -90, -90, -90, -90, -853, -853, -853, -853,
+    1017, 1017, 1017, 1017, 1017, 1017, 1017, 1017, -681, -681, -681, -681, -681, -681, -681, -681,
+    -75, -75, -156, -156, 329, 329, 418, 418, 349, 349, -872, -872, 644, 644, -1590, -1590,
+    1469, 1469, 1469, 1469, 126, 126, 126, 126, -1162, -1162, -1162, -1162, -1618, -1618, -1618, -1618,
+    -130, -130, -130, -130, -130, -130, -130, -130, -1602, -1602, -1602, -1602, -1602, -1602, -1602, -1602,
+    1119, 1119, -602, -602, 1483, 1483, -777, -777, -147, -147, 1159, 1159, 778, 778, -246, -246,
+    -666, -666, -666, -666, -320, -320, -320, -320, -8, -8, -8, -8, 516, 516, 516, 516,
+    1458, 1458, 1458, 1458, 1458, 1458, 1458, 1458, -829, -829, -829, -829, -829, -829, -829, -829,
+    1653, 1653, 1574, 1574, -460, -460, -291, -291, -235, -235, 177, 177, 587, 587, 422, 422,
+    -1544, -1544, -1544, -1544, -282, -282, -282, -282, 1491, 1491, 1491, 1491, -1293, -1293, -1293, -1293,
+    383, 383, 383, 383, 383, 383, 383, 383, 264, 264, 264, 264, 264, 264, 264, 264,
+    105, 105, 1550, 1550, 871, 871, -1251, -1251, 843, 843, 555, 555, 430, 430, -1103, -1103,
+    1015, 1015, 1015, 1015, -552, -552, -552, -552, 652, 652, 652, 652, 1223, 1223, 1223, 1223,
+    -1325, -1325, -1325, -1325, -1325, -1325, -1325, -1325, 573, 573, 573, 573, 573, 573, 573, 573
+};
+
+/* zeta and -zeta of every pair of degree-1 products, on the odd lanes */
+static const int16_t zetas_basemul_avx2[256] = {
+    0, -1103, 0, 1103, 0, 430, 0, -430, 0, 555, 0, -555, 0, 843, 0, -843,
+    0, -1251, 0, 1251, 0, 871, 0, -871, 0, 1550, 0, -1550, 0, 105, 0, -105,
+    0, 422, 0, -422, 0, 587, 0, -587, 0, 177, 0, -177, 0, -235, 0, 235,
+    0, -291, 0, 291, 0, -460, 0, 460, 0, 1574, 0, -1574, 0, 1653, 0, -1653,
+    0, -246, 0, 246, 0, 778, 0, -778, 0, 1159, 0, -1159, 0, -147, 0, 147,
+    0, -777, 0, 777, 0, 1483, 0, -1483, 0, -602, 0, 602, 0, 1119, 0, -1119,
+    0, -1590, 0, 1590, 0, 644, 0, -644, 0, -872, 0, 872, 0, 349, 0, -349,
+    0, 418, 0, -418, 0, 329, 0, -329, 0, -156, 0, 156, 0, -75, 0, 75,
+    0, 817, 0, -817, 0, 1097, 0, -1097, 0, 603, 0, -603, 0, 610, 0, -610,
+    0, 1322, 0, -1322, 0, -1285, 0, 1285, 0, -1465, 0, 1465, 0, 384, 0, -384,
+    0, -1215, 0, 1215, 0, -136, 0, 136, 0, 1218, 0, -1218, 0, -1335, 0, 1335,
+    0, -874, 0, 874, 0, 220, 0, -220, 0, -1187, 0, 1187, 0, -1659, 0, 1659,
+    0, -1185, 0, 1185, 0, -1530, 0, 1530, 0, -1278, 0, 1278, 0, 794, 0, -794,
+    0, -1510, 0, 1510, 0, -854, 0, 854, 0, -870, 0, 870, 0, 478, 0, -478,
+    0, -108, 0, 108, 0, -308, 0, 308, 0, 996, 0, -996, 0, 991, 0, -991,
+    0, 958, 0, -958, 0, -1460, 0, 1460, 0, 1522, 0, -1522, 0, 1628, 0, -1628
+};
+
+/*************************************************
+* Name:        fqmul16
+*
+* Description: Sixteen Montgomery multiplications; lane i equals
+*              montgomery_reduce((int32_t)a[i]*b[i])
+**************************************************/
+AVX2_TARGET static __m256i fqmul16(__m256i a, __m256i b) {
+    __m256i lo = _mm256_mullo_epi16(a, b);
+    __m256i hi = _mm256_mulhi_epi16(a, b);
+    lo = _mm256_mullo_epi16(lo, _mm256_set1_epi16(QINV));
+    lo = _mm256_mulhi_epi16(lo, _mm256_set1_epi16(KYBER_Q));
+    return _mm256_sub_epi16(hi, lo);
+}
+
+/*************************************************
+* Name:        barrett16
+*
+* Description: Sixteen Barrett reductions; lane i equals barrett_reduce(a[i]).
+*              mulhi gives floor(v*a/2^16); mulhrs by 32 then computes
+*              floor((x + 2^9)/2^10), which together is the scalar
+*              (v*a + 2^25) >> 26.
+**************************************************/
+AVX2_TARGET static __m256i barrett16(__m256i a) {
+    __m256i t = _mm256_mulhi_epi16(a, _mm256_set1_epi16(((1 << 26) + KYBER_Q / 2) / KYBER_Q));
+    t = _mm256_mulhrs_epi16(t, _mm256_set1_epi16(32));
+    t = _mm256_mullo_epi16(t, _mm256_set1_epi16(KYBER_Q));
+    return _mm256_sub_epi16(a, t);
+}
+
+/* Forward (Cooley-Tukey) and inverse (Gentleman-Sande) butterflies on
+ * sixteen independent pairs, in the same order of operations as ntt.c */
+AVX2_TARGET static void ct_butterfly(__m256i *lo, __m256i *hi, __m256i zeta) {
+    __m256i t = fqmul16(zeta, *hi);
+    *hi = _mm256_sub_epi16(*lo, t);
+    *lo = _mm256_add_epi16(*lo, t);
+}
+
+AVX2_TARGET static void gs_butterfly(__m256i *lo, __m256i *hi, __m256i zeta) {
+    __m256i t = *lo;
+    *lo = barrett16(_mm256_add_epi16(t, *hi));
+    *hi = fqmul16(zeta, _mm256_sub_epi16(*hi, t));
+}
+
+/* The three lane rearrangements below are their own inverses. Applied in
+ * order to a 32-coefficient chunk held as (a, b) = (c[0..15], c[16..31])
+ * they pair up the coefficients of the len = 8, 4 and 2 layers. */
+AVX2_TARGET static void shuffle128(__m256i *a, __m256i *b) {
+    __m256i t = _mm256_permute2x128_si256(*a, *b, 0x20);
+    *b = _mm256_permute2x128_si256(*a, *b, 0x31);
+    *a = t;
+}
+
+AVX2_TARGET static void shuffle64(__m256i *a, __m256i *b) {
+    __m256i t = _mm256_unpacklo_epi64(*a, *b);
+    *b = _mm256_unpackhi_epi64(*a, *b);
+    *a = t;
+}
+
+AVX2_TARGET static void shuffle32(__m256i *a, __m256i *b) {
+    __m256i t = _mm256_blend_epi32(*a, _mm256_slli_epi64(*b, 32), 0xAA);
+    *b = _mm256_blend_epi32(_mm256_srli_epi64(*a, 32), *b, 0xAA);
+    *a = t;
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_ntt_avx2
+*
+* Description: AVX2 version of PQCLEAN_MLKEM768_CLEAN_ntt. The len >= 32
+*              layers run over the whole array; the remaining four stay
+*              within a 32-coefficient chunk and run on two registers.
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+AVX2_TARGET void PQCLEAN_MLKEM768_CLEAN_ntt_avx2(int16_t r[KYBER_N]) {
+    unsigned int len, start, j, k;
+    __m256i a, b, zeta;
+
+    k = 1;
+    for (len = 128; len >= 32; len >>= 1) {
+        for (start = 0; start < KYBER_N; start += 2 * len) {
+            zeta = _mm256_set1_epi16(PQCLEAN_MLKEM768_CLEAN_zetas[k++]);
+            for (j = start; j < start + len; j += 16) {
+                a = _mm256_loadu_si256((const __m256i *)&r[j]);
+                b = _mm256_loadu_si256((const __m256i *)&r[j + len]);
+                ct_butterfly(&a, &b, zeta);
+                _mm256_storeu_si256((__m256i *)&r[j], a);
+                _mm256_storeu_si256((__m256i *)&r[j + len], b);
+            }
+        }
+    }
+
+    for (j = 0; j < KYBER_N / 32; j++) {
+        const int16_t *z = &zetas_ntt_avx2[48 * j];
+
+        a = _mm256_loadu_si256((const __m256i *)&r[32 * j]);
+        b = _mm256_loadu_si256((const __m256i *)&r[32 * j + 16]);
+
+        ct_butterfly(&a, &b, _mm256_set1_epi16(PQCLEAN_MLKEM768_CLEAN_zetas[8 + j]));
+        shuffle128(&a, &b);
+        ct_butterfly(&a, &b, _mm256_loadu_si256((const __m256i *)&z[0]));
+        shuffle64(&a, &b);
+        ct_butterfly(&a, &b, _mm256_loadu_si256((const __m256i *)&z[16]));
+        shuffle32(&a, &b);
+        ct_butterfly(&a, &b, _mm256_loadu_si256((const __m256i *)&z[32]));
+        shuffle32(&a, &b);
+        shuffle64(&a, &b);
+        shuffle128(&a, &b);
+
+        _mm256_storeu_si256((__m256i *)&r[32 * j], a);
+        _mm256_storeu_si256((__m256i *)&r[32 * j + 16], b);
+    }
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_invntt_avx2
+*
+* Description: AVX2 version of PQCLEAN_MLKEM768_CLEAN_invntt, including the
+*              final multiplication by mont^2/128
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+AVX2_TARGET void PQCLEAN_MLKEM768_CLEAN_invntt_avx2(int16_t r[KYBER_N]) {
+    unsigned int len, start, j, k;
+    __m256i a, b, zeta;
+    const __m256i f = _mm256_set1_epi16(1441); // mont^2/128
+
+    for (j = 0; j < KYBER_N / 32; j++) {
+        const int16_t *z = &zetas_invntt_avx2[48 * j];
+
+        a = _mm256_loadu_si256((const __m256i *)&r[32 * j]);
+        b = _mm256_loadu_si256((const __m256i *)&r[32 * j + 16]);
+
+        shuffle128(&a, &b);
+        shuffle64(&a, &b);
+        shuffle32(&a, &b);
+        gs_butterfly(&a, &b, _mm256_loadu_si256((const __m256i *)&z[0]));
+        shuffle32(&a, &b);
+        gs_butterfly(&a, &b, _mm256_loadu_si256((const __m256i *)&z[16]));
+        shuffle64(&a, &b);
+        gs_butterfly(&a, &b, _mm256_loadu_si256((const __m256i *)&z[32]));
+        shuffle128(&a, &b);
+        gs_butterfly(&a, &b, _mm256_set1_epi16(PQCLEAN_MLKEM768_CLEAN_zetas[15 - j]));
+
+        _mm256_storeu_si256((__m256i *)&r[32 * j], a);
+        _mm256_storeu_si256((__m256i *)&r[32 * j + 16], b);
+    }
+
+    k = 7;
+    for (len = 32; len <= 128; len <<= 1) {
+        for (start = 0; start < KYBER_N; start += 2 * len) {
+            zeta = _mm256_set1_epi16(PQCLEAN_MLKEM768_CLEAN_zetas[k--]);
+            for (j = start; j < start + len; j += 16) {
+                a = _mm256_loadu_si256((const __m256i *)&r[j]);
+                b = _mm256_loadu_si256((const __m256i *)&r[j + len]);
+                gs_butterfly(&a, &b, zeta);
+                _mm256_storeu_si256((__m256i *)&r[j], a);
+                _mm256_storeu_si256((__m256i *)&r[j + len], b);
+            }
+        }
+    }
+
+    for (j = 0; j < KYBER_N; j += 16) {
+        a = _mm256_loadu_si256((const __m256i *)&r[j]);
+        _mm256_storeu_si256((__m256i *)&r[j], fqmul16(a, f));
+    }
+}
+
+/*************************************************
+* Name:        swap16
+*
+* Description: Swap the two 16-bit halves of every 32-bit lane
+**************************************************/
+AVX2_TARGET static __m256i swap16(__m256i a) {
+    return _mm256_or_si256(_mm256_slli_epi32(a, 16), _mm256_srli_epi32(a, 16));
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_basemul_montgomery_avx2
+*
+* Description: AVX2 version of PQCLEAN_MLKEM768_CLEAN_poly_basemul_montgomery.
+*              For every pair (a0, a1), (b0, b1) the even lane computes
+*              fqmul(fqmul(a1, b1), zeta) + fqmul(a0, b0) and the odd lane
+*              fqmul(a0, b1) + fqmul(a1, b0), as PQCLEAN_MLKEM768_CLEAN_basemul.
+*
+* Arguments:   - int16_t r[256]: pointer to output polynomial
+*              - const int16_t a[256]: pointer to first input polynomial
+*              - const int16_t b[256]: pointer to second input polynomial
+**************************************************/
+AVX2_TARGET void PQCLEAN_MLKEM768_CLEAN_basemul_montgomery_avx2(int16_t r[KYBER_N], const int16_t a[KYBER_N], const int16_t b[KYBER_N]) {
+    unsigned int i;
+    __m256i va, vb, p, q, pz;
+
+    for (i = 0; i < KYBER_N; i += 16) {
+        va = _mm256_loadu_si256((const __m256i *)&a[i]);
+        vb = _mm256_loadu_si256((const __m256i *)&b[i]);
+
+        p = fqmul16(va, vb);
+        q = fqmul16(va, swap16(vb));
+        pz = fqmul16(p, _mm256_loadu_si256((const __m256i *)&zetas_basemul_avx2[i]));
+
+        p = _mm256_add_epi16(p, swap16(pz));
+        q = _mm256_add_epi16(q, swap16(q));
+        _mm256_storeu_si256((__m256i *)&r[i], _mm256_blend_epi16(p, q, 0xAA));
+    }
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_mulcache_compute_avx2
+*
+* Description: AVX2 version of PQCLEAN_MLKEM768_CLEAN_poly_mulcache_compute.
+*              The products are formed in the odd lanes and then packed.
+*
+* Arguments:   - int16_t r[128]: pointer to output cache
+*              - const int16_t a[256]: pointer to input polynomial
+**************************************************/
+AVX2_TARGET void PQCLEAN_MLKEM768_CLEAN_poly_mulcache_compute_avx2(int16_t r[KYBER_N / 2], const int16_t a[KYBER_N]) {
+    unsigned int i;
+    __m256i x0, x1;
+
+    for (i = 0; i < KYBER_N; i += 32) {
+        x0 = _mm256_loadu_si256((const __m256i *)&a[i]);
+        x1 = _mm256_loadu_si256((const __m256i *)&a[i + 16]);
+        x0 = fqmul16(x0, _mm256_loadu_si256((const __m256i *)&zetas_basemul_avx2[i]));
+        x1 = fqmul16(x1, _mm256_loadu_si256((const __m256i *)&zetas_basemul_avx2[i + 16]));
+        x0 = _mm256_packs_epi32(_mm256_srai_epi32(x0, 16), _mm256_srai_epi32(x1, 16));
+        _mm256_storeu_si256((__m256i *)&r[i / 2], _mm256_permute4x64_epi64(x0, 0xD8));
+    }
+}
+
+/*************************************************
+* Name:        montgomery32
+*
+* Description: Montgomery reduction of eight 32-bit lanes, same arithmetic
+*              as PQCLEAN_MLKEM768_CLEAN_montgomery_reduce; the result is in
+*              the low 16 bits of each lane
+**************************************************/
+AVX2_TARGET static __m256i montgomery32(__m256i a) {
+    __m256i t = _mm256_mullo_epi32(a, _mm256_set1_epi32(QINV));
+    t = _mm256_srai_epi32(_mm256_slli_epi32(t, 16), 16);
+    t = _mm256_mullo_epi32(t, _mm256_set1_epi32(KYBER_Q));
+    return _mm256_srai_epi32(_mm256_sub_epi32(a, t), 16);
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_basemul_acc_cached_avx2
+*
+* Description: AVX2 version of
+*              polyvec_basemul_acc_montgomery_cached.
+*              With (a0, a1) in one 32-bit lane, madd against (b0, c) and
+*              (b1, b0) gives both 32-bit products of the pair.
+*
+* Arguments:   - int16_t r[256]: pointer to output polynomial
+*              - const poly *a: pointer to first input vector of k polynomials
+*              - const poly *b: pointer to second input vector of k polynomials
+*              - const poly_mulcache *b_cache: pointer to the k caches of b
+*              - unsigned int k: vector length (KYBER_K of the parameter set)
+**************************************************/
+AVX2_TARGET void PQCLEAN_MLKEM768_CLEAN_basemul_acc_cached_avx2(int16_t r[KYBER_N], const poly *a, const poly *b,
+        const poly_mulcache *b_cache, unsigned int k) {
+    unsigned int i, j;
+    __m256i va, vb, vc, acc0, acc1;
+
+    for (j = 0; j < KYBER_N; j += 16) {
+        acc0 = _mm256_setzero_si256();
+        acc1 = _mm256_setzero_si256();
+        for (i = 0; i < k; i++) {
+            va = _mm256_loadu_si256((const __m256i *)&a[i].coeffs[j]);
+            vb = _mm256_loadu_si256((const __m256i *)&b[i].coeffs[j]);
+            vc = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)&b_cache[i].coeffs[j / 2]));
+            vc = _mm256_blend_epi16(vb, _mm256_slli_epi32(vc, 16), 0xAA);
+            acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(va, vc));
+            acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(va, swap16(vb)));
+        }
+        acc0 = montgomery32(acc0);
+        acc1 = montgomery32(acc1);
+        acc0 = _mm256_blend_epi16(acc0, _mm256_slli_epi32(acc1, 16), 0xAA);
+        _mm256_storeu_si256((__m256i *)&r[j], acc0);
+    }
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_reduce_avx2
+*
+* Description: AVX2 version of PQCLEAN_MLKEM768_CLEAN_poly_reduce
+*
+* Arguments:   - int16_t r[256]: pointer to input/output polynomial
+**************************************************/
+AVX2_TARGET void PQCLEAN_MLKEM768_CLEAN_poly_reduce_avx2(int16_t r[KYBER_N]) {
+    unsigned int i;
+
+    for (i = 0; i < KYBER_N; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)&r[i]);
+        _mm256_storeu_si256((__m256i *)&r[i], barrett16(a));
+    }
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_tomont_avx2
+*
+* Description: AVX2 version of PQCLEAN_MLKEM768_CLEAN_poly_tomont
+*
+* Arguments:   - int16_t r[256]: pointer to input/output polynomial
+**************************************************/
+AVX2_TARGET void PQCLEAN_MLKEM768_CLEAN_poly_tomont_avx2(int16_t r[KYBER_N]) {
+    unsigned int i;
+    const __m256i f = _mm256_set1_epi16((int16_t)((1ULL << 32) % KYBER_Q));
+
+    for (i = 0; i < KYBER_N; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)&r[i]);
+        _mm256_storeu_si256((__m256i *)&r[i], fqmul16(a, f));
+    }
+}
+
+/*************************************************
+* Name:        caddq16
+*
+* Description: Map coefficients in (-q, q) to [0, q) by adding q to the
+*              negative ones, as the clean packing code does
+**************************************************/
+AVX2_TARGET static __m256i caddq16(__m256i a) {
+    __m256i t = _mm256_and_si256(_mm256_srai_epi16(a, 15), _mm256_set1_epi16(KYBER_Q));
+    return _mm256_add_epi16(a, t);
+}
+
+/*************************************************
+* Name:        compress4_32
+*
+* Description: Eight lanes of the scalar d = 4 compression,
+*              (((u << 4) + 1665) * 80635 mod 2^32) >> 28, in 32-bit lanes
+**************************************************/
+AVX2_TARGET static __m256i compress4_32(__m256i u) {
+    u = _mm256_slli_epi32(u, 4);
+    u = _mm256_add_epi32(u, _mm256_set1_epi32(1665));
+    u = _mm256_mullo_epi32(u, _mm256_set1_epi32(80635));
+    u = _mm256_srli_epi32(u, 28);
+    return _mm256_and_si256(u, _mm256_set1_epi32(0xF));
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_compress4_avx2
+*
+* Description: AVX2 version of PQCLEAN_MLKEM768_CLEAN_poly_compress_d4
+*
+* Arguments:   - uint8_t *r: pointer to output byte array (128 bytes)
+*              - const int16_t a[256]: pointer to input polynomial
+**************************************************/
+AVX2_TARGET void PQCLEAN_MLKEM768_CLEAN_poly_compress4_avx2(uint8_t r[128], const int16_t a[KYBER_N]) {
+    unsigned int i, j;
+    __m256i u, lo, hi, w[4];
+    const __m256i idx = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    for (i = 0; i < KYBER_N; i += 64) {
+        for (j = 0; j < 4; j++) {
+            u = caddq16(_mm256_loadu_si256((const __m256i *)&a[i + 16 * j]));
+            lo = compress4_32(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(u)));
+            hi = compress4_32(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(u, 1)));
+            // 16-bit lanes t[0..15] in order, then t[2k] | t[2k+1] << 4
+            // in the low byte of every 32-bit lane
+            u = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8);
+            w[j] = _mm256_and_si256(_mm256_or_si256(u, _mm256_srli_epi32(u, 12)), _mm256_set1_epi32(0xFF));
+        }
+        u = _mm256_packus_epi16(_mm256_packus_epi32(w[0], w[1]), _mm256_packus_epi32(w[2], w[3]));
+        u = _mm256_permutevar8x32_epi32(u, idx);
+        _mm256_storeu_si256((__m256i *)&r[i / 2], u);
+    }
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_decompress4_avx2
+*
+* Description: AVX2 version of PQCLEAN_MLKEM768_CLEAN_poly_decompress_d4.
+*              ((n*q) + 8) >> 4 is computed as mulhrs(n << 11, q).
+*
+* Arguments:   - int16_t r[256]: pointer to output polynomial
+*              - const uint8_t *a: pointer to input byte array (128 bytes)
+**************************************************/
+AVX2_TARGET void PQCLEAN_MLKEM768_CLEAN_poly_decompress4_avx2(int16_t r[KYBER_N], const uint8_t a[128]) {
+    unsigned int i;
+    int64_t t;
+    __m256i v, lo, hi;
+    const __m256i shuf = _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                          4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+
+    for (i = 0; i < KYBER_N; i += 16) {
+        memcpy(&t, &a[i / 2], sizeof(t));
+        // every byte lands in both halves of a 32-bit lane pair
+        v = _mm256_shuffle_epi8(_mm256_set1_epi64x(t), shuf);
+        lo = _mm256_and_si256(v, _mm256_set1_epi16(0x0F));
+        hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi16(0x0F));
+        v = _mm256_blend_epi16(lo, hi, 0xAA);
+        v = _mm256_mulhrs_epi16(_mm256_slli_epi16(v, 11), _mm256_set1_epi16(KYBER_Q));
+        _mm256_storeu_si256((__m256i *)&r[i], v);
+    }
+}
+
+/*************************************************
+* Name:        compress10_32
+*
+* Description: Eight lanes of the scalar d = 10 compression,
+*              ((((uint64_t)u << 10) + 1665) * 1290167) >> 32, using the
+*              32x32 -> 64-bit multiplier on even and odd lanes separately
+**************************************************/
+AVX2_TARGET static __m256i compress10_32(__m256i u) {
+    const __m256i c = _mm256_set1_epi32(1290167);
+    __m256i e, o;
+
+    u = _mm256_slli_epi32(u, 10);
+    u = _mm256_add_epi32(u, _mm256_set1_epi32(1665));
+    e = _mm256_srli_epi64(_mm256_mul_epu32(u, c), 32);
+    o = _mm256_mul_epu32(_mm256_srli_epi64(u, 32), c);
+    u = _mm256_blend_epi32(e, o, 0xAA);
+    return _mm256_and_si256(u, _mm256_set1_epi32(0x3FF));
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_compress10_avx2
+*
+* Description: AVX2 version of the per-polynomial part of
+*              polyvec_compress (d = 10)
+*
+* Arguments:   - uint8_t *r: pointer to output byte array (320 bytes)
+*              - const int16_t a[256]: pointer to input polynomial
+**************************************************/
+AVX2_TARGET void PQCLEAN_MLKEM768_CLEAN_poly_compress10_avx2(uint8_t r[320], const int16_t a[KYBER_N]) {
+    unsigned int i;
+    uint8_t buf[32];
+    __m256i u, lo, hi;
+    const __m256i shuf = _mm256_setr_epi8(0, 1, 2, 3, 4, 8, 9, 10, 11, 12, -1, -1, -1, -1, -1, -1,
+                                          0, 1, 2, 3, 4, 8, 9, 10, 11, 12, -1, -1, -1, -1, -1, -1);
+
+    for (i = 0; i < KYBER_N; i += 16) {
+        u = caddq16(_mm256_loadu_si256((const __m256i *)&a[i]));
+        // the scalar code takes u as uint16_t, so zero-extend
+        lo = compress10_32(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(u)));
+        hi = compress10_32(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(u, 1)));
+        u = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8);
+        // t[2k] | t[2k+1] << 10 per 32-bit lane, then two of those per
+        // 64-bit lane: 40 bits = 5 output bytes
+        u = _mm256_madd_epi16(u, _mm256_set1_epi32((1 << 10 << 16) | 1));
+        u = _mm256_sllv_epi32(u, _mm256_set1_epi64x(12));
+        u = _mm256_srli_epi64(u, 12);
+        u = _mm256_shuffle_epi8(u, shuf);
+        _mm256_storeu_si256((__m256i *)buf, u);
+        memcpy(&r[i / 16 * 20], &buf[0], 10);
+        memcpy(&r[i / 16 * 20 + 10], &buf[16], 10);
+    }
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_decompress10_avx2
+*
+* Description: AVX2 version of the per-polynomial part of
+*              polyvec_decompress (d = 10).
+*              ((t*q) + 512) >> 10 is computed as mulhrs(t << 5, q).
+*
+* Arguments:   - int16_t r[256]: pointer to output polynomial
+*              - const uint8_t *a: pointer to input byte array (320 bytes)
+**************************************************/
+AVX2_TARGET void PQCLEAN_MLKEM768_CLEAN_poly_decompress10_avx2(int16_t r[KYBER_N], const uint8_t a[320]) {
+    unsigned int i;
+    uint8_t buf[32] = {0};
+    __m256i v;
+    const __m256i shuf = _mm256_setr_epi8(0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9,
+                                          0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9);
+    // shift the 10-bit field of each lane up to bits 6..15
+    const __m256i sh = _mm256_setr_epi16(64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1);
+
+    for (i = 0; i < KYBER_N; i += 16) {
+        memcpy(&buf[0], &a[i / 16 * 20], 10);
+        memcpy(&buf[16], &a[i / 16 * 20 + 10], 10);
+        v = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)buf), shuf);
+        v = _mm256_mullo_epi16(v, sh);
+        v = _mm256_srli_epi16(v, 6);
+        v = _mm256_mulhrs_epi16(_mm256_slli_epi16(v, 5), _mm256_set1_epi16(KYBER_Q));
+        _mm256_storeu_si256((__m256i *)&r[i], v);
+    }
+}
+
+/* Byte offsets of the accepted 16-bit lanes of a 128-bit vector: row m
+ * lists 2*i for each set bit i of m in ascending order, zero padded */
+static const uint8_t rej_idx[256][8] = {
+    { 0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0},
+    { 2,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  2,  0,  0,  0,  0,  0,  0},
+    { 4,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  4,  0,  0,  0,  0,  0,  0},
+    { 2,  4,  0,  0,  0,  0,  0,  0},
+    { 0,  2,  4,  0,  0,  0,  0,  0},
+    { 6,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  6,  0,  0,  0,  0,  0,  0},
+    { 2,  6,  0,  0,  0,  0,  0,  0},
+    { 0,  2,  6,  0,  0,  0,  0,  0},
+    { 4,  6,  0,  0,  0,  0,  0,  0},
+    { 0,  4,  6,  0,  0,  0,  0,  0},
+    { 2,  4,  6,  0,  0,  0,  0,  0},
+    { 0,  2,  4,  6,  0,  0,  0,  0},
+    { 8,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  8,  0,  0,  0,  0,  0,  0},
+    { 2,  8,  0,  0,  0,  0,  0,  0},
+    { 0,  2,  8,  0,  0,  0,  0,  0},
+    { 4,  8,  0,  0,  0,  0,  0,  0},
+    { 0,  4,  8,  0,  0,  0,  0,  0},
+    { 2,  4,  8,  0,  0,  0,  0,  0},
+    { 0,  2,  4,  8,  0,  0,  0,  0},
+    { 6,  8,  0,  0,  0,  0,  0,  0},
+    { 0,  6,  8,  0,  0,  0,  0,  0},
+    { 2,  6,  8,  0,  0,  0,  0,  0},
+    { 0,  2,  6,  8,  0,  0,  0,  0},
+    { 4,  6,  8,  0,  0,  0,  0,  0},
+    { 0,  4,  6,  8,  0,  0,  0,  0},
+    { 2,  4,  6,  8,  0,  0,  0,  0},
+    { 0,  2,  4,  6,  8,  0,  0,  0},
+    {10,  0,  0,  0,  0,  0,  0,  0},
+    { 0, 10,  0,  0,  0,  0,  0,  0},
+    { 2, 10,  0,  0,  0,  0,  0,  0},
+    { 0,  2, 10,  0,  0,  0,  0,  0},
+    { 4, 10,  0,  0,  0,  0,  0,  0},
+    { 0,  4, 10,  0,  0,  0,  0,  0},
+    { 2,  4, 10,  0,  0,  0,  0,  0},
+    { 0,  2,  4, 10,  0,  0,  0,  0},
+    { 6, 10,  0,  0,  0,  0,  0,  0},
+    { 0,  6, 10,  0,  0,  0,  0,  0},
+    { 2,  6, 10,  0,  0,  0,  0,  0},
+    { 0,  2,  6, 10,  0,  0,  0,  0},
+    { 4,  6, 10,  0,  0,  0,  0,  0},
+    { 0,  4,  6, 10,  0,  0,  0,  0},
+    { 2,  4,  6, 10,  0,  0,  0,  0},
+    { 0,  2,  4,  6, 10,  0,  0,  0},
+    { 8, 10,  0,  0,  0,  0,  0,  0},
+    { 0,  8, 10,  0,  0,  0,  0,  0},
+    { 2,  8, 10,  0,  0,  0,  0,  0},
+    { 0,  2,  8, 10,  0,  0,  0,  0},
+    { 4,  8, 10,  0,  0,  0,  0,  0},
+    { 0,  4,  8, 10,  0,  0,  0,  0},
+    { 2,  4,  8, 10,  0,  0,  0,  0},
+    { 0,  2,  4,  8, 10,  0,  0,  0},
+    { 6,  8, 10,  0,  0,  0,  0,  0},
+    { 0,  6,  8, 10,  0,  0,  0,  0},
+    { 2,  6,  8, 10,  0,  0,  0,  0},
+    { 0,  2,  6,  8, 10,  0,  0,  0},
+    { 4,  6,  8, 10,  0,  0,  0,  0},
+    { 0,  4,  6,  8, 10,  0,  0,  0},
+    { 2,  4,  6,  8, 10,  0,  0,  0},
+    { 0,  2,  4,  6,  8, 10,  0,  0},
+    {12,  0,  0,  0,  0,  0,  0,  0},
+    { 0, 12,  0,  0,  0,  0,  0,  0},
+    { 2, 12,  0,  0,  0,  0,  0,  0},
+    { 0,  2, 12,  0,  0,  0,  0,  0},
+    { 4, 12,  0,  0,  0,  0,  0,  0},
+    { 0,  4, 12,  0,  0,  0,  0,  0},
+    { 2,  4, 12,  0,  0,  0,  0,  0},
+    { 0,  2,  4, 12,  0,  0,  0,  0},
+    { 6, 12,  0,  0,  0,  0,  0,  0},
+    { 0,  6, 12,  0,  0,  0,  0,  0},
+    { 2,  6, 12,  0,  0,  0,  0,  0},
+    { 0,  2,  6, 12,  0,  0,  0,  0},
+    { 4,  6, 12,  0,  0,  0,  0,  0},
+    { 0,  4,  6, 12,  0,  0,  0,  0},
+    { 2,  4,  6, 12,  0,  0,  0,  0},
+    { 0,  2,  4,  6, 12,  0,  0,  0},
+    { 8, 12,  0,  0,  0,  0,  0,  0},
+    { 0,  8, 12,  0,  0,  0,  0,  0},
+    { 2,  8, 12,  0,  0,  0,  0,  0},
+    { 0,  2,  8, 12,  0,  0,  0,  0},
+    { 4,  8, 12,  0,  0,  0,  0,  0},
+    { 0,  4,  8, 12,  0,  0,  0,  0},
+    { 2,  4,  8, 12,  0,  0,  0,  0},
+    { 0,  2,  4,  8, 12,  0,  0,  0},
+    { 6,  8, 12,  0,  0,  0,  0,  0},
+    { 0,  6,  8, 12,  0,  0,  0,  0},
+    { 2,  6,  8, 12,  0,  0,  0,  0},
+    { 0,  2,  6,  8, 12,  0,  0,  0},
+    { 4,  6,  8, 12,  0,  0,  0,  0},
+    { 0,  4,  6,  8, 12,  0,  0,  0},
+    { 2,  4,  6,  8, 12,  0,  0,  0},
+    { 0,  2,  4,  6,  8, 12,  0,  0},
+    {10, 12,  0,  0,  0,  0,  0,  0},
+    { 0, 10, 12,  0,  0,  0,  0,  0},
+    { 2, 10, 12,  0,  0,  0,  0,  0},
+    { 0,  2, 10, 12,  0,  0,  0,  0},
+    { 4, 10, 12,  0,  0,  0,  0,  0},
+    { 0,  4, 10, 12,  0,  0,  0,  0},
+    { 2,  4, 10, 12,  0,  0,  0,  0},
+    { 0,  2,  4, 10, 12,  0,  0,  0},
+    { 6, 10, 12,  0,  0,  0,  0,  0},
+    { 0,  6, 10, 12,  0,  0,  0,  0},
+    { 2,  6, 10, 12,  0,  0,  0,  0},
+    { 0,  2,  6, 10, 12,  0,  0,  0},
+    { 4,  6, 10, 12,  0,  0,  0,  0},
+    { 0,  4,  6, 10, 12,  0,  0,  0},
+    { 2,  4,  6, 10, 12,  0,  0,  0},
+    { 0,  2,  4,  6, 10, 12,  0,  0},
+    { 8, 10, 12,  0,  0,  0,  0,  0},
+    { 0,  8, 10, 12,  0,  0,  0,  0},
+    { 2,  8, 10, 12,  0,  0,  0,  0},
+    { 0,  2,  8, 10, 12,  0,  0,  0},
+    { 4,  8, 10, 12,  0,  0,  0,  0},
+    { 0,  4,  8, 10, 12,  0,  0,  0},
+    { 2,  4,  8, 10, 12,  0,  0,  0},
+    { 0,  2,  4,  8, 10, 12,  0,  0},
+    { 6,  8, 10, 12,  0,  0,  0,  0},
+    { 0,  6,  8, 10, 12,  0,  0,  0},
+    { 2,  6,  8, 10, 12,  0,  0,  0},
+    { 0,  2,  6,  8, 10, 12,  0,  0},
+    { 4,  6,  8, 10, 12,  0,  0,  0},
+    { 0,  4,  6,  8, 10, 12,  0,  0},
+    { 2,  4,  6,  8, 10, 12,  0,  0},
+    { 0,  2,  4,  6,  8, 10, 12,  0},
+    {14,  0,  0,  0,  0,  0,  0,  0},
+    { 0, 14,  0,  0,  0,  0,  0,  0},
+    { 2, 14,  0,  0,  0,  0,  0,  0},
+    { 0,  2, 14,  0,  0,  0,  0,  0},
+    { 4, 14,  0,  0,  0,  0,  0,  0},
+    { 0,  4, 14,  0,  0,  0,  0,  0},
+    { 2,  4, 14,  0,  0,  0,  0,  0},
+    { 0,  2,  4, 14,  0,  0,  0,  0},
+    { 6, 14,  0,  0,  0,  0,  0,  0},
+    { 0,  6, 14,  0,  0,  0,  0,  0},
+    { 2,  6, 14,  0,  0,  0,  0,  0},
+    { 0,  2,  6, 14,  0,  0,  0,  0},
+    { 4,  6, 14,  0,  0,  0,  0,  0},
+    { 0,  4,  6, 14,  0,  0,  0,  0},
+    { 2,  4,  6, 14,  0,  0,  0,  0},
+    { 0,  2,  4,  6, 14,  0,  0,  0},
+    { 8, 14,  0,  0,  0,  0,  0,  0},
+    { 0,  8, 14,  0,  0,  0,  0,  0},
+    { 2,  8, 14,  0,  0,  0,  0,  0},
+    { 0,  2,  8, 14,  0,  0,  0,  0},
+    { 4,  8, 14,  0,  0,  0,  0,  0},
+    { 0,  4,  8, 14,  0,  0,  0,  0},
+    { 2,  4,  8, 14,  0,  0,  0,  0},
+    { 0,  2,  4,  8, 14,  0,  0,  0},
+    { 6,  8, 14,  0,  0,  0,  0,  0},
+    { 0,  6,  8, 14,  0,  0,  0,  0},
+    { 2,  6,  8, 14,  0,  0,  0,  0},
+    { 0,  2,  6,  8, 14,  0,  0,  0},
+    { 4,  6,  8, 14,  0,  0,  0,  0},
+    { 0,  4,  6,  8, 14,  0,  0,  0},
+    { 2,  4,  6,  8, 14,  0,  0,  0},
+    { 0,  2,  4,  6,  8, 14,  0,  0},
+    {10, 14,  0,  0,  0,  0,  0,  0},
+    { 0, 10, 14,  0,  0,  0,  0,  0},
+    { 2, 10, 14,  0,  0,  0,  0,  0},
+    { 0,  2, 10, 14,  0,  0,  0,  0},
+    { 4, 10, 14,  0,  0,  0,  0,  0},
+    { 0,  4, 10, 14,  0,  0,  0,  0},
+    { 2,  4, 10, 14,  0,  0,  0,  0},
+    { 0,  2,  4, 10, 14,  0,  0,  0},
+    { 6, 10, 14,  0,  0,  0,  0,  0},
+    { 0,  6, 10, 14,  0,  0,  0,  0},
+    { 2,  6, 10, 14,  0,  0,  0,  0},
+    { 0,  2,  6, 10, 14,  0,  0,  0},
+    { 4,  6, 10, 14,  0,  0,  0,  0},
+    { 0,  4,  6, 10, 14,  0,  0,  0},
+    { 2,  4,  6, 10, 14,  0,  0,  0},
+    { 0,  2,  4,  6, 10, 14,  0,  0},
+    { 8, 10, 14,  0,  0,  0,  0,  0},
+    { 0,  8, 10, 14,  0,  0,  0,  0},
+    { 2,  8, 10, 14,  0,  0,  0,  0},
+    { 0,  2,  8, 10, 14,  0,  0,  0},
+    { 4,  8, 10, 14,  0,  0,  0,  0},
+    { 0,  4,  8, 10, 14,  0,  0,  0},
+    { 2,  4,  8, 10, 14,  0,  0,  0},
+    { 0,  2,  4,  8, 10, 14,  0,  0},
+    { 6,  8, 10, 14,  0,  0,  0,  0},
+    { 0,  6,  8, 10, 14,  0,  0,  0},
+    { 2,  6,  8, 10, 14,  0,  0,  0},
+    { 0,  2,  6,  8, 10, 14,  0,  0},
+    { 4,  6,  8, 10, 14,  0,  0,  0},
+    { 0,  4,  6,  8, 10, 14,  0,  0},
+    { 2,  4,  6,  8, 10, 14,  0,  0},
+    { 0,  2,  4,  6,  8, 10, 14,  0},
+    {12, 14,  0,  0,  0,  0,  0,  0},
+    { 0, 12, 14,  0,  0,  0,  0,  0},
+    { 2, 12, 14,  0,  0,  0,  0,  0},
+    { 0,  2, 12, 14,  0,  0,  0,  0},
+    { 4, 12, 14,  0,  0,  0,  0,  0},
+    { 0,  4, 12, 14,  0,  0,  0,  0},
+    { 2,  4, 12, 14,  0,  0,  0,  0},
+    { 0,  2,  4, 12, 14,  0,  0,  0},
+    { 6, 12, 14,  0,  0,  0,  0,  0},
+    { 0,  6, 12, 14,  0,  0,  0,  0},
+    { 2,  6, 12, 14,  0,  0,  0,  0},
+    { 0,  2,  6, 12, 14,  0,  0,  0},
+    { 4,  6, 12, 14,  0,  0,  0,  0},
+    { 0,  4,  6, 12, 14,  0,  0,  0},
+    { 2,  4,  6, 12, 14,  0,  0,  0},
+    { 0,  2,  4,  6, 12, 14,  0,  0},
+    { 8, 12, 14,  0,  0,  0,  0,  0},
+    { 0,  8, 12, 14,  0,  0,  0,  0},
+    { 2,  8, 12, 14,  0,  0,  0,  0},
+    { 0,  2,  8, 12, 14,  0,  0,  0},
+    { 4,  8, 12, 14,  0,  0,  0,  0},
+    { 0,  4,  8, 12, 14,  0,  0,  0},
+    { 2,  4,  8, 12, 14,  0,  0,  0},
+    { 0,  2,  4,  8, 12, 14,  0,  0},
+    { 6,  8, 12, 14,  0,  0,  0,  0},
+    { 0,  6,  8, 12, 14,  0,  0,  0},
+    { 2,  6,  8, 12, 14,  0,  0,  0},
+    { 0,  2,  6,  8, 12, 14,  0,  0},
+    { 4,  6,  8, 12, 14,  0,  0,  0},
+    { 0,  4,  6,  8, 12, 14,  0,  0},
+    { 2,  4,  6,  8, 12, 14,  0,  0},
+    { 0,  2,  4,  6,  8, 12, 14,  0},
+    {10, 12, 14,  0,  0,  0,  0,  0},
+    { 0, 10, 12, 14,  0,  0,  0,  0},
+    { 2, 10, 12, 14,  0,  0,  0,  0},
+    { 0,  2, 10, 12, 14,  0,  0,  0},
+    { 4, 10, 12, 14,  0,  0,  0,  0},
+    { 0,  4, 10, 12, 14,  0,  0,  0},
+    { 2,  4, 10, 12, 14,  0,  0,  0},
+    { 0,  2,  4, 10, 12, 14,  0,  0},
+    { 6, 10, 12, 14,  0,  0,  0,  0},
+    { 0,  6, 10, 12, 14,  0,  0,  0},
+    { 2,  6, 10, 12, 14,  0,  0,  0},
+    { 0,  2,  6, 10, 12, 14,  0,  0},
+    { 4,  6, 10, 12, 14,  0,  0,  0},
+    { 0,  4,  6, 10, 12, 14,  0,  0},
+    { 2,  4,  6, 10, 12, 14,  0,  0},
+    { 0,  2,  4,  6, 10, 12, 14,  0},
+    { 8, 10, 12, 14,  0,  0,  0,  0},
+    { 0,  8, 10, 12, 14,  0,  0,  0},
+    { 2,  8, 10, 12, 14,  0,  0,  0},
+    { 0,  2,  8, 10, 12, 14,  0,  0},
+    { 4,  8, 10, 12, 14,  0,  0,  0},
+    { 0,  4,  8, 10, 12, 14,  0,  0},
+    { 2,  4,  8, 10, 12, 14,  0,  0},
+    { 0,  2,  4,  8, 10, 12, 14,  0},
+    { 6,  8, 10, 12, 14,  0,  0,  0},
+    { 0,  6,  8, 10, 12, 14,  0,  0},
+    { 2,  6,  8, 10, 12, 14,  0,  0},
+    { 0,  2,  6,  8, 10, 12, 14,  0},
+    { 4,  6,  8, 10, 12, 14,  0,  0},
+    { 0,  4,  6,  8, 10, 12, 14,  0},
+    { 2,  4,  6,  8, 10, 12, 14,  0},
+    { 0,  2,  4,  6,  8, 10, 12, 14}
+};
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_rej_uniform_avx2
+*
+* Description: AVX2 prefix of rej_uniform. Each step expands 24 bytes to
+*              16 candidates, compares them against q and compacts the
+*              accepted ones with a byte shuffle, emitting up to 16
+*              coefficients. Stops while at least 16 outputs are still
+*              missing and 32 input bytes remain, so that all loads and
+*              stores stay in bounds; the caller finishes with the scalar
+*              loop from *pos. The accepted values and their order are the
+*              same as in the scalar loop.
+*
+* Arguments:   - int16_t *r: pointer to output buffer
+*              - unsigned int len: requested number of 16-bit integers
+*              - const uint8_t *buf: pointer to input buffer
+*              - unsigned int buflen: length of input buffer in bytes
+*              - unsigned int *pos: set to the number of bytes consumed
+*
+* Returns number of sampled 16-bit integers
+**************************************************/
+__attribute__((target("avx2,popcnt")))
+unsigned int PQCLEAN_MLKEM768_CLEAN_rej_uniform_avx2(int16_t *r, unsigned int len,
+        const uint8_t *buf, unsigned int buflen, unsigned int *pos) {
+    unsigned int ctr = 0, p = 0, good;
+    __m256i f, g;
+    __m128i i0, i1;
+    const __m256i bound = _mm256_set1_epi16(KYBER_Q);
+    const __m256i mask = _mm256_set1_epi16(0xFFF);
+    // bytes 3k, 3k+1 and 3k+1, 3k+2 of each 12-byte half into lanes 2k, 2k+1
+    const __m256i shuf = _mm256_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11,
+                                          4, 5, 5, 6, 7, 8, 8, 9, 10, 11, 11, 12, 13, 14, 14, 15);
+    const __m128i ones = _mm_set1_epi8(1);
+
+    while (ctr + 16 <= len && p + 32 <= buflen) {
+        f = _mm256_loadu_si256((const __m256i *)&buf[p]);
+        f = _mm256_permute4x64_epi64(f, 0x94);
+        f = _mm256_shuffle_epi8(f, shuf);
+        g = _mm256_srli_epi16(f, 4);
+        f = _mm256_blend_epi16(f, g, 0xAA);
+        f = _mm256_and_si256(f, mask);
+        p += 24;
+
+        g = _mm256_cmpgt_epi16(bound, f);
+        g = _mm256_packs_epi16(g, g);
+        good = (unsigned int)_mm256_movemask_epi8(g);
+
+        i0 = _mm_loadl_epi64((const __m128i *)rej_idx[good & 0xFF]);
+        i1 = _mm_loadl_epi64((const __m128i *)rej_idx[(good >> 16) & 0xFF]);
+        i0 = _mm_unpacklo_epi8(i0, _mm_add_epi8(i0, ones));
+        i1 = _mm_unpacklo_epi8(i1, _mm_add_epi8(i1, ones));
+
+        _mm_storeu_si128((__m128i *)&r[ctr], _mm_shuffle_epi8(_mm256_castsi256_si128(f), i0));
+        ctr += (unsigned int)_mm_popcnt_u32(good & 0xFF);
+        _mm_storeu_si128((__m128i *)&r[ctr], _mm_shuffle_epi8(_mm256_extracti128_si256(f, 1), i1));
+        ctr += (unsigned int)_mm_popcnt_u32((good >> 16) & 0xFF);
+    }
+
+    *pos = p;
+    return ctr;
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_poly_cbd2_avx2
+*
+* Description: AVX2 version of poly_cbd2. Every nibble of the input turns
+*              into one coefficient: the bit pairs are summed, a - b + 3 is
+*              formed per nibble without borrows, and the nibbles are
+*              widened to 16-bit lanes in coefficient order.
+*
+* Arguments:   - int16_t r[256]: pointer to output polynomial
+*              - const uint8_t *buf: pointer to input byte array (128 bytes)
+**************************************************/
+AVX2_TARGET void PQCLEAN_MLKEM768_CLEAN_poly_cbd2_avx2(int16_t r[KYBER_N], const uint8_t buf[2 * KYBER_N / 4]) {
+    unsigned int i;
+    __m256i f0, f1, f2, f3;
+    const __m256i mask55 = _mm256_set1_epi32(0x55555555);
+    const __m256i mask33 = _mm256_set1_epi32(0x33333333);
+    const __m256i mask03 = _mm256_set1_epi32(0x03030303);
+    const __m256i mask0F = _mm256_set1_epi32(0x0F0F0F0F);
+
+    for (i = 0; i < KYBER_N / 64; i++) {
+        f0 = _mm256_loadu_si256((const __m256i *)&buf[32 * i]);
+
+        f1 = _mm256_srli_epi16(f0, 1);
+        f0 = _mm256_and_si256(mask55, f0);
+        f1 = _mm256_and_si256(mask55, f1);
+        f0 = _mm256_add_epi8(f0, f1);
+
+        f1 = _mm256_srli_epi16(f0, 2);
+        f0 = _mm256_and_si256(mask33, f0);
+        f1 = _mm256_and_si256(mask33, f1);
+        f0 = _mm256_add_epi8(f0, mask33);
+        f0 = _mm256_sub_epi8(f0, f1);
+
+        f1 = _mm256_srli_epi16(f0, 4);
+        f0 = _mm256_and_si256(mask0F, f0);
+        f1 = _mm256_and_si256(mask0F, f1);
+        f0 = _mm256_sub_epi8(f0, mask03);
+        f1 = _mm256_sub_epi8(f1, mask03);
+
+        // byte b holds coefficients 2b (f0) and 2b+1 (f1)
+        f2 = _mm256_unpacklo_epi8(f0, f1);
+        f3 = _mm256_unpackhi_epi8(f0, f1);
+
+        _mm256_storeu_si256((__m256i *)&r[64 * i +  0], _mm256_cvtepi8_epi16(_mm256_castsi256_si128(f2)));
+        _mm256_storeu_si256((__m256i *)&r[64 * i + 16], _mm256_cvtepi8_epi16(_mm256_castsi256_si128(f3)));
+        _mm256_storeu_si256((__m256i *)&r[64 * i + 32], _mm256_cvtepi8_epi16(_mm256_extracti128_si256(f2, 1)));
+        _mm256_storeu_si256((__m256i *)&r[64 * i + 48], _mm256_cvtepi8_epi16(_mm256_extracti128_si256(f3, 1)));
+    }
+}
+#endif
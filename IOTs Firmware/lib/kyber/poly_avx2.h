@@ -0,0 +1,41 @@
+#ifndef PQCLEAN_MLKEM768_CLEAN_POLY_AVX2_H
+#define PQCLEAN_MLKEM768_CLEAN_POLY_AVX2_H
+#include "params.h"
+#include "poly.h"
+#include <stdint.h>
+
+/*
+ * AVX2 versions of the polynomial arithmetic, selected per process at run
+ * time. The kernels are compiled with a function-level target attribute, so
+ * the rest of the library (and the binary as a whole) does not need -mavx2
+ * and still runs on CPUs without AVX2. Every kernel produces exactly the
+ * same coefficients and bytes as the clean code it replaces.
+ *
+ * Define KYBER_NO_AVX2 to build without the backend.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) && !defined(KYBER_NO_AVX2)
+#define KYBER_AVX2_DISPATCH
+
+int PQCLEAN_MLKEM768_CLEAN_have_avx2(void);
+
+void PQCLEAN_MLKEM768_CLEAN_ntt_avx2(int16_t r[KYBER_N]);
+void PQCLEAN_MLKEM768_CLEAN_invntt_avx2(int16_t r[KYBER_N]);
+void PQCLEAN_MLKEM768_CLEAN_basemul_montgomery_avx2(int16_t r[KYBER_N], const int16_t a[KYBER_N], const int16_t b[KYBER_N]);
+void PQCLEAN_MLKEM768_CLEAN_poly_mulcache_compute_avx2(int16_t r[KYBER_N / 2], const int16_t a[KYBER_N]);
+void PQCLEAN_MLKEM768_CLEAN_basemul_acc_cached_avx2(int16_t r[KYBER_N], const poly *a, const poly *b,
+        const poly_mulcache *b_cache, unsigned int k);
+
+void PQCLEAN_MLKEM768_CLEAN_poly_reduce_avx2(int16_t r[KYBER_N]);
+void PQCLEAN_MLKEM768_CLEAN_poly_tomont_avx2(int16_t r[KYBER_N]);
+
+void PQCLEAN_MLKEM768_CLEAN_poly_compress4_avx2(uint8_t r[128], const int16_t a[KYBER_N]);
+void PQCLEAN_MLKEM768_CLEAN_poly_decompress4_avx2(int16_t r[KYBER_N], const uint8_t a[128]);
+void PQCLEAN_MLKEM768_CLEAN_poly_compress10_avx2(uint8_t r[320], const int16_t a[KYBER_N]);
+void PQCLEAN_MLKEM768_CLEAN_poly_decompress10_avx2(int16_t r[KYBER_N], const uint8_t a[320]);
+
+unsigned int PQCLEAN_MLKEM768_CLEAN_rej_uniform_avx2(int16_t *r, unsigned int len,
+        const uint8_t *buf, unsigned int buflen, unsigned int *pos);
+void PQCLEAN_MLKEM768_CLEAN_poly_cbd2_avx2(int16_t r[KYBER_N], const uint8_t buf[2 * KYBER_N / 4]);
+#endif
+
+#endif
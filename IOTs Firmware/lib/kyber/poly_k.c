@@ -0,0 +1,326 @@
+#include "cbd.h"
+#include "ntt.h"
+#include "params.h"
+#include "poly.h"
+#include "poly_avx2.h"
+#include "reduce.h"
+#include "symmetric.h"
+#include <stdint.h>
+
+/*
+ * The polynomial functions whose encoding or noise distribution depends on
+ * the parameter set. This file is compiled once per set, the rest of poly.c
+ * is shared.
+ */
+
+/*************************************************
+* Name:        poly_compress
+*
+* Description: Compression and subsequent serialization of a polynomial
+*              with d_v bits per coefficient (4, or 5 for ML-KEM-1024)
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (of length KYBER_POLYCOMPRESSEDBYTES)
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void KYBER_NAMESPACE(poly_compress)(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const poly *a) {
+#if (KYBER_POLYCOMPRESSEDBYTES == 128)
+    PQCLEAN_MLKEM768_CLEAN_poly_compress_d4(r, a);
+#elif (KYBER_POLYCOMPRESSEDBYTES == 160)
+    PQCLEAN_MLKEM768_CLEAN_poly_compress_d5(r, a);
+#else
+#error "KYBER_POLYCOMPRESSEDBYTES needs to be in {128, 160}"
+#endif
+}
+
+/*************************************************
+* Name:        poly_decompress
+*
+* Description: De-serialization and subsequent decompression of a polynomial;
+*              approximate inverse of poly_compress
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *a: pointer to input byte array
+*                                  (of length KYBER_POLYCOMPRESSEDBYTES bytes)
+**************************************************/
+void KYBER_NAMESPACE(poly_decompress)(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES]) {
+#if (KYBER_POLYCOMPRESSEDBYTES == 128)
+    PQCLEAN_MLKEM768_CLEAN_poly_decompress_d4(r, a);
+#elif (KYBER_POLYCOMPRESSEDBYTES == 160)
+    PQCLEAN_MLKEM768_CLEAN_poly_decompress_d5(r, a);
+#else
+#error "KYBER_POLYCOMPRESSEDBYTES needs to be in {128, 160}"
+#endif
+}
+
+#if (KYBER_POLYCOMPRESSEDBYTES == 128)
+/*************************************************
+* Name:        compress_dv_row
+*
+* Description: poly_compress of eight consecutive coefficients
+*
+* Arguments:   - uint8_t *r: pointer to output byte array (4 bytes)
+*              - const int16_t *a: pointer to input coefficients
+**************************************************/
+static void compress_dv_row(uint8_t r[4], const int16_t a[8]) {
+    unsigned int j;
+    int16_t u;
+    uint32_t d0;
+    uint8_t t[8];
+
+    for (j = 0; j < 8; j++) {
+        u  = a[j];
+        u += (u >> 15) & KYBER_Q;
+        d0 = u << 4;
+        d0 += 1665;
+        d0 *= 80635;
+        d0 >>= 28;
+        t[j] = d0 & 0xf;
+    }
+
+    r[0] = t[0] | (t[1] << 4);
+    r[1] = t[2] | (t[3] << 4);
+    r[2] = t[4] | (t[5] << 4);
+    r[3] = t[6] | (t[7] << 4);
+}
+
+/*************************************************
+* Name:        decompress_dv_row
+*
+* Description: poly_decompress of eight consecutive coefficients
+*
+* Arguments:   - int16_t *r: pointer to output coefficients
+*              - const uint8_t *a: pointer to input byte array (4 bytes)
+**************************************************/
+static void decompress_dv_row(int16_t r[8], const uint8_t a[4]) {
+    unsigned int i;
+
+    for (i = 0; i < 4; i++) {
+        r[2 * i + 0] = (((uint16_t)(a[i] & 15) * KYBER_Q) + 8) >> 4;
+        r[2 * i + 1] = (((uint16_t)(a[i] >> 4) * KYBER_Q) + 8) >> 4;
+    }
+}
+#else
+/*************************************************
+* Name:        compress_dv_row
+*
+* Description: poly_compress of eight consecutive coefficients
+*
+* Arguments:   - uint8_t *r: pointer to output byte array (5 bytes)
+*              - const int16_t *a: pointer to input coefficients
+**************************************************/
+static void compress_dv_row(uint8_t r[5], const int16_t a[8]) {
+    unsigned int j;
+    int16_t u;
+    uint32_t d0;
+    uint8_t t[8];
+
+    for (j = 0; j < 8; j++) {
+        u  = a[j];
+        u += (u >> 15) & KYBER_Q;
+        d0 = u << 5;
+        d0 += 1664;
+        d0 *= 40318;
+        d0 >>= 27;
+        t[j] = d0 & 0x1f;
+    }
+
+    r[0] = (t[0] >> 0) | (t[1] << 5);
+    r[1] = (t[1] >> 3) | (t[2] << 2) | (t[3] << 7);
+    r[2] = (t[3] >> 1) | (t[4] << 4);
+    r[3] = (t[4] >> 4) | (t[5] << 1) | (t[6] << 6);
+    r[4] = (t[6] >> 2) | (t[7] << 3);
+}
+
+/*************************************************
+* Name:        decompress_dv_row
+*
+* Description: poly_decompress of eight consecutive coefficients
+*
+* Arguments:   - int16_t *r: pointer to output coefficients
+*              - const uint8_t *a: pointer to input byte array (5 bytes)
+**************************************************/
+static void decompress_dv_row(int16_t r[8], const uint8_t a[5]) {
+    unsigned int j;
+    uint8_t t[8];
+
+    t[0] = (a[0] >> 0);
+    t[1] = (a[0] >> 5) | (a[1] << 3);
+    t[2] = (a[1] >> 2);
+    t[3] = (a[1] >> 7) | (a[2] << 1);
+    t[4] = (a[2] >> 4) | (a[3] << 4);
+    t[5] = (a[3] >> 1);
+    t[6] = (a[3] >> 6) | (a[4] << 2);
+    t[7] = (a[4] >> 3);
+
+    for (j = 0; j < 8; j++) {
+        r[j] = ((uint32_t)(t[j] & 31) * KYBER_Q + 16) >> 5;
+    }
+}
+#endif
+
+/* Offset of coefficient n in the compressed polynomial */
+#define POLY_ROW(n) ((n) * KYBER_POLYCOMPRESSEDBYTES / KYBER_N)
+
+/*************************************************
+* Name:        poly_invntt_add_compress
+*
+* Description: Computes the compressed v of a ciphertext: same as
+*              poly_invntt_tomont of a, poly_add of e and of the message
+*              polynomial, poly_reduce and poly_compress, but each block
+*              of coefficients is finished and packed as soon as the last
+*              layers of the inverse transform produce it. The bytes are
+*              identical; a is used as scratch space.
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (of length KYBER_POLYCOMPRESSEDBYTES)
+*              - poly *a: pointer to input polynomial in NTT domain; clobbered
+*              - const poly *e: pointer to noise polynomial to add
+*              - const uint8_t *msg: pointer to message to add
+*                                    (of length KYBER_INDCPA_MSGBYTES)
+**************************************************/
+void KYBER_NAMESPACE(poly_invntt_add_compress)(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], poly *a, const poly *e,
+        const uint8_t msg[KYBER_INDCPA_MSGBYTES]) {
+    unsigned int j, k, c;
+    int16_t t[8][8];
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        poly m;
+        PQCLEAN_MLKEM768_CLEAN_poly_frommsg(&m, msg);
+        PQCLEAN_MLKEM768_CLEAN_poly_invntt_tomont(a);
+        PQCLEAN_MLKEM768_CLEAN_poly_add(a, a, e);
+        PQCLEAN_MLKEM768_CLEAN_poly_add(a, a, &m);
+        PQCLEAN_MLKEM768_CLEAN_poly_reduce(a);
+        KYBER_NAMESPACE(poly_compress)(r, a);
+        return;
+    }
+#endif
+
+    PQCLEAN_MLKEM768_CLEAN_invntt_head(a->coeffs);
+    for (j = 0; j < 32; j += 8) {
+        PQCLEAN_MLKEM768_CLEAN_invntt_tail(t, a->coeffs, j);
+        for (k = 0; k < 8; k++) {
+            const int16_t *ek = &e->coeffs[32 * k + j];
+            const uint8_t m = msg[(32 * k + j) / 8];
+            for (c = 0; c < 8; c++) {
+                int16_t mc = -(int16_t)((m >> c) & 1) & ((KYBER_Q + 1) / 2);
+                t[k][c] = PQCLEAN_MLKEM768_CLEAN_barrett_reduce(t[k][c] + ek[c] + mc);
+            }
+            compress_dv_row(&r[POLY_ROW(32 * k + j)], t[k]);
+        }
+    }
+}
+
+/*************************************************
+* Name:        poly_invntt_sub_tomsg
+*
+* Description: Recovers the message in decryption: same as
+*              poly_decompress of v, poly_invntt_tomont of a, poly_sub,
+*              poly_reduce and poly_tomsg, but v is decompressed and each
+*              block of coefficients is decoded as soon as the last layers
+*              of the inverse transform produce it. a is used as scratch space.
+*
+* Arguments:   - uint8_t *msg: pointer to output message
+*                              (of length KYBER_INDCPA_MSGBYTES)
+*              - poly *a: pointer to input polynomial in NTT domain; clobbered
+*              - const uint8_t *v: pointer to compressed polynomial v
+*                                  (of length KYBER_POLYCOMPRESSEDBYTES)
+**************************************************/
+void KYBER_NAMESPACE(poly_invntt_sub_tomsg)(uint8_t msg[KYBER_INDCPA_MSGBYTES], poly *a,
+        const uint8_t v[KYBER_POLYCOMPRESSEDBYTES]) {
+    unsigned int j, k, c;
+    int16_t t[8][8], w[8];
+    uint32_t d, m;
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        poly vp;
+        KYBER_NAMESPACE(poly_decompress)(&vp, v);
+        PQCLEAN_MLKEM768_CLEAN_poly_invntt_tomont(a);
+        PQCLEAN_MLKEM768_CLEAN_poly_sub(a, &vp, a);
+        PQCLEAN_MLKEM768_CLEAN_poly_reduce(a);
+        PQCLEAN_MLKEM768_CLEAN_poly_tomsg(msg, a);
+        return;
+    }
+#endif
+
+    PQCLEAN_MLKEM768_CLEAN_invntt_head(a->coeffs);
+    for (j = 0; j < 32; j += 8) {
+        PQCLEAN_MLKEM768_CLEAN_invntt_tail(t, a->coeffs, j);
+        for (k = 0; k < 8; k++) {
+            decompress_dv_row(w, &v[POLY_ROW(32 * k + j)]);
+            m = 0;
+            for (c = 0; c < 8; c++) {
+                d  = PQCLEAN_MLKEM768_CLEAN_barrett_reduce(w[c] - t[k][c]);
+                d <<= 1;
+                d += 1665;
+                d *= 80635;
+                d >>= 28;
+                d &= 1;
+                m |= d << c;
+            }
+            msg[(32 * k + j) / 8] = (uint8_t)m;
+        }
+    }
+}
+
+/*************************************************
+* Name:        poly_getnoise_eta1
+*
+* Description: Sample a polynomial deterministically from a seed and a nonce,
+*              with output polynomial close to centered binomial distribution
+*              with parameter KYBER_ETA1
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *seed: pointer to input seed
+*                                     (of length KYBER_SYMBYTES bytes)
+*              - uint8_t nonce: one-byte input nonce
+**************************************************/
+void KYBER_NAMESPACE(poly_getnoise_eta1)(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t nonce) {
+    uint8_t buf[KYBER_ETA1 * KYBER_N / 4];
+    prf(buf, sizeof(buf), seed, nonce);
+    poly_cbd_eta1(r, buf);
+}
+
+/*************************************************
+* Name:        poly_getnoise_eta1_4x
+*
+* Description: Sample four polynomials with parameter KYBER_ETA1 from the
+*              same seed and four different nonces; the output is identical
+*              to four calls of poly_getnoise_eta1
+*
+* Arguments:   - poly *r0..r3: pointers to output polynomials
+*              - const uint8_t *seed: pointer to input seed
+*                                     (of length KYBER_SYMBYTES bytes)
+*              - uint8_t nonce0..nonce3: one-byte input nonces
+**************************************************/
+void KYBER_NAMESPACE(poly_getnoise_eta1_4x)(poly *r0, poly *r1, poly *r2, poly *r3,
+        const uint8_t seed[KYBER_SYMBYTES],
+        uint8_t nonce0, uint8_t nonce1, uint8_t nonce2, uint8_t nonce3) {
+    uint8_t buf[4][KYBER_ETA1 * KYBER_N / 4];
+    prf_x4(buf[0], buf[1], buf[2], buf[3], sizeof(buf[0]), seed, nonce0, nonce1, nonce2, nonce3);
+    poly_cbd_eta1(r0, buf[0]);
+    poly_cbd_eta1(r1, buf[1]);
+    poly_cbd_eta1(r2, buf[2]);
+    poly_cbd_eta1(r3, buf[3]);
+}
+
+/*************************************************
+* Name:        poly_getnoise_eta1_2x
+*
+* Description: Two-way variant of poly_getnoise_eta1_4x
+*
+* Arguments:   - poly *r0, *r1: pointers to output polynomials
+*              - const uint8_t *seed: pointer to input seed
+*                                     (of length KYBER_SYMBYTES bytes)
+*              - uint8_t nonce0, nonce1: one-byte input nonces
+**************************************************/
+void KYBER_NAMESPACE(poly_getnoise_eta1_2x)(poly *r0, poly *r1,
+        const uint8_t seed[KYBER_SYMBYTES],
+        uint8_t nonce0, uint8_t nonce1) {
+    uint8_t buf[2][KYBER_ETA1 * KYBER_N / 4];
+    prf_x2(buf[0], buf[1], sizeof(buf[0]), seed, nonce0, nonce1);
+    poly_cbd_eta1(r0, buf[0]);
+    poly_cbd_eta1(r1, buf[1]);
+}
@@ -1,10 +1,13 @@
+#include "ntt.h"
 #include "params.h"
 #include "poly.h"
+#include "poly_avx2.h"
 #include "polyvec.h"
+#include "reduce.h"
 #include <stdint.h>
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_polyvec_compress
+* Name:        polyvec_compress
 *
 * Description: Compress and serialize vector of polynomials
 *
@@ -12,11 +15,52 @@
 *                            (needs space for KYBER_POLYVECCOMPRESSEDBYTES)
 *              - const polyvec *a: pointer to input vector of polynomials
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_polyvec_compress(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES], const polyvec *a) {
+void KYBER_NAMESPACE(polyvec_compress)(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES], const polyvec *a) {
     unsigned int i, j, k;
     uint64_t d0;
 
+#if (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 352))
+    uint16_t t[8];
+    for (i = 0; i < KYBER_K; i++) {
+        for (j = 0; j < KYBER_N / 8; j++) {
+            for (k = 0; k < 8; k++) {
+                t[k]  = a->vec[i].coeffs[8 * j + k];
+                t[k] += ((int16_t)t[k] >> 15) & KYBER_Q;
+                /*      t[k]  = ((((uint32_t)t[k] << 11) + KYBER_Q/2)/KYBER_Q) & 0x7ff; */
+                d0 = t[k];
+                d0 <<= 11;
+                d0 += 1664;
+                d0 *= 645084;
+                d0 >>= 31;
+                t[k] = d0 & 0x7ff;
+            }
+
+            r[ 0] = (uint8_t)(t[0] >>  0);
+            r[ 1] = (uint8_t)((t[0] >>  8) | (t[1] << 3));
+            r[ 2] = (uint8_t)((t[1] >>  5) | (t[2] << 6));
+            r[ 3] = (uint8_t)(t[2] >>  2);
+            r[ 4] = (uint8_t)((t[2] >> 10) | (t[3] << 1));
+            r[ 5] = (uint8_t)((t[3] >>  7) | (t[4] << 4));
+            r[ 6] = (uint8_t)((t[4] >>  4) | (t[5] << 7));
+            r[ 7] = (uint8_t)(t[5] >>  1);
+            r[ 8] = (uint8_t)((t[5] >>  9) | (t[6] << 2));
+            r[ 9] = (uint8_t)((t[6] >>  6) | (t[7] << 5));
+            r[10] = (uint8_t)(t[7] >>  3);
+            r += 11;
+        }
+    }
+#elif (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 320))
     uint16_t t[4];
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        for (i = 0; i < KYBER_K; i++) {
+            PQCLEAN_MLKEM768_CLEAN_poly_compress10_avx2(&r[i * (KYBER_POLYVECCOMPRESSEDBYTES / KYBER_K)], a->vec[i].coeffs);
+        }
+        return;
+    }
+#endif
+
     for (i = 0; i < KYBER_K; i++) {
         for (j = 0; j < KYBER_N / 4; j++) {
             for (k = 0; k < 4; k++) {
@@ -39,22 +83,55 @@ void PQCLEAN_MLKEM768_CLEAN_polyvec_compress(uint8_t r[KYBER_POLYVECCOMPRESSEDBY
             r += 5;
         }
     }
+#else
+#error "KYBER_POLYVECCOMPRESSEDBYTES needs to be in {320*KYBER_K, 352*KYBER_K}"
+#endif
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_polyvec_decompress
+* Name:        polyvec_decompress
 *
 * Description: De-serialize and decompress vector of polynomials;
-*              approximate inverse of PQCLEAN_MLKEM768_CLEAN_polyvec_compress
+*              approximate inverse of polyvec_compress
 *
 * Arguments:   - polyvec *r:       pointer to output vector of polynomials
 *              - const uint8_t *a: pointer to input byte array
 *                                  (of length KYBER_POLYVECCOMPRESSEDBYTES)
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_polyvec_decompress(polyvec *r, const uint8_t a[KYBER_POLYVECCOMPRESSEDBYTES]) {
+void KYBER_NAMESPACE(polyvec_decompress)(polyvec *r, const uint8_t a[KYBER_POLYVECCOMPRESSEDBYTES]) {
     unsigned int i, j, k;
 
+#if (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 352))
+    uint16_t t[8];
+    for (i = 0; i < KYBER_K; i++) {
+        for (j = 0; j < KYBER_N / 8; j++) {
+            t[0] = (a[0] >> 0) | ((uint16_t)a[ 1] << 8);
+            t[1] = (a[1] >> 3) | ((uint16_t)a[ 2] << 5);
+            t[2] = (a[2] >> 6) | ((uint16_t)a[ 3] << 2) | ((uint16_t)a[4] << 10);
+            t[3] = (a[4] >> 1) | ((uint16_t)a[ 5] << 7);
+            t[4] = (a[5] >> 4) | ((uint16_t)a[ 6] << 4);
+            t[5] = (a[6] >> 7) | ((uint16_t)a[ 7] << 1) | ((uint16_t)a[8] << 9);
+            t[6] = (a[8] >> 2) | ((uint16_t)a[ 9] << 6);
+            t[7] = (a[9] >> 5) | ((uint16_t)a[10] << 3);
+            a += 11;
+
+            for (k = 0; k < 8; k++) {
+                r->vec[i].coeffs[8 * j + k] = ((uint32_t)(t[k] & 0x7FF) * KYBER_Q + 1024) >> 11;
+            }
+        }
+    }
+#elif (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 320))
     uint16_t t[4];
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        for (i = 0; i < KYBER_K; i++) {
+            PQCLEAN_MLKEM768_CLEAN_poly_decompress10_avx2(r->vec[i].coeffs, &a[i * (KYBER_POLYVECCOMPRESSEDBYTES / KYBER_K)]);
+        }
+        return;
+    }
+#endif
+
     for (i = 0; i < KYBER_K; i++) {
         for (j = 0; j < KYBER_N / 4; j++) {
             t[0] = (a[0] >> 0) | ((uint16_t)a[1] << 8);
@@ -68,10 +145,257 @@ void PQCLEAN_MLKEM768_CLEAN_polyvec_decompress(polyvec *r, const uint8_t a[KYBER
             }
         }
     }
+#else
+#error "KYBER_POLYVECCOMPRESSEDBYTES needs to be in {320*KYBER_K, 352*KYBER_K}"
+#endif
+}
+
+#if (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 352))
+/*************************************************
+* Name:        compress_du_row
+*
+* Description: polyvec_compress of eight consecutive coefficients
+*
+* Arguments:   - uint8_t *r: pointer to output byte array (11 bytes)
+*              - const int16_t *a: pointer to input coefficients
+**************************************************/
+static void compress_du_row(uint8_t r[11], const int16_t a[8]) {
+    unsigned int k;
+    uint64_t d0;
+    uint16_t t[8];
+
+    for (k = 0; k < 8; k++) {
+        t[k]  = a[k];
+        t[k] += ((int16_t)t[k] >> 15) & KYBER_Q;
+        d0 = t[k];
+        d0 <<= 11;
+        d0 += 1664;
+        d0 *= 645084;
+        d0 >>= 31;
+        t[k] = d0 & 0x7ff;
+    }
+
+    r[ 0] = (uint8_t)(t[0] >>  0);
+    r[ 1] = (uint8_t)((t[0] >>  8) | (t[1] << 3));
+    r[ 2] = (uint8_t)((t[1] >>  5) | (t[2] << 6));
+    r[ 3] = (uint8_t)(t[2] >>  2);
+    r[ 4] = (uint8_t)((t[2] >> 10) | (t[3] << 1));
+    r[ 5] = (uint8_t)((t[3] >>  7) | (t[4] << 4));
+    r[ 6] = (uint8_t)((t[4] >>  4) | (t[5] << 7));
+    r[ 7] = (uint8_t)(t[5] >>  1);
+    r[ 8] = (uint8_t)((t[5] >>  9) | (t[6] << 2));
+    r[ 9] = (uint8_t)((t[6] >>  6) | (t[7] << 5));
+    r[10] = (uint8_t)(t[7] >>  3);
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_polyvec_tobytes
+* Name:        decompress_du_row
+*
+* Description: polyvec_decompress of eight consecutive coefficients
+*
+* Arguments:   - int16_t *r: pointer to output coefficients
+*              - const uint8_t *a: pointer to input byte array (11 bytes)
+**************************************************/
+static void decompress_du_row(int16_t r[8], const uint8_t a[11]) {
+    unsigned int k;
+    uint16_t t[8];
+
+    t[0] = (a[0] >> 0) | ((uint16_t)a[ 1] << 8);
+    t[1] = (a[1] >> 3) | ((uint16_t)a[ 2] << 5);
+    t[2] = (a[2] >> 6) | ((uint16_t)a[ 3] << 2) | ((uint16_t)a[4] << 10);
+    t[3] = (a[4] >> 1) | ((uint16_t)a[ 5] << 7);
+    t[4] = (a[5] >> 4) | ((uint16_t)a[ 6] << 4);
+    t[5] = (a[6] >> 7) | ((uint16_t)a[ 7] << 1) | ((uint16_t)a[8] << 9);
+    t[6] = (a[8] >> 2) | ((uint16_t)a[ 9] << 6);
+    t[7] = (a[9] >> 5) | ((uint16_t)a[10] << 3);
+
+    for (k = 0; k < 8; k++) {
+        r[k] = ((uint32_t)(t[k] & 0x7FF) * KYBER_Q + 1024) >> 11;
+    }
+}
+#else
+/*************************************************
+* Name:        compress_du_row
+*
+* Description: polyvec_compress of eight consecutive coefficients
+*
+* Arguments:   - uint8_t *r: pointer to output byte array (10 bytes)
+*              - const int16_t *a: pointer to input coefficients
+**************************************************/
+static void compress_du_row(uint8_t r[10], const int16_t a[8]) {
+    unsigned int k;
+    uint64_t d0;
+    uint16_t t[8];
+
+    for (k = 0; k < 8; k++) {
+        t[k]  = a[k];
+        t[k] += ((int16_t)t[k] >> 15) & KYBER_Q;
+        d0 = t[k];
+        d0 <<= 10;
+        d0 += 1665;
+        d0 *= 1290167;
+        d0 >>= 32;
+        t[k] = d0 & 0x3ff;
+    }
+
+    for (k = 0; k < 8; k += 4) {
+        r[0] = (uint8_t)(t[k] >> 0);
+        r[1] = (uint8_t)((t[k] >> 8) | (t[k + 1] << 2));
+        r[2] = (uint8_t)((t[k + 1] >> 6) | (t[k + 2] << 4));
+        r[3] = (uint8_t)((t[k + 2] >> 4) | (t[k + 3] << 6));
+        r[4] = (uint8_t)(t[k + 3] >> 2);
+        r += 5;
+    }
+}
+
+/*************************************************
+* Name:        decompress_du_row
+*
+* Description: polyvec_decompress of eight consecutive coefficients
+*
+* Arguments:   - int16_t *r: pointer to output coefficients
+*              - const uint8_t *a: pointer to input byte array (10 bytes)
+**************************************************/
+static void decompress_du_row(int16_t r[8], const uint8_t a[10]) {
+    unsigned int k;
+    uint16_t t[4];
+
+    for (k = 0; k < 8; k += 4) {
+        t[0] = (a[0] >> 0) | ((uint16_t)a[1] << 8);
+        t[1] = (a[1] >> 2) | ((uint16_t)a[2] << 6);
+        t[2] = (a[2] >> 4) | ((uint16_t)a[3] << 4);
+        t[3] = (a[3] >> 6) | ((uint16_t)a[4] << 2);
+        a += 5;
+
+        r[k + 0] = ((uint32_t)(t[0] & 0x3FF) * KYBER_Q + 512) >> 10;
+        r[k + 1] = ((uint32_t)(t[1] & 0x3FF) * KYBER_Q + 512) >> 10;
+        r[k + 2] = ((uint32_t)(t[2] & 0x3FF) * KYBER_Q + 512) >> 10;
+        r[k + 3] = ((uint32_t)(t[3] & 0x3FF) * KYBER_Q + 512) >> 10;
+    }
+}
+#endif
+
+/* Compressed bytes of one polynomial, and offset of coefficient n in them */
+#define POLYVEC_POLYBYTES (KYBER_POLYVECCOMPRESSEDBYTES / KYBER_K)
+#define POLYVEC_ROW(n) ((n) * POLYVEC_POLYBYTES / KYBER_N)
+
+/*************************************************
+* Name:        polyvec_decompress_ntt
+*
+* Description: Same as polyvec_decompress followed by polyvec_ntt, but the
+*              coefficients are decompressed block by block straight into
+*              the first layers of the transform instead of being written
+*              out and read back by a separate pass
+*
+* Arguments:   - polyvec *r:       pointer to output vector of polynomials
+*              - const uint8_t *a: pointer to input byte array
+*                                  (of length KYBER_POLYVECCOMPRESSEDBYTES)
+**************************************************/
+void KYBER_NAMESPACE(polyvec_decompress_ntt)(polyvec *r, const uint8_t a[KYBER_POLYVECCOMPRESSEDBYTES]) {
+    unsigned int i, j, k;
+    int16_t t[8][8];
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        KYBER_NAMESPACE(polyvec_decompress)(r, a);
+        KYBER_NAMESPACE(polyvec_ntt)(r);
+        return;
+    }
+#endif
+
+    for (i = 0; i < KYBER_K; i++) {
+        for (j = 0; j < 32; j += 8) {
+            for (k = 0; k < 8; k++) {
+                decompress_du_row(t[k], &a[POLYVEC_ROW(32 * k + j)]);
+            }
+            PQCLEAN_MLKEM768_CLEAN_ntt_head(r->vec[i].coeffs, (const int16_t (*)[8])t, j);
+        }
+        PQCLEAN_MLKEM768_CLEAN_ntt_tail(r->vec[i].coeffs);
+        a += POLYVEC_POLYBYTES;
+    }
+}
+
+/*************************************************
+* Name:        poly_invntt_add_compress_du
+*
+* Description: Single-polynomial form of polyvec_invntt_add_compress,
+*              writing the bytes of one entry of the compressed vector
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (needs space for KYBER_POLYVECCOMPRESSEDBYTES / KYBER_K)
+*              - poly *a: pointer to input polynomial in NTT domain; clobbered
+*              - const poly *e: pointer to polynomial to add
+**************************************************/
+void KYBER_NAMESPACE(poly_invntt_add_compress_du)(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES / KYBER_K], poly *a,
+        const poly *e) {
+    unsigned int j, k, c;
+    int16_t t[8][8];
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        PQCLEAN_MLKEM768_CLEAN_poly_invntt_tomont(a);
+        PQCLEAN_MLKEM768_CLEAN_poly_add(a, a, e);
+        PQCLEAN_MLKEM768_CLEAN_poly_reduce(a);
+#if (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 320))
+        PQCLEAN_MLKEM768_CLEAN_poly_compress10_avx2(r, a->coeffs);
+#else
+        for (j = 0; j < KYBER_N; j += 8) {
+            compress_du_row(&r[POLYVEC_ROW(j)], &a->coeffs[j]);
+        }
+#endif
+        return;
+    }
+#endif
+
+    PQCLEAN_MLKEM768_CLEAN_invntt_head(a->coeffs);
+    for (j = 0; j < 32; j += 8) {
+        PQCLEAN_MLKEM768_CLEAN_invntt_tail(t, a->coeffs, j);
+        for (k = 0; k < 8; k++) {
+            const int16_t *ek = &e->coeffs[32 * k + j];
+            for (c = 0; c < 8; c++) {
+                t[k][c] = PQCLEAN_MLKEM768_CLEAN_barrett_reduce(t[k][c] + ek[c]);
+            }
+            compress_du_row(&r[POLYVEC_ROW(32 * k + j)], t[k]);
+        }
+    }
+}
+
+/*************************************************
+* Name:        polyvec_invntt_add_compress
+*
+* Description: Same as polyvec_invntt_tomont, polyvec_add of e,
+*              polyvec_reduce and polyvec_compress, but each block of
+*              coefficients is reduced and packed as soon as the last
+*              layers of the inverse transform produce it. The bytes are
+*              identical; a is used as scratch space.
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (needs space for KYBER_POLYVECCOMPRESSEDBYTES)
+*              - polyvec *a: pointer to input vector of polynomials in NTT
+*                            domain; clobbered
+*              - const polyvec *e: pointer to vector of polynomials to add
+**************************************************/
+void KYBER_NAMESPACE(polyvec_invntt_add_compress)(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES], polyvec *a,
+        const polyvec *e) {
+    unsigned int i;
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        KYBER_NAMESPACE(polyvec_invntt_tomont)(a);
+        KYBER_NAMESPACE(polyvec_add)(a, a, e);
+        KYBER_NAMESPACE(polyvec_reduce)(a);
+        KYBER_NAMESPACE(polyvec_compress)(r, a);
+        return;
+    }
+#endif
+
+    for (i = 0; i < KYBER_K; i++) {
+        KYBER_NAMESPACE(poly_invntt_add_compress_du)(r + i * POLYVEC_POLYBYTES, &a->vec[i], &e->vec[i]);
+    }
+}
+
+/*************************************************
+* Name:        polyvec_tobytes
 *
 * Description: Serialize vector of polynomials
 *
@@ -79,7 +403,7 @@ void PQCLEAN_MLKEM768_CLEAN_polyvec_decompress(polyvec *r, const uint8_t a[KYBER
 *                            (needs space for KYBER_POLYVECBYTES)
 *              - const polyvec *a: pointer to input vector of polynomials
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_polyvec_tobytes(uint8_t r[KYBER_POLYVECBYTES], const polyvec *a) {
+void KYBER_NAMESPACE(polyvec_tobytes)(uint8_t r[KYBER_POLYVECBYTES], const polyvec *a) {
     unsigned int i;
     for (i = 0; i < KYBER_K; i++) {
         PQCLEAN_MLKEM768_CLEAN_poly_tobytes(r + i * KYBER_POLYBYTES, &a->vec[i]);
@@ -87,16 +411,16 @@ void PQCLEAN_MLKEM768_CLEAN_polyvec_tobytes(uint8_t r[KYBER_POLYVECBYTES], const
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_polyvec_frombytes
+* Name:        polyvec_frombytes
 *
 * Description: De-serialize vector of polynomials;
-*              inverse of PQCLEAN_MLKEM768_CLEAN_polyvec_tobytes
+*              inverse of polyvec_tobytes
 *
 * Arguments:   - uint8_t *r:       pointer to output byte array
 *              - const polyvec *a: pointer to input vector of polynomials
 *                                  (of length KYBER_POLYVECBYTES)
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_polyvec_frombytes(polyvec *r, const uint8_t a[KYBER_POLYVECBYTES]) {
+void KYBER_NAMESPACE(polyvec_frombytes)(polyvec *r, const uint8_t a[KYBER_POLYVECBYTES]) {
     unsigned int i;
     for (i = 0; i < KYBER_K; i++) {
         PQCLEAN_MLKEM768_CLEAN_poly_frombytes(&r->vec[i], a + i * KYBER_POLYBYTES);
@@ -104,13 +428,13 @@ void PQCLEAN_MLKEM768_CLEAN_polyvec_frombytes(polyvec *r, const uint8_t a[KYBER_
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_polyvec_ntt
+* Name:        polyvec_ntt
 *
 * Description: Apply forward NTT to all elements of a vector of polynomials
 *
 * Arguments:   - polyvec *r: pointer to in/output vector of polynomials
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_polyvec_ntt(polyvec *r) {
+void KYBER_NAMESPACE(polyvec_ntt)(polyvec *r) {
     unsigned int i;
     for (i = 0; i < KYBER_K; i++) {
         PQCLEAN_MLKEM768_CLEAN_poly_ntt(&r->vec[i]);
@@ -118,14 +442,14 @@ void PQCLEAN_MLKEM768_CLEAN_polyvec_ntt(polyvec *r) {
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_polyvec_invntt_tomont
+* Name:        polyvec_invntt_tomont
 *
 * Description: Apply inverse NTT to all elements of a vector of polynomials
 *              and multiply by Montgomery factor 2^16
 *
 * Arguments:   - polyvec *r: pointer to in/output vector of polynomials
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_polyvec_invntt_tomont(polyvec *r) {
+void KYBER_NAMESPACE(polyvec_invntt_tomont)(polyvec *r) {
     unsigned int i;
     for (i = 0; i < KYBER_K; i++) {
         PQCLEAN_MLKEM768_CLEAN_poly_invntt_tomont(&r->vec[i]);
@@ -133,7 +457,7 @@ void PQCLEAN_MLKEM768_CLEAN_polyvec_invntt_tomont(polyvec *r) {
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_polyvec_basemul_acc_montgomery
+* Name:        polyvec_basemul_acc_montgomery
 *
 * Description: Multiply elements of a and b in NTT domain, accumulate into r,
 *              and multiply by 2^-16.
@@ -142,7 +466,7 @@ void PQCLEAN_MLKEM768_CLEAN_polyvec_invntt_tomont(polyvec *r) {
 *            - const polyvec *a: pointer to first input vector of polynomials
 *            - const polyvec *b: pointer to second input vector of polynomials
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_polyvec_basemul_acc_montgomery(poly *r, const polyvec *a, const polyvec *b) {
+void KYBER_NAMESPACE(polyvec_basemul_acc_montgomery)(poly *r, const polyvec *a, const polyvec *b) {
     unsigned int i;
     poly t;
 
@@ -156,7 +480,69 @@ void PQCLEAN_MLKEM768_CLEAN_polyvec_basemul_acc_montgomery(poly *r, const polyve
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_polyvec_reduce
+* Name:        polyvec_mulcache_compute
+*
+* Description: Precompute the multiplication cache of a vector of
+*              polynomials in NTT domain
+*
+* Arguments: - polyvec_mulcache *x: pointer to output cache
+*            - const polyvec *a: pointer to input vector of polynomials
+**************************************************/
+void KYBER_NAMESPACE(polyvec_mulcache_compute)(polyvec_mulcache *x, const polyvec *a) {
+    unsigned int i;
+    for (i = 0; i < KYBER_K; i++) {
+        PQCLEAN_MLKEM768_CLEAN_poly_mulcache_compute(&x->vec[i], &a->vec[i]);
+    }
+}
+
+/*************************************************
+* Name:        polyvec_basemul_acc_montgomery_cached
+*
+* Description: Multiply elements of a and b in NTT domain, accumulate into r,
+*              and multiply by 2^-16, using the cache of b computed by
+*              polyvec_mulcache_compute.
+*              All K products are accumulated in 32 bits and each output
+*              coefficient is reduced once. This requires the coefficients
+*              of a to be below 2^12 and those of b below q in absolute
+*              value, which holds for unpacked keys, expanded matrix
+*              entries and reduced NTT outputs.
+*              The result is congruent to the one of
+*              polyvec_basemul_acc_montgomery and
+*              bounded by q in absolute value.
+*
+* Arguments: - poly *r: pointer to output polynomial
+*            - const polyvec *a: pointer to first input vector of polynomials
+*            - const polyvec *b: pointer to second input vector of polynomials
+*            - const polyvec_mulcache *b_cache: pointer to cache of b
+**************************************************/
+void KYBER_NAMESPACE(polyvec_basemul_acc_montgomery_cached)(poly *r, const polyvec *a, const polyvec *b,
+        const polyvec_mulcache *b_cache) {
+    unsigned int i, j;
+    int32_t t0, t1;
+
+#if defined(KYBER_AVX2_DISPATCH)
+    if (PQCLEAN_MLKEM768_CLEAN_have_avx2()) {
+        PQCLEAN_MLKEM768_CLEAN_basemul_acc_cached_avx2(r->coeffs, a->vec, b->vec, b_cache->vec, KYBER_K);
+        return;
+    }
+#endif
+
+    for (j = 0; j < KYBER_N / 2; j++) {
+        t0 = 0;
+        t1 = 0;
+        for (i = 0; i < KYBER_K; i++) {
+            const int16_t *x = &a->vec[i].coeffs[2 * j];
+            const int16_t *y = &b->vec[i].coeffs[2 * j];
+            t0 += (int32_t)x[0] * y[0] + (int32_t)x[1] * b_cache->vec[i].coeffs[j];
+            t1 += (int32_t)x[0] * y[1] + (int32_t)x[1] * y[0];
+        }
+        r->coeffs[2 * j] = PQCLEAN_MLKEM768_CLEAN_montgomery_reduce(t0);
+        r->coeffs[2 * j + 1] = PQCLEAN_MLKEM768_CLEAN_montgomery_reduce(t1);
+    }
+}
+
+/*************************************************
+* Name:        polyvec_reduce
 *
 * Description: Applies Barrett reduction to each coefficient
 *              of each element of a vector of polynomials;
@@ -164,7 +550,7 @@ void PQCLEAN_MLKEM768_CLEAN_polyvec_basemul_acc_montgomery(poly *r, const polyve
 *
 * Arguments:   - polyvec *r: pointer to input/output polynomial
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_polyvec_reduce(polyvec *r) {
+void KYBER_NAMESPACE(polyvec_reduce)(polyvec *r) {
     unsigned int i;
     for (i = 0; i < KYBER_K; i++) {
         PQCLEAN_MLKEM768_CLEAN_poly_reduce(&r->vec[i]);
@@ -172,7 +558,7 @@ void PQCLEAN_MLKEM768_CLEAN_polyvec_reduce(polyvec *r) {
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_polyvec_add
+* Name:        polyvec_add
 *
 * Description: Add vectors of polynomials
 *
@@ -180,7 +566,7 @@ void PQCLEAN_MLKEM768_CLEAN_polyvec_reduce(polyvec *r) {
 *            - const polyvec *a: pointer to first input vector of polynomials
 *            - const polyvec *b: pointer to second input vector of polynomials
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_polyvec_add(polyvec *r, const polyvec *a, const polyvec *b) {
+void KYBER_NAMESPACE(polyvec_add)(polyvec *r, const polyvec *a, const polyvec *b) {
     unsigned int i;
     for (i = 0; i < KYBER_K; i++) {
         PQCLEAN_MLKEM768_CLEAN_poly_add(&r->vec[i], &a->vec[i], &b->vec[i]);
@@ -8,19 +8,31 @@ typedef struct {
     poly vec[KYBER_K];
 } polyvec;
 
-void PQCLEAN_MLKEM768_CLEAN_polyvec_compress(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES], const polyvec *a);
-void PQCLEAN_MLKEM768_CLEAN_polyvec_decompress(polyvec *r, const uint8_t a[KYBER_POLYVECCOMPRESSEDBYTES]);
+typedef struct {
+    poly_mulcache vec[KYBER_K];
+} polyvec_mulcache;
+
+void KYBER_NAMESPACE(polyvec_compress)(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES], const polyvec *a);
+void KYBER_NAMESPACE(polyvec_decompress)(polyvec *r, const uint8_t a[KYBER_POLYVECCOMPRESSEDBYTES]);
+void KYBER_NAMESPACE(polyvec_decompress_ntt)(polyvec *r, const uint8_t a[KYBER_POLYVECCOMPRESSEDBYTES]);
+void KYBER_NAMESPACE(poly_invntt_add_compress_du)(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES / KYBER_K], poly *a,
+        const poly *e);
+void KYBER_NAMESPACE(polyvec_invntt_add_compress)(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES], polyvec *a,
+        const polyvec *e);
 
-void PQCLEAN_MLKEM768_CLEAN_polyvec_tobytes(uint8_t r[KYBER_POLYVECBYTES], const polyvec *a);
-void PQCLEAN_MLKEM768_CLEAN_polyvec_frombytes(polyvec *r, const uint8_t a[KYBER_POLYVECBYTES]);
+void KYBER_NAMESPACE(polyvec_tobytes)(uint8_t r[KYBER_POLYVECBYTES], const polyvec *a);
+void KYBER_NAMESPACE(polyvec_frombytes)(polyvec *r, const uint8_t a[KYBER_POLYVECBYTES]);
 
-void PQCLEAN_MLKEM768_CLEAN_polyvec_ntt(polyvec *r);
-void PQCLEAN_MLKEM768_CLEAN_polyvec_invntt_tomont(polyvec *r);
+void KYBER_NAMESPACE(polyvec_ntt)(polyvec *r);
+void KYBER_NAMESPACE(polyvec_invntt_tomont)(polyvec *r);
 
-void PQCLEAN_MLKEM768_CLEAN_polyvec_basemul_acc_montgomery(poly *r, const polyvec *a, const polyvec *b);
+void KYBER_NAMESPACE(polyvec_basemul_acc_montgomery)(poly *r, const polyvec *a, const polyvec *b);
+void KYBER_NAMESPACE(polyvec_mulcache_compute)(polyvec_mulcache *x, const polyvec *a);
+void KYBER_NAMESPACE(polyvec_basemul_acc_montgomery_cached)(poly *r, const polyvec *a, const polyvec *b,
+        const polyvec_mulcache *b_cache);
 
-void PQCLEAN_MLKEM768_CLEAN_polyvec_reduce(polyvec *r);
+void KYBER_NAMESPACE(polyvec_reduce)(polyvec *r);
 
-void PQCLEAN_MLKEM768_CLEAN_polyvec_add(polyvec *r, const polyvec *a, const polyvec *b);
+void KYBER_NAMESPACE(polyvec_add)(polyvec *r, const polyvec *a, const polyvec *b);
 
 #endif
@@ -1,4 +1,5 @@
 #include "fips202.h"
+#include "fips202x4.h"
 #include "params.h"
 #include "symmetric.h"
 #include <stddef.h>
@@ -19,13 +20,66 @@ void PQCLEAN_MLKEM768_CLEAN_kyber_shake128_absorb(xof_state *state,
         const uint8_t seed[KYBER_SYMBYTES],
         uint8_t x,
         uint8_t y) {
-    uint8_t extseed[KYBER_SYMBYTES + 2];
+    uint8_t xy[2];
+    keccak_iovec in[2];
 
-    memcpy(extseed, seed, KYBER_SYMBYTES);
-    extseed[KYBER_SYMBYTES + 0] = x;
-    extseed[KYBER_SYMBYTES + 1] = y;
+    xy[0] = x;
+    xy[1] = y;
+    in[0].base = seed;
+    in[0].len = KYBER_SYMBYTES;
+    in[1].base = xy;
+    in[1].len = sizeof(xy);
 
-    shake128_absorb(state, extseed, sizeof(extseed));
+    shake128_absorb_iov(state, in, 2);
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_kyber_shake128x4_absorb
+*
+* Description: Four-way absorb step of the SHAKE128 specialized for the
+*              Kyber context; lane k absorbs seed || xy[2k] || xy[2k+1].
+*
+* Arguments:   - xof_x4_state *state: pointer to (uninitialized) output Keccak state
+*              - const uint8_t *seed: pointer to KYBER_SYMBYTES input to be absorbed into state
+*              - const uint8_t *xy: pointer to the two additional input bytes of each lane
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_kyber_shake128x4_absorb(xof_x4_state *state,
+        const uint8_t seed[KYBER_SYMBYTES],
+        const uint8_t xy[8]) {
+    uint8_t extseed[4][KYBER_SYMBYTES + 2];
+    unsigned int k;
+
+    for (k = 0; k < 4; k++) {
+        memcpy(extseed[k], seed, KYBER_SYMBYTES);
+        extseed[k][KYBER_SYMBYTES + 0] = xy[2 * k + 0];
+        extseed[k][KYBER_SYMBYTES + 1] = xy[2 * k + 1];
+    }
+
+    shake128x4_absorb_once(state, extseed[0], extseed[1], extseed[2], extseed[3], sizeof(extseed[0]));
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_kyber_shake128x2_absorb
+*
+* Description: Two-way variant of PQCLEAN_MLKEM768_CLEAN_kyber_shake128x4_absorb
+*
+* Arguments:   - xof_x2_state *state: pointer to (uninitialized) output Keccak state
+*              - const uint8_t *seed: pointer to KYBER_SYMBYTES input to be absorbed into state
+*              - const uint8_t *xy: pointer to the two additional input bytes of each lane
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_kyber_shake128x2_absorb(xof_x2_state *state,
+        const uint8_t seed[KYBER_SYMBYTES],
+        const uint8_t xy[4]) {
+    uint8_t extseed[2][KYBER_SYMBYTES + 2];
+    unsigned int k;
+
+    for (k = 0; k < 2; k++) {
+        memcpy(extseed[k], seed, KYBER_SYMBYTES);
+        extseed[k][KYBER_SYMBYTES + 0] = xy[2 * k + 0];
+        extseed[k][KYBER_SYMBYTES + 1] = xy[2 * k + 1];
+    }
+
+    shake128x2_absorb_once(state, extseed[0], extseed[1], sizeof(extseed[0]));
 }
 
 /*************************************************
@@ -40,32 +94,87 @@ void PQCLEAN_MLKEM768_CLEAN_kyber_shake128_absorb(xof_state *state,
 *              - uint8_t nonce: single-byte nonce (public PRF input)
 **************************************************/
 void PQCLEAN_MLKEM768_CLEAN_kyber_shake256_prf(uint8_t *out, size_t outlen, const uint8_t key[KYBER_SYMBYTES], uint8_t nonce) {
-    uint8_t extkey[KYBER_SYMBYTES + 1];
+    keccak_iovec in[2];
 
-    memcpy(extkey, key, KYBER_SYMBYTES);
-    extkey[KYBER_SYMBYTES] = nonce;
+    in[0].base = key;
+    in[0].len = KYBER_SYMBYTES;
+    in[1].base = &nonce;
+    in[1].len = 1;
 
-    shake256(out, outlen, extkey, sizeof(extkey));
+    shake256_iov(out, outlen, in, 2);
 }
 
 /*************************************************
-* Name:        PQCLEAN_MLKEM768_CLEAN_kyber_shake256_prf
+* Name:        PQCLEAN_MLKEM768_CLEAN_kyber_shake256x4_prf
 *
-* Description: Usage of SHAKE256 as a PRF, concatenates secret and public input
-*              and then generates outlen bytes of SHAKE256 output
+* Description: Four SHAKE256 PRF calls under the same key with different
+*              nonces, computed in lockstep
+*
+* Arguments:   - uint8_t *out0..out3: pointers to the outputs
+*              - size_t outlen: number of requested output bytes per lane
+*              - const uint8_t *key: pointer to the key (of length KYBER_SYMBYTES)
+*              - uint8_t nonce0..nonce3: single-byte nonce of each lane
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_kyber_shake256x4_prf(uint8_t *out0, uint8_t *out1, uint8_t *out2, uint8_t *out3,
+        size_t outlen, const uint8_t key[KYBER_SYMBYTES],
+        uint8_t nonce0, uint8_t nonce1, uint8_t nonce2, uint8_t nonce3) {
+    uint8_t extkey[4][KYBER_SYMBYTES + 1];
+    unsigned int k;
+
+    for (k = 0; k < 4; k++) {
+        memcpy(extkey[k], key, KYBER_SYMBYTES);
+    }
+    extkey[0][KYBER_SYMBYTES] = nonce0;
+    extkey[1][KYBER_SYMBYTES] = nonce1;
+    extkey[2][KYBER_SYMBYTES] = nonce2;
+    extkey[3][KYBER_SYMBYTES] = nonce3;
+
+    shake256x4(out0, out1, out2, out3, outlen, extkey[0], extkey[1], extkey[2], extkey[3], sizeof(extkey[0]));
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_kyber_shake256x2_prf
+*
+* Description: Two-way variant of PQCLEAN_MLKEM768_CLEAN_kyber_shake256x4_prf
+*
+* Arguments:   - uint8_t *out0, *out1: pointers to the outputs
+*              - size_t outlen: number of requested output bytes per lane
+*              - const uint8_t *key: pointer to the key (of length KYBER_SYMBYTES)
+*              - uint8_t nonce0, nonce1: single-byte nonce of each lane
+**************************************************/
+void PQCLEAN_MLKEM768_CLEAN_kyber_shake256x2_prf(uint8_t *out0, uint8_t *out1,
+        size_t outlen, const uint8_t key[KYBER_SYMBYTES],
+        uint8_t nonce0, uint8_t nonce1) {
+    uint8_t extkey[2][KYBER_SYMBYTES + 1];
+
+    memcpy(extkey[0], key, KYBER_SYMBYTES);
+    memcpy(extkey[1], key, KYBER_SYMBYTES);
+    extkey[0][KYBER_SYMBYTES] = nonce0;
+    extkey[1][KYBER_SYMBYTES] = nonce1;
+
+    shake256x2(out0, out1, outlen, extkey[0], extkey[1], sizeof(extkey[0]));
+}
+
+/*************************************************
+* Name:        PQCLEAN_MLKEM768_CLEAN_kyber_shake256_rkprf
+*
+* Description: Usage of SHAKE256 as a PRF for the implicit rejection key,
+*              concatenates secret key and ciphertext and then generates
+*              KYBER_SSBYTES bytes of SHAKE256 output
 *
 * Arguments:   - uint8_t *out: pointer to output
-*              - size_t outlen: number of requested output bytes
 *              - const uint8_t *key: pointer to the key (of length KYBER_SYMBYTES)
-*              - uint8_t nonce: single-byte nonce (public PRF input)
+*              - const uint8_t *input: pointer to the ciphertext
+*              - size_t inlen: length of the ciphertext, which depends on
+*                the parameter set
 **************************************************/
-void PQCLEAN_MLKEM768_CLEAN_kyber_shake256_rkprf(uint8_t out[KYBER_SSBYTES], const uint8_t key[KYBER_SYMBYTES], const uint8_t input[KYBER_CIPHERTEXTBYTES]) {
-    shake256incctx s;
-
-    shake256_inc_init(&s);
-    shake256_inc_absorb(&s, key, KYBER_SYMBYTES);
-    shake256_inc_absorb(&s, input, KYBER_CIPHERTEXTBYTES);
-    shake256_inc_finalize(&s);
-    shake256_inc_squeeze(out, KYBER_SSBYTES, &s);
-    shake256_inc_ctx_release(&s);
+void PQCLEAN_MLKEM768_CLEAN_kyber_shake256_rkprf(uint8_t out[KYBER_SSBYTES], const uint8_t key[KYBER_SYMBYTES], const uint8_t *input, size_t inlen) {
+    keccak_iovec in[2];
+
+    in[0].base = key;
+    in[0].len = KYBER_SYMBYTES;
+    in[1].base = input;
+    in[1].len = inlen;
+
+    shake256_iov(out, KYBER_SSBYTES, in, 2);
 }
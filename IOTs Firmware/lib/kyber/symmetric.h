@@ -1,30 +1,59 @@
 #ifndef PQCLEAN_MLKEM768_CLEAN_SYMMETRIC_H
 #define PQCLEAN_MLKEM768_CLEAN_SYMMETRIC_H
 #include "fips202.h"
+#include "fips202x4.h"
 #include "params.h"
 #include <stddef.h>
 #include <stdint.h>
 
 
 typedef shake128ctx xof_state;
+typedef keccakx4_state xof_x4_state;
+typedef keccakx2_state xof_x2_state;
 
 void PQCLEAN_MLKEM768_CLEAN_kyber_shake128_absorb(xof_state *s,
         const uint8_t seed[KYBER_SYMBYTES],
         uint8_t x,
         uint8_t y);
 
+void PQCLEAN_MLKEM768_CLEAN_kyber_shake128x4_absorb(xof_x4_state *s,
+        const uint8_t seed[KYBER_SYMBYTES],
+        const uint8_t xy[8]);
+
+void PQCLEAN_MLKEM768_CLEAN_kyber_shake128x2_absorb(xof_x2_state *s,
+        const uint8_t seed[KYBER_SYMBYTES],
+        const uint8_t xy[4]);
+
 void PQCLEAN_MLKEM768_CLEAN_kyber_shake256_prf(uint8_t *out, size_t outlen, const uint8_t key[KYBER_SYMBYTES], uint8_t nonce);
 
-void PQCLEAN_MLKEM768_CLEAN_kyber_shake256_rkprf(uint8_t out[KYBER_SSBYTES], const uint8_t key[KYBER_SYMBYTES], const uint8_t input[KYBER_CIPHERTEXTBYTES]);
+void PQCLEAN_MLKEM768_CLEAN_kyber_shake256x4_prf(uint8_t *out0, uint8_t *out1, uint8_t *out2, uint8_t *out3,
+        size_t outlen, const uint8_t key[KYBER_SYMBYTES],
+        uint8_t nonce0, uint8_t nonce1, uint8_t nonce2, uint8_t nonce3);
+
+void PQCLEAN_MLKEM768_CLEAN_kyber_shake256x2_prf(uint8_t *out0, uint8_t *out1,
+        size_t outlen, const uint8_t key[KYBER_SYMBYTES],
+        uint8_t nonce0, uint8_t nonce1);
+
+void PQCLEAN_MLKEM768_CLEAN_kyber_shake256_rkprf(uint8_t out[KYBER_SSBYTES], const uint8_t key[KYBER_SYMBYTES], const uint8_t *input, size_t inlen);
 
 #define XOF_BLOCKBYTES SHAKE128_RATE
 
 #define hash_h(OUT, IN, INBYTES) sha3_256(OUT, IN, INBYTES)
 #define hash_g(OUT, IN, INBYTES) sha3_512(OUT, IN, INBYTES)
+#define hash_g_iov(OUT, IOV, IOVCNT) sha3_512_iov(OUT, IOV, IOVCNT)
 #define xof_absorb(STATE, SEED, X, Y) PQCLEAN_MLKEM768_CLEAN_kyber_shake128_absorb(STATE, SEED, X, Y)
 #define xof_squeezeblocks(OUT, OUTBLOCKS, STATE) shake128_squeezeblocks(OUT, OUTBLOCKS, STATE)
 #define xof_ctx_release(STATE) shake128_ctx_release(STATE)
 #define prf(OUT, OUTBYTES, KEY, NONCE) PQCLEAN_MLKEM768_CLEAN_kyber_shake256_prf(OUT, OUTBYTES, KEY, NONCE)
-#define rkprf(OUT, KEY, INPUT) PQCLEAN_MLKEM768_CLEAN_kyber_shake256_rkprf(OUT, KEY, INPUT)
+#define xof_x4_absorb(STATE, SEED, XY) PQCLEAN_MLKEM768_CLEAN_kyber_shake128x4_absorb(STATE, SEED, XY)
+#define xof_x4_squeezeblocks(OUT0, OUT1, OUT2, OUT3, OUTBLOCKS, STATE) \
+    shake128x4_squeezeblocks(OUT0, OUT1, OUT2, OUT3, OUTBLOCKS, STATE)
+#define xof_x2_absorb(STATE, SEED, XY) PQCLEAN_MLKEM768_CLEAN_kyber_shake128x2_absorb(STATE, SEED, XY)
+#define xof_x2_squeezeblocks(OUT0, OUT1, OUTBLOCKS, STATE) shake128x2_squeezeblocks(OUT0, OUT1, OUTBLOCKS, STATE)
+#define prf_x4(OUT0, OUT1, OUT2, OUT3, OUTBYTES, KEY, N0, N1, N2, N3) \
+    PQCLEAN_MLKEM768_CLEAN_kyber_shake256x4_prf(OUT0, OUT1, OUT2, OUT3, OUTBYTES, KEY, N0, N1, N2, N3)
+#define prf_x2(OUT0, OUT1, OUTBYTES, KEY, N0, N1) \
+    PQCLEAN_MLKEM768_CLEAN_kyber_shake256x2_prf(OUT0, OUT1, OUTBYTES, KEY, N0, N1)
+#define rkprf(OUT, KEY, INPUT) PQCLEAN_MLKEM768_CLEAN_kyber_shake256_rkprf(OUT, KEY, INPUT, KYBER_CIPHERTEXTBYTES)
 
 #endif /* SYMMETRIC_H */
@@ -0,0 +1,114 @@
+#include "mlkem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Checks that no KEM operation of any parameter set touches the heap.
+ * Linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc, so every
+ * call the library makes to one of them comes through the counters below
+ * first. Exits non-zero and names the operation if one allocates.
+ */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t nmemb, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+
+static unsigned long allocs = 0;
+
+void *__wrap_malloc(size_t size) {
+    allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+    allocs++;
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    allocs++;
+    return __real_realloc(ptr, size);
+}
+
+static uint8_t pk[PQCLEAN_MLKEM_CLEAN_MAX_PUBLICKEYBYTES];
+static uint8_t sk[PQCLEAN_MLKEM_CLEAN_MAX_SECRETKEYBYTES];
+static uint8_t ct[PQCLEAN_MLKEM_CLEAN_MAX_CIPHERTEXTBYTES];
+static uint8_t epk[PQCLEAN_MLKEM_CLEAN_MAX_EXPANDEDPKBYTES];
+static uint8_t esk[PQCLEAN_MLKEM_CLEAN_MAX_EXPANDEDSKBYTES];
+static uint8_t ss1[PQCLEAN_MLKEM_CLEAN_BYTES], ss2[PQCLEAN_MLKEM_CLEAN_BYTES];
+static mlkem_enc_stream stream;
+
+static int failed = 0;
+
+/* Records the allocations since the last call against operation name */
+static void check(const mlkem_params *p, const char *name) {
+    if (allocs != 0) {
+        printf("%s %s: %lu heap allocations\n", p->algname, name, allocs);
+        failed = 1;
+    }
+    allocs = 0;
+}
+
+static void check_ss(const mlkem_params *p, const char *name) {
+    if (memcmp(ss1, ss2, sizeof(ss1)) != 0) {
+        printf("%s %s: shared secrets differ\n", p->algname, name);
+        failed = 1;
+    }
+}
+
+int main(void) {
+    static const unsigned int ids[] = {512, 768, 1024};
+    unsigned int i;
+    size_t n, off;
+
+    for (i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+        const mlkem_params *p = PQCLEAN_MLKEM_CLEAN_params(ids[i]);
+
+        allocs = 0;
+        p->keypair(pk, sk);
+        check(p, "keypair");
+        p->enc(ct, ss1, pk);
+        check(p, "enc");
+        p->dec(ss2, ct, sk);
+        check(p, "dec");
+        check_ss(p, "enc/dec");
+
+        p->expand_pk(epk, pk);
+        check(p, "expand_pk");
+        p->enc_expanded(ct, ss1, epk);
+        check(p, "enc_expanded");
+        p->expand_sk(esk, sk);
+        check(p, "expand_sk");
+        p->dec_expanded(ss2, ct, esk);
+        check(p, "dec_expanded");
+        check_ss(p, "enc_expanded/dec_expanded");
+
+        p->enc_stream_init(&stream);
+        p->enc_stream_absorb(&stream, pk, p->publickeybytes);
+        p->enc_stream_start(&stream, ss1);
+        off = 0;
+        while ((n = p->enc_stream_emit(&stream, ct + off)) > 0) {
+            off += n;
+        }
+        check(p, "enc_stream");
+        p->dec(ss2, ct, sk);
+        check(p, "dec");
+        check_ss(p, "enc_stream/dec");
+
+        PQCLEAN_MLKEM_CLEAN_keypair_batch(p, pk, sk, 1);
+        check(p, "keypair_batch");
+        PQCLEAN_MLKEM_CLEAN_enc_batch(p, ct, ss1, pk, 0, 1);
+        check(p, "enc_batch");
+        PQCLEAN_MLKEM_CLEAN_dec_batch(p, ss2, ct, sk, 0, 1);
+        check(p, "dec_batch");
+        check_ss(p, "enc_batch/dec_batch");
+    }
+
+    if (!failed) {
+        printf("alloc: no heap allocations in keypair, enc or dec of any parameter set\n");
+    }
+    return failed;
+}
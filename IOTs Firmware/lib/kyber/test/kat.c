@@ -0,0 +1,220 @@
+#include "fips202.h"
+#include "fips202x4.h"
+#include "mlkem.h"
+#include "poly_avx2.h"
+#include "randombytes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Known-answer hash: SHA3-256 over the keys, ciphertexts and shared
+ * secrets of n rounds of keypair/enc/dec per parameter set, with every
+ * other ciphertext corrupted so that decapsulation takes the implicit
+ * rejection path, and, for ML-KEM-768, over the outputs of the SHA-3 and
+ * SHAKE functions for a range of input lengths. The coins come from the
+ * fixed-seed test/rng.c. A last line covers the four- and two-lane
+ * batched SHAKE of fips202x4.c, every lane of which must also give what
+ * the one-lane function gives for its input.
+ *
+ * The values do not depend on how the library is built; `make kat`
+ * checks them for every build variant against test/kat.expected. The
+ * ML-KEM-768 line is that of the unmodified PQClean clean implementation.
+ *
+ *   ./test/kat [rounds]
+ */
+static uint8_t pk[PQCLEAN_MLKEM_CLEAN_MAX_PUBLICKEYBYTES];
+static uint8_t sk[PQCLEAN_MLKEM_CLEAN_MAX_SECRETKEYBYTES];
+static uint8_t ct[PQCLEAN_MLKEM_CLEAN_MAX_CIPHERTEXTBYTES];
+static uint8_t ss1[PQCLEAN_MLKEM_CLEAN_BYTES], ss2[PQCLEAN_MLKEM_CLEAN_BYTES];
+
+static int kem_kat(sha3_256incctx *h, const mlkem_params *p, int n) {
+    uint8_t coins[64];
+    int i;
+
+    for (i = 0; i < n; i++) {
+        randombytes(coins, 64);
+        p->keypair_derand(pk, sk, coins);
+        randombytes(coins, 32);
+        p->enc_derand(ct, ss1, pk, coins);
+        if (i & 1) {
+            ct[i % p->ciphertextbytes] ^= 1;
+        }
+        p->dec(ss2, ct, sk);
+        if (!(i & 1) && memcmp(ss1, ss2, sizeof(ss1)) != 0) {
+            printf("%s: shared secrets differ in round %d\n", p->algname, i);
+            return 1;
+        }
+        sha3_256_inc_absorb(h, pk, p->publickeybytes);
+        sha3_256_inc_absorb(h, sk, p->secretkeybytes);
+        sha3_256_inc_absorb(h, ct, p->ciphertextbytes);
+        sha3_256_inc_absorb(h, ss1, sizeof(ss1));
+        sha3_256_inc_absorb(h, ss2, sizeof(ss2));
+    }
+    return 0;
+}
+
+static void fips202_kat(sha3_256incctx *h) {
+    uint8_t in[1000], out[777];
+    shake128incctx inc;
+    size_t len, k, n;
+
+    for (k = 0; k < sizeof(in); k++) {
+        in[k] = (uint8_t)(k * 7);
+    }
+    for (len = 0; len <= sizeof(in); len += 37) {
+        shake128(out, 777, in, len);
+        sha3_256_inc_absorb(h, out, 777);
+        shake256(out, 333, in, len);
+        sha3_256_inc_absorb(h, out, 333);
+        sha3_512(out, in, len);
+        sha3_256_inc_absorb(h, out, 64);
+        sha3_384(out, in, len);
+        sha3_256_inc_absorb(h, out, 48);
+        sha3_256(out, in, len);
+        sha3_256_inc_absorb(h, out, 32);
+
+        // Incremental absorb in 13-byte pieces, squeezed in two parts
+        shake128_inc_init(&inc);
+        for (k = 0; k < len; k += n) {
+            n = len - k < 13 ? len - k : 13;
+            shake128_inc_absorb(&inc, in + k, n);
+        }
+        shake128_inc_finalize(&inc);
+        shake128_inc_squeeze(out, 5, &inc);
+        shake128_inc_squeeze(out + 5, 400, &inc);
+        shake128_inc_ctx_release(&inc);
+        sha3_256_inc_absorb(h, out, 405);
+    }
+}
+
+/* Lane l of the batched calls gets in[l], which differ in every byte */
+#define LANE_INBYTES 400
+#define LANE_BLOCKS 3
+static uint8_t lane_in[4][LANE_INBYTES];
+static uint8_t lane_out[4][LANE_BLOCKS * SHAKE128_RATE];
+static uint8_t one_out[LANE_BLOCKS * SHAKE128_RATE];
+
+/* Checks lanes 0..nlanes-1 of lane_out against the one-lane function for
+ * len input bytes and outlen output bytes, and hashes them */
+static int check_lanes(sha3_256incctx *h, const char *name, unsigned int nlanes, int shake256_lanes,
+                       size_t len, size_t outlen) {
+    unsigned int l;
+
+    for (l = 0; l < nlanes; l++) {
+        if (shake256_lanes) {
+            shake256(one_out, outlen, lane_in[l], len);
+        } else {
+            shake128(one_out, outlen, lane_in[l], len);
+        }
+        if (memcmp(lane_out[l], one_out, outlen) != 0) {
+            printf("%s: lane %u differs from one lane for %zu input bytes\n", name, l, len);
+            return 1;
+        }
+        sha3_256_inc_absorb(h, lane_out[l], outlen);
+    }
+    return 0;
+}
+
+static int fips202x4_kat(sha3_256incctx *h) {
+    uint8_t *out[4];
+    keccakx4_state x4;
+    keccakx2_state x2;
+    size_t len, k;
+    unsigned int l;
+    int bad = 0;
+
+    for (l = 0; l < 4; l++) {
+        out[l] = lane_out[l];
+        for (k = 0; k < LANE_INBYTES; k++) {
+            lane_in[l][k] = (uint8_t)(k * 7 + l * 13 + 1);
+        }
+    }
+    for (len = 0; len <= LANE_INBYTES; len += 23) {
+        // Squeezed one block and then the rest, to cover repeated calls
+        shake128x4_absorb_once(&x4, lane_in[0], lane_in[1], lane_in[2], lane_in[3], len);
+        shake128x4_squeezeblocks(out[0], out[1], out[2], out[3], 1, &x4);
+        shake128x4_squeezeblocks(out[0] + SHAKE128_RATE, out[1] + SHAKE128_RATE, out[2] + SHAKE128_RATE,
+                                 out[3] + SHAKE128_RATE, LANE_BLOCKS - 1, &x4);
+        bad |= check_lanes(h, "shake128x4", 4, 0, len, LANE_BLOCKS * SHAKE128_RATE);
+
+        shake256x4_absorb_once(&x4, lane_in[0], lane_in[1], lane_in[2], lane_in[3], len);
+        shake256x4_squeezeblocks(out[0], out[1], out[2], out[3], 1, &x4);
+        shake256x4_squeezeblocks(out[0] + SHAKE256_RATE, out[1] + SHAKE256_RATE, out[2] + SHAKE256_RATE,
+                                 out[3] + SHAKE256_RATE, LANE_BLOCKS - 1, &x4);
+        bad |= check_lanes(h, "shake256x4_squeezeblocks", 4, 1, len, LANE_BLOCKS * SHAKE256_RATE);
+
+        shake256x4(out[0], out[1], out[2], out[3], 200 + len % 91, lane_in[0], lane_in[1], lane_in[2],
+                   lane_in[3], len);
+        bad |= check_lanes(h, "shake256x4", 4, 1, len, 200 + len % 91);
+
+        shake128x2_absorb_once(&x2, lane_in[0], lane_in[1], len);
+        shake128x2_squeezeblocks(out[0], out[1], 1, &x2);
+        shake128x2_squeezeblocks(out[0] + SHAKE128_RATE, out[1] + SHAKE128_RATE, LANE_BLOCKS - 1, &x2);
+        bad |= check_lanes(h, "shake128x2", 2, 0, len, LANE_BLOCKS * SHAKE128_RATE);
+
+        shake256x2_absorb_once(&x2, lane_in[0], lane_in[1], len);
+        shake256x2_squeezeblocks(out[0], out[1], 1, &x2);
+        shake256x2_squeezeblocks(out[0] + SHAKE256_RATE, out[1] + SHAKE256_RATE, LANE_BLOCKS - 1, &x2);
+        bad |= check_lanes(h, "shake256x2_squeezeblocks", 2, 1, len, LANE_BLOCKS * SHAKE256_RATE);
+
+        shake256x2(out[0], out[1], 200 + len % 91, lane_in[0], lane_in[1], len);
+        bad |= check_lanes(h, "shake256x2", 2, 1, len, 200 + len % 91);
+    }
+    return bad;
+}
+
+static void print_hash(const char *label, sha3_256incctx *h) {
+    uint8_t d[32];
+    size_t i;
+
+    sha3_256_inc_finalize(d, h);
+    printf("%s ", label);
+    for (i = 0; i < sizeof(d); i++) {
+        printf("%02x", d[i]);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    static const unsigned int ids[] = {512, 1024};
+    int n = argc > 1 ? atoi(argv[1]) : 200;
+    const mlkem_params *p;
+    sha3_256incctx h;
+    unsigned int i;
+
+#if defined(KYBER_AVX2_DISPATCH)
+    fprintf(stderr, "arithmetic: %s", PQCLEAN_MLKEM768_CLEAN_have_avx2() ? "AVX2" : "portable (no AVX2 on this CPU)");
+#else
+    fprintf(stderr, "arithmetic: portable");
+#endif
+#if defined(__AVX2__)
+    fprintf(stderr, ", batched SHAKE: AVX2\n");
+#else
+    fprintf(stderr, ", batched SHAKE: one lane at a time\n");
+#endif
+
+    p = PQCLEAN_MLKEM_CLEAN_params(768);
+    sha3_256_inc_init(&h);
+    if (kem_kat(&h, p, n)) {
+        return 1;
+    }
+    fips202_kat(&h);
+    print_hash("ML-KEM-768+SHA-3", &h);
+
+    for (i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+        p = PQCLEAN_MLKEM_CLEAN_params(ids[i]);
+        sha3_256_inc_init(&h);
+        if (kem_kat(&h, p, n)) {
+            return 1;
+        }
+        print_hash(p->algname, &h);
+    }
+
+    sha3_256_inc_init(&h);
+    if (fips202x4_kat(&h)) {
+        return 1;
+    }
+    print_hash("SHAKE-x4/x2", &h);
+    return 0;
+}
@@ -0,0 +1,22 @@
+#include "randombytes.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * randombytes for the host tests, in place of ../randombytes.c and the
+ * ESP32 RNG: a fixed-seed xorshift, so that every run draws the same
+ * keys and ciphertexts. Not random at all; for tests only.
+ */
+static uint64_t state = 0x0123456789abcdefULL;
+
+int randombytes(uint8_t *out, size_t outlen) {
+    size_t i;
+
+    for (i = 0; i < outlen; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        out[i] = (uint8_t)(state >> 24);
+    }
+    return 0;
+}
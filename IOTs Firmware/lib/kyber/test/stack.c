@@ -0,0 +1,136 @@
+#include "mlkem.h"
+#include "params.h"
+#include <stdio.h>
+
+/*
+ * Stack high-water mark of the KEM calls of every parameter set. Paints
+ * STACK_PAINT bytes below the frame of peak(), runs the call, and finds
+ * the deepest byte that changed.
+ *
+ * Built with KYBER_LOWSTACK, the streaming encryption must stay within
+ * KYBER_LOWSTACK_BUDGET for the whole call (see params.h). enc,
+ * enc_expanded and expand_pk only hold their buffers to the budget; the
+ * frames below them come on top, so they are held to STACK_LOWSTACK_ENC,
+ * which catches a regression but is not the budget. keypair and dec are
+ * reported only.
+ */
+#define STACK_PAINT (64 * 1024)
+#define STACK_PATTERN 0x5a
+#ifndef STACK_LOWSTACK_ENC
+#define STACK_LOWSTACK_ENC 4608
+#endif
+
+enum { REPORT, BOUNDED, BUDGET };
+
+static uint8_t pk[PQCLEAN_MLKEM_CLEAN_MAX_PUBLICKEYBYTES];
+static uint8_t sk[PQCLEAN_MLKEM_CLEAN_MAX_SECRETKEYBYTES];
+static uint8_t ct[PQCLEAN_MLKEM_CLEAN_MAX_CIPHERTEXTBYTES];
+static uint8_t epk[PQCLEAN_MLKEM_CLEAN_MAX_EXPANDEDPKBYTES];
+static uint8_t esk[PQCLEAN_MLKEM_CLEAN_MAX_EXPANDEDSKBYTES];
+static uint8_t ss[PQCLEAN_MLKEM_CLEAN_BYTES];
+static uint8_t coins[64];
+static mlkem_enc_stream stream;
+static const mlkem_params *p;
+
+static void run_keypair(void) {
+    p->keypair_derand(pk, sk, coins);
+}
+
+static void run_enc(void) {
+    p->enc_derand(ct, ss, pk, coins);
+}
+
+static void run_dec(void) {
+    p->dec(ss, ct, sk);
+}
+
+static void run_expand_pk(void) {
+    p->expand_pk(epk, pk);
+}
+
+static void run_enc_expanded(void) {
+    p->enc_expanded_derand(ct, ss, epk, coins);
+}
+
+static void run_dec_expanded(void) {
+    p->dec_expanded(ss, ct, esk);
+}
+
+static void run_enc_stream(void) {
+    size_t n, off = 0;
+
+    p->enc_stream_init(&stream);
+    p->enc_stream_absorb(&stream, pk, p->publickeybytes);
+    p->enc_stream_start_derand(&stream, ss, coins);
+    while ((n = p->enc_stream_emit(&stream, ct + off)) > 0) {
+        off += n;
+    }
+}
+
+static const struct {
+    const char *name;
+    void (*run)(void);
+    int limit;
+} calls[] = {
+    {"keypair", run_keypair, REPORT},
+    {"enc", run_enc, BOUNDED},
+    {"dec", run_dec, REPORT},
+    {"expand_pk", run_expand_pk, BOUNDED},
+    {"enc_expanded", run_enc_expanded, BOUNDED},
+    {"dec_expanded", run_dec_expanded, REPORT},
+    {"enc_stream", run_enc_stream, BUDGET},
+};
+
+/* Bytes of stack below its own frame that run touched */
+__attribute__((noinline)) static size_t peak(void (*run)(void)) {
+    volatile uint8_t *top = (volatile uint8_t *)__builtin_frame_address(0) - 256;
+    size_t i;
+
+    for (i = 0; i < STACK_PAINT; i++) {
+        top[-(long)i] = STACK_PATTERN;
+    }
+    run();
+    for (i = STACK_PAINT - 1; i > 0; i--) {
+        if (top[-(long)i] != STACK_PATTERN) {
+            break;
+        }
+    }
+    return i;
+}
+
+int main(void) {
+    static const unsigned int ids[] = {512, 768, 1024};
+    unsigned int i, j;
+    size_t used;
+#if defined(KYBER_LOWSTACK)
+    size_t limit;
+#endif
+    int failed = 0;
+
+    for (i = 0; i < sizeof(coins); i++) {
+        coins[i] = (uint8_t)(31 * i);
+    }
+    for (i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+        p = PQCLEAN_MLKEM_CLEAN_params(ids[i]);
+        run_keypair();
+        run_enc();
+        run_expand_pk();
+        p->expand_sk(esk, sk);
+
+        printf("%s stack bytes:", p->algname);
+        for (j = 0; j < sizeof(calls) / sizeof(calls[0]); j++) {
+            used = peak(calls[j].run);
+            printf(" %s %zu", calls[j].name, used);
+#if defined(KYBER_LOWSTACK)
+            limit = calls[j].limit == BUDGET ? KYBER_LOWSTACK_BUDGET
+                    : calls[j].limit == BOUNDED ? STACK_LOWSTACK_ENC : 0;
+            if (limit != 0 && used > limit) {
+                printf(" (over %zu)", limit);
+                failed = 1;
+            }
+#endif
+        }
+        printf("\n");
+    }
+    return failed;
+}
@@ -0,0 +1,156 @@
+#include "parallel_std.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "mlkem.h"
+#include "randombytes.h"
+}
+
+/*
+ * Thread sweep of the batch calls in mlkem.h on MlkemThreadPool
+ * (parallel_std.hpp):
+ *
+ *   test/sweep [threads [n]]
+ *
+ * For every pool size from 1 to threads (default: the number of CPUs),
+ * checks the batch calls of every parameter set against the serial ones,
+ * then times n (default 2000) ML-KEM-768 key pairs, encapsulations and
+ * decapsulations as one batch each, next to the serial calls without an
+ * executor. n of 0 only runs the checks. Exits non-zero if a check fails.
+ */
+
+/*
+ * randombytes for this test, in place of test/rng.c: the batch calls draw
+ * from every thread of the pool at once, so the fixed-seed xorshift of
+ * test/rng.c is taken under a lock here.
+ */
+static std::mutex rng_mutex;
+static uint64_t rng_state = 0x0123456789abcdefULL;
+
+extern "C" int randombytes(uint8_t *out, size_t outlen) {
+    std::lock_guard<std::mutex> lock(rng_mutex);
+    for (size_t i = 0; i < outlen; i++) {
+        rng_state ^= rng_state << 13;
+        rng_state ^= rng_state >> 7;
+        rng_state ^= rng_state << 17;
+        out[i] = static_cast<uint8_t>(rng_state >> 24);
+    }
+    return 0;
+}
+
+static const unsigned int PARAM_SETS[] = {512, 768, 1024};
+// Fewer items than threads, one item, and uneven shares
+static const unsigned int CHECK_SIZES[] = {1, 2, 7, 33};
+
+static int failed = 0;
+
+static void fail(const mlkem_params *p, unsigned int threads, unsigned int n, const char *what) {
+    printf("%s threads=%u n=%u: %s\n", p->algname, threads, n, what);
+    failed = 1;
+}
+
+static void check(const mlkem_params *p, unsigned int threads, unsigned int n) {
+    std::vector<uint8_t> pk(n * p->publickeybytes), sk(n * p->secretkeybytes);
+    std::vector<uint8_t> ct(n * p->ciphertextbytes);
+    std::vector<uint8_t> ss1(n * PQCLEAN_MLKEM_CLEAN_BYTES), ss2(n * PQCLEAN_MLKEM_CLEAN_BYTES);
+
+    PQCLEAN_MLKEM_CLEAN_keypair_batch(p, pk.data(), sk.data(), n);
+    PQCLEAN_MLKEM_CLEAN_enc_batch(p, ct.data(), ss1.data(), pk.data(), p->publickeybytes, n);
+    PQCLEAN_MLKEM_CLEAN_dec_batch(p, ss2.data(), ct.data(), sk.data(), p->secretkeybytes, n);
+    if (ss1 != ss2) fail(p, threads, n, "batch dec differs from batch enc");
+
+    for (unsigned int i = 0; i < n; i++) {
+        p->dec(ss2.data() + i * PQCLEAN_MLKEM_CLEAN_BYTES, ct.data() + i * p->ciphertextbytes,
+               sk.data() + i * p->secretkeybytes);
+    }
+    if (ss1 != ss2) fail(p, threads, n, "serial dec differs from batch enc");
+
+    // One key for every item (stride 0)
+    PQCLEAN_MLKEM_CLEAN_enc_batch(p, ct.data(), ss1.data(), pk.data(), 0, n);
+    PQCLEAN_MLKEM_CLEAN_dec_batch(p, ss2.data(), ct.data(), sk.data(), 0, n);
+    if (ss1 != ss2) fail(p, threads, n, "batch dec differs from batch enc with one key");
+
+    // Each item draws its own randomness, so no two secrets are the same
+    for (unsigned int i = 1; i < n; i++) {
+        if (memcmp(ss1.data(), ss1.data() + i * PQCLEAN_MLKEM_CLEAN_BYTES, PQCLEAN_MLKEM_CLEAN_BYTES) == 0) {
+            fail(p, threads, n, "items share a secret");
+            break;
+        }
+    }
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Rates {
+    double keypair, enc, dec;
+};
+
+static Rates time_batches(const mlkem_params *p, unsigned int n) {
+    std::vector<uint8_t> pk(n * p->publickeybytes), sk(n * p->secretkeybytes);
+    std::vector<uint8_t> ct(n * p->ciphertextbytes), ss(n * PQCLEAN_MLKEM_CLEAN_BYTES);
+    Rates r;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    PQCLEAN_MLKEM_CLEAN_keypair_batch(p, pk.data(), sk.data(), n);
+    r.keypair = n / seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    PQCLEAN_MLKEM_CLEAN_enc_batch(p, ct.data(), ss.data(), pk.data(), p->publickeybytes, n);
+    r.enc = n / seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    PQCLEAN_MLKEM_CLEAN_dec_batch(p, ss.data(), ct.data(), sk.data(), p->secretkeybytes, n);
+    r.dec = n / seconds_since(start);
+    return r;
+}
+
+static void print_rates(const char *name, const Rates &r, const Rates &serial) {
+    printf("%-8s keypair %8.0f/s (x%.2f)  enc %8.0f/s (x%.2f)  dec %8.0f/s (x%.2f)\n", name,
+           r.keypair, r.keypair / serial.keypair, r.enc, r.enc / serial.enc, r.dec, r.dec / serial.dec);
+}
+
+int main(int argc, char **argv) {
+    unsigned int threads = std::thread::hardware_concurrency();
+    unsigned int n = 2000;
+
+    if (argc > 1) threads = static_cast<unsigned int>(strtoul(argv[1], NULL, 10));
+    if (argc > 2) n = static_cast<unsigned int>(strtoul(argv[2], NULL, 10));
+    if (argc > 3 || threads < 1) {
+        fprintf(stderr, "usage: %s [threads [n]]\n", argv[0]);
+        return 2;
+    }
+
+    const mlkem_params *timed = PQCLEAN_MLKEM_CLEAN_params(768);
+    Rates serial = {0, 0, 0};
+    if (n > 0) {
+        printf("%s, batches of %u\n", timed->algname, n);
+        time_batches(timed, n);  // warm-up, not counted
+        serial = time_batches(timed, n);
+        print_rates("serial", serial, serial);
+    }
+
+    for (unsigned int t = 1; t <= threads; t++) {
+        MlkemThreadPool pool(t);
+        PQCLEAN_MLKEM_CLEAN_set_executor(pool.executor());
+        for (unsigned int id : PARAM_SETS) {
+            for (unsigned int size : CHECK_SIZES) {
+                check(PQCLEAN_MLKEM_CLEAN_params(id), t, size);
+            }
+        }
+        if (n > 0) {
+            char name[16];
+            snprintf(name, sizeof(name), "%u thr", t);
+            print_rates(name, time_batches(timed, n), serial);
+        }
+        PQCLEAN_MLKEM_CLEAN_set_executor(NULL);
+    }
+
+    if (!failed) printf("batch calls match the serial ones on 1 to %u threads\n", threads);
+    return failed;
+}
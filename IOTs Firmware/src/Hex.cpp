@@ -0,0 +1,54 @@
+#include "Hex.h"
+
+// The two digits of each byte value
+static const char hexPairs[513] =
+    "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+// The value of each hex digit, either case; X for anything else
+#define X 0xff
+static const uint8_t hexValues[256] = {
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, X, X, X, X, X, X,
+    X, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+};
+#undef X
+
+char* bytesToHex(char* out, const uint8_t* bytes, size_t len) {
+    // Back to front, so that out may be bytes itself
+    for (size_t i = len; i-- > 0;) {
+        const char* pair = hexPairs + 2 * bytes[i];
+        out[2 * i + 1] = pair[1];
+        out[2 * i] = pair[0];
+    }
+    return out + 2 * len;
+}
+
+bool hexToBytes(const char* hex, uint8_t* bytes, size_t len) {
+    uint8_t bad = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t hi = hexValues[(uint8_t)hex[2 * i]], lo = hexValues[(uint8_t)hex[2 * i + 1]];
+        bad |= (hi | lo) & 0xf0;
+        bytes[i] = (uint8_t)(hi << 4 | (lo & 15));
+    }
+    return bad == 0;
+}
@@ -0,0 +1,21 @@
+#ifndef HEX_H
+#define HEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Lowercase hex for the wire format, a table lookup per byte. Both
+ * directions work in place, so an envelope can be decoded or expanded
+ * where it lies in a frame.
+ */
+
+// Writes the 2 * len hex digits of bytes at out, which may be bytes itself
+// or must not overlap it, and returns the end. No terminator.
+char* bytesToHex(char* out, const uint8_t* bytes, size_t len);
+
+// Decodes the 2 * len digits at hex, either case, into len bytes at bytes,
+// which may be hex itself. False if any of them is not a hex digit.
+bool hexToBytes(const char* hex, uint8_t* bytes, size_t len);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef MESSAGE_ARENA_H
+#define MESSAGE_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Fixed scratch memory for the message path of the server connection, so
+ * that handling a frame or sending a pulse takes nothing from the heap.
+ * Memory is handed out front to back and all given back at once by
+ * reset(), before each frame is handled and each pulse is sent; nothing
+ * taken from it may be kept past that.
+ *
+ * The largest user is the handshake: the ML-KEM-1024 auth:response or
+ * key:public frame in hex, about 3.3 KB, next to its JSON document.
+ */
+#ifndef MESSAGE_ARENA_BYTES
+#define MESSAGE_ARENA_BYTES 6144
+#endif
+
+// Bytes in a buffer owned by someone else: a frame, the arena, a key
+struct Span {
+    uint8_t* data;
+    size_t len;
+};
+
+class MessageArena {
+public:
+    MessageArena() : used_(0) {}
+
+    void reset() { used_ = 0; }
+    // The most one take() can get
+    size_t available() const {
+        size_t start = (used_ + 3) & ~(size_t)3;
+        return start < sizeof(buf_) ? sizeof(buf_) - start : 0;
+    }
+
+    // size bytes, 4-byte aligned, or NULL if there is not that much left
+    uint8_t* take(size_t size) {
+        size_t start = (used_ + 3) & ~(size_t)3;
+        if (start > sizeof(buf_) || size > sizeof(buf_) - start) return NULL;
+        used_ = start + size;
+        return buf_ + start;
+    }
+
+private:
+    alignas(4) uint8_t buf_[MESSAGE_ARENA_BYTES];
+    size_t used_;
+
+    MessageArena(const MessageArena&);
+    MessageArena& operator=(const MessageArena&);
+};
+
+#endif
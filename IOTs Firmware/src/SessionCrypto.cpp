@@ -0,0 +1,161 @@
+#include "SessionCrypto.h"
+
+#include <string.h>
+
+#include <esp_system.h>
+#include "mbedtls/md.h"
+
+static const char infoDeviceToServer[] = "mlkem-session v1 device->server";
+static const char infoServerToDevice[] = "mlkem-session v1 server->device";
+static const char infoRekey[] = "mlkem-session v1 rekey";
+
+// HKDF-Expand (RFC 5869) with SHA-256 and a 32-byte PRK; len <= 255 * 32
+static void hkdfExpand(const uint8_t prk[32], const char* info, uint8_t* out, size_t len) {
+    mbedtls_md_context_t ctx;
+    uint8_t t[32];
+    uint8_t counter = 1;
+
+    mbedtls_md_init(&ctx);
+    mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    for (size_t done = 0; done < len; counter++) {
+        size_t n = len - done < sizeof(t) ? len - done : sizeof(t);
+        mbedtls_md_hmac_starts(&ctx, prk, 32);
+        if (counter > 1) mbedtls_md_hmac_update(&ctx, t, sizeof(t));
+        mbedtls_md_hmac_update(&ctx, (const unsigned char*)info, strlen(info));
+        mbedtls_md_hmac_update(&ctx, &counter, 1);
+        mbedtls_md_hmac_finish(&ctx, t);
+        memcpy(out + done, t, n);
+        done += n;
+    }
+    mbedtls_md_free(&ctx);
+    memset(t, 0, sizeof(t));
+}
+
+SessionCrypto::SessionCrypto() : active_(false), legacy_(false) {
+    mbedtls_gcm_init(&send_.gcm);
+    mbedtls_gcm_init(&recv_.gcm);
+}
+
+SessionCrypto::~SessionCrypto() {
+    end();
+}
+
+void SessionCrypto::setKey(Direction& d, const uint8_t key[SESSION_KEYBYTES]) {
+    memcpy(d.key, key, SESSION_KEYBYTES);
+    mbedtls_gcm_setkey(&d.gcm, MBEDTLS_CIPHER_ID_AES, d.key, 8 * SESSION_KEYBYTES);
+}
+
+void SessionCrypto::nonce(const Direction& d, uint32_t epoch, uint64_t seq, uint8_t iv[SESSION_IVBYTES]) {
+    for (int i = 0; i < 4; i++) iv[i] = d.iv[i] ^ (uint8_t)(epoch >> (24 - 8 * i));
+    for (int i = 0; i < 8; i++) iv[4 + i] = d.iv[4 + i] ^ (uint8_t)(seq >> (56 - 8 * i));
+}
+
+void SessionCrypto::begin(const uint8_t ss[32], const uint8_t* salt, size_t saltLen) {
+    mbedtls_md_context_t ctx;
+    uint8_t prk[32], okm[SESSION_KEYBYTES + SESSION_IVBYTES];
+
+    end();
+    mbedtls_md_init(&ctx);
+    mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    mbedtls_md_hmac_starts(&ctx, salt, saltLen);
+    mbedtls_md_hmac_update(&ctx, ss, 32);
+    mbedtls_md_hmac_finish(&ctx, prk);
+    mbedtls_md_free(&ctx);
+
+    hkdfExpand(prk, infoDeviceToServer, okm, sizeof(okm));
+    setKey(send_, okm);
+    memcpy(send_.iv, okm + SESSION_KEYBYTES, SESSION_IVBYTES);
+    hkdfExpand(prk, infoServerToDevice, okm, sizeof(okm));
+    setKey(recv_, okm);
+    memcpy(recv_.iv, okm + SESSION_KEYBYTES, SESSION_IVBYTES);
+
+    memset(prk, 0, sizeof(prk));
+    memset(okm, 0, sizeof(okm));
+    legacy_ = false;
+    active_ = true;
+}
+
+void SessionCrypto::beginLegacy(const uint8_t ss[32]) {
+    end();
+    setKey(send_, ss);
+    setKey(recv_, ss);
+    legacy_ = true;
+    active_ = true;
+}
+
+void SessionCrypto::end() {
+    Direction* dirs[2] = {&send_, &recv_};
+    for (int i = 0; i < 2; i++) {
+        Direction* d = dirs[i];
+        mbedtls_gcm_free(&d->gcm);
+        mbedtls_gcm_init(&d->gcm);
+        memset(d->key, 0, sizeof(d->key));
+        memset(d->iv, 0, sizeof(d->iv));
+        d->epoch = 0;
+        d->seq = 0;
+        d->bytes = 0;
+    }
+    active_ = false;
+}
+
+void SessionCrypto::seal(const uint8_t* in, size_t len, uint8_t* out, uint8_t iv[SESSION_IVBYTES],
+                         uint8_t tag[SESSION_TAGBYTES]) {
+    if (legacy_) {
+        esp_fill_random(iv, SESSION_IVBYTES);
+    } else {
+        if (send_.seq >= SESSION_REKEY_MESSAGES || send_.bytes >= SESSION_REKEY_BYTES) {
+            uint8_t next[SESSION_KEYBYTES];
+            hkdfExpand(send_.key, infoRekey, next, sizeof(next));
+            setKey(send_, next);
+            memset(next, 0, sizeof(next));
+            send_.epoch++;
+            send_.seq = 0;
+            send_.bytes = 0;
+        }
+        nonce(send_, send_.epoch, send_.seq, iv);
+        send_.seq++;
+        send_.bytes += len;
+    }
+    mbedtls_gcm_crypt_and_tag(&send_.gcm, MBEDTLS_GCM_ENCRYPT, len, iv, SESSION_IVBYTES, NULL, 0, in, out,
+                              SESSION_TAGBYTES, tag);
+}
+
+bool SessionCrypto::open(const uint8_t iv[SESSION_IVBYTES], const uint8_t* in, size_t len,
+                         const uint8_t tag[SESSION_TAGBYTES], uint8_t* out) {
+    if (!active_) return false;
+    if (legacy_) {
+        return mbedtls_gcm_auth_decrypt(&recv_.gcm, len, iv, SESSION_IVBYTES, NULL, 0, tag, SESSION_TAGBYTES, in,
+                                        out) == 0;
+    }
+
+    uint32_t epoch = 0;
+    uint64_t seq = 0;
+    for (int i = 0; i < 4; i++) epoch = epoch << 8 | (uint8_t)(iv[i] ^ recv_.iv[i]);
+    for (int i = 4; i < 12; i++) seq = seq << 8 | (uint8_t)(iv[i] ^ recv_.iv[i]);
+    if (epoch < recv_.epoch || epoch - recv_.epoch > SESSION_MAX_SKIP || (epoch == recv_.epoch && seq < recv_.seq)) {
+        return false;
+    }
+
+    if (epoch == recv_.epoch) {
+        if (mbedtls_gcm_auth_decrypt(&recv_.gcm, len, iv, SESSION_IVBYTES, NULL, 0, tag, SESSION_TAGBYTES, in,
+                                     out) != 0) {
+            return false;
+        }
+    } else {
+        // The sender has rekeyed; follow it only once the message authenticates
+        uint8_t next[SESSION_KEYBYTES];
+        mbedtls_gcm_context gcm;
+        memcpy(next, recv_.key, sizeof(next));
+        for (uint32_t e = recv_.epoch; e < epoch; e++) hkdfExpand(next, infoRekey, next, sizeof(next));
+        mbedtls_gcm_init(&gcm);
+        mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, next, 8 * SESSION_KEYBYTES);
+        int ret = mbedtls_gcm_auth_decrypt(&gcm, len, iv, SESSION_IVBYTES, NULL, 0, tag, SESSION_TAGBYTES, in, out);
+        mbedtls_gcm_free(&gcm);
+        if (ret == 0) setKey(recv_, next);
+        memset(next, 0, sizeof(next));
+        if (ret != 0) return false;
+        recv_.epoch = epoch;
+    }
+    recv_.seq = seq + 1;
+    return true;
+}
@@ -0,0 +1,82 @@
+#ifndef SESSION_CRYPTO_H
+#define SESSION_CRYPTO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mbedtls/gcm.h"
+
+/*
+ * AES-256-GCM for the messages of one authenticated session, set up once
+ * after auth:success and kept until the connection drops.
+ *
+ * Version 1 (both sides put "session":1 in auth:init / auth:success):
+ *   PRK       = HMAC-SHA256(salt = the auth:challenge nonce as sent, ss)
+ *   key || iv = HKDF-Expand(PRK, "mlkem-session v1 device->server", 44)
+ *               and likewise "server->device", one pair per direction
+ *   nonce     = iv XOR (epoch as 4 bytes || sequence as 8, big-endian)
+ * The sequence counts the messages sent under the current key. A sender
+ * moves to the next epoch, key = HKDF-Expand(key, "mlkem-session v1 rekey",
+ * 32), once a key has sealed SESSION_REKEY_MESSAGES messages or
+ * SESSION_REKEY_BYTES bytes; the receiver follows the epoch it reads out of
+ * the nonce, and rejects nonces it has already seen.
+ *
+ * Legacy servers get the old scheme: the KEM shared secret as the key both
+ * ways and random nonces, though the GCM contexts are still kept.
+ */
+#define SESSION_VERSION 1
+#define SESSION_KEYBYTES 32
+#define SESSION_IVBYTES 12
+#define SESSION_TAGBYTES 16
+
+#ifndef SESSION_REKEY_MESSAGES
+#define SESSION_REKEY_MESSAGES 65536UL
+#endif
+#ifndef SESSION_REKEY_BYTES
+#define SESSION_REKEY_BYTES (16UL << 20)
+#endif
+// Epochs a received message may be ahead of the receiver
+#define SESSION_MAX_SKIP 16
+
+class SessionCrypto {
+public:
+    SessionCrypto();
+    ~SessionCrypto();
+
+    // Version 1 keys from the shared secret, salted with the challenge nonce
+    void begin(const uint8_t ss[32], const uint8_t* salt, size_t saltLen);
+    // The pre-version 1 scheme
+    void beginLegacy(const uint8_t ss[32]);
+    void end();
+    bool active() const { return active_; }
+
+    // Encrypts len bytes from in to out, which may be the same buffer, and
+    // writes the nonce and tag to go with them
+    void seal(const uint8_t* in, size_t len, uint8_t* out, uint8_t iv[SESSION_IVBYTES],
+              uint8_t tag[SESSION_TAGBYTES]);
+    // Decrypts and authenticates; in and out may be the same buffer. False
+    // if the tag does not match or the nonce is stale.
+    bool open(const uint8_t iv[SESSION_IVBYTES], const uint8_t* in, size_t len,
+              const uint8_t tag[SESSION_TAGBYTES], uint8_t* out);
+
+private:
+    struct Direction {
+        mbedtls_gcm_context gcm;
+        uint8_t key[SESSION_KEYBYTES];
+        uint8_t iv[SESSION_IVBYTES];
+        uint32_t epoch;
+        uint64_t seq;       // next to send, or lowest acceptable to receive
+        uint64_t bytes;
+    };
+
+    static void setKey(Direction& d, const uint8_t key[SESSION_KEYBYTES]);
+    static void nonce(const Direction& d, uint32_t epoch, uint64_t seq, uint8_t iv[SESSION_IVBYTES]);
+
+    Direction send_, recv_;
+    bool active_, legacy_;
+
+    SessionCrypto(const SessionCrypto&);
+    SessionCrypto& operator=(const SessionCrypto&);
+};
+
+#endif
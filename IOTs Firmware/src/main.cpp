@@ -5,6 +5,7 @@
 #include <ArduinoJson.h>
 #include <WiFiMulti.h>
 #include <Adafruit_NeoPixel.h>
+#include <Preferences.h>
 
 
 #include "mbedtls/md.h"
@@ -12,20 +13,54 @@
 
 
 extern "C" {
-    #include "api.h"
+    #include "mlkem.h"
+    #include "fips202.h"
 }
 
 #include "Secrets.h" 
+#include "SessionCrypto.h"
+#include "Hex.h"
+#include "MessageArena.h"
 
 #define LED_PIN 48
 #define NUM_PIXELS 1
 
+// ML-KEM parameter set requested in auth:init (512, 768 or 1024); the
+// server has the final say and names the set it used in auth:challenge.
+#ifndef KEM_PARAM_SET
+#define KEM_PARAM_SET 768
+#endif
+
+// Ask for Socket.IO binary attachments in auth:init, so that pk, the
+// ciphertext and the AES-GCM envelopes travel as raw bytes rather than as
+// hex inside JSON. A server that does not know the flag answers in hex, and
+// the device then stays on hex for the session.
+#ifndef WIRE_BINARY
+#define WIRE_BINARY 1
+#endif
+
+// Split ML-KEM matrix and noise sampling between both cores (0: loop task only).
+#ifndef KEM_PARALLEL
+#define KEM_PARALLEL 1
+#endif
+
+// ML-KEM-1024 encapsulation needs more than the default 8 KB loop stack,
+// unless the library is built with KYBER_LOWSTACK (about 4 KB at most).
+#if !defined(KYBER_LOWSTACK)
+SET_LOOP_TASK_STACK_SIZE(24 * 1024);
+#endif
+
 Adafruit_NeoPixel pixel(NUM_PIXELS, LED_PIN, NEO_GRB + NEO_KHZ800);
 WiFiMulti wifiMulti;
 WebSocketsClient webSocket;
 
 String macAddress;
 bool isAuthenticated = false;
+bool binaryWire = false;  // the server sent auth:challenge with pk attached
+
+// A 451- packet waiting for its attachment
+char pendingEvent[256];
+size_t pendingEventLen = 0;
 
 unsigned long lastWifiReconnectAttempt = 0;
 const unsigned long WIFI_RECONNECT_INTERVAL = 5000;
@@ -34,132 +69,566 @@ const unsigned long LED_BLINK_INTERVAL = 500;
 bool ledOn = false;
 
 
-void hexStringToBytes(String hex, uint8_t* bytes, size_t len);
-String bytesToHexString(const uint8_t* bytes, size_t len);
+// Scratch memory for the frames of the server connection (MessageArena.h)
+MessageArena arena;
 
+// ArduinoJson documents in the arena. They never grow, and their memory
+// goes back with the rest of the arena.
+struct ArenaAllocator {
+    void* allocate(size_t size) { return arena.take(size); }
+    void deallocate(void*) {}
+    void* reallocate(void*, size_t) { return NULL; }
+};
+typedef BasicJsonDocument<ArenaAllocator> ArenaJsonDocument;
 
+// Enough for any event the server sends, parsed in place: the strings stay
+// in the frame
+#define EVENT_DOC_BYTES 512
 
-String hmacSHA256(String key, String payload) {
-    byte hmacResult[32];
+// HMAC-SHA256 of msg under key, as lowercase hex with a terminator
+void hmacSHA256(const char* key, Span msg, char hex[65]) {
+    uint8_t mac[32];
     mbedtls_md_context_t ctx;
-    mbedtls_md_type_t md_type = MBEDTLS_MD_SHA256;
 
     mbedtls_md_init(&ctx);
-    mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(md_type), 1);
-    mbedtls_md_hmac_starts(&ctx, (const unsigned char *)key.c_str(), key.length());
-    mbedtls_md_hmac_update(&ctx, (const unsigned char *)payload.c_str(), payload.length());
-    mbedtls_md_hmac_finish(&ctx, hmacResult);
+    mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    mbedtls_md_hmac_starts(&ctx, (const unsigned char*)key, strlen(key));
+    mbedtls_md_hmac_update(&ctx, msg.data, msg.len);
+    mbedtls_md_hmac_finish(&ctx, mac);
     mbedtls_md_free(&ctx);
 
-    String hashStr = "";
-    for (int i = 0; i < 32; i++) {
-        if (hmacResult[i] < 16) hashStr += "0";
-        hashStr += String(hmacResult[i], HEX);
-    }
-    return hashStr;
+    *bytesToHex(hex, mac, sizeof(mac)) = '\0';
 }
 
+// The KEM shared secret of the handshake in progress, and the nonce it was
+// answered to; the session keys are derived from both on auth:success
 uint8_t sharedSecret[32];
 bool hasSharedSecret = false;
+char authNonce[65];
+size_t authNonceLen = 0;
+
+SessionCrypto session;
+unsigned int sessionVersion = 0;  // 0 for the legacy scheme
+
+// Sets up the session for ss in the scheme the server agreed to
+void sessionBegin(const uint8_t* ss) {
+    if (sessionVersion == SESSION_VERSION) {
+        session.begin(ss, (const uint8_t*)authNonce, authNonceLen);
+    } else {
+        session.beginLegacy(ss);
+    }
+}
 
-String encryptMessage(String plaintext) {
-    if (!hasSharedSecret) return plaintext;
+// Server public keys in expanded form (H(pk), t and A^T), keyed by H(pk),
+// which is also the first 32 bytes of an expanded key. The backend rotates
+// its keypair rarely, so a reconnect normally finds its key here and the
+// encapsulation skips the matrix generation.
+#define EPK_CACHE_SLOTS 2
+
+struct ExpandedPkSlot {
+    unsigned int paramSet;  // 0 if empty
+    unsigned long lastUsed;
+    uint8_t epk[PQCLEAN_MLKEM_CLEAN_MAX_EXPANDEDPKBYTES];
+};
+
+ExpandedPkSlot epkCache[EPK_CACHE_SLOTS];
+unsigned long epkCacheClock = 0;
+
+// Returns the cached expanded key whose H(pk) is hpk, or NULL.
+const uint8_t* findExpandedPublicKey(const mlkem_params* kem, const uint8_t* hpk) {
+    epkCacheClock++;
+    for (int i = 0; i < EPK_CACHE_SLOTS; i++) {
+        ExpandedPkSlot* slot = &epkCache[i];
+        if (slot->paramSet == kem->id && memcmp(slot->epk, hpk, 32) == 0) {
+            slot->lastUsed = epkCacheClock;
+            return slot->epk;
+        }
+    }
+    return NULL;
+}
 
-    mbedtls_gcm_context aes;
-    mbedtls_gcm_init(&aes);
-    mbedtls_gcm_setkey(&aes, MBEDTLS_CIPHER_ID_AES, sharedSecret, 256);
+// Expands pk into the least recently used slot and returns it.
+const uint8_t* cacheExpandedPublicKey(const mlkem_params* kem, const uint8_t* pk) {
+    ExpandedPkSlot* victim = &epkCache[0];
 
-    uint8_t iv[12];
-    esp_fill_random(iv, 12);
-    
-    size_t len = plaintext.length();
-    uint8_t* output = new uint8_t[len];
-    uint8_t tag[16];
+    for (int i = 1; i < EPK_CACHE_SLOTS; i++) {
+        if (epkCache[i].lastUsed < victim->lastUsed) victim = &epkCache[i];
+    }
+    kem->expand_pk(victim->epk, pk);
+    victim->paramSet = kem->id;
+    victim->lastUsed = ++epkCacheClock;
+    return victim->epk;
+}
 
-    mbedtls_gcm_crypt_and_tag(&aes, MBEDTLS_GCM_ENCRYPT, len, iv, 12, NULL, 0, (const unsigned char*)plaintext.c_str(), output, 16, tag);
-    
-    mbedtls_gcm_free(&aes);
+// A challenge with a key that is not cached is answered with a streaming
+// encapsulation straight from the received bytes; the key is expanded
+// into the cache afterwards, from loop(), instead of on the handshake path.
+uint8_t challengePk[PQCLEAN_MLKEM_CLEAN_MAX_PUBLICKEYBYTES];
+unsigned int challengePkSet = 0;  // parameter set of challengePk awaiting expansion, 0 if none
+mlkem_enc_stream encStream;
+
+// Clears a stream that will not be emitted: after enc_stream_start it
+// holds the coins and half of the ciphertext.
+void encStreamWipe() {
+    memset(&encStream, 0, sizeof(encStream));
+}
 
-    DynamicJsonDocument doc(2048);
+// Ready (ct, ss) pairs for the pinned server key, i.e. the last one seen in
+// auth:challenge. loop() tops the pool up one encapsulation per pass, so the
+// next handshake with the same key only has to pop a pair. A challenge with
+// any other key invalidates the pool and pins that key instead.
+#define ENC_POOL_SIZE 2
+
+struct EncPool {
+    unsigned int paramSet;  // 0 if no key is pinned
+    uint8_t hpk[32];        // H(pk) of the pinned key
+    unsigned int count;
+    uint8_t ct[ENC_POOL_SIZE][PQCLEAN_MLKEM_CLEAN_MAX_CIPHERTEXTBYTES];
+    uint8_t ss[ENC_POOL_SIZE][PQCLEAN_MLKEM_CLEAN_BYTES];
+};
+
+EncPool encPool;
+
+// Drops all pairs and pins the key whose expanded form is epk.
+void encPoolPin(const mlkem_params* kem, const uint8_t* epk) {
+    memset(encPool.ss, 0, sizeof(encPool.ss));
+    encPool.count = 0;
+    encPool.paramSet = kem->id;
+    memcpy(encPool.hpk, epk, sizeof(encPool.hpk));
+}
 
-    doc["iv"] = bytesToHexString(iv, 12);
-    doc["tag"] = bytesToHexString(tag, 16);
-    doc["data"] = bytesToHexString(output, len);
-    
-    delete[] output;
-    
-    String jsonString;
-    serializeJson(doc, jsonString);
-    return jsonString;
+// Drops all pairs and unpins the key.
+void encPoolDrop() {
+    memset(encPool.ss, 0, sizeof(encPool.ss));
+    encPool.count = 0;
+    encPool.paramSet = 0;
 }
 
-String decryptMessage(String jsonPayload) {
-    if (!hasSharedSecret) return "";
+// Pops a precomputed pair for the key whose expanded form is epk. Returns
+// false if there is none; if the key is not the pinned one, it is pinned.
+bool encPoolTake(const mlkem_params* kem, const uint8_t* epk, uint8_t* ct, uint8_t* ss) {
+    if (encPool.paramSet != kem->id || memcmp(encPool.hpk, epk, sizeof(encPool.hpk)) != 0) {
+        encPoolPin(kem, epk);
+        return false;
+    }
+    if (encPool.count == 0) return false;
 
-    DynamicJsonDocument doc(2048);
-    if (deserializeJson(doc, jsonPayload)) return "";
+    encPool.count--;
+    memcpy(ct, encPool.ct[encPool.count], kem->ciphertextbytes);
+    memcpy(ss, encPool.ss[encPool.count], PQCLEAN_MLKEM_CLEAN_BYTES);
+    memset(encPool.ss[encPool.count], 0, PQCLEAN_MLKEM_CLEAN_BYTES);
+    return true;
+}
+
+// Expands a pending challenge key or adds one pair to the pool, at most one
+// of the two per call. Called from loop() while idle.
+void encPoolRefill() {
+    if (challengePkSet != 0) {
+        const mlkem_params* kem = PQCLEAN_MLKEM_CLEAN_params(challengePkSet);
+        encPoolPin(kem, cacheExpandedPublicKey(kem, challengePk));
+        challengePkSet = 0;
+        return;
+    }
+    if (encPool.paramSet == 0 || encPool.count == ENC_POOL_SIZE) return;
+
+    const mlkem_params* kem = PQCLEAN_MLKEM_CLEAN_params(encPool.paramSet);
+    for (int i = 0; i < EPK_CACHE_SLOTS; i++) {
+        const ExpandedPkSlot* slot = &epkCache[i];
+        if (slot->paramSet == encPool.paramSet && memcmp(slot->epk, encPool.hpk, sizeof(encPool.hpk)) == 0) {
+            kem->enc_expanded(encPool.ct[encPool.count], encPool.ss[encPool.count], slot->epk);
+            encPool.count++;
+            return;
+        }
+    }
+    // The expanded key was evicted; wait for the next challenge to pin again
+    encPool.paramSet = 0;
+}
 
-    String ivHex = doc["iv"];
-    String tagHex = doc["tag"];
-    String dataHex = doc["data"];
+// Static device key pair, so that the server can send a new session key
+// encapsulated to the device (key:exchange) without a handshake. The
+// exchange has to come sealed under the current session, so only the
+// server the device authenticated to can replace the key. It is kept in
+// NVS in one of two forms:
+//   DEVICE_KEY_SEED      the 64-byte keypair_derand seed. The key pair is
+//                        derived on first use, not at boot.
+//   DEVICE_KEY_EXPANDED  the expanded secret key (NTT(s), H(pk), t, A^T, z)
+//                        and rho. Nothing to derive, and decapsulation
+//                        skips the matrix generation.
+#define DEVICE_KEY_SEED 1
+#define DEVICE_KEY_EXPANDED 2
+#ifndef DEVICE_KEY_MODE
+#define DEVICE_KEY_MODE DEVICE_KEY_SEED
+#endif
+
+struct DeviceKey {
+    const mlkem_params* kem;  // NULL until deviceKeyBegin()
+    bool derived;             // pk and the secret key below are set
+    uint8_t pk[PQCLEAN_MLKEM_CLEAN_MAX_PUBLICKEYBYTES];
+#if DEVICE_KEY_MODE == DEVICE_KEY_EXPANDED
+    uint8_t esk[PQCLEAN_MLKEM_CLEAN_MAX_EXPANDEDSKBYTES + 32];  // esk || rho, as stored
+#else
+    uint8_t seed[64];
+    uint8_t sk[PQCLEAN_MLKEM_CLEAN_MAX_SECRETKEYBYTES];
+#endif
+};
+
+DeviceKey deviceKey;
+
+// Loads the device key for kem from NVS, creating and storing a new one on
+// first boot. Returns false if NVS is not usable.
+bool deviceKeyBegin(const mlkem_params* kem) {
+    Preferences prefs;
+    char name[16];
+    if (!prefs.begin("devkey", false)) return false;
+
+#if DEVICE_KEY_MODE == DEVICE_KEY_EXPANDED
+    // pk is t, which esk holds after the IND-CPA secret key and H(pk),
+    // followed by rho
+    const size_t tBytes = kem->publickeybytes - 32;
+    const size_t stored = kem->expandedskbytes + 32;
+    snprintf(name, sizeof(name), "esk%u", kem->id);
+    if (prefs.getBytes(name, deviceKey.esk, stored) != stored) {
+        uint8_t seed[64];
+        uint8_t* sk = new uint8_t[kem->secretkeybytes];  // first boot only
+        esp_fill_random(seed, sizeof(seed));
+        kem->keypair_derand(deviceKey.pk, sk, seed);
+        kem->expand_sk(deviceKey.esk, sk);
+        memcpy(deviceKey.esk + kem->expandedskbytes, deviceKey.pk + tBytes, 32);
+        prefs.putBytes(name, deviceKey.esk, stored);
+        memset(seed, 0, sizeof(seed));
+        memset(sk, 0, kem->secretkeybytes);
+        delete[] sk;
+    }
+    memcpy(deviceKey.pk, deviceKey.esk + tBytes + 32, tBytes);
+    memcpy(deviceKey.pk + tBytes, deviceKey.esk + kem->expandedskbytes, 32);
+    deviceKey.derived = true;
+#else
+    snprintf(name, sizeof(name), "seed%u", kem->id);
+    if (prefs.getBytes(name, deviceKey.seed, sizeof(deviceKey.seed)) != sizeof(deviceKey.seed)) {
+        esp_fill_random(deviceKey.seed, sizeof(deviceKey.seed));
+        prefs.putBytes(name, deviceKey.seed, sizeof(deviceKey.seed));
+    }
+    deviceKey.derived = false;
+#endif
+    prefs.end();
+    deviceKey.kem = kem;
+    return true;
+}
 
-    uint8_t iv[12];
-    uint8_t tag[16];
-    size_t dataLen = dataHex.length() / 2;
-    uint8_t* data = new uint8_t[dataLen];
-    uint8_t* output = new uint8_t[dataLen];
+// Derives the key pair from the seed if that has not happened yet.
+void deviceKeyDerive() {
+#if DEVICE_KEY_MODE == DEVICE_KEY_SEED
+    if (deviceKey.derived) return;
+    deviceKey.kem->keypair_derand(deviceKey.pk, deviceKey.sk, deviceKey.seed);
+    deviceKey.derived = true;
+#endif
+}
 
-    hexStringToBytes(ivHex, iv, 12);
-    hexStringToBytes(tagHex, tag, 16);
-    hexStringToBytes(dataHex, data, dataLen);
+// Decapsulates ct, which must be kem->ciphertextbytes long, with the device key.
+void deviceKeyDecaps(uint8_t* ss, const uint8_t* ct) {
+    deviceKeyDerive();
+#if DEVICE_KEY_MODE == DEVICE_KEY_EXPANDED
+    deviceKey.kem->dec_expanded(ss, ct, deviceKey.esk);
+#else
+    deviceKey.kem->dec(ss, ct, deviceKey.sk);
+#endif
+}
 
-    mbedtls_gcm_context aes;
-    mbedtls_gcm_init(&aes);
-    mbedtls_gcm_setkey(&aes, MBEDTLS_CIPHER_ID_AES, sharedSecret, 256);
+// Takes room for a frame of up to len bytes from the arena, behind the
+// space the WebSockets library needs to put the frame header in, so that it
+// sends the frame from there instead of copying it into a buffer of its
+// own. NULL if the arena is full.
+uint8_t* frameTake(size_t len) {
+    uint8_t* p = arena.take(WEBSOCKETS_MAX_HEADER_SIZE + len);
+    return p ? p + WEBSOCKETS_MAX_HEADER_SIZE : NULL;
+}
 
-    int ret = mbedtls_gcm_auth_decrypt(&aes, dataLen, iv, 12, NULL, 0, tag, 16, data, output);
-    mbedtls_gcm_free(&aes);
-    
-    delete[] data;
+// Send len bytes at frame, which came from frameTake(). The library masks
+// them in place.
+void sendTextFrame(uint8_t* frame, size_t len) {
+    webSocket.sendTXT(frame - WEBSOCKETS_MAX_HEADER_SIZE, len, true);
+}
 
-    if (ret != 0) {
-        delete[] output;
-        Serial.println("[AES] Decryption/Auth Failed!");
-        return "";
-    }
+void sendBinaryFrame(uint8_t* frame, size_t len) {
+    webSocket.sendBIN(frame - WEBSOCKETS_MAX_HEADER_SIZE, len, true);
+}
 
-    String result = "";
-    for(size_t i=0; i<dataLen; i++) result += (char)output[i];
-    delete[] output;
-    
-    return result;
+void sendSocketEvent(const char* eventName, const JsonDocument& doc) {
+    size_t room = strlen(eventName) + measureJson(doc) + 8;
+    char* frame = (char*)frameTake(room);
+    if (!frame) return;
+    int len = snprintf(frame, room, "42[\"%s\",", eventName);
+    len += serializeJson(doc, frame + len, room - len);
+    frame[len++] = ']';
+    sendTextFrame((uint8_t*)frame, len);
 }
 
+// Binary session envelope, iv || ciphertext || tag, where it lies in the
+// receive buffer. The plaintext is decrypted in place over the ciphertext;
+// returns it, or an empty span if the envelope does not open.
+Span openBinaryEnvelope(uint8_t* env, size_t len) {
+    Span plain = {env + 12, 0};
+    if (!session.active() || len < 28) return plain;
 
+    if (session.open(env, env + 12, len - 28, env + len - 16, env + 12)) plain.len = len - 28;
+    return plain;
+}
 
-void hexStringToBytes(String hex, uint8_t* bytes, size_t len) {
-    for (size_t i = 0; i < len; i++) {
-        String byteStr = hex.substring(i * 2, i * 2 + 2);
-        bytes[i] = (uint8_t) strtol(byteStr.c_str(), NULL, 16);
+// The digits of the string field key in a JSON object as the servers write
+// it, without whitespace; only for fields that hold hex, so without escapes.
+// An empty span if there is no such field.
+Span jsonHexField(char* obj, size_t len, const char* key) {
+    char needle[16];
+    int n = snprintf(needle, sizeof(needle), "\"%s\":\"", key);
+    Span field = {NULL, 0};
+    for (size_t i = 0; n > 0 && i + n <= len; i++) {
+        if (memcmp(obj + i, needle, n) != 0) continue;
+        char* start = obj + i + n;
+        char* end = (char*)memchr(start, '"', len - (i + n));
+        if (end) {
+            field.data = (uint8_t*)start;
+            field.len = end - start;
+        }
+        break;
     }
+    return field;
 }
 
-String bytesToHexString(const uint8_t* bytes, size_t len) {
-    String hex = "";
-    for (size_t i = 0; i < len; i++) {
-        if (bytes[i] < 16) hex += "0";
-        hex += String(bytes[i], HEX);
+// The {iv, tag, data} envelope, a JSON object in the receive buffer. The
+// data digits are decoded in place and the plaintext decrypted in place over
+// them; returns it, or an empty span if the envelope does not open.
+Span openHexEnvelope(char* obj, size_t len) {
+    Span iv = jsonHexField(obj, len, "iv"), tag = jsonHexField(obj, len, "tag");
+    Span data = jsonHexField(obj, len, "data");
+    Span plain = {data.data, 0};
+    uint8_t ivBytes[12], tagBytes[16];
+
+    if (!session.active() || iv.len != 24 || tag.len != 32 || !data.data || data.len % 2 != 0 ||
+            !hexToBytes((const char*)iv.data, ivBytes, 12) || !hexToBytes((const char*)tag.data, tagBytes, 16) ||
+            !hexToBytes((const char*)data.data, data.data, data.len / 2)) {
+        return plain;
     }
-    return hex;
+    if (session.open(ivBytes, data.data, data.len / 2, tagBytes, data.data)) plain.len = data.len / 2;
+    return plain;
 }
 
+// Handles the Socket.IO event in text, a 42 packet, or a 451- packet with
+// its attachment. Both are the receive buffers, and are decoded in place.
+void handleEvent(char* text, size_t len, uint8_t* attachment, size_t attachmentLen) {
+    char* json = (char*)memchr(text, '[', len);
+    if (!json) return;
+    len -= json - text;
+
+    // Messages, the one event that keeps coming, skip the JSON document:
+    // the envelope is opened where it lies
+    static const char messageHead[] = "[\"message\",";
+    const size_t messageHeadLen = sizeof(messageHead) - 1;
+    if (len > messageHeadLen && memcmp(json, messageHead, messageHeadLen) == 0) {
+        Span plain = attachment ? openBinaryEnvelope(attachment, attachmentLen)
+                                : openHexEnvelope(json + messageHeadLen, len - messageHeadLen);
+        if (plain.len) {
+            Serial.print("[MSG] ");
+            Serial.write(plain.data, plain.len);
+            Serial.println();
+        } else {
+            Serial.println("[AES] Decryption/Auth Failed!");
+        }
+        return;
+    }
+
+    // A new session key, encapsulated by the server to the device key. The
+    // ciphertext comes in an envelope of the current session, like a
+    // message; anything that does not open under it is dropped, as the
+    // decapsulation would give a key for any ciphertext at all.
+    static const char exchangeHead[] = "[\"key:exchange\",";
+    const size_t exchangeHeadLen = sizeof(exchangeHead) - 1;
+    if (len > exchangeHeadLen && memcmp(json, exchangeHead, exchangeHeadLen) == 0) {
+        if (!deviceKey.kem || !isAuthenticated) return;
+        const mlkem_params* kem = deviceKey.kem;
+        Span ct = attachment ? openBinaryEnvelope(attachment, attachmentLen)
+                             : openHexEnvelope(json + exchangeHeadLen, len - exchangeHeadLen);
+        if (ct.len == kem->ciphertextbytes) {
+            uint8_t ss[PQCLEAN_MLKEM_CLEAN_BYTES];
+            unsigned long t0 = micros();
+            deviceKeyDecaps(ss, ct.data);
+            unsigned long t1 = micros();
+            sessionBegin(ss);
+            memset(ss, 0, sizeof(ss));
+            Serial.printf("[Kyber] Session key replaced by key:exchange (%lu us).\n", t1 - t0);
+        } else {
+            Serial.println("[Kyber] Error: key:exchange not sealed under the session!");
+        }
+        return;
+    }
+
+    ArenaJsonDocument doc(EVENT_DOC_BYTES);
+    if (deserializeJson(doc, json, len)) return;
+
+    const char* event = doc[0] | "";
+
+    if (strcmp(event, "auth:challenge") == 0) {
+        const char* nonce = doc[1]["nonce"] | "";
+        authNonceLen = strnlen(nonce, sizeof(authNonce) - 1);
+        memcpy(authNonce, nonce, authNonceLen);
+        authNonce[authNonceLen] = '\0';
+        const char* pkHex = doc[1]["pk"] | "";
+        bool pkAttached = attachment && (doc[1]["pk"]["_placeholder"] | false);
+        unsigned int paramSet = doc[1]["paramSet"] | 768;
+        Serial.printf("[Auth] Received Nonce: %s\n", authNonce);
+
+        const mlkem_params *kem = PQCLEAN_MLKEM_CLEAN_params(paramSet);
+        // ct only ever lives on the loop task; keep it off its stack
+        static uint8_t ct[PQCLEAN_MLKEM_CLEAN_MAX_CIPHERTEXTBYTES];
+        uint8_t ss[PQCLEAN_MLKEM_CLEAN_BYTES];
+        size_t ctLen = 0;
+        bool streamed = false;
+
+        if (!kem) {
+            Serial.printf("[Kyber] Error: Unsupported parameter set %u!\n", paramSet);
+        } else if (pkAttached ? attachmentLen == kem->publickeybytes : strlen(pkHex) == kem->publickeybytes * 2) {
+            uint8_t hpk[32];
+            sha3_256incctx h;
+            const char* how;
+            unsigned long t0 = micros();
+
+            // Take in the key a polynomial at a time; the stream hashes
+            // each piece and unpacks t as it comes in. challengePk is
+            // overwritten, so an expansion still pending is dropped.
+            challengePkSet = 0;
+            kem->enc_stream_init(&encStream);
+            for (size_t off = 0; off < kem->publickeybytes; off += 384) {
+                size_t n = kem->publickeybytes - off < 384 ? kem->publickeybytes - off : 384;
+                if (pkAttached) {
+                    memcpy(challengePk + off, attachment + off, n);
+                } else if (!hexToBytes(pkHex + 2 * off, challengePk + off, n)) {
+                    // The handshake ends here: no auth:response, no shared secret
+                    Serial.println("[Kyber] Error: Invalid PK hex!");
+                    return;
+                }
+                kem->enc_stream_absorb(&encStream, challengePk + off, n);
+            }
+            sha3_256_inc_ctx_clone(&h, &encStream.hpk);
+            sha3_256_inc_finalize(hpk, &h);
+
+            const uint8_t* epk = findExpandedPublicKey(kem, hpk);
+            if (epk && encPoolTake(kem, epk, ct, ss)) {
+                how = "precomputed";
+            } else if (epk) {
+                kem->enc_expanded(ct, ss, epk);
+                how = "cached pk";
+            } else {
+                // The pool's pairs are for another key; drop them now rather
+                // than when loop() gets to expanding this one. The
+                // ciphertext is emitted into the frame below
+                encPoolDrop();
+                kem->enc_stream_start(&encStream, ss);
+                challengePkSet = kem->id;
+                streamed = true;
+                how = "new pk, streamed";
+            }
+            unsigned long t1 = micros();
+            ctLen = kem->ciphertextbytes;
+            memcpy(sharedSecret, ss, 32);
+            memset(ss, 0, sizeof(ss));
+            hasSharedSecret = true;
+            binaryWire = pkAttached;
+            Serial.printf("[Kyber] %s Shared Secret stored (%s, %lu us).\n", kem->algname, how, t1 - t0);
+        } else {
+            Serial.print("[Kyber] Error: Invalid PK length!");
+        }
+
+        // Signed over nonce || macAddress
+        char signature[65];
+        Span payloadForSig = {arena.take(authNonceLen + macAddress.length()), authNonceLen + macAddress.length()};
+        if (!payloadForSig.data) {
+            encStreamWipe();
+            return;
+        }
+        memcpy(payloadForSig.data, authNonce, authNonceLen);
+        memcpy(payloadForSig.data + authNonceLen, macAddress.c_str(), macAddress.length());
+        hmacSHA256(DEVICE_SHARED_SECRET, payloadForSig, signature);
+
+        // Room for either header with the signature in place of %s and up
+        // to ten digits in place of %u; the binary one is the longer
+        static const char responseHex[] =
+            "42[\"auth:response\",{\"signature\":\"%s\",\"paramSet\":%u,\"ciphertext\":\"";
+        static const char responseBinary[] =
+            "451-[\"auth:response\",{\"signature\":\"%s\",\"paramSet\":%u,"
+            "\"ciphertext\":{\"_placeholder\":true,\"num\":0}}]";
+        const size_t headRoom = sizeof(responseBinary) - 4 + 64 + 10;
+        char* frame = (char*)frameTake(headRoom + (binaryWire ? 0 : 2 * ctLen));
+        if (!frame) {
+            encStreamWipe();
+            return;
+        }
 
+        if (binaryWire && ctLen) {
+            // 451-["auth:response",{...}], then the ciphertext as its attachment
+            uint8_t* ctFrame = frameTake(ctLen);
+            int headLen = snprintf(frame, headRoom, responseBinary, signature, paramSet);
+            if (!ctFrame || headLen <= 0 || (size_t)headLen >= headRoom) {
+                encStreamWipe();
+                return;
+            }
+            if (streamed) {
+                size_t off = 0, n;
+                while ((n = kem->enc_stream_emit(&encStream, ctFrame + off)) > 0) off += n;
+            } else {
+                memcpy(ctFrame, ct, ctLen);
+            }
+            sendTextFrame((uint8_t*)frame, headLen);
+            sendBinaryFrame(ctFrame, ctLen);
+            return;
+        }
 
-void sendSocketEvent(String eventName, DynamicJsonDocument& doc) {
-    String jsonString;
-    serializeJson(doc, jsonString);
-    String output = "42[\"" + eventName + "\"," + jsonString + "]";
-    webSocket.sendTXT(output);
+        // 42["auth:response",{...}] written straight into the frame,
+        // the ciphertext hex-encoded a piece at a time
+        int headLen = snprintf(frame, headRoom, responseHex, signature, paramSet);
+        if (headLen <= 0 || (size_t)headLen >= headRoom) {
+            encStreamWipe();
+            return;
+        }
+        char* p = frame + headLen;
+        if (streamed) {
+            uint8_t piece[PQCLEAN_MLKEM_CLEAN_ENCSTREAM_MAXCHUNK];
+            size_t n;
+            while ((n = kem->enc_stream_emit(&encStream, piece)) > 0) {
+                p = bytesToHex(p, piece, n);
+            }
+        } else {
+            p = bytesToHex(p, ct, ctLen);
+        }
+        memcpy(p, "\"}]", 3);
+        sendTextFrame((uint8_t*)frame, p + 3 - frame);
+    }
+    else if (strcmp(event, "key:request") == 0 && deviceKey.kem && isAuthenticated && session.active()) {
+        // Only asked for inside a session, whose server is the one sending
+        // key:exchange. The public key is derived here rather than at boot
+        // in seed mode
+        const mlkem_params* kem = deviceKey.kem;
+        deviceKeyDerive();
+        const size_t headRoom = 64;
+        char* frame = (char*)frameTake(headRoom + 2 * kem->publickeybytes);
+        if (!frame) return;
+        char* p = frame + snprintf(frame, headRoom, "42[\"key:public\",{\"paramSet\":%u,\"pk\":\"", kem->id);
+        p = bytesToHex(p, deviceKey.pk, kem->publickeybytes);
+        memcpy(p, "\"}]", 3);
+        sendTextFrame((uint8_t*)frame, p + 3 - frame);
+    }
+    else if (strcmp(event, "auth:success") == 0) {
+        Serial.println("[Auth] SUCCESS");
+        isAuthenticated = true;
+        if (hasSharedSecret) {
+            sessionVersion = doc[1]["session"] | 0u;
+            sessionBegin(sharedSecret);
+            memset(sharedSecret, 0, sizeof(sharedSecret));
+            hasSharedSecret = false;
+        }
+    }
+    else if (strcmp(event, "auth:failed") == 0) {
+        Serial.println("[Auth] FAILED");
+        isAuthenticated = false;
+    }
 }
 
 void webSocketEvent(WStype_t type, uint8_t * payload, size_t length) {
@@ -167,86 +636,64 @@ void webSocketEvent(WStype_t type, uint8_t * payload, size_t length) {
         case WStype_DISCONNECTED:
             Serial.println("[WSc] Disconnected!");
             isAuthenticated = false;
+            session.end();
             break;
 
         case WStype_CONNECTED: {
             Serial.printf("[WSc] Connected to %s\n", payload);
-            DynamicJsonDocument doc(256);
+            binaryWire = false;
+            pendingEventLen = 0;
+            arena.reset();
+            ArenaJsonDocument doc(256);
             doc["macAddress"] = macAddress;
+            doc["paramSet"] = KEM_PARAM_SET;
+            doc["session"] = SESSION_VERSION;
+#if WIRE_BINARY
+            doc["binary"] = true;
+#endif
             sendSocketEvent("auth:init", doc);
             break;
         }
 
         case WStype_TEXT: {
-            String text = (char*)payload;
+            char* text = (char*)payload;
+            arena.reset();
+            if (length == 0) return;
 
-            if (text.startsWith("2")) {
+            if (text[0] == '2') {
                 Serial.println("[WSc] Received Ping (2), sending Pong (3)");
-                webSocket.sendTXT("3");
+                uint8_t* pong = frameTake(1);
+                if (!pong) return;
+                pong[0] = '3';
+                sendTextFrame(pong, 1);
                 return;
             }
 
-            if (text.startsWith("0")) {
+            if (text[0] == '0') {
                 Serial.printf("[WSc] Session Open: %s\n", payload);
                 return;
             }
 
-            if (!text.startsWith("42")) break;
-
-            int jsonStart = text.indexOf('[');
-            if (jsonStart < 0) break;
-
-            DynamicJsonDocument doc(2048);
-            if (deserializeJson(doc, text.substring(jsonStart))) break;
-
-            String event = doc[0];
-
-            if (event == "auth:challenge") {
-                String nonce = doc[1]["nonce"];
-                String pkHex = doc[1]["pk"];
-                Serial.println("[Auth] Received Nonce: " + nonce);
-                
-                uint8_t pk[PQCLEAN_MLKEM768_CLEAN_CRYPTO_PUBLICKEYBYTES];
-                uint8_t ss[PQCLEAN_MLKEM768_CLEAN_CRYPTO_BYTES];
-                uint8_t ct[PQCLEAN_MLKEM768_CLEAN_CRYPTO_CIPHERTEXTBYTES];
-                
-                if (pkHex.length() == PQCLEAN_MLKEM768_CLEAN_CRYPTO_PUBLICKEYBYTES * 2) {
-                    hexStringToBytes(pkHex, pk, PQCLEAN_MLKEM768_CLEAN_CRYPTO_PUBLICKEYBYTES);
-                    PQCLEAN_MLKEM768_CLEAN_crypto_kem_enc(ct, ss, pk);
-                    memcpy(sharedSecret, ss, 32);
-                    hasSharedSecret = true;
-                    Serial.println("[Kyber] Shared Secret stored.");
-                } else {
-                    Serial.print("[Kyber] Error: Invalid PK length!");
-                }
-                
-                String payloadForSig = nonce + macAddress;
-                String signature = hmacSHA256(DEVICE_SHARED_SECRET, payloadForSig);
-                
-                DynamicJsonDocument resp(2048);
-                resp["signature"] = signature;
-                resp["ciphertext"] = bytesToHexString(ct, PQCLEAN_MLKEM768_CLEAN_CRYPTO_CIPHERTEXTBYTES);
-                
-                sendSocketEvent("auth:response", resp);
-            } 
-            else if (event == "auth:success") {
-                Serial.println("[Auth] SUCCESS");
-                isAuthenticated = true;
-            }
-            else if (event == "auth:failed") {
-                Serial.println("[Auth] FAILED");
-                isAuthenticated = false;
-            }
-            else if (event == "message") {
-                String enc;
-                serializeJson(doc[1], enc);
-                String dec = decryptMessage(enc);
-                if (dec.length()) {
-                    Serial.println("[MSG] " + dec);
-                }
+            if (length >= 4 && memcmp(text, "451-", 4) == 0) {
+                // A binary event; its one attachment is the next frame
+                pendingEventLen = length < sizeof(pendingEvent) ? length : 0;
+                memcpy(pendingEvent, text, pendingEventLen);
+                return;
             }
+            pendingEventLen = 0;
+
+            if (length >= 2 && memcmp(text, "42", 2) == 0) handleEvent(text, length, NULL, 0);
             break;
         }
+
+        case WStype_BIN:
+            if (pendingEventLen) {
+                size_t len = pendingEventLen;
+                pendingEventLen = 0;
+                arena.reset();
+                handleEvent(pendingEvent, len, payload, length);
+            }
+            break;
     }
 }
 
@@ -255,6 +702,21 @@ void setup() {
     pixel.begin();
     pixel.setBrightness(20);
 
+#if KEM_PARALLEL
+    const mlkem_executor *exec = PQCLEAN_MLKEM_CLEAN_freertos_executor();
+    PQCLEAN_MLKEM_CLEAN_set_executor(exec);
+    Serial.println(exec ? "[Kyber] Sampling on both cores" : "[Kyber] Worker task failed, sampling on one core");
+#endif
+
+    unsigned long t0 = micros();
+    const mlkem_params* deviceKem = PQCLEAN_MLKEM_CLEAN_params(KEM_PARAM_SET);
+    if (deviceKeyBegin(deviceKem)) {
+        Serial.printf("[Kyber] Device %s key loaded (%s, %lu us)\n", deviceKem->algname,
+                      DEVICE_KEY_MODE == DEVICE_KEY_EXPANDED ? "expanded" : "seed", micros() - t0);
+    } else {
+        Serial.println("[Kyber] NVS unavailable, no device key");
+    }
+
     macAddress = WiFi.macAddress();
     macAddress.replace(":", "");
     Serial.println("MAC: " + macAddress);
@@ -275,24 +737,56 @@ void setup() {
 
 unsigned long lastPulse = 0;
 
+#define PULSE_FORMAT "{\"status\":\"online\",\"ts\":%lu}"
+#define PULSE_MAX_BYTES 48
+
+// Sends the pulse from the arena: the JSON is printed where its ciphertext
+// goes, sealed in place and, on the hex wire, expanded to hex in place
+void sendPulse() {
+    arena.reset();
+
+    if (binaryWire) {
+        static const char head[] = "451-[\"pulse\",{\"_placeholder\":true,\"num\":0}]";
+        uint8_t* text = frameTake(sizeof(head) - 1);
+        uint8_t* env = frameTake(PULSE_MAX_BYTES + 28);
+        if (!text || !env) return;
+
+        uint8_t* plain = env + 12;
+        int len = snprintf((char*)plain, PULSE_MAX_BYTES + 1, PULSE_FORMAT, millis());
+        session.seal(plain, len, plain, env, plain + len);
+        memcpy(text, head, sizeof(head) - 1);
+        sendTextFrame(text, sizeof(head) - 1);
+        sendBinaryFrame(env, len + 28);
+        return;
+    }
+
+    // 42["pulse",{"data":"...","iv":"...","tag":"..."}]
+    static const char head[] = "42[\"pulse\",{\"data\":\"";
+    char* frame = (char*)frameTake(sizeof(head) + 2 * (PULSE_MAX_BYTES + 12 + 16) + 32);
+    if (!frame) return;
+    memcpy(frame, head, sizeof(head) - 1);
+
+    uint8_t* data = (uint8_t*)frame + sizeof(head) - 1;
+    uint8_t iv[12], tag[16];
+    int len = snprintf((char*)data, PULSE_MAX_BYTES + 1, PULSE_FORMAT, millis());
+    session.seal(data, len, data, iv, tag);
+
+    char* p = bytesToHex((char*)data, data, len);
+    memcpy(p, "\",\"iv\":\"", 8);
+    p = bytesToHex(p + 8, iv, sizeof(iv));
+    memcpy(p, "\",\"tag\":\"", 9);
+    p = bytesToHex(p + 9, tag, sizeof(tag));
+    memcpy(p, "\"}]", 3);
+    sendTextFrame((uint8_t*)frame, p + 3 - frame);
+}
+
 void loop() {
     wifiMulti.run();
     webSocket.loop();
+    encPoolRefill();
 
-    if (isAuthenticated && millis() - lastPulse > 5000 && hasSharedSecret) {
+    if (isAuthenticated && millis() - lastPulse > 5000 && session.active()) {
         lastPulse = millis();
-
-        DynamicJsonDocument doc(128);
-        doc["status"] = "online";
-        doc["ts"] = millis();
-
-        String plain;
-        serializeJson(doc, plain);
-
-        String enc = encryptMessage(plain);
-
-        DynamicJsonDocument out(512);
-        deserializeJson(out, enc);
-        sendSocketEvent("pulse", out);
+        sendPulse();
     }
 }
@@ -0,0 +1,227 @@
+// Runs the firmware's message path on the host and counts its heap
+// allocations: messages from the server, in hex and as binary
+// attachments, pings, and pulses. After the handshake the device should
+// not allocate at all; the harness exits non-zero if anything does, or if
+// a message or pulse does not come through.
+//
+// Before that it runs the handshake: auth:challenge of every parameter set
+// with the key in hex and as an attachment, answered with a new key
+// (streamed), from the pool and from the expanded key cache. Each
+// auth:response must be exactly the frame the server expects.
+//
+//   ./alloc [messages]
+//
+// malloc, calloc and realloc are replaced here, which also catches the
+// calls operator new and the C++ library make.
+#include "Arduino.h"
+#include "WebSocketsClient.h"
+#include "WiFi.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/random.h>
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t nmemb, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+static bool counting = false;
+static unsigned long allocs = 0;
+
+extern "C" void *malloc(size_t size) {
+    if (counting) allocs++;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t nmemb, size_t size) {
+    if (counting) allocs++;
+    return __libc_calloc(nmemb, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) {
+    if (counting) allocs++;
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void *ptr) {
+    __libc_free(ptr);
+}
+
+// What the device printed and sent; recording is not counted
+static std::string printed, sentText, sentBinary;
+
+// The Arduino and WebSockets functions the stubs leave to the harness
+SerialT Serial;
+WiFiT WiFi;
+
+size_t SerialT::write(const uint8_t *p, size_t n) {
+    bool c = counting;
+    counting = false;
+    printed.append((const char *)p, n);
+    counting = c;
+    return n;
+}
+
+void ws_record(int opcode, const uint8_t *p, size_t len) {
+    bool c = counting;
+    counting = false;
+    (opcode == 1 ? sentText : sentBinary).assign((const char *)p, len);
+    counting = c;
+}
+
+unsigned long millis() {
+    using namespace std::chrono;
+    return (unsigned long)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned long micros() {
+    using namespace std::chrono;
+    return (unsigned long)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void delay(unsigned long) {}
+
+void esp_fill_random(void *p, size_t n) {
+    if (getrandom(p, n, 0) != (ssize_t)n) abort();
+}
+
+// main.cpp
+void webSocketEvent(WStype_t type, uint8_t *payload, size_t length);
+void sendPulse();
+void sessionBegin(const uint8_t *ss);
+extern unsigned int sessionVersion;
+extern char authNonce[65];
+extern size_t authNonceLen;
+extern bool isAuthenticated, binaryWire;
+extern String macAddress;
+extern uint8_t sharedSecret[32];
+extern const char *DEVICE_SHARED_SECRET;
+void encPoolRefill();
+
+// server.cpp
+void server_begin(const uint8_t ss[32], const std::string &salt);
+std::string server_hex_message(const std::string &plain);
+std::string server_binary_message(const std::string &plain);
+bool server_open_pulse(const std::string &text, const std::string &attachment, std::string &plain);
+std::string server_challenge(unsigned int id, bool binary, const std::string &nonce, std::string &attachment);
+bool server_check_response(const std::string &text, const std::string &attachment, bool binary,
+                           const std::string &secret, const std::string &nonce, const std::string &mac,
+                           const uint8_t ss[32], std::string &why);
+
+static void receive(WStype_t type, std::string &frame) {
+    webSocketEvent(type, (uint8_t *)&frame[0], frame.size());
+}
+
+// Answers challenges with one new key for id; false if a response is not
+// the expected frame or was not made the expected way
+static bool handshake(unsigned int id, bool binary) {
+    static const char *const ways[] = {"new pk, streamed", "precomputed", "cached pk"};
+    const std::string nonce = "0123456789abcdef0123456789abcdef";
+    std::string attachment;
+    std::string challenge = server_challenge(id, binary, nonce, attachment);
+    bool ok = true;
+
+    for (const char *way : ways) {
+        std::string text = challenge, bin = attachment, why;
+        printed.clear();
+        sentText.clear();
+        sentBinary.clear();
+        receive(WStype_TEXT, text);
+        if (binary) receive(WStype_BIN, bin);
+        if (!server_check_response(sentText, sentBinary, binary, DEVICE_SHARED_SECRET, nonce,
+                                   macAddress.c_str(), sharedSecret, why)) {
+            printf("ML-KEM-%u %s challenge (%s): %s\n", id, binary ? "binary" : "hex", way, why.c_str());
+            ok = false;
+        } else if (printed.find(way) == std::string::npos) {
+            printf("ML-KEM-%u %s challenge: not answered %s\n", id, binary ? "binary" : "hex", way);
+            ok = false;
+        }
+        // What loop() does while idle: expand the key, then one pair
+        if (way == ways[0]) {
+            encPoolRefill();
+            encPoolRefill();
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    const int n = argc > 1 ? atoi(argv[1]) : 10000;
+    int failed = 0;
+
+    macAddress = "24:0A:C4:12:34:56";
+    int handshakes = 0;
+    for (int binary = 0; binary < 2; binary++) {
+        for (unsigned int id : {512u, 768u, 1024u}) {
+            if (!handshake(id, binary)) failed = 1;
+            handshakes += 3;
+        }
+    }
+    printf("auth:challenge: %d answered, %s\n", handshakes, failed ? "FAILED" : "all as expected");
+
+    for (int binary = 0; binary < 2; binary++) {
+        // The state auth:challenge and auth:success leave behind
+        uint8_t ss[32];
+        esp_fill_random(ss, sizeof(ss));
+        std::string nonce = "00112233445566778899aabbccddeeff";
+        memcpy(authNonce, nonce.data(), nonce.size());
+        authNonceLen = nonce.size();
+        sessionVersion = 1;
+        sessionBegin(ss);
+        server_begin(ss, nonce);
+        isAuthenticated = true;
+        binaryWire = binary;
+
+        unsigned long received = 0, pinged = 0, pulsed = 0;
+        int bad = 0;
+        double receiveNs = 0, pulseNs = 0;
+        for (int i = 0; i < n; i++) {
+            std::string plain = "{\"cmd\":\"blink\",\"seq\":" + std::to_string(i) + "}";
+            std::string text = binary ? "451-[\"message\",{\"_placeholder\":true,\"num\":0}]" : server_hex_message(plain);
+            std::string attachment = binary ? server_binary_message(plain) : std::string();
+            printed.clear();
+            auto t0 = std::chrono::steady_clock::now();
+            allocs = 0;
+            counting = true;
+            receive(WStype_TEXT, text);
+            if (binary) receive(WStype_BIN, attachment);
+            counting = false;
+            auto t1 = std::chrono::steady_clock::now();
+            received += allocs;
+            bad += printed.find(plain) == std::string::npos;
+
+            std::string ping = "2";
+            allocs = 0;
+            counting = true;
+            receive(WStype_TEXT, ping);
+            counting = false;
+            pinged += allocs;
+            bad += sentText != "3";
+
+            sentBinary.clear();
+            auto t2 = std::chrono::steady_clock::now();
+            allocs = 0;
+            counting = true;
+            sendPulse();
+            counting = false;
+            auto t3 = std::chrono::steady_clock::now();
+            pulsed += allocs;
+            std::string pulse;
+            bad += !server_open_pulse(sentText, sentBinary, pulse) ||
+                   pulse.find("\"status\":\"online\"") == std::string::npos;
+
+            receiveNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+            pulseNs += std::chrono::duration<double, std::nano>(t3 - t2).count();
+        }
+
+        printf("%s: heap allocations per message: receive %.2f, ping %.2f, pulse %.2f; %d bad; "
+               "receive %.0f ns, pulse %.0f ns\n",
+               binary ? "binary" : "hex", (double)received / n, (double)pinged / n, (double)pulsed / n, bad,
+               receiveNs / n, pulseNs / n);
+        if (received || pinged || pulsed || bad) failed = 1;
+    }
+    return failed;
+}
@@ -0,0 +1,117 @@
+// Server end of the session for the harness: the edge's SessionCrypto and
+// Socket.IO framing, as the edge sends messages and reads pulses, and the
+// server's half of auth:challenge / auth:response
+#include "devicecrypto.h"
+#include "socketio.h"
+
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "mlkem.h"
+}
+
+static EdgeSessionCrypto session;
+
+void server_begin(const uint8_t ss[32], const std::string &salt) {
+    session.begin(EdgeSessionCrypto::SERVER, ss, salt);
+}
+
+std::string server_hex_message(const std::string &plain) {
+    return sio_event("", "message", envelope_seal(session, plain));
+}
+
+std::string server_binary_message(const std::string &plain) {
+    return envelope_seal_binary(session, plain);
+}
+
+// Opens a pulse: a 42 frame, or the attachment of a 451- frame
+bool server_open_pulse(const std::string &text, const std::string &attachment, std::string &plain) {
+    SioPacket pkt;
+    std::string name;
+    JsonObject args;
+    if (text.empty() || !sio_parse(text.data() + 1, text.size() - 1, pkt) ||
+            !sio_parse_event(pkt.data, pkt.len, name, args) || name != "pulse") {
+        return false;
+    }
+    if (pkt.type == SIO_BINARY_EVENT) {
+        return envelope_open_binary(session, (const uint8_t *)attachment.data(), attachment.size(), plain);
+    }
+    return envelope_open(session, args, plain);
+}
+
+static const mlkem_params *challengeKem;
+static std::vector<uint8_t> challengeSk;
+
+// A new key pair for id and the auth:challenge carrying its public key:
+// a 42 frame with the key in hex, or a 451- frame with the key as its
+// attachment
+std::string server_challenge(unsigned int id, bool binary, const std::string &nonce, std::string &attachment) {
+    challengeKem = PQCLEAN_MLKEM_CLEAN_params(id);
+    std::vector<uint8_t> pk(challengeKem->publickeybytes);
+    challengeSk.resize(challengeKem->secretkeybytes);
+    challengeKem->keypair(pk.data(), challengeSk.data());
+
+    JsonObject args{{"nonce", nonce, true}};
+    if (binary) {
+        args.push_back(sio_placeholder_field("pk", 0));
+        attachment.assign((const char *)pk.data(), pk.size());
+    } else {
+        args.push_back(JsonField{"pk", hex_encode(pk.data(), pk.size()), true});
+        attachment.clear();
+    }
+    args.push_back(JsonField{"paramSet", std::to_string(id), false});
+    return sio_event("", "auth:challenge", args, binary ? 1 : 0);
+}
+
+// Checks the auth:response to the last challenge byte for byte against
+// the frame the server expects: the signature over nonce || mac, the
+// parameter set, and a ciphertext that decapsulates to ss. why says what
+// differs.
+bool server_check_response(const std::string &text, const std::string &attachment, bool binary,
+                           const std::string &secret, const std::string &nonce, const std::string &mac,
+                           const uint8_t ss[32], std::string &why) {
+    size_t ctLen = challengeKem->ciphertextbytes;
+    std::string head = std::string(binary ? "451-" : "42") + "[\"auth:response\",{\"signature\":\"" +
+                       hmac_hex(secret, nonce + mac) + "\",\"paramSet\":" + std::to_string(challengeKem->id) +
+                       ",\"ciphertext\":";
+    std::vector<uint8_t> ct(ctLen);
+    std::string expected;
+    if (binary) {
+        expected = head + "{\"_placeholder\":true,\"num\":0}}]";
+        if (attachment.size() != ctLen) {
+            why = "attachment of " + std::to_string(attachment.size()) + " bytes";
+            return false;
+        }
+        memcpy(ct.data(), attachment.data(), ctLen);
+    } else {
+        if (text.size() != head.size() + 1 + 2 * ctLen + 3 ||
+                !hex_decode(text.substr(head.size() + 1, 2 * ctLen), ct.data(), ctLen)) {
+            why = "frame of " + std::to_string(text.size()) + " bytes: " + text.substr(0, head.size() + 8);
+            return false;
+        }
+        expected = head + "\"" + hex_encode(ct.data(), ctLen) + "\"}]";
+    }
+    if (text != expected) {
+        why = "frame " + text.substr(0, 200);
+        return false;
+    }
+
+    // As the edge reads it
+    SioPacket pkt;
+    std::string name;
+    JsonObject args;
+    if (!sio_parse(text.data() + 1, text.size() - 1, pkt) || !sio_parse_event(pkt.data, pkt.len, name, args) ||
+            name != "auth:response") {
+        why = "frame does not parse";
+        return false;
+    }
+
+    uint8_t serverSs[32];
+    challengeKem->dec(serverSs, ct.data(), challengeSk.data());
+    if (memcmp(serverSs, ss, 32) != 0) {
+        why = "ciphertext does not decapsulate to the device's shared secret";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,6 @@
+#pragma once
+// Stand-in for the Adafruit NeoPixel library; the LED does nothing.
+#include <stdint.h>
+#define NEO_GRB 0
+#define NEO_KHZ800 0
+struct Adafruit_NeoPixel { Adafruit_NeoPixel(int, int, int) {} void begin() {} void setBrightness(int) {} void setPixelColor(int, uint32_t) {} void show() {} uint32_t Color(int, int, int) { return 0; } void clear() {} };
@@ -0,0 +1,58 @@
+#pragma once
+// Stand-in for the Arduino core on the host, for test/host: the part of
+// String, Serial and the timing functions main.cpp uses. Serial output,
+// printf included, goes to SerialT::write, the timing functions and
+// esp_fill_random to the harness.
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+typedef uint8_t byte;
+#define HEX 16
+class String {
+public:
+    std::string s;
+    String() {}
+    String(const char *c) : s(c ? c : "") {}
+    String(const std::string &x) : s(x) {}
+    String(int v, int base = 10) { char b[32]; snprintf(b, 32, base == 16 ? "%x" : "%d", v); s = b; }
+    String(unsigned v, int base = 10) { char b[32]; snprintf(b, 32, base == 16 ? "%x" : "%u", v); s = b; }
+    String(char c) { s = std::string(1, c); }
+    size_t length() const { return s.size(); }
+    const char *c_str() const { return s.c_str(); }
+    String substring(size_t a, size_t b) const { return String(s.substr(a, b - a)); }
+    String substring(size_t a) const { return String(s.substr(a)); }
+    int indexOf(char c) const { size_t p = s.find(c); return p == std::string::npos ? -1 : (int)p; }
+    bool startsWith(const char *p) const { return s.rfind(p, 0) == 0; }
+    void replace(const char *a, const char *b) { (void)a; (void)b; }
+    bool reserve(size_t n) { s.reserve(n); return true; }
+    bool concat(const char *c, unsigned int n) { s.append(c, n); return true; }
+    char operator[](size_t i) const { return s[i]; }
+    String &operator+=(const String &o) { s += o.s; return *this; }
+    String &operator+=(const char *o) { s += o; return *this; }
+    String &operator+=(char c) { s += c; return *this; }
+    friend String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+    friend String operator+(const String &a, const char *b) { return String(a.s + b); }
+    friend String operator+(const char *a, const String &b) { return String(a + b.s); }
+    bool operator==(const char *o) const { return s == o; }
+    bool operator==(const String &o) const { return s == o.s; }
+};
+struct SerialT { void begin(int) {} template <class T> void print(T) {} template <class T> void println(T) {} void println() {} size_t write(const uint8_t *p, size_t n); int printf(const char *f, ...) {
+        char b[256];
+        va_list ap;
+        va_start(ap, f);
+        int n = vsnprintf(b, sizeof(b), f, ap);
+        va_end(ap);
+        if (n > 0) write((const uint8_t *)b, (size_t)n < sizeof(b) ? (size_t)n : sizeof(b) - 1);
+        return n;
+    }
+};
+extern SerialT Serial;
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long);
+void esp_fill_random(void *, size_t);
+#define SET_LOOP_TASK_STACK_SIZE(x) static int _stack_size = (x)
@@ -0,0 +1,150 @@
+#pragma once
+// Stand-in for ArduinoJson 6. deserializeJson parses in place, as the real
+// one does for a char* input: strings are terminated where they lie and
+// the document keeps a fixed table of nodes, so parsing takes nothing from
+// the heap. Lookups that miss give the default. Writing to a document and
+// serializing it do nothing. BasicJsonDocument takes its pool from the
+// allocator when it is made, as the real one does.
+#include "Arduino.h"
+#include <stdlib.h>
+
+struct JsonNode {
+    char type;          // 's' string, 'n' number, 'b' true/false, 'a' array, 'o' object, 0 null
+    const char *key;    // in an object
+    const char *str;
+    unsigned long num;
+    int child, next;    // -1 for none
+};
+
+struct JsonVariant {
+    const JsonNode *nodes = nullptr;
+    int i = -1;
+
+    JsonVariant() {}
+    JsonVariant(const JsonNode *n, int at) : nodes(n), i(at) {}
+
+    const JsonNode *node() const { return i < 0 ? nullptr : &nodes[i]; }
+    JsonVariant operator[](int k) const {
+        const JsonNode *n = node();
+        int c = n && n->type == 'a' ? n->child : -1;
+        while (c >= 0 && k-- > 0) c = nodes[c].next;
+        return JsonVariant(nodes, c);
+    }
+    JsonVariant operator[](const char *key) const {
+        const JsonNode *n = node();
+        int c = n && n->type == 'o' ? n->child : -1;
+        while (c >= 0 && strcmp(nodes[c].key, key) != 0) c = nodes[c].next;
+        return JsonVariant(nodes, c);
+    }
+    template <class T> JsonVariant &operator=(const T &) { return *this; }
+    operator String() const { return String(); }
+    operator unsigned int() const { return *this | 0u; }
+    operator int() const { return *this | 0; }
+    template <class T> T as() const { return T(); }
+    template <class T> bool is() const { return false; }
+    bool isNull() const { return node() == nullptr; }
+    unsigned int operator|(unsigned int d) const { return node() && node()->type == 'n' ? (unsigned int)node()->num : d; }
+    int operator|(int d) const { return node() && node()->type == 'n' ? (int)node()->num : d; }
+    bool operator|(bool d) const { return node() && node()->type == 'b' ? node()->num != 0 : d; }
+    const char *operator|(const char *d) const { return node() && node()->type == 's' ? node()->str : d; }
+};
+
+#define JSON_STUB_NODES 64
+
+struct JsonDocument : JsonVariant {
+    JsonNode pool[JSON_STUB_NODES];
+    int used = 0;
+
+    JsonDocument() : JsonVariant(pool, -1) {}
+    JsonDocument(const JsonDocument &) = delete;
+    JsonDocument &operator=(const JsonDocument &) = delete;
+
+    // Parses the value at *p into a new node; -1 if malformed or out of nodes
+    int parse(char *&p, char *end) {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+        if (p == end || used == JSON_STUB_NODES) return -1;
+        int at = used++;
+        JsonNode &n = pool[at];
+        n.type = 0;
+        n.key = n.str = nullptr;
+        n.num = 0;
+        n.child = n.next = -1;
+        if (*p == '"') {
+            n.type = 's';
+            n.str = parse_string(p, end);
+            return n.str ? at : -1;
+        }
+        if (*p == '[' || *p == '{') {
+            char close = *p == '[' ? ']' : '}';
+            n.type = *p == '[' ? 'a' : 'o';
+            p++;
+            int *link = &n.child;
+            for (;;) {
+                while (p < end && (*p == ' ' || *p == ',' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+                if (p == end) return -1;
+                if (*p == close) {
+                    p++;
+                    return at;
+                }
+                const char *key = nullptr;
+                if (close == '}') {
+                    if (*p != '"' || !(key = parse_string(p, end))) return -1;
+                    while (p < end && *p != ':') p++;
+                    if (p++ == end) return -1;
+                }
+                int c = parse(p, end);
+                if (c < 0) return -1;
+                pool[c].key = key;
+                *link = c;
+                link = &pool[c].next;
+            }
+        }
+        if (end - p >= 4 && memcmp(p, "null", 4) == 0) {
+            p += 4;
+            return at;
+        }
+        if (end - p >= 4 && memcmp(p, "true", 4) == 0) {
+            n.type = 'b';
+            n.num = 1;
+            p += 4;
+            return at;
+        }
+        if (end - p >= 5 && memcmp(p, "false", 5) == 0) {
+            n.type = 'b';
+            p += 5;
+            return at;
+        }
+        n.type = 'n';
+        while (p < end && ((*p >= '0' && *p <= '9') || *p == '-')) {
+            n.num = n.num * 10 + (unsigned long)(*p == '-' ? 0 : *p - '0');
+            p++;
+        }
+        return at;
+    }
+
+    // Terminates the string at p in place; escapes are left as written
+    static const char *parse_string(char *&p, char *end) {
+        char *start = ++p;
+        while (p < end && *p != '"') p += *p == '\\' ? 2 : 1;
+        if (p >= end) return nullptr;
+        *p++ = '\0';
+        return start;
+    }
+};
+struct DynamicJsonDocument : JsonDocument { DynamicJsonDocument(size_t) {} };
+template <class A> struct BasicJsonDocument : JsonDocument, A { BasicJsonDocument(size_t n) { this->deallocate(this->allocate(n)); } };
+template <class D> size_t measureJson(const D &) { return 0; }
+template <size_t N> struct StaticJsonDocument : JsonDocument {};
+
+struct DeserializationError {
+    bool failed;
+    operator bool() const { return failed; }
+};
+template <class D> DeserializationError deserializeJson(D &doc, char *json, size_t len) {
+    doc.used = 0;
+    char *p = json;
+    doc.i = doc.parse(p, json + len);
+    return DeserializationError{doc.i < 0};
+}
+template <class D> size_t serializeJson(const D &, String &) { return 0; }
+template <class D> size_t serializeJson(const D &, char *, size_t) { return 0; }
@@ -0,0 +1,13 @@
+#pragma once
+// Stand-in for the ESP32 NVS Preferences: nothing is ever stored.
+#include <stddef.h>
+#include <stdint.h>
+class Preferences {
+public:
+    bool begin(const char *, bool = false, const char * = nullptr) { return true; }
+    void end() {}
+    size_t getBytesLength(const char *) { return 0; }
+    size_t getBytes(const char *, void *, size_t) { return 0; }
+    size_t putBytes(const char *, const void *, size_t len) { return len; }
+    bool remove(const char *) { return true; }
+};
@@ -0,0 +1,43 @@
+#pragma once
+// Stand-in for arduinoWebSockets: hands each frame sent to ws_record in the
+// harness, and copies it into a buffer of its own (malloc) unless the
+// header fits in front of it, as the library does for frames under 1400
+// bytes. The payload is masked in place.
+#include "Arduino.h"
+#define WEBSOCKETS_MAX_HEADER_SIZE (14)
+typedef enum {
+    WStype_ERROR,
+    WStype_DISCONNECTED,
+    WStype_CONNECTED,
+    WStype_TEXT,
+    WStype_BIN,
+    WStype_FRAGMENT_TEXT_START,
+    WStype_FRAGMENT_BIN_START,
+    WStype_FRAGMENT,
+    WStype_FRAGMENT_FIN,
+    WStype_PING,
+    WStype_PONG,
+} WStype_t;
+void ws_record(int opcode, const uint8_t *p, size_t len);
+struct WebSocketsClient {
+    void begin(const char *, int, const char *) {}
+    void onEvent(void (*)(WStype_t, uint8_t *, size_t)) {}
+    void setReconnectInterval(int) {}
+    void loop() {}
+    bool frame(int op, uint8_t *p, size_t len, bool headerToPayload) {
+        ws_record(op, headerToPayload ? p + WEBSOCKETS_MAX_HEADER_SIZE : p, len);
+        uint8_t *buf = p;
+        if (!headerToPayload) {
+            buf = (uint8_t *)malloc(len + WEBSOCKETS_MAX_HEADER_SIZE);
+            memcpy(buf + WEBSOCKETS_MAX_HEADER_SIZE, p, len);
+        }
+        for (size_t i = 0; i < len; i++) buf[WEBSOCKETS_MAX_HEADER_SIZE + i] ^= (uint8_t)(0x5a + i);
+        if (!headerToPayload) free(buf);
+        return true;
+    }
+    bool sendTXT(const String &s) { return sendTXT(s.c_str(), s.length()); }
+    bool sendTXT(const char *p, size_t len = 0) { return frame(1, (uint8_t *)p, len ? len : strlen(p), false); }
+    bool sendTXT(uint8_t *p, size_t len, bool h = false) { return frame(1, p, len, h); }
+    bool sendBIN(uint8_t *p, size_t len, bool h = false) { return frame(2, p, len, h); }
+    bool sendBIN(const uint8_t *p, size_t len) { return frame(2, (uint8_t *)p, len, false); }
+};
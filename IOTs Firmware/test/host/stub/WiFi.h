@@ -0,0 +1,6 @@
+#pragma once
+// Stand-in for the ESP32 WiFi library, with an empty MAC address.
+#include "Arduino.h"
+#define WL_CONNECTED 3
+struct WiFiT { String macAddress() { return String(); } };
+extern WiFiT WiFi;
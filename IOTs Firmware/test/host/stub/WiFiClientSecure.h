@@ -0,0 +1,2 @@
+#pragma once
+// Stand-in for the ESP32 WiFiClientSecure header; main.cpp only includes it.
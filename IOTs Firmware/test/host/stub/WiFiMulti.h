@@ -0,0 +1,3 @@
+#pragma once
+// Stand-in for the ESP32 WiFiMulti library, always connected.
+struct WiFiMulti { void addAP(const char *, const char *) {} int run() { return 3; } };
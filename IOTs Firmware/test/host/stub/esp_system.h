@@ -0,0 +1,4 @@
+#pragma once
+// Stand-in for the ESP-IDF system header; esp_fill_random is the harness's.
+#include <stddef.h>
+void esp_fill_random(void *, size_t);
@@ -0,0 +1,105 @@
+// Microbenchmark of the addon against crystals-kyber, the JavaScript
+// implementation the backend used so far (measured only when it is
+// installed in backend/node_modules).
+//
+//   node bench.js [paramSet=768] [handshakes=2000]
+//
+// ops/s: each operation run back to back on the main thread, and for the
+// addon also queued all at once on the libuv thread pool (UV_THREADPOOL_SIZE
+// threads). Event-loop lag: a burst of server-side handshakes (keyPair then
+// decapsulate), each started from its own macrotask as socket events are,
+// while monitorEventLoopDelay samples how long timers are held up.
+const { monitorEventLoopDelay, performance } = require("perf_hooks");
+const kem = require(".");
+
+const id = parseInt(process.argv[2]) || 768;
+const handshakes = parseInt(process.argv[3]) || 2000;
+
+const opsPerSec = (n, fn) => {
+  const t0 = performance.now();
+  for (let i = 0; i < n; i++) fn();
+  return (n * 1000) / (performance.now() - t0);
+};
+
+const opsPerSecAsync = async (n, fn) => {
+  const t0 = performance.now();
+  await Promise.all(Array.from({ length: n }, fn));
+  return (n * 1000) / (performance.now() - t0);
+};
+
+// Runs one handshake per macrotask and reports the event-loop delay
+const lag = async (handshake) => {
+  const h = monitorEventLoopDelay({ resolution: 1 });
+  const pending = [];
+  h.enable();
+  const t0 = performance.now();
+  await new Promise((resolve) => {
+    let i = 0;
+    const next = () => {
+      pending.push(handshake());
+      if (++i < handshakes) setImmediate(next);
+      else resolve();
+    };
+    setImmediate(next);
+  });
+  await Promise.all(pending);
+  const wall = performance.now() - t0;
+  h.disable();
+  const ms = (ns) => (ns / 1e6).toFixed(2);
+  return `p50 ${ms(h.percentile(50))} ms  p99 ${ms(h.percentile(99))} ms  max ${ms(h.max)} ms  (${(
+    (handshakes * 1000) /
+    wall
+  ).toFixed(0)} handshakes/s)`;
+};
+
+const row = (name, v) =>
+  console.log(`  ${name.padEnd(28)} ${typeof v === "number" ? `${v.toFixed(0)} ops/s` : v}`);
+
+const main = async () => {
+  const native = { 512: kem.MlKem512, 768: kem.MlKem768, 1024: kem.MlKem1024 }[id];
+  if (!native) throw new Error("parameter set must be 512, 768 or 1024");
+
+  let js = null;
+  try {
+    const pkg = await import("crystals-kyber");
+    js = (pkg.default || pkg)[`Kyber${id}`] || null;
+  } catch (err) {
+    js = null;
+  }
+
+  const n = Math.max(100, handshakes);
+  const { pk, sk } = native.keyPair();
+  const { ct } = native.encapsulate(pk);
+
+  console.log(`ML-KEM-${id}, threadpool ${process.env.UV_THREADPOOL_SIZE || 4}`);
+  console.log("native addon");
+  row("keyPair", opsPerSec(n, () => native.keyPair()));
+  row("encapsulate", opsPerSec(n, () => native.encapsulate(pk)));
+  row("decapsulate", opsPerSec(n, () => native.decapsulate(ct, sk)));
+  row("keyPairAsync", await opsPerSecAsync(n, () => native.keyPairAsync()));
+  row("encapsulateAsync", await opsPerSecAsync(n, () => native.encapsulateAsync(pk)));
+  row("decapsulateAsync", await opsPerSecAsync(n, () => native.decapsulateAsync(ct, sk)));
+  row("lag, sync handshakes", await lag(async () => native.decapsulate(ct, native.keyPair().sk)));
+  row(
+    "lag, async handshakes",
+    await lag(async () => native.decapsulateAsync(ct, (await native.keyPairAsync()).sk))
+  );
+
+  if (!js) {
+    console.log("crystals-kyber: not installed, skipped");
+    return;
+  }
+  // The backend only generates keys and decapsulates; the addon's ciphertext
+  // has the right length, and decapsulation costs the same either way
+  const jsKeys = js.keyPair();
+  const jsN = Math.max(20, Math.floor(n / 10));
+  console.log("crystals-kyber");
+  row("keyPair", opsPerSec(jsN, () => js.keyPair()));
+  row("decapsulate", opsPerSec(jsN, () => js.decapsulate(ct, jsKeys.sk)));
+  row("lag, handshakes", await lag(async () => js.decapsulate(ct, js.keyPair().sk)));
+};
+
+main().catch((err) => {
+  console.error(err.message);
+  process.exit(1);
+});
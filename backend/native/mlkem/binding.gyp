@@ -0,0 +1,37 @@
+{
+  "targets": [
+    {
+      "target_name": "mlkem",
+      "sources": [
+        "src/addon.c",
+        "src/randombytes.c",
+        "src/kyber/kyber-cbd.c",
+        "src/kyber/kyber-fips202.c",
+        "src/kyber/kyber-fips202x4.c",
+        "src/kyber/kyber-indcpa.c",
+        "src/kyber/kyber-kem.c",
+        "src/kyber/kyber-mlkem.c",
+        "src/kyber/kyber-mlkem512.c",
+        "src/kyber/kyber-mlkem1024.c",
+        "src/kyber/kyber-ntt.c",
+        "src/kyber/kyber-parallel.c",
+        "src/kyber/kyber-poly.c",
+        "src/kyber/kyber-poly_avx2.c",
+        "src/kyber/kyber-poly_k.c",
+        "src/kyber/kyber-polyvec.c",
+        "src/kyber/kyber-reduce.c",
+        "src/kyber/kyber-symmetric-shake.c",
+        "src/kyber/kyber-verify.c"
+      ],
+      "cflags_c": ["-std=c99", "-O3"],
+      "xcode_settings": {
+        "OTHER_CFLAGS": ["-std=c99", "-O3"]
+      },
+      "conditions": [
+        ["OS=='win'", {
+          "libraries": ["bcrypt.lib"]
+        }]
+      ]
+    }
+  ]
+}
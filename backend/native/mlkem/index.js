@@ -0,0 +1,23 @@
+// ML-KEM from the firmware's C library, one object per parameter set with
+// the same shape the backend uses for crystals-kyber (keyPair, decapsulate),
+// plus promise-returning variants that run on the libuv thread pool.
+const binding = require("./build/Release/mlkem.node");
+
+const paramSet = (id) => ({
+  id,
+  ...binding.sizes(id),
+  keyPair: (coins) =>
+    coins === undefined ? binding.keypair(id) : binding.keypair(id, coins),
+  encapsulate: (pk, coins) =>
+    coins === undefined ? binding.encaps(id, pk) : binding.encaps(id, pk, coins),
+  decapsulate: (ct, sk) => binding.decaps(id, ct, sk),
+  keyPairAsync: () => binding.keypairAsync(id),
+  encapsulateAsync: (pk) => binding.encapsAsync(id, pk),
+  decapsulateAsync: (ct, sk) => binding.decapsAsync(id, ct, sk),
+});
+
+module.exports = {
+  MlKem512: paramSet(512),
+  MlKem768: paramSet(768),
+  MlKem1024: paramSet(1024),
+};
@@ -0,0 +1,374 @@
+/*
+ * N-API binding of the firmware's ML-KEM library (IOTs Firmware/lib/kyber),
+ * so that the backend runs the same code as the devices.
+ *
+ * Every operation takes the parameter set id (512, 768 or 1024) first. The
+ * synchronous functions run on the calling thread; the *Async ones copy
+ * their inputs, run on the libuv thread pool and return a promise, so a
+ * handshake never holds up the event loop.
+ *
+ *   keypair(id[, coins])        -> { pk, sk }   coins: d || z, 64 bytes
+ *   encaps(id, pk[, coins])     -> { ct, ss }   coins: m, 32 bytes
+ *   decaps(id, ct, sk)          -> ss
+ *   keypairAsync(id), encapsAsync(id, pk), decapsAsync(id, ct, sk)
+ *   sizes(id)                   -> { publicKeyBytes, secretKeyBytes, ... }
+ */
+#include "../../../../IOTs Firmware/lib/kyber/mlkem.h"
+#include <node_api.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KEYPAIR_COINSBYTES (2 * PQCLEAN_MLKEM_CLEAN_BYTES)
+
+#define CHECK(env, call)                                         \
+    do {                                                         \
+        if ((call) != napi_ok) {                                 \
+            napi_throw_error((env), NULL, "N-API call failed");  \
+            return NULL;                                         \
+        }                                                        \
+    } while (0)
+
+typedef enum {
+    OP_KEYPAIR,
+    OP_ENCAPS,
+    OP_DECAPS
+} kem_op;
+
+typedef struct {
+    napi_async_work work;
+    napi_deferred deferred;
+    const mlkem_params *params;
+    kem_op op;
+    int rc;
+    uint8_t pk[PQCLEAN_MLKEM_CLEAN_MAX_PUBLICKEYBYTES];
+    uint8_t sk[PQCLEAN_MLKEM_CLEAN_MAX_SECRETKEYBYTES];
+    uint8_t ct[PQCLEAN_MLKEM_CLEAN_MAX_CIPHERTEXTBYTES];
+    uint8_t ss[PQCLEAN_MLKEM_CLEAN_BYTES];
+} kem_job;
+
+static void wipe(void *p, size_t len) {
+    volatile uint8_t *v = (volatile uint8_t *)p;
+    while (len--) {
+        *v++ = 0;
+    }
+}
+
+/* Reads the parameter set id; throws and returns NULL if it is not one */
+static const mlkem_params *get_params(napi_env env, napi_value v) {
+    uint32_t id;
+    const mlkem_params *params;
+
+    if (napi_get_value_uint32(env, v, &id) != napi_ok) {
+        napi_throw_type_error(env, NULL, "parameter set must be a number");
+        return NULL;
+    }
+    params = PQCLEAN_MLKEM_CLEAN_params(id);
+    if (params == NULL) {
+        napi_throw_range_error(env, NULL, "parameter set must be 512, 768 or 1024");
+    }
+    return params;
+}
+
+/* Reads a Uint8Array (or Buffer) of exactly len bytes; throws and returns NULL otherwise */
+static const uint8_t *get_bytes(napi_env env, napi_value v, size_t len, const char *what) {
+    bool is_typedarray;
+    napi_typedarray_type type;
+    size_t length;
+    void *data;
+    char msg[64];
+
+    if (napi_is_typedarray(env, v, &is_typedarray) != napi_ok || !is_typedarray ||
+            napi_get_typedarray_info(env, v, &type, &length, &data, NULL, NULL) != napi_ok ||
+            type != napi_uint8_array) {
+        snprintf(msg, sizeof(msg), "%s must be a Uint8Array", what);
+        napi_throw_type_error(env, NULL, msg);
+        return NULL;
+    }
+    if (length != len) {
+        snprintf(msg, sizeof(msg), "%s must be %u bytes", what, (unsigned int)len);
+        napi_throw_range_error(env, NULL, msg);
+        return NULL;
+    }
+    return data;
+}
+
+static napi_value make_buffer(napi_env env, const uint8_t *data, size_t len) {
+    napi_value buf;
+    if (napi_create_buffer_copy(env, len, data, NULL, &buf) != napi_ok) {
+        return NULL;
+    }
+    return buf;
+}
+
+static napi_value make_pair(napi_env env, const char *k1, const uint8_t *v1, size_t l1,
+                            const char *k2, const uint8_t *v2, size_t l2) {
+    napi_value obj, b1, b2;
+
+    if (napi_create_object(env, &obj) != napi_ok ||
+            (b1 = make_buffer(env, v1, l1)) == NULL ||
+            (b2 = make_buffer(env, v2, l2)) == NULL ||
+            napi_set_named_property(env, obj, k1, b1) != napi_ok ||
+            napi_set_named_property(env, obj, k2, b2) != napi_ok) {
+        return NULL;
+    }
+    return obj;
+}
+
+/* Result of a finished job as a JS value, or NULL */
+static napi_value job_result(napi_env env, const kem_job *job) {
+    const mlkem_params *p = job->params;
+
+    switch (job->op) {
+        case OP_KEYPAIR:
+            return make_pair(env, "pk", job->pk, p->publickeybytes, "sk", job->sk, p->secretkeybytes);
+        case OP_ENCAPS:
+            return make_pair(env, "ct", job->ct, p->ciphertextbytes, "ss", job->ss, sizeof(job->ss));
+        case OP_DECAPS:
+            return make_buffer(env, job->ss, sizeof(job->ss));
+    }
+    return NULL;
+}
+
+static void job_run(kem_job *job) {
+    const mlkem_params *p = job->params;
+
+    switch (job->op) {
+        case OP_KEYPAIR:
+            job->rc = p->keypair(job->pk, job->sk);
+            break;
+        case OP_ENCAPS:
+            job->rc = p->enc(job->ct, job->ss, job->pk);
+            break;
+        case OP_DECAPS:
+            job->rc = p->dec(job->ss, job->ct, job->sk);
+            break;
+    }
+}
+
+static void job_free(kem_job *job) {
+    wipe(job, sizeof(*job));
+    free(job);
+}
+
+/*************************************************
+* Name:        parse_job
+*
+* Description: Checks the arguments of keypair/encaps/decaps and copies the
+*              inputs into a new job. On error throws and returns NULL.
+*
+* Arguments:   - napi_env env: environment
+*              - napi_callback_info info: call arguments
+*              - kem_op op: operation
+*              - size_t *argc: set to the number of arguments passed
+*              - napi_value *argv: receives up to 4 arguments
+**************************************************/
+static kem_job *parse_job(napi_env env, napi_callback_info info, kem_op op, size_t *argc, napi_value *argv) {
+    const mlkem_params *params;
+    const uint8_t *a = NULL, *b = NULL;
+    kem_job *job;
+
+    *argc = 4;
+    if (napi_get_cb_info(env, info, argc, argv, NULL, NULL) != napi_ok) {
+        napi_throw_error(env, NULL, "N-API call failed");
+        return NULL;
+    }
+    if (*argc < 1) {
+        napi_throw_type_error(env, NULL, "missing parameter set");
+        return NULL;
+    }
+    params = get_params(env, argv[0]);
+    if (params == NULL) {
+        return NULL;
+    }
+    if (op == OP_ENCAPS) {
+        if (*argc < 2) {
+            napi_throw_type_error(env, NULL, "missing public key");
+            return NULL;
+        }
+        if ((a = get_bytes(env, argv[1], params->publickeybytes, "public key")) == NULL) {
+            return NULL;
+        }
+    } else if (op == OP_DECAPS) {
+        if (*argc < 3) {
+            napi_throw_type_error(env, NULL, "missing ciphertext or secret key");
+            return NULL;
+        }
+        if ((a = get_bytes(env, argv[1], params->ciphertextbytes, "ciphertext")) == NULL ||
+                (b = get_bytes(env, argv[2], params->secretkeybytes, "secret key")) == NULL) {
+            return NULL;
+        }
+    }
+
+    job = calloc(1, sizeof(*job));
+    if (job == NULL) {
+        napi_throw_error(env, NULL, "out of memory");
+        return NULL;
+    }
+    job->params = params;
+    job->op = op;
+    if (op == OP_ENCAPS) {
+        memcpy(job->pk, a, params->publickeybytes);
+    } else if (op == OP_DECAPS) {
+        memcpy(job->ct, a, params->ciphertextbytes);
+        memcpy(job->sk, b, params->secretkeybytes);
+    }
+    return job;
+}
+
+static napi_value run_sync(napi_env env, napi_callback_info info, kem_op op) {
+    napi_value argv[4], result = NULL;
+    size_t argc;
+    const uint8_t *coins;
+    int ok = 1;
+    kem_job *job = parse_job(env, info, op, &argc, argv);
+
+    if (job == NULL) {
+        return NULL;
+    }
+
+    /* Optional coins make keypair and encaps deterministic, for known-answer tests */
+    if (op == OP_KEYPAIR && argc >= 2) {
+        coins = get_bytes(env, argv[1], KEYPAIR_COINSBYTES, "coins");
+        ok = coins != NULL;
+        if (ok) {
+            job->rc = job->params->keypair_derand(job->pk, job->sk, coins);
+        }
+    } else if (op == OP_ENCAPS && argc >= 3) {
+        coins = get_bytes(env, argv[2], PQCLEAN_MLKEM_CLEAN_BYTES, "coins");
+        ok = coins != NULL;
+        if (ok) {
+            job->rc = job->params->enc_derand(job->ct, job->ss, job->pk, coins);
+        }
+    } else {
+        job_run(job);
+    }
+
+    if (ok) {
+        if (job->rc != 0) {
+            napi_throw_error(env, NULL, "ML-KEM operation failed");
+        } else if ((result = job_result(env, job)) == NULL) {
+            napi_throw_error(env, NULL, "N-API call failed");
+        }
+    }
+    job_free(job);
+    return result;
+}
+
+static void async_execute(napi_env env, void *data) {
+    (void)env;
+    job_run((kem_job *)data);
+}
+
+static void async_complete(napi_env env, napi_status status, void *data) {
+    kem_job *job = data;
+    napi_value result = NULL, msg;
+
+    if (status == napi_ok && job->rc == 0) {
+        result = job_result(env, job);
+    }
+    if (result != NULL) {
+        napi_resolve_deferred(env, job->deferred, result);
+    } else {
+        napi_create_string_utf8(env, status == napi_cancelled ? "cancelled" : "ML-KEM operation failed",
+                                NAPI_AUTO_LENGTH, &msg);
+        napi_create_error(env, NULL, msg, &result);
+        napi_reject_deferred(env, job->deferred, result);
+    }
+    napi_delete_async_work(env, job->work);
+    job_free(job);
+}
+
+static napi_value run_async(napi_env env, napi_callback_info info, kem_op op) {
+    napi_value argv[4], promise, name;
+    size_t argc;
+    kem_job *job = parse_job(env, info, op, &argc, argv);
+
+    if (job == NULL) {
+        return NULL;
+    }
+    if (napi_create_promise(env, &job->deferred, &promise) != napi_ok ||
+            napi_create_string_utf8(env, "mlkem", NAPI_AUTO_LENGTH, &name) != napi_ok ||
+            napi_create_async_work(env, NULL, name, async_execute, async_complete, job, &job->work) != napi_ok) {
+        job_free(job);
+        napi_throw_error(env, NULL, "N-API call failed");
+        return NULL;
+    }
+    if (napi_queue_async_work(env, job->work) != napi_ok) {
+        napi_delete_async_work(env, job->work);
+        job_free(job);
+        napi_throw_error(env, NULL, "N-API call failed");
+        return NULL;
+    }
+    return promise;
+}
+
+static napi_value keypair(napi_env env, napi_callback_info info) {
+    return run_sync(env, info, OP_KEYPAIR);
+}
+
+static napi_value encaps(napi_env env, napi_callback_info info) {
+    return run_sync(env, info, OP_ENCAPS);
+}
+
+static napi_value decaps(napi_env env, napi_callback_info info) {
+    return run_sync(env, info, OP_DECAPS);
+}
+
+static napi_value keypair_async(napi_env env, napi_callback_info info) {
+    return run_async(env, info, OP_KEYPAIR);
+}
+
+static napi_value encaps_async(napi_env env, napi_callback_info info) {
+    return run_async(env, info, OP_ENCAPS);
+}
+
+static napi_value decaps_async(napi_env env, napi_callback_info info) {
+    return run_async(env, info, OP_DECAPS);
+}
+
+static napi_value sizes(napi_env env, napi_callback_info info) {
+    static const char *names[] = {"publicKeyBytes", "secretKeyBytes", "ciphertextBytes", "sharedSecretBytes"};
+    napi_value argv[1], obj, v;
+    size_t argc = 1, values[4];
+    const mlkem_params *p;
+    unsigned int i;
+
+    CHECK(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "missing parameter set");
+        return NULL;
+    }
+    p = get_params(env, argv[0]);
+    if (p == NULL) {
+        return NULL;
+    }
+    values[0] = p->publickeybytes;
+    values[1] = p->secretkeybytes;
+    values[2] = p->ciphertextbytes;
+    values[3] = PQCLEAN_MLKEM_CLEAN_BYTES;
+
+    CHECK(env, napi_create_object(env, &obj));
+    for (i = 0; i < 4; i++) {
+        CHECK(env, napi_create_uint32(env, (uint32_t)values[i], &v));
+        CHECK(env, napi_set_named_property(env, obj, names[i], v));
+    }
+    return obj;
+}
+
+static napi_value init(napi_env env, napi_value exports) {
+    napi_property_descriptor props[] = {
+        {"keypair", NULL, keypair, NULL, NULL, NULL, napi_enumerable, NULL},
+        {"encaps", NULL, encaps, NULL, NULL, NULL, napi_enumerable, NULL},
+        {"decaps", NULL, decaps, NULL, NULL, NULL, napi_enumerable, NULL},
+        {"keypairAsync", NULL, keypair_async, NULL, NULL, NULL, napi_enumerable, NULL},
+        {"encapsAsync", NULL, encaps_async, NULL, NULL, NULL, napi_enumerable, NULL},
+        {"decapsAsync", NULL, decaps_async, NULL, NULL, NULL, napi_enumerable, NULL},
+        {"sizes", NULL, sizes, NULL, NULL, NULL, napi_enumerable, NULL},
+    };
+
+    CHECK(env, napi_define_properties(env, exports, sizeof(props) / sizeof(props[0]), props));
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, init)
@@ -0,0 +1,2 @@
+/* gyp cannot build sources from a path with a space in it, so the library is compiled through these */
+#include "../../../../../IOTs Firmware/lib/kyber/kem.c"
@@ -0,0 +1,38 @@
+// randombytes for the host build of lib/kyber in the Node addon
+#include "../../../../IOTs Firmware/lib/kyber/randombytes.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <bcrypt.h>
+
+int randombytes(uint8_t *out, size_t outlen) {
+    return BCRYPT_SUCCESS(BCryptGenRandom(NULL, out, (ULONG)outlen, BCRYPT_USE_SYSTEM_PREFERRED_RNG)) ? 0 : -1;
+}
+
+#elif defined(__APPLE__) || defined(__OpenBSD__) || defined(__FreeBSD__)
+#include <stdlib.h>
+
+int randombytes(uint8_t *out, size_t outlen) {
+    arc4random_buf(out, outlen);
+    return 0;
+}
+
+#else
+#include <errno.h>
+#include <sys/random.h>
+
+int randombytes(uint8_t *out, size_t outlen) {
+    while (outlen > 0) {
+        ssize_t n = getrandom(out, outlen, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        out += n;
+        outlen -= (size_t)n;
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,90 @@
+/*
+ * Writes test/vectors.json: known answers of the firmware build of
+ * lib/kyber, for test/interop.js to check the addon against byte for byte.
+ * It is compiled with the firmware's own configuration (platformio.ini),
+ * so the vectors come from the bit-interleaved Keccak and the low-stack
+ * encryption that run on the ESP32-S3, not from the host code paths the
+ * addon uses.
+ *
+ * From backend/native/mlkem:
+ *
+ *   cd "../../../IOTs Firmware/lib/kyber" && cc -std=c99 -O2 -DKECCAK_BITINTERLEAVED \
+ *       -DKYBER_LOWSTACK -DKYBER_NO_AVX2 -I. -o /tmp/gen_vectors "$OLDPWD/test/gen_vectors.c" \
+ *       cbd.c fips202.c fips202x4.c indcpa.c kem.c mlkem.c mlkem512.c mlkem1024.c ntt.c \
+ *       parallel.c poly.c poly_k.c polyvec.c reduce.c symmetric-shake.c verify.c && cd -
+ *   /tmp/gen_vectors > test/vectors.json
+ *
+ * Each case derives d || z and m from SHAKE256 of a label, so the vectors
+ * can be regenerated exactly. Keys and ciphertexts are recorded as their
+ * SHA3-256; ssReject is the implicit-rejection secret for the ciphertext
+ * with its last byte flipped.
+ */
+#include "fips202.h"
+#include "mlkem.h"
+#include "randombytes.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CASES 4
+
+/* Only the deterministic entry points are used */
+int randombytes(uint8_t *out, size_t outlen) {
+    (void)out;
+    (void)outlen;
+    return -1;
+}
+
+static void print_hex(const char *name, const uint8_t *a, size_t len, const char *sep) {
+    size_t i;
+    printf("\"%s\": \"", name);
+    for (i = 0; i < len; i++) {
+        printf("%02x", a[i]);
+    }
+    printf("\"%s", sep);
+}
+
+int main(void) {
+    static const unsigned int ids[] = {512, 768, 1024};
+    uint8_t pk[PQCLEAN_MLKEM_CLEAN_MAX_PUBLICKEYBYTES];
+    uint8_t sk[PQCLEAN_MLKEM_CLEAN_MAX_SECRETKEYBYTES];
+    uint8_t ct[PQCLEAN_MLKEM_CLEAN_MAX_CIPHERTEXTBYTES];
+    uint8_t ss[PQCLEAN_MLKEM_CLEAN_BYTES], ss_dec[PQCLEAN_MLKEM_CLEAN_BYTES];
+    uint8_t coins[3 * PQCLEAN_MLKEM_CLEAN_BYTES];
+    uint8_t h[32];
+    char label[32];
+    unsigned int s, i;
+
+    printf("[\n");
+    for (s = 0; s < 3; s++) {
+        const mlkem_params *p = PQCLEAN_MLKEM_CLEAN_params(ids[s]);
+        for (i = 0; i < CASES; i++) {
+            snprintf(label, sizeof(label), "mlkem-interop-%u-%u", p->id, i);
+            shake256(coins, sizeof(coins), (const uint8_t *)label, strlen(label));
+
+            if (p->keypair_derand(pk, sk, coins) != 0 ||
+                    p->enc_derand(ct, ss, pk, coins + 2 * PQCLEAN_MLKEM_CLEAN_BYTES) != 0 ||
+                    p->dec(ss_dec, ct, sk) != 0 || memcmp(ss, ss_dec, sizeof(ss)) != 0) {
+                fprintf(stderr, "%s case %u failed\n", p->algname, i);
+                return 1;
+            }
+
+            printf("  {\"paramSet\": %u, ", p->id);
+            print_hex("keypairCoins", coins, 2 * PQCLEAN_MLKEM_CLEAN_BYTES, ", ");
+            print_hex("encapsCoins", coins + 2 * PQCLEAN_MLKEM_CLEAN_BYTES, PQCLEAN_MLKEM_CLEAN_BYTES, ",\n   ");
+            sha3_256(h, pk, p->publickeybytes);
+            print_hex("pk", h, sizeof(h), ", ");
+            sha3_256(h, sk, p->secretkeybytes);
+            print_hex("sk", h, sizeof(h), ",\n   ");
+            sha3_256(h, ct, p->ciphertextbytes);
+            print_hex("ct", h, sizeof(h), ", ");
+            print_hex("ss", ss, sizeof(ss), ",\n   ");
+
+            ct[p->ciphertextbytes - 1] ^= 1;
+            p->dec(ss_dec, ct, sk);
+            print_hex("ssReject", ss_dec, sizeof(ss_dec), "");
+            printf("}%s\n", s == 2 && i == CASES - 1 ? "" : ",");
+        }
+    }
+    printf("]\n");
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Checks the addon byte for byte against known answers of the firmware
+// build of lib/kyber (see gen_vectors.c): key generation, encapsulation,
+// decapsulation and implicit rejection, through both the synchronous and
+// the thread-pool entry points.
+const crypto = require("crypto");
+const assert = require("assert");
+const kem = require("..");
+const vectors = require("./vectors.json");
+
+const SETS = { 512: kem.MlKem512, 768: kem.MlKem768, 1024: kem.MlKem1024 };
+
+const sha3 = (buf) => crypto.createHash("sha3-256").update(buf).digest("hex");
+const hex = (buf) => Buffer.from(buf).toString("hex");
+
+const check = async (v) => {
+  const p = SETS[v.paramSet];
+  const { pk, sk } = p.keyPair(Buffer.from(v.keypairCoins, "hex"));
+  assert.strictEqual(sha3(pk), v.pk, "public key");
+  assert.strictEqual(sha3(sk), v.sk, "secret key");
+
+  const { ct, ss } = p.encapsulate(pk, Buffer.from(v.encapsCoins, "hex"));
+  assert.strictEqual(sha3(ct), v.ct, "ciphertext");
+  assert.strictEqual(hex(ss), v.ss, "shared secret");
+
+  assert.strictEqual(hex(p.decapsulate(ct, sk)), v.ss, "decapsulation");
+  assert.strictEqual(hex(await p.decapsulateAsync(ct, sk)), v.ss, "async decapsulation");
+
+  const bad = Buffer.from(ct);
+  bad[bad.length - 1] ^= 1;
+  assert.strictEqual(hex(p.decapsulate(bad, sk)), v.ssReject, "implicit rejection");
+  assert.strictEqual(hex(await p.decapsulateAsync(bad, sk)), v.ssReject, "async implicit rejection");
+};
+
+// Random keys: the thread-pool entry points against the synchronous ones
+const roundTrip = async (p) => {
+  const { pk, sk } = await p.keyPairAsync();
+  const a = await p.encapsulateAsync(pk);
+  assert.ok(p.decapsulate(a.ct, sk).equals(a.ss), "async encapsulation");
+  const b = p.encapsulate(pk);
+  assert.ok((await p.decapsulateAsync(b.ct, sk)).equals(b.ss), "async decapsulation");
+};
+
+const main = async () => {
+  let failed = 0;
+  for (const v of vectors) {
+    try {
+      await check(v);
+    } catch (err) {
+      failed++;
+      console.error(`ML-KEM-${v.paramSet}: ${err.message}`);
+    }
+  }
+  for (const p of Object.values(SETS)) {
+    for (let i = 0; i < 16; i++) {
+      try {
+        await roundTrip(p);
+      } catch (err) {
+        failed++;
+        console.error(`ML-KEM-${p.id} round trip: ${err.message}`);
+      }
+    }
+  }
+  console.log(`${vectors.length} firmware vectors, ${failed ? `${failed} failures` : "all match"}`);
+  process.exit(failed ? 1 : 0);
+};
+
+main();
@@ -3,6 +3,7 @@ import Network from "../models/Network.js";
 import Threat from "../models/Threat.js";
 import Device from "../models/Device.js";
 import redis from "../config/redis.js";
+import { pushEdgeSecret } from "../services/edge.service.js";
 import mongoose from "mongoose";
 
 // Server start time for uptime calculation
@@ -363,6 +364,7 @@ export const updateOrgKeys = async (req, res) => {
     }
 
     await redis.set("org:default_secret", sharedSecret);
+    pushEdgeSecret(sharedSecret);
 
     res.json({
       success: true,
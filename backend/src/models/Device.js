@@ -20,6 +20,12 @@ const deviceSchema = new mongoose.Schema(
       required: true,
       select: false, // Do not return by default
     },
+    // ML-KEM parameter set forced for this device (512, 768 or 1024);
+    // when unset the set requested by the device in auth:init is used
+    kemParamSet: {
+      type: Number,
+      enum: [512, 768, 1024],
+    },
     name: {
       type: String,
       default: "Unknown Device",
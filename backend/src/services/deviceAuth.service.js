@@ -1,6 +1,7 @@
 import crypto from "crypto";
 import Device from "../models/Device.js";
 import redis from "../config/redis.js";
+import { pushEdgeSecret } from "./edge.service.js";
 
 const PEPPER = process.env.DEVICE_ID_PEPPER || "super-secret-pepper-string";
 
@@ -35,7 +36,10 @@ export const verifySignature = (payload, signature, sharedSecret) => {
 export const syncDeviceHashes = async () => {
   try {
     console.log("[Sync] Starting MongoDB -> Redis device sync...");
-    const devices = await Device.find({}, "macAddress hashedId sharedSecret");
+    const devices = await Device.find(
+      {},
+      "macAddress hashedId sharedSecret kemParamSet"
+    );
 
     if (devices.length === 0) {
       console.log("[Sync] No devices found in DB.");
@@ -51,11 +55,16 @@ export const syncDeviceHashes = async () => {
       pipeline.hset(key, {
         hashedId: dev.hashedId,
         sharedSecret: dev.sharedSecret,
+        ...(dev.kemParamSet && { kemParamSet: dev.kemParamSet }),
       });
       pipeline.expire(key, 60 * 60 * 4); // Expire after 4 hours (refreshed by next sync)
     });
 
     await pipeline.exec();
+    // Devices added since the last sync, or with a new secret
+    devices.forEach((dev) => {
+      if (dev.sharedSecret) pushEdgeSecret(dev.sharedSecret, dev.macAddress);
+    });
     console.log(`[Sync] Synced ${devices.length} devices to Redis.`);
   } catch (error) {
     console.error("[Sync] Error syncing devices:", error);
@@ -0,0 +1,137 @@
+import net from "net";
+import crypto from "crypto";
+import redis from "../config/redis.js";
+
+// Client for the mlkem-edge server (see edge/ at the repo root), which
+// terminates device WebSockets and runs the auth handshake itself, and
+// reports sessions, decrypted telemetry and disconnects over a Unix socket
+// as one JSON object per line. Disabled unless EDGE_SOCKET is set.
+
+const SOCKET_PATH = process.env.EDGE_SOCKET;
+const RETRY_MS = 5000;
+
+const hashMacAddress = (mac) =>
+  crypto.createHash("sha256").update(mac).digest("hex");
+
+let conn = null;
+let buffered = "";
+let onUpdate = () => {};
+// Devices with a session on the edge server
+const edgeDevices = new Set();
+
+const send = (obj) => {
+  if (!conn) return false;
+  conn.write(JSON.stringify(obj) + "\n");
+  return true;
+};
+
+// The edge server checks auth:response itself, so it needs the same HMAC
+// secrets socket.service reads from Redis: all of them when the bridge
+// connects, and each one again wherever it is written (pushEdgeSecret)
+const pushSecrets = async () => {
+  const globalSecret = await redis.get("org:default_secret");
+  if (globalSecret) send({ type: "secret", secret: globalSecret });
+
+  const keys = await redis.keys("device:*:auth");
+  for (const key of keys) {
+    const secret = await redis.hget(key, "sharedSecret");
+    if (secret) send({ type: "secret", mac: key.slice(7, -5), secret });
+  }
+};
+
+const onEvent = async (event) => {
+  const { mac } = event;
+  if (!mac) return;
+  const macHash = hashMacAddress(mac);
+
+  if (event.type === "session") {
+    edgeDevices.add(mac);
+    await redis.set(`auth:whitelist:${macHash}`, "true");
+    await redis.set(`session:key:${macHash}`, event.sessionKey, "EX", 3600 * 24);
+    await redis.hset(`device:${macHash}:status`, {
+      online: true,
+      lastSeen: Date.now(),
+      socketId: `edge:${event.sid}`,
+      rawMac: mac,
+    });
+    onUpdate({ macAddress: mac, status: "online", lastSeen: Date.now() });
+  } else if (event.type === "telemetry") {
+    await redis.hset(`device:${macHash}:status`, "lastSeen", event.ts || Date.now());
+  } else if (event.type === "offline") {
+    edgeDevices.delete(mac);
+    await redis.del(`session:key:${macHash}`);
+    await redis.hset(`device:${macHash}:status`, "online", false);
+    onUpdate({ macAddress: mac, status: "offline", lastSeen: Date.now() });
+  }
+};
+
+const onData = (chunk) => {
+  buffered += chunk;
+  let nl;
+  while ((nl = buffered.indexOf("\n")) >= 0) {
+    const line = buffered.slice(0, nl);
+    buffered = buffered.slice(nl + 1);
+    try {
+      onEvent(JSON.parse(line)).catch((err) =>
+        console.error("[Edge] Event error:", err.message)
+      );
+    } catch (err) {
+      console.error("[Edge] Bad line from edge server:", err.message);
+    }
+  }
+};
+
+const connect = () => {
+  const socket = net.createConnection(SOCKET_PATH);
+  socket.setEncoding("utf8");
+  socket.on("connect", () => {
+    console.log(`[Edge] Connected to ${SOCKET_PATH}`);
+    conn = socket;
+    pushSecrets().catch((err) =>
+      console.error("[Edge] Could not push secrets:", err.message)
+    );
+  });
+  socket.on("data", onData);
+  socket.on("error", (err) => {
+    console.error("[Edge] Socket error:", err.message);
+  });
+  socket.on("close", () => {
+    if (conn === socket) console.warn("[Edge] Disconnected");
+    conn = null;
+    buffered = "";
+    // Sessions are not replayed; devices reconnect and authenticate again
+    edgeDevices.clear();
+    setTimeout(connect, RETRY_MS);
+  });
+};
+
+/**
+ * Start the bridge to the edge server if EDGE_SOCKET is set.
+ * @param {(update: object) => void} deviceUpdate called with the same
+ *   device:update payloads socket.service emits to the frontend
+ */
+export const initEdge = (deviceUpdate) => {
+  if (!SOCKET_PATH) return;
+  onUpdate = deviceUpdate;
+  connect();
+};
+
+/**
+ * Pass an HMAC secret just written to Redis on to the edge server; without
+ * a mac it is the organisation default (org:default_secret). A no-op while
+ * the bridge is down, as the secrets are all pushed when it connects.
+ * @param {string} secret
+ * @param {string} [mac]
+ */
+export const pushEdgeSecret = (secret, mac) =>
+  send(mac ? { type: "secret", mac, secret } : { type: "secret", secret });
+
+/**
+ * Send a message to a device connected through the edge server, which
+ * seals it under the device's session key. Returns false if the device
+ * has no session there.
+ * @param {string} mac
+ * @param {string} text
+ */
+export const sendToEdgeDevice = (mac, text) =>
+  edgeDevices.has(mac) && send({ type: "message", mac, text });
@@ -0,0 +1,103 @@
+import net from "net";
+
+// Client for the mlkem-keypool service (see keypool/ at the repo root),
+// which hands out pregenerated ML-KEM key pairs over a Unix socket so that
+// auth:init does not run key generation on the event loop. Disabled unless
+// KEYPOOL_SOCKET is set; callers fall back to generating the key pair.
+
+const SOCKET_PATH = process.env.KEYPOOL_SOCKET;
+const TIMEOUT_MS = parseInt(process.env.KEYPOOL_TIMEOUT_MS) || 50;
+const RETRY_MS = 5000;
+
+const KEYPOOL_OK = 0;
+
+// pk and sk sizes by parameter set id
+const SIZES = {
+  512: [800, 1632],
+  768: [1184, 2400],
+  1024: [1568, 3168],
+};
+
+let conn = null;
+let connectedAt = 0;
+let retryAt = 0;
+let buffered = Buffer.alloc(0);
+// Requests in the order they were sent; the service answers in that order
+const pending = [];
+
+const failAll = () => {
+  while (pending.length) {
+    const req = pending.shift();
+    clearTimeout(req.timer);
+    req.resolve(null);
+  }
+  buffered = Buffer.alloc(0);
+};
+
+const onData = (chunk) => {
+  buffered = Buffer.concat([buffered, chunk]);
+  while (pending.length && buffered.length >= 1) {
+    const req = pending[0];
+    const [pkBytes, skBytes] = SIZES[req.paramSet];
+    const len = buffered[0] === KEYPOOL_OK ? 1 + pkBytes + skBytes : 1;
+    if (buffered.length < len) break;
+
+    const resp = buffered.subarray(0, len);
+    buffered = buffered.subarray(len);
+    pending.shift();
+    clearTimeout(req.timer);
+    if (req.done) continue; // timed out; the reply is only drained
+
+    if (resp[0] !== KEYPOOL_OK) {
+      req.resolve(null);
+    } else {
+      req.resolve({
+        pk: new Uint8Array(resp.subarray(1, 1 + pkBytes)),
+        sk: new Uint8Array(resp.subarray(1 + pkBytes)),
+      });
+    }
+    resp.fill(0);
+  }
+};
+
+const connect = () => {
+  if (conn) return conn;
+  if (Date.now() < retryAt) return null;
+
+  conn = net.createConnection(SOCKET_PATH);
+  connectedAt = Date.now();
+  conn.on("data", onData);
+  conn.on("error", (err) => {
+    console.error("[KeyPool] Socket error:", err.message);
+  });
+  conn.on("close", () => {
+    console.warn("[KeyPool] Disconnected, falling back to inline keygen");
+    conn = null;
+    retryAt = connectedAt + RETRY_MS;
+    failAll();
+  });
+  return conn;
+};
+
+/**
+ * Take a pregenerated key pair for a parameter set from the key pool.
+ * Resolves to { pk, sk } as Uint8Arrays, or null if the pool is not
+ * configured, not reachable, or does not answer within KEYPOOL_TIMEOUT_MS.
+ * @param {number} paramSet 512, 768 or 1024
+ */
+export const takeKeyPair = (paramSet) => {
+  if (!SOCKET_PATH || !SIZES[paramSet]) return Promise.resolve(null);
+  const socket = connect();
+  if (!socket) return Promise.resolve(null);
+
+  return new Promise((resolve) => {
+    const req = { paramSet, done: false };
+    req.resolve = (result) => {
+      req.done = true;
+      resolve(result);
+    };
+    req.timer = setTimeout(() => req.resolve(null), TIMEOUT_MS);
+    pending.push(req);
+    socket.write(Buffer.from([paramSet >> 8, paramSet & 0xff]));
+  });
+};
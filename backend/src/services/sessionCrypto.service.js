@@ -0,0 +1,147 @@
+import crypto from "crypto";
+
+// Server side of the device session crypto; see SessionCrypto.h in the
+// firmware for the scheme. Version 1 derives a key and nonce base per
+// direction from the KEM shared secret, salted with the auth:challenge
+// nonce, counts messages into the nonce, and rekeys after
+// REKEY_MESSAGES messages or REKEY_BYTES bytes. Legacy sessions use the
+// shared secret as the key both ways with random nonces.
+
+export const SESSION_VERSION = 1;
+
+const KEY_BYTES = 32;
+const IV_BYTES = 12;
+const TAG_BYTES = 16;
+const REKEY_MESSAGES = 65536;
+const REKEY_BYTES = 16 << 20;
+const MAX_SKIP = 16;
+
+const INFO_DEVICE_TO_SERVER = "mlkem-session v1 device->server";
+const INFO_SERVER_TO_DEVICE = "mlkem-session v1 server->device";
+const INFO_REKEY = "mlkem-session v1 rekey";
+
+// HKDF-Expand (RFC 5869) with SHA-256
+const hkdfExpand = (prk, info, length) => {
+  const out = [];
+  let t = Buffer.alloc(0);
+  for (let counter = 1, done = 0; done < length; counter++) {
+    t = crypto
+      .createHmac("sha256", prk)
+      .update(t)
+      .update(info)
+      .update(Buffer.from([counter]))
+      .digest();
+    out.push(t);
+    done += t.length;
+  }
+  return Buffer.concat(out).subarray(0, length);
+};
+
+const direction = (key, iv) => ({ key, iv, epoch: 0, seq: 0, bytes: 0 });
+
+const nonce = (dir, epoch, seq) => {
+  const iv = Buffer.from(dir.iv);
+  iv.writeUInt32BE((iv.readUInt32BE(0) ^ epoch) >>> 0, 0);
+  iv.writeBigUInt64BE(iv.readBigUInt64BE(4) ^ BigInt(seq), 4);
+  return iv;
+};
+
+export class SessionCrypto {
+  /**
+   * Version 1 session for the server end of a connection.
+   * @param {Buffer|Uint8Array} ss KEM shared secret
+   * @param {string} salt the nonce sent in auth:challenge
+   */
+  static server(ss, salt) {
+    const prk = crypto.createHmac("sha256", salt).update(ss).digest();
+    const d2s = hkdfExpand(prk, INFO_DEVICE_TO_SERVER, KEY_BYTES + IV_BYTES);
+    const s2d = hkdfExpand(prk, INFO_SERVER_TO_DEVICE, KEY_BYTES + IV_BYTES);
+    return new SessionCrypto(
+      direction(s2d.subarray(0, KEY_BYTES), s2d.subarray(KEY_BYTES)),
+      direction(d2s.subarray(0, KEY_BYTES), d2s.subarray(KEY_BYTES)),
+      false
+    );
+  }
+
+  /** @param {Buffer|Uint8Array} ss KEM shared secret */
+  static legacy(ss) {
+    const key = Buffer.from(ss);
+    return new SessionCrypto(direction(key, null), direction(key, null), true);
+  }
+
+  constructor(send, recv, legacy) {
+    this.send = send;
+    this.recv = recv;
+    this.legacy = legacy;
+  }
+
+  /**
+   * @param {string} plaintext
+   * @returns {{ iv: Buffer, data: Buffer, tag: Buffer }}
+   */
+  seal(plaintext) {
+    const send = this.send;
+    let iv;
+    if (this.legacy) {
+      iv = crypto.randomBytes(IV_BYTES);
+    } else {
+      if (send.seq >= REKEY_MESSAGES || send.bytes >= REKEY_BYTES) {
+        send.key = hkdfExpand(send.key, INFO_REKEY, KEY_BYTES);
+        send.epoch++;
+        send.seq = 0;
+        send.bytes = 0;
+      }
+      iv = nonce(send, send.epoch, send.seq);
+    }
+
+    const cipher = crypto.createCipheriv("aes-256-gcm", send.key, iv);
+    const data = Buffer.concat([cipher.update(plaintext, "utf8"), cipher.final()]);
+    if (!this.legacy) {
+      send.seq++;
+      send.bytes += data.length;
+    }
+    return { iv, data, tag: cipher.getAuthTag() };
+  }
+
+  /**
+   * Decrypt and authenticate a message from the device.
+   * @returns {string|null} null if it does not authenticate or is a replay
+   */
+  open(iv, data, tag) {
+    const recv = this.recv;
+    if (iv.length !== IV_BYTES || tag.length !== TAG_BYTES) return null;
+
+    let key = recv.key;
+    let epoch = recv.epoch;
+    let seq = 0;
+    if (!this.legacy) {
+      epoch = (iv.readUInt32BE(0) ^ recv.iv.readUInt32BE(0)) >>> 0;
+      seq = Number(iv.readBigUInt64BE(4) ^ recv.iv.readBigUInt64BE(4));
+      if (
+        epoch < recv.epoch ||
+        epoch - recv.epoch > MAX_SKIP ||
+        (epoch === recv.epoch && seq < recv.seq)
+      ) {
+        return null;
+      }
+      for (let e = recv.epoch; e < epoch; e++) key = hkdfExpand(key, INFO_REKEY, KEY_BYTES);
+    }
+
+    let plaintext;
+    try {
+      const decipher = crypto.createDecipheriv("aes-256-gcm", key, iv);
+      decipher.setAuthTag(tag);
+      plaintext = Buffer.concat([decipher.update(data), decipher.final()]);
+    } catch (err) {
+      return null;
+    }
+
+    // Follow the device's rekey only once the message has authenticated
+    if (!this.legacy) {
+      recv.key = key;
+      recv.epoch = epoch;
+      recv.seq = seq + 1;
+    }
+    return plaintext.toString("utf8");
+  }
+}
@@ -1,24 +1,62 @@
 import { Server } from "socket.io";
 import redis from "../config/redis.js";
 import { generateNonce, verifySignature } from "./deviceAuth.service.js";
+import { takeKeyPair } from "./keyPool.service.js";
+import { initEdge, sendToEdgeDevice } from "./edge.service.js";
+import { SessionCrypto, SESSION_VERSION } from "./sessionCrypto.service.js";
 import pkg from "crystals-kyber";
-const { Kyber768 } = pkg;
+const { Kyber512, Kyber768, Kyber1024 } = pkg;
 import crypto from "crypto";
+import { createRequire } from "module";
+
+const require = createRequire(import.meta.url);
+
+// KEM parameter sets by the id carried in auth:init / auth:challenge. The
+// native build of the firmware's library (native/mlkem) is used when it has
+// been built, and runs on the libuv thread pool; otherwise crystals-kyber
+const loadKemParamSets = () => {
+  try {
+    const { MlKem512, MlKem768, MlKem1024 } = require("../../native/mlkem");
+    console.log("[Kyber] KEM: native ML-KEM addon (lib/kyber)");
+    return { 512: MlKem512, 768: MlKem768, 1024: MlKem1024 };
+  } catch (err) {
+    console.log(`[Kyber] KEM: crystals-kyber (native addon not loaded: ${err.message.split("\n")[0]})`);
+    return { 512: Kyber512, 768: Kyber768, 1024: Kyber1024 };
+  }
+};
+const KEM_PARAM_SETS = loadKemParamSets();
+
+const kemKeyPair = (paramSet) => {
+  const kem = KEM_PARAM_SETS[paramSet];
+  return kem.keyPairAsync ? kem.keyPairAsync() : kem.keyPair();
+};
+
+const kemDecapsulate = (paramSet, ct, sk) => {
+  const kem = KEM_PARAM_SETS[paramSet];
+  return kem.decapsulateAsync ? kem.decapsulateAsync(ct, sk) : kem.decapsulate(ct, sk);
+};
+const DEFAULT_KEM_PARAM_SET = 768;
+
+// Pick the parameter set for a device: an explicit per-device policy wins,
+// then the set the device asked for, then the default
+const resolveParamSet = (policy, requested) => {
+  for (const id of [policy, requested]) {
+    const n = parseInt(id);
+    if (KEM_PARAM_SETS[n]) return n;
+  }
+  return DEFAULT_KEM_PARAM_SET;
+};
 
 // Decrypt AES-256-GCM message
-const decryptMessage = (encryptedObj, sharedSecretHex) => {
+const decryptMessage = (encryptedObj, session) => {
   try {
-    const key = Buffer.from(sharedSecretHex, "hex");
     const iv = Buffer.from(encryptedObj.iv, "hex");
     const tag = Buffer.from(encryptedObj.tag, "hex");
     const encryptedText = Buffer.from(encryptedObj.data, "hex");
 
-    const decipher = crypto.createDecipheriv("aes-256-gcm", key, iv);
-    decipher.setAuthTag(tag);
-
-    let decrypted = decipher.update(encryptedText);
-    decrypted = Buffer.concat([decrypted, decipher.final()]);
-    return decrypted.toString("utf8");
+    const decrypted = session.open(iv, encryptedText, tag);
+    if (decrypted === null) console.error("AES Decrypt Error: rejected message");
+    return decrypted;
   } catch (err) {
     console.error("AES Decrypt Error:", err.message);
     return null;
@@ -26,20 +64,14 @@ const decryptMessage = (encryptedObj, sharedSecretHex) => {
 };
 
 // Encrypt message with AES-256-GCM
-const encryptMessage = (plaintext, sharedSecretHex) => {
+const encryptMessage = (plaintext, session) => {
   try {
-    const key = Buffer.from(sharedSecretHex, "hex");
-    const iv = crypto.randomBytes(12);
-    const cipher = crypto.createCipheriv("aes-256-gcm", key, iv);
-
-    let encrypted = cipher.update(plaintext, "utf8");
-    encrypted = Buffer.concat([encrypted, cipher.final()]);
-    const tag = cipher.getAuthTag();
+    const { iv, data, tag } = session.seal(plaintext);
 
     return {
       iv: iv.toString("hex"),
       tag: tag.toString("hex"),
-      data: encrypted.toString("hex"),
+      data: data.toString("hex"),
     };
   } catch (err) {
     console.error("AES Encrypt Error:", err.message);
@@ -47,6 +79,29 @@ const encryptMessage = (plaintext, sharedSecretHex) => {
   }
 };
 
+// Binary sessions carry the envelope as one Socket.IO attachment,
+// iv || ciphertext || tag, instead of { iv, tag, data } in hex
+const decryptBinaryMessage = (envelope, session) => {
+  if (envelope.length < 28) return null;
+  const iv = envelope.subarray(0, 12);
+  const tag = envelope.subarray(envelope.length - 16);
+  const encrypted = envelope.subarray(12, envelope.length - 16);
+
+  const decrypted = session.open(iv, encrypted, tag);
+  if (decrypted === null) console.error("AES Decrypt Error: rejected message");
+  return decrypted;
+};
+
+const encryptBinaryMessage = (plaintext, session) => {
+  try {
+    const { iv, data, tag } = session.seal(plaintext);
+    return Buffer.concat([iv, data, tag]);
+  } catch (err) {
+    console.error("AES Encrypt Error:", err.message);
+    return null;
+  }
+};
+
 // Generate SHA-256 hash of MAC address
 const hashMacAddress = (mac) => {
   return crypto.createHash("sha256").update(mac).digest("hex");
@@ -68,6 +123,9 @@ export const initSocket = (httpServer) => {
   const deviceNamespace = io.of("/devices");
   const frontendNamespace = io.of("/frontend");
 
+  // Devices may also connect through the mlkem-edge server
+  initEdge((update) => frontendNamespace.emit("device:update", update));
+
   // Handle device connections and authentication
   deviceNamespace.on("connection", (socket) => {
     console.log(`[Device] Connected: ${socket.id}`);
@@ -77,13 +135,22 @@ export const initSocket = (httpServer) => {
       macAddress: null,
       nonce: null,
       sharedSecret: null,
+      paramSet: DEFAULT_KEM_PARAM_SET,
+      // The device asked for pk, ciphertext and envelopes as binary
+      // attachments rather than hex
+      binary: false,
+      // Session crypto version the device supports (0 for the legacy scheme)
+      sessionVersion: 0,
+      session: null,
     };
 
-    socket.on("auth:init", async ({ macAddress }) => {
+    socket.on("auth:init", async ({ macAddress, paramSet, binary, session }) => {
       console.log(`[Device] Auth Init from ${macAddress}`);
 
       const macHash = hashMacAddress(macAddress);
       authState.macAddress = macAddress;
+      authState.binary = binary === true;
+      authState.sessionVersion = session === SESSION_VERSION ? SESSION_VERSION : 0;
 
       // Check validation whitelist (MAC Hash)
       const isKnown = await redis.get(`auth:whitelist:${macHash}`);
@@ -101,14 +168,23 @@ export const initSocket = (httpServer) => {
       await redis.set(`auth:nonce:${macHash}`, nonce, "EX", 30);
 
       try {
-        const { pk, sk } = Kyber768.keyPair(); // Ensure crystals-kyber is working
+        const policy = await redis.hget(`device:${macAddress}:auth`, "kemParamSet");
+        authState.paramSet = resolveParamSet(policy, paramSet);
+
+        const { pk, sk } =
+          (await takeKeyPair(authState.paramSet)) ||
+          (await kemKeyPair(authState.paramSet));
 
         const skHex = Buffer.from(sk).toString("hex");
         const pkHex = Buffer.from(pk).toString("hex");
 
         await redis.set(`auth:kyber:${macHash}`, skHex, "EX", 60);
 
-        socket.emit("auth:challenge", { nonce, pk: pkHex });
+        socket.emit("auth:challenge", {
+          nonce,
+          pk: authState.binary ? Buffer.from(pk) : pkHex,
+          paramSet: authState.paramSet,
+        });
       } catch (e) {
         console.error("Kyber Error:", e);
         socket.emit("auth:failed", { reason: "Internal encryption error" });
@@ -152,8 +228,10 @@ export const initSocket = (httpServer) => {
 
         if (skHex && ciphertext) {
           const sk = new Uint8Array(Buffer.from(skHex, "hex"));
-          const ct = new Uint8Array(Buffer.from(ciphertext, "hex"));
-          const ss = Kyber768.decapsulate(ct, sk);
+          const ct = new Uint8Array(
+            Buffer.isBuffer(ciphertext) ? ciphertext : Buffer.from(ciphertext, "hex")
+          );
+          const ss = await kemDecapsulate(authState.paramSet, ct, sk);
           sharedSecretHex = Buffer.from(ss).toString("hex");
           console.log(
             `[Kyber] Shared Secret Established: ${sharedSecretHex.substring(
@@ -172,6 +250,11 @@ export const initSocket = (httpServer) => {
         console.log(`[Device] Authenticated: ${macAddress}`);
         authState.isAuthenticated = true;
         authState.sharedSecret = sharedSecretHex;
+        authState.session = authState.sessionVersion
+          ? SessionCrypto.server(Buffer.from(sharedSecretHex, "hex"), nonce)
+          : SessionCrypto.legacy(Buffer.from(sharedSecretHex, "hex"));
+        socket.data.binary = authState.binary;
+        socket.data.session = authState.session;
 
         const macHash = hashMacAddress(macAddress);
 
@@ -200,7 +283,12 @@ export const initSocket = (httpServer) => {
           lastSeen: Date.now(),
         });
 
-        socket.emit("auth:success", { token: "session-active" });
+        socket.emit(
+          "auth:success",
+          authState.sessionVersion
+            ? { token: "session-active", session: authState.sessionVersion }
+            : { token: "session-active" }
+        );
       } else {
         console.warn(`[Device] Auth Failed: ${macAddress}`);
         socket.emit("auth:failed", {
@@ -212,7 +300,7 @@ export const initSocket = (httpServer) => {
 
     socket.on("pulse", async (encryptedPayload) => {
       // Pulse handling
-      if (!authState.isAuthenticated || !authState.sharedSecret) return;
+      if (!authState.isAuthenticated || !authState.session) return;
       try {
         let payload = encryptedPayload;
         if (
@@ -224,7 +312,9 @@ export const initSocket = (httpServer) => {
           payload = encryptedPayload;
         }
 
-        const decryptedJson = decryptMessage(payload, authState.sharedSecret);
+        const decryptedJson = Buffer.isBuffer(payload)
+          ? decryptBinaryMessage(payload, authState.session)
+          : decryptMessage(payload, authState.session);
         if (decryptedJson) {
           const macHash = hashMacAddress(authState.macAddress);
           await redis.hset(`device:${macHash}:status`, "lastSeen", Date.now());
@@ -285,6 +375,8 @@ export const initSocket = (httpServer) => {
       console.log(`[Frontend] Message Request: "${message}" to ${targetMac}`);
 
       const sendToDevice = async (mac, msg) => {
+        if (sendToEdgeDevice(mac, msg)) return { success: true };
+
         const socketId = await redis.get(`socket:device:${mac}`);
         if (!socketId) return { success: false, reason: "offline" };
 
@@ -294,14 +386,17 @@ export const initSocket = (httpServer) => {
         if (!sessionKey) return { success: false, reason: "no-secure-session" };
 
         // Encrypt and Send
-        const encrypted = encryptMessage(msg, sessionKey);
+        // We need to send this to the specific socket in deviceNamespace
+        // sealed with the socket's session so the nonce sequence carries on
+        const targetSocket = deviceNamespace.sockets.get(socketId);
+        const session = targetSocket?.data.session;
+        if (!session) return { success: false, reason: "send-failed" };
+        const encrypted = targetSocket.data.binary
+          ? encryptBinaryMessage(msg, session)
+          : encryptMessage(msg, session);
         if (encrypted) {
-          // We need to send this to the specific socket in deviceNamespace
-          const targetSocket = deviceNamespace.sockets.get(socketId);
-          if (targetSocket) {
-            targetSocket.emit("message", encrypted);
-            return { success: true };
-          }
+          targetSocket.emit("message", encrypted);
+          return { success: true };
         }
         return { success: false, reason: "send-failed" };
       };
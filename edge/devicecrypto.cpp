@@ -0,0 +1,276 @@
+#include "devicecrypto.h"
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+std::string hex_encode(const uint8_t *p, size_t len) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out(2 * len, '\0');
+    for (size_t i = 0; i < len; i++) {
+        out[2 * i] = digits[p[i] >> 4];
+        out[2 * i + 1] = digits[p[i] & 15];
+    }
+    return out;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = (char)(c | 0x20);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool hex_decode(const std::string &hex, uint8_t *out, size_t len) {
+    if (hex.size() != 2 * len) return false;
+    for (size_t i = 0; i < len; i++) {
+        int hi = hex_digit(hex[2 * i]), lo = hex_digit(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out[i] = (uint8_t)(hi << 4 | lo);
+    }
+    return true;
+}
+
+void random_bytes(uint8_t *out, size_t len) {
+    if (RAND_bytes(out, (int)len) != 1) throw std::runtime_error("RAND_bytes failed");
+}
+
+static void hmac(const std::string &secret, const std::string &payload, uint8_t mac[32]) {
+    unsigned int len = 32;
+    HMAC(EVP_sha256(), secret.data(), (int)secret.size(), (const unsigned char *)payload.data(), payload.size(),
+         mac, &len);
+}
+
+std::string hmac_hex(const std::string &secret, const std::string &payload) {
+    uint8_t mac[32];
+    hmac(secret, payload, mac);
+    return hex_encode(mac, sizeof(mac));
+}
+
+bool hmac_verify(const std::string &secret, const std::string &payload, const std::string &sig_hex) {
+    uint8_t mac[32], sig[32];
+    if (!hex_decode(sig_hex, sig, sizeof(sig))) return false;
+    hmac(secret, payload, mac);
+    return CRYPTO_memcmp(mac, sig, sizeof(mac)) == 0;
+}
+
+static const char info_device_to_server[] = "mlkem-session v1 device->server";
+static const char info_server_to_device[] = "mlkem-session v1 server->device";
+static const char info_rekey[] = "mlkem-session v1 rekey";
+
+// HKDF-Expand (RFC 5869) with SHA-256 and a 32-byte PRK; out may alias prk
+static void hkdf_expand(const uint8_t prk[32], const char *info, uint8_t *out, size_t len) {
+    uint8_t key[32], t[32], block[32 + 64];
+    std::memcpy(key, prk, sizeof(key));
+    size_t info_len = std::strlen(info);
+    uint8_t counter = 1;
+    for (size_t done = 0; done < len; counter++) {
+        size_t n = 0;
+        if (counter > 1) {
+            std::memcpy(block, t, sizeof(t));
+            n = sizeof(t);
+        }
+        std::memcpy(block + n, info, info_len);
+        n += info_len;
+        block[n++] = counter;
+        unsigned int mac_len = 32;
+        HMAC(EVP_sha256(), key, sizeof(key), block, n, t, &mac_len);
+        size_t take = len - done < sizeof(t) ? len - done : sizeof(t);
+        std::memcpy(out + done, t, take);
+        done += take;
+    }
+    OPENSSL_cleanse(key, sizeof(key));
+    OPENSSL_cleanse(t, sizeof(t));
+}
+
+SessionCrypto::SessionCrypto(SessionCrypto &&other) noexcept
+    : send_(other.send_), recv_(other.recv_), active_(other.active_), legacy_(other.legacy_) {
+    other.send_ = Direction();
+    other.recv_ = Direction();
+    other.active_ = false;
+}
+
+SessionCrypto &SessionCrypto::operator=(SessionCrypto &&other) noexcept {
+    if (this != &other) {
+        end();
+        send_ = other.send_;
+        recv_ = other.recv_;
+        active_ = other.active_;
+        legacy_ = other.legacy_;
+        other.send_ = Direction();
+        other.recv_ = Direction();
+        other.active_ = false;
+    }
+    return *this;
+}
+
+void SessionCrypto::set_key(Direction &d, const uint8_t key[32], bool encrypt) {
+    if (d.ctx == nullptr && (d.ctx = EVP_CIPHER_CTX_new()) == nullptr) {
+        throw std::runtime_error("EVP_CIPHER_CTX_new failed");
+    }
+    std::memmove(d.key, key, sizeof(d.key));
+    if (EVP_CipherInit_ex(d.ctx, EVP_aes_256_gcm(), nullptr, d.key, nullptr, encrypt ? 1 : 0) != 1) {
+        throw std::runtime_error("AES-GCM key setup failed");
+    }
+}
+
+void SessionCrypto::begin(Role role, const uint8_t ss[32], const std::string &salt) {
+    uint8_t prk[32], d2s[32 + 12], s2d[32 + 12];
+    unsigned int len = sizeof(prk);
+
+    end();
+    HMAC(EVP_sha256(), salt.data(), (int)salt.size(), ss, 32, prk, &len);
+    hkdf_expand(prk, info_device_to_server, d2s, sizeof(d2s));
+    hkdf_expand(prk, info_server_to_device, s2d, sizeof(s2d));
+    const uint8_t *send = role == DEVICE ? d2s : s2d, *recv = role == DEVICE ? s2d : d2s;
+    set_key(send_, send, true);
+    std::memcpy(send_.iv, send + 32, 12);
+    set_key(recv_, recv, false);
+    std::memcpy(recv_.iv, recv + 32, 12);
+
+    OPENSSL_cleanse(prk, sizeof(prk));
+    OPENSSL_cleanse(d2s, sizeof(d2s));
+    OPENSSL_cleanse(s2d, sizeof(s2d));
+    legacy_ = false;
+    active_ = true;
+}
+
+void SessionCrypto::begin_legacy(const uint8_t ss[32]) {
+    end();
+    set_key(send_, ss, true);
+    set_key(recv_, ss, false);
+    legacy_ = true;
+    active_ = true;
+}
+
+void SessionCrypto::end() {
+    for (Direction *d : {&send_, &recv_}) {
+        EVP_CIPHER_CTX_free(d->ctx);
+        OPENSSL_cleanse(d->key, sizeof(d->key));
+        *d = Direction();
+    }
+    active_ = false;
+}
+
+static void session_nonce(const uint8_t base[12], uint32_t epoch, uint64_t seq, uint8_t iv[12]) {
+    for (int i = 0; i < 4; i++) iv[i] = base[i] ^ (uint8_t)(epoch >> (24 - 8 * i));
+    for (int i = 0; i < 8; i++) iv[4 + i] = base[4 + i] ^ (uint8_t)(seq >> (56 - 8 * i));
+}
+
+void SessionCrypto::seal(const uint8_t *in, size_t len, uint8_t *out, uint8_t iv[12], uint8_t tag[16]) {
+    if (legacy_) {
+        random_bytes(iv, 12);
+    } else {
+        if (send_.seq >= SESSION_REKEY_MESSAGES || send_.bytes >= SESSION_REKEY_BYTES) {
+            uint8_t next[32];
+            hkdf_expand(send_.key, info_rekey, next, sizeof(next));
+            set_key(send_, next, true);
+            OPENSSL_cleanse(next, sizeof(next));
+            send_.epoch++;
+            send_.seq = 0;
+            send_.bytes = 0;
+        }
+        session_nonce(send_.iv, send_.epoch, send_.seq, iv);
+        send_.seq++;
+        send_.bytes += len;
+    }
+
+    int n = 0, fin = 0;
+    bool ok = send_.ctx != nullptr && EVP_EncryptInit_ex(send_.ctx, nullptr, nullptr, nullptr, iv) == 1 &&
+              EVP_EncryptUpdate(send_.ctx, out, &n, in, (int)len) == 1 &&
+              EVP_EncryptFinal_ex(send_.ctx, out + n, &fin) == 1 &&
+              EVP_CIPHER_CTX_ctrl(send_.ctx, EVP_CTRL_GCM_GET_TAG, 16, tag) == 1;
+    if (!ok) throw std::runtime_error("AES-GCM encryption failed");
+}
+
+static bool gcm_open(EVP_CIPHER_CTX *ctx, const uint8_t iv[12], const uint8_t *in, size_t len, const uint8_t tag[16],
+                     uint8_t *out) {
+    int n = 0, fin = 0;
+    return EVP_DecryptInit_ex(ctx, nullptr, nullptr, nullptr, iv) == 1 &&
+           EVP_DecryptUpdate(ctx, out, &n, in, (int)len) == 1 &&
+           EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, 16, (void *)tag) == 1 &&
+           EVP_DecryptFinal_ex(ctx, out + n, &fin) == 1;
+}
+
+bool SessionCrypto::open(const uint8_t iv[12], const uint8_t *in, size_t len, const uint8_t tag[16], uint8_t *out) {
+    if (!active_) return false;
+    if (legacy_) return gcm_open(recv_.ctx, iv, in, len, tag, out);
+
+    uint32_t epoch = 0;
+    uint64_t seq = 0;
+    for (int i = 0; i < 4; i++) epoch = epoch << 8 | (uint8_t)(iv[i] ^ recv_.iv[i]);
+    for (int i = 4; i < 12; i++) seq = seq << 8 | (uint8_t)(iv[i] ^ recv_.iv[i]);
+    if (epoch < recv_.epoch || epoch - recv_.epoch > SESSION_MAX_SKIP || (epoch == recv_.epoch && seq < recv_.seq)) {
+        return false;
+    }
+
+    if (epoch == recv_.epoch) {
+        if (!gcm_open(recv_.ctx, iv, in, len, tag, out)) return false;
+    } else {
+        // The sender has rekeyed; follow it only once the message authenticates
+        Direction next;
+        std::memcpy(next.key, recv_.key, sizeof(next.key));
+        for (uint32_t e = recv_.epoch; e < epoch; e++) hkdf_expand(next.key, info_rekey, next.key, sizeof(next.key));
+        set_key(next, next.key, false);
+        bool ok = gcm_open(next.ctx, iv, in, len, tag, out);
+        if (ok) {
+            std::swap(next.ctx, recv_.ctx);
+            std::memcpy(recv_.key, next.key, sizeof(recv_.key));
+            recv_.epoch = epoch;
+        }
+        EVP_CIPHER_CTX_free(next.ctx);
+        OPENSSL_cleanse(next.key, sizeof(next.key));
+        if (!ok) return false;
+    }
+    recv_.seq = seq + 1;
+    return true;
+}
+
+JsonObject envelope_seal(SessionCrypto &session, const std::string &plain) {
+    uint8_t iv[12], tag[16];
+    std::vector<uint8_t> ct(plain.size() + 1);
+
+    session.seal((const uint8_t *)plain.data(), plain.size(), ct.data(), iv, tag);
+    return JsonObject{{"iv", hex_encode(iv, sizeof(iv)), true},
+                      {"tag", hex_encode(tag, sizeof(tag)), true},
+                      {"data", hex_encode(ct.data(), plain.size()), true}};
+}
+
+bool envelope_open(SessionCrypto &session, const JsonObject &env, std::string &plain) {
+    const std::string *iv_hex = json_get(env, "iv"), *tag_hex = json_get(env, "tag"), *data_hex = json_get(env, "data");
+    uint8_t iv[12], tag[16];
+    if (iv_hex == nullptr || tag_hex == nullptr || data_hex == nullptr || data_hex->size() % 2 != 0 ||
+            !hex_decode(*iv_hex, iv, sizeof(iv)) || !hex_decode(*tag_hex, tag, sizeof(tag))) {
+        return false;
+    }
+    // Decrypted in place over the decoded ciphertext
+    plain.resize(data_hex->size() / 2);
+    uint8_t *p = (uint8_t *)&plain[0];
+    if (!hex_decode(*data_hex, p, plain.size()) || !session.open(iv, p, plain.size(), tag, p)) {
+        plain.clear();
+        return false;
+    }
+    return true;
+}
+
+std::string envelope_seal_binary(SessionCrypto &session, const std::string &plain) {
+    std::string env(ENVELOPE_OVERHEAD + plain.size(), '\0');
+    uint8_t *p = (uint8_t *)&env[0];
+
+    session.seal((const uint8_t *)plain.data(), plain.size(), p + 12, p, p + 12 + plain.size());
+    return env;
+}
+
+bool envelope_open_binary(SessionCrypto &session, const uint8_t *env, size_t len, std::string &plain) {
+    if (len < ENVELOPE_OVERHEAD) return false;
+    plain.resize(len - ENVELOPE_OVERHEAD);
+    if (!session.open(env, env + 12, plain.size(), env + len - 16, (uint8_t *)&plain[0])) {
+        plain.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,89 @@
+#ifndef EDGE_DEVICECRYPTO_H
+#define EDGE_DEVICECRYPTO_H
+
+#include "socketio.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * The device protocol's primitives outside ML-KEM, byte-compatible with the
+ * firmware and the Node backend: hex, the HMAC-SHA256 signature over
+ * nonce || macAddress, and the AES-256-GCM envelope {iv, tag, data} sealed
+ * under a SessionCrypto. On a binary session the envelope is one
+ * attachment instead, iv || ciphertext || tag.
+ */
+std::string hex_encode(const uint8_t *p, size_t len);
+// Decodes exactly len bytes; false if hex is not 2 * len hex digits
+bool hex_decode(const std::string &hex, uint8_t *out, size_t len);
+
+void random_bytes(uint8_t *out, size_t len);
+
+std::string hmac_hex(const std::string &secret, const std::string &payload);
+// Checks a hex signature in constant time
+bool hmac_verify(const std::string &secret, const std::string &payload, const std::string &sig_hex);
+
+typedef struct evp_cipher_ctx_st EVP_CIPHER_CTX;
+
+/*
+ * AES-256-GCM for the messages of one session, with a cipher context per
+ * direction keyed once. Version 1 ("session":1 in auth:init and
+ * auth:success) is the scheme of SessionCrypto.h in the firmware: per
+ * direction keys and nonce bases from HKDF over the shared secret, salted
+ * with the challenge nonce, nonces counting epoch and sequence, a rekey
+ * every SESSION_REKEY_MESSAGES messages or SESSION_REKEY_BYTES bytes, and
+ * no nonce accepted twice. Legacy sessions key both ways with the shared
+ * secret and use random nonces.
+ */
+#define SESSION_VERSION 1
+#define SESSION_REKEY_MESSAGES 65536u
+#define SESSION_REKEY_BYTES (16u << 20)
+#define SESSION_MAX_SKIP 16
+
+class SessionCrypto {
+public:
+    enum Role { DEVICE, SERVER };
+
+    SessionCrypto() = default;
+    SessionCrypto(SessionCrypto &&other) noexcept;
+    SessionCrypto &operator=(SessionCrypto &&other) noexcept;
+    SessionCrypto(const SessionCrypto &) = delete;
+    SessionCrypto &operator=(const SessionCrypto &) = delete;
+    ~SessionCrypto() { end(); }
+
+    void begin(Role role, const uint8_t ss[32], const std::string &salt);
+    void begin_legacy(const uint8_t ss[32]);
+    void end();
+    bool active() const { return active_; }
+    bool legacy() const { return legacy_; }
+
+    // in and out may be the same buffer
+    void seal(const uint8_t *in, size_t len, uint8_t *out, uint8_t iv[12], uint8_t tag[16]);
+    // False if the tag does not match or the nonce is stale
+    bool open(const uint8_t iv[12], const uint8_t *in, size_t len, const uint8_t tag[16], uint8_t *out);
+
+private:
+    struct Direction {
+        EVP_CIPHER_CTX *ctx = nullptr;
+        uint8_t key[32] = {};
+        uint8_t iv[12] = {};
+        uint32_t epoch = 0;
+        uint64_t seq = 0;       // next to send, or lowest acceptable to receive
+        uint64_t bytes = 0;
+    };
+
+    static void set_key(Direction &d, const uint8_t key[32], bool encrypt);
+
+    Direction send_, recv_;
+    bool active_ = false, legacy_ = false;
+};
+
+JsonObject envelope_seal(SessionCrypto &session, const std::string &plain);
+bool envelope_open(SessionCrypto &session, const JsonObject &env, std::string &plain);
+
+#define ENVELOPE_OVERHEAD (12 + 16)
+std::string envelope_seal_binary(SessionCrypto &session, const std::string &plain);
+bool envelope_open_binary(SessionCrypto &session, const uint8_t *env, size_t len, std::string &plain);
+
+#endif
@@ -0,0 +1,1086 @@
+/*
+ * mlkem-edge: terminates the device protocol of src/main.cpp in C++.
+ *
+ * Devices connect with Engine.IO v4 over WebSocket and run
+ *   auth:init -> auth:challenge{nonce,pk,paramSet}
+ *   auth:response{signature,ciphertext} -> auth:success / auth:failed
+ * then send encrypted pulses. A device that puts "binary":true in auth:init
+ * gets pk as a Socket.IO binary attachment, and may then send ciphertext
+ * and pulses, and receives messages, as attachments; everyone else gets
+ * the hex in JSON the backend has always used. Devices that put
+ * "session":1 in auth:init get it back in auth:success and seal under the
+ * version 1 session keys (devicecrypto.h); others under the shared secret.
+ * I/O threads each own a SO_REUSEPORT listener and an epoll loop; the HMAC
+ * check and ML-KEM decapsulation, and key generation when the key pool is
+ * empty, run on a worker pool. Sessions
+ * and decrypted telemetry go to the Node app over the bridge (edge.h).
+ *
+ *   mlkem-edge [--port 5001] [--io-threads 1] [--workers N] [--bridge PATH]
+ *              [--secrets FILE] [--sets 512,768,1024] [--pool 4096]
+ *              [--ping-interval 25000] [--ping-timeout 20000]
+ */
+#include "devicecrypto.h"
+#include "edge.h"
+#include "keypool.h"
+#include "socketio.h"
+#include "websocket.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <shared_mutex>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// Challenges expire as the backend's auth:kyber:* keys do
+static const auto challenge_ttl = std::chrono::seconds(60);
+static const unsigned int default_param_set = 768;
+// Attachments of one BINARY_EVENT; the protocol never needs more than one
+static const unsigned int max_attachments = 4;
+
+static int ping_interval_ms = 25000;
+static int ping_timeout_ms = 20000;
+
+static std::atomic<unsigned long> stat_handshakes{0}, stat_failures{0}, stat_telemetry{0}, stat_connections{0};
+
+static long long now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+           .count();
+}
+
+static void set_nonblocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+/* HMAC secrets by MAC address, and the organisation-wide default */
+class Secrets {
+public:
+    bool lookup(const std::string &mac, std::string &secret) {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        auto it = by_mac_.find(mac);
+        if (it != by_mac_.end()) {
+            secret = it->second;
+            return true;
+        }
+        secret = fallback_;
+        return !fallback_.empty();
+    }
+
+    void set(const std::string &mac, const std::string &secret) {
+        std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+        if (mac.empty() || mac == "*") fallback_ = secret;
+        else by_mac_[mac] = secret;
+    }
+
+    // Lines of "MAC SECRET", or "* SECRET" for the default
+    bool load(const char *path) {
+        std::ifstream in(path);
+        std::string mac, secret;
+        if (!in) return false;
+        while (in >> mac) {
+            if (mac[0] == '#') {
+                std::getline(in, secret);
+                continue;
+            }
+            if (in >> secret) set(mac, secret);
+        }
+        return true;
+    }
+
+private:
+    std::shared_timed_mutex mutex_;
+    std::unordered_map<std::string, std::string> by_mac_;
+    std::string fallback_;
+};
+
+static Secrets secrets;
+static std::vector<std::unique_ptr<KeyPool>> pools;
+static std::vector<const mlkem_params *> enabled_sets;
+
+static const mlkem_params *resolve_param_set(const std::string *requested) {
+    unsigned int id = requested != nullptr ? (unsigned int)std::strtoul(requested->c_str(), nullptr, 10) : 0;
+    for (const mlkem_params *p : enabled_sets) {
+        if (p->id == id) return p;
+    }
+    for (const mlkem_params *p : enabled_sets) {
+        if (p->id == default_param_set) return p;
+    }
+    return enabled_sets[0];
+}
+
+static KeyPool *pool_for(const mlkem_params *p) {
+    for (auto &pool : pools) {
+        if (pool->params() == p) return pool.get();
+    }
+    return nullptr;
+}
+
+class Loop;
+
+/* Work for the worker pool, and its result */
+struct Job {
+    enum Kind { KEYGEN, VERIFY } kind;
+    Loop *loop;
+    int fd;
+    uint64_t conn_id;
+    const mlkem_params *kem;
+
+    std::string mac, nonce, signature, ciphertext;  // VERIFY
+    bool ciphertext_hex;        // else the raw bytes of an attachment
+    uint8_t pk[PQCLEAN_MLKEM_CLEAN_MAX_PUBLICKEYBYTES];
+    uint8_t sk[PQCLEAN_MLKEM_CLEAN_MAX_SECRETKEYBYTES];
+    uint8_t ss[PQCLEAN_MLKEM_CLEAN_BYTES];
+    const char *error = nullptr;
+
+    ~Job() {
+        std::memset(sk, 0, sizeof(sk));
+        std::memset(ss, 0, sizeof(ss));
+    }
+
+    void run() {
+        if (kind == KEYGEN) {
+            kem->keypair(pk, sk);
+            return;
+        }
+        std::string secret;
+        uint8_t ct[PQCLEAN_MLKEM_CLEAN_MAX_CIPHERTEXTBYTES];
+        if (!secrets.lookup(mac, secret)) {
+            error = "Unknown device";
+        } else if (!hmac_verify(secret, nonce + mac, signature) ||
+                   !(ciphertext_hex ? hex_decode(ciphertext, ct, kem->ciphertextbytes)
+                                    : ciphertext.size() == kem->ciphertextbytes)) {
+            error = "Invalid signature or kyber failure";
+        } else {
+            if (!ciphertext_hex) std::memcpy(ct, ciphertext.data(), kem->ciphertextbytes);
+            kem->dec(ss, ct, sk);
+        }
+    }
+};
+
+class Workers {
+public:
+    explicit Workers(unsigned int n) {
+        for (unsigned int i = 0; i < n; i++) threads_.emplace_back(&Workers::work, this);
+    }
+
+    void submit(std::unique_ptr<Job> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(job));
+        }
+        ready_.notify_one();
+    }
+
+private:
+    void work();
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::unique_ptr<Job>> queue_;
+    std::vector<std::thread> threads_;
+};
+
+static std::unique_ptr<Workers> workers;
+
+/* One line of bridge output per call; dropped while no Node client is connected */
+class Bridge {
+public:
+    bool listen(const char *path);
+    void publish(std::string line);
+    void run();
+
+private:
+    struct Client {
+        int fd;
+        std::string in, out;
+    };
+    void handle_line(const std::string &line);
+    void flush(Client &c);
+
+    int lfd_ = -1, efd_ = -1, epfd_ = -1;
+    std::mutex mutex_;
+    std::string pending_;
+    std::unordered_map<int, Client> clients_;
+    std::atomic<bool> connected_{false};
+};
+
+static Bridge bridge;
+
+/* Authenticated devices by MAC address, for messages from the Node app */
+struct DirectoryEntry {
+    Loop *loop;
+    int fd;
+    uint64_t conn_id;
+};
+static std::mutex directory_mutex;
+static std::unordered_map<std::string, DirectoryEntry> directory;
+
+struct Conn {
+    int fd;
+    uint64_t id;
+    bool upgraded = false;
+    bool closing = false;
+    bool writing = false;
+    std::string in, out;
+    std::string sid;
+    std::string nsp;            // namespace the device talks on
+    Clock::time_point last_ping;
+    bool awaiting_pong = false;
+    bool binary = false;        // asked for attachments in auth:init
+    bool session_v1 = false;    // asked for "session":1 in auth:init
+
+    // A BINARY_EVENT waiting for its attachments
+    unsigned int pending_attachments = 0;
+    std::string pending_nsp, pending_name;
+    JsonObject pending_args;
+    std::vector<std::string> attachments;
+
+    // Handshake state
+    std::string mac, nonce;
+    const mlkem_params *kem = nullptr;
+    uint8_t sk[PQCLEAN_MLKEM_CLEAN_MAX_SECRETKEYBYTES];
+    bool have_sk = false;
+    bool busy = false;          // a job is out for this connection
+    Clock::time_point challenged;
+    bool authenticated = false;
+    SessionCrypto session;
+
+    ~Conn() {
+        std::memset(sk, 0, sizeof(sk));
+    }
+};
+
+class Loop {
+public:
+    bool start(int port);
+    void run();
+
+    // Thread-safe: hand a finished job, or a message for a device, to this loop
+    void complete(std::unique_ptr<Job> job);
+    void post_message(int fd, uint64_t conn_id, std::string text);
+
+private:
+    struct Message {
+        int fd;
+        uint64_t conn_id;
+        std::string text;
+    };
+
+    void accept_all();
+    void on_readable(Conn &c);
+    void on_frame(Conn &c, const WsFrame &f);
+    void on_engineio(Conn &c, const char *p, size_t len);
+    void on_event(Conn &c, const std::string &nsp, const std::string &name, const JsonObject &args,
+                  const std::vector<std::string> &attachments);
+    void auth_init(Conn &c, const JsonObject &args);
+    void auth_response(Conn &c, const JsonObject &args, const std::vector<std::string> &attachments);
+    void send_challenge(Conn &c, const uint8_t *pk);
+    void drain();
+    void finish(Job &job);
+    void tick();
+
+    // emit, emit_binary and flush write out at once, and close the
+    // connection if that fails or it is closing: c may be gone when they
+    // return. Set closing and read c before, or find() it again after.
+    void send_text(Conn &c, const std::string &text);
+    void emit(Conn &c, const char *event, const JsonObject &args);
+    // An event with one attachment, args holding its placeholder
+    void emit_binary(Conn &c, const char *event, const JsonObject &args, const void *data, size_t len);
+    void flush(Conn &c);
+    void close_conn(Conn &c);
+    Conn *find(int fd, uint64_t id);
+
+    int epfd_ = -1, lfd_ = -1, efd_ = -1;
+    std::vector<std::unique_ptr<Conn>> conns_;  // by fd
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Job>> done_;
+    std::vector<Message> messages_;
+    Clock::time_point last_tick_;
+};
+
+static std::atomic<uint64_t> next_conn_id{1};
+
+void Workers::work() {
+    for (;;) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return !queue_.empty(); });
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        job->run();
+        Loop *loop = job->loop;
+        loop->complete(std::move(job));
+    }
+}
+
+bool Loop::start(int port) {
+    int one = 1;
+    struct sockaddr_in addr;
+
+    epfd_ = epoll_create1(0);
+    efd_ = eventfd(0, EFD_NONBLOCK);
+    lfd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (epfd_ < 0 || efd_ < 0 || lfd_ < 0) return false;
+    setsockopt(lfd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(lfd_, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(lfd_, (struct sockaddr *)&addr, sizeof(addr)) < 0 || ::listen(lfd_, 4096) < 0) return false;
+    set_nonblocking(lfd_);
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = lfd_;
+    epoll_ctl(epfd_, EPOLL_CTL_ADD, lfd_, &ev);
+    ev.data.fd = efd_;
+    epoll_ctl(epfd_, EPOLL_CTL_ADD, efd_, &ev);
+    last_tick_ = Clock::now();
+    return true;
+}
+
+void Loop::run() {
+    struct epoll_event events[256];
+
+    for (;;) {
+        int n = epoll_wait(epfd_, events, 256, 1000);
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == lfd_) {
+                accept_all();
+                continue;
+            }
+            if (fd == efd_) {
+                drain();
+                continue;
+            }
+            if ((size_t)fd >= conns_.size() || !conns_[fd]) continue;
+            Conn &c = *conns_[fd];
+            if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                close_conn(c);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) flush(c);
+            if ((size_t)fd < conns_.size() && conns_[fd] && (events[i].events & EPOLLIN)) on_readable(c);
+        }
+        if (Clock::now() - last_tick_ >= std::chrono::seconds(1)) tick();
+    }
+}
+
+void Loop::accept_all() {
+    for (;;) {
+        int fd = accept4(lfd_, nullptr, nullptr, SOCK_NONBLOCK);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if ((size_t)fd >= conns_.size()) conns_.resize((size_t)fd + 1024);
+        conns_[fd].reset(new Conn());
+        Conn &c = *conns_[fd];
+        c.fd = fd;
+        c.id = next_conn_id++;
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev);
+        stat_connections++;
+    }
+}
+
+void Loop::on_readable(Conn &c) {
+    char buf[16384];
+    for (;;) {
+        ssize_t n = read(c.fd, buf, sizeof(buf));
+        if (n > 0) {
+            c.in.append(buf, (size_t)n);
+            if ((size_t)n < sizeof(buf)) break;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) break;
+        close_conn(c);
+        return;
+    }
+
+    if (!c.upgraded) {
+        std::string path, key;
+        long used = ws_parse_upgrade(c.in, path, key);
+        if (used == 0) return;
+        if (used < 0 || path.compare(0, 11, "/socket.io/") != 0 || path.find("EIO=4") == std::string::npos ||
+                path.find("transport=websocket") == std::string::npos) {
+            c.out += "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            c.closing = true;
+            flush(c);
+            return;
+        }
+        c.in.erase(0, (size_t)used);
+        c.upgraded = true;
+
+        uint8_t sid[10];
+        random_bytes(sid, sizeof(sid));
+        c.sid = hex_encode(sid, sizeof(sid));
+        c.out += ws_accept_response(key);
+        char open[192];
+        int len = snprintf(open, sizeof(open),
+                           "0{\"sid\":\"%s\",\"upgrades\":[],\"pingInterval\":%d,\"pingTimeout\":%d,\"maxPayload\":%d}",
+                           c.sid.c_str(), ping_interval_ms, ping_timeout_ms, WS_MAX_PAYLOAD);
+        ws_append_frame(c.out, WS_TEXT, open, (size_t)len, nullptr);
+        c.last_ping = Clock::now();
+    }
+
+    size_t pos = 0;
+    int fd = c.fd;
+    uint64_t id = c.id;
+    while (pos < c.in.size()) {
+        WsFrame f;
+        long used = ws_parse_frame(&c.in[pos], c.in.size() - pos, true, f);
+        if (used == 0) break;
+        if (used < 0) {
+            close_conn(c);
+            return;
+        }
+        pos += (size_t)used;
+        on_frame(c, f);
+        if (find(fd, id) == nullptr) return;
+        if (c.closing) break;
+    }
+    c.in.erase(0, pos);
+    flush(c);
+}
+
+void Loop::on_frame(Conn &c, const WsFrame &f) {
+    switch (f.opcode) {
+        case WS_TEXT:
+            on_engineio(c, f.payload, f.len);
+            break;
+        case WS_BINARY:
+            if (c.pending_attachments == 0) break;
+            c.attachments.emplace_back(f.payload, f.len);
+            if (c.attachments.size() == c.pending_attachments) {
+                // Moved out: the event may close the connection
+                std::vector<std::string> attachments;
+                JsonObject args;
+                attachments.swap(c.attachments);
+                args.swap(c.pending_args);
+                c.pending_attachments = 0;
+                on_event(c, std::string(c.pending_nsp), std::string(c.pending_name), args, attachments);
+            }
+            break;
+        case WS_PING:
+            ws_append_frame(c.out, WS_PONG, f.payload, f.len, nullptr);
+            break;
+        case WS_CLOSE:
+            ws_append_frame(c.out, WS_CLOSE, f.payload, f.len < 2 ? f.len : 2, nullptr);
+            c.closing = true;
+            flush(c);
+            break;
+        default:
+            break;
+    }
+}
+
+void Loop::on_engineio(Conn &c, const char *p, size_t len) {
+    if (len == 0) return;
+    switch (p[0]) {
+        case EIO_PONG:
+            c.awaiting_pong = false;
+            break;
+        case EIO_PING:
+            send_text(c, "3");
+            break;
+        case EIO_CLOSE:
+            c.closing = true;
+            flush(c);
+            break;
+        case EIO_MESSAGE: {
+            SioPacket pkt;
+            std::string name;
+            JsonObject args;
+            // A packet in place of an expected attachment abandons that event
+            c.pending_attachments = 0;
+            c.attachments.clear();
+            if (!sio_parse(p + 1, len - 1, pkt)) break;
+            if (pkt.type == SIO_CONNECT) {
+                c.nsp = pkt.nsp;
+                send_text(c, sio_connect(pkt.nsp, c.sid));
+            } else if (pkt.type == SIO_EVENT && sio_parse_event(pkt.data, pkt.len, name, args)) {
+                on_event(c, pkt.nsp, name, args, std::vector<std::string>());
+            } else if (pkt.type == SIO_BINARY_EVENT && pkt.attachments > 0 && pkt.attachments <= max_attachments &&
+                       sio_parse_event(pkt.data, pkt.len, c.pending_name, c.pending_args)) {
+                c.pending_attachments = pkt.attachments;
+                c.pending_nsp = pkt.nsp;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// The attachment a placeholder refers to, or NULL
+static const std::string *attachment(const std::vector<std::string> &attachments, int num) {
+    return num >= 0 && (size_t)num < attachments.size() ? &attachments[(size_t)num] : nullptr;
+}
+
+void Loop::on_event(Conn &c, const std::string &nsp, const std::string &name, const JsonObject &args,
+                    const std::vector<std::string> &attachments) {
+    c.nsp = nsp;
+    if (name == "auth:init") {
+        auth_init(c, args);
+    } else if (name == "auth:response") {
+        auth_response(c, args, attachments);
+    } else if (c.authenticated) {
+        // pulse, and any other event the device seals under the session key
+        std::string plain;
+        int num = sio_placeholder(args);
+        const std::string *env = attachment(attachments, num);
+        if (num >= 0 ? env == nullptr || !envelope_open_binary(c.session, (const uint8_t *)env->data(), env->size(), plain)
+                     : !envelope_open(c.session, args, plain)) {
+            return;
+        }
+        std::string line = "{\"type\":\"telemetry\",\"event\":";
+        json_append_string(line, name.data(), name.size());
+        line += ",\"mac\":";
+        json_append_string(line, c.mac.data(), c.mac.size());
+        line += ",\"payload\":";
+        json_append_string(line, plain.data(), plain.size());
+        line += ",\"ts\":" + std::to_string(now_ms()) + "}";
+        bridge.publish(std::move(line));
+        stat_telemetry++;
+    }
+}
+
+void Loop::auth_init(Conn &c, const JsonObject &args) {
+    const std::string *mac = json_get(args, "macAddress");
+    if (c.busy || mac == nullptr || mac->empty()) return;
+
+    if (c.authenticated) {
+        std::lock_guard<std::mutex> lock(directory_mutex);
+        auto it = directory.find(c.mac);
+        if (it != directory.end() && it->second.conn_id == c.id) directory.erase(it);
+    }
+    c.authenticated = false;
+    c.session.end();
+    c.mac = *mac;
+    const std::string *binary = json_get(args, "binary");
+    c.binary = binary != nullptr && *binary == "true";
+    const std::string *session = json_get(args, "session");
+    c.session_v1 = session != nullptr && *session == std::to_string(SESSION_VERSION);
+    c.kem = resolve_param_set(json_get(args, "paramSet"));
+    uint8_t nonce[16];
+    random_bytes(nonce, sizeof(nonce));
+    c.nonce = hex_encode(nonce, sizeof(nonce));
+
+    uint8_t pk[PQCLEAN_MLKEM_CLEAN_MAX_PUBLICKEYBYTES];
+    KeyPool *pool = pool_for(c.kem);
+    if (pool != nullptr && pool->try_take(pk, c.sk)) {
+        send_challenge(c, pk);
+        return;
+    }
+
+    std::unique_ptr<Job> job(new Job());
+    job->kind = Job::KEYGEN;
+    job->loop = this;
+    job->fd = c.fd;
+    job->conn_id = c.id;
+    job->kem = c.kem;
+    c.busy = true;
+    workers->submit(std::move(job));
+}
+
+void Loop::send_challenge(Conn &c, const uint8_t *pk) {
+    c.have_sk = true;
+    c.challenged = Clock::now();
+    if (c.binary) {
+        emit_binary(c, "auth:challenge",
+                    JsonObject{{"nonce", c.nonce, true}, sio_placeholder_field("pk", 0),
+                               {"paramSet", std::to_string(c.kem->id), false}},
+                    pk, c.kem->publickeybytes);
+        return;
+    }
+    emit(c, "auth:challenge", JsonObject{{"nonce", c.nonce, true},
+                                         {"pk", hex_encode(pk, c.kem->publickeybytes), true},
+                                         {"paramSet", std::to_string(c.kem->id), false}});
+}
+
+void Loop::auth_response(Conn &c, const JsonObject &args, const std::vector<std::string> &attachments) {
+    const std::string *signature = json_get(args, "signature");
+    const std::string *ciphertext = json_get(args, "ciphertext");
+    int num = sio_placeholder(ciphertext);
+    if (num >= 0) ciphertext = attachment(attachments, num);
+
+    if (c.busy) return;
+    if (c.mac.empty() || !c.have_sk || Clock::now() - c.challenged > challenge_ttl) {
+        emit(c, "auth:failed", JsonObject{{"reason", "No auth session init", true}});
+        return;
+    }
+    if (signature == nullptr || ciphertext == nullptr) {
+        c.closing = true;
+        emit(c, "auth:failed", JsonObject{{"reason", "Invalid signature or kyber failure", true}});
+        return;
+    }
+
+    // One response per challenge: the secret key goes with the job
+    std::unique_ptr<Job> job(new Job());
+    job->kind = Job::VERIFY;
+    job->loop = this;
+    job->fd = c.fd;
+    job->conn_id = c.id;
+    job->kem = c.kem;
+    job->mac = c.mac;
+    job->nonce = c.nonce;
+    job->signature = *signature;
+    job->ciphertext = *ciphertext;
+    job->ciphertext_hex = num < 0;
+    std::memcpy(job->sk, c.sk, c.kem->secretkeybytes);
+    std::memset(c.sk, 0, sizeof(c.sk));
+    c.have_sk = false;
+    c.busy = true;
+    workers->submit(std::move(job));
+}
+
+void Loop::complete(std::unique_ptr<Job> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_.push_back(std::move(job));
+    }
+    uint64_t one = 1;
+    if (write(efd_, &one, sizeof(one)) < 0) {
+        // the counter is already non-zero; the loop will drain
+    }
+}
+
+void Loop::post_message(int fd, uint64_t conn_id, std::string text) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        messages_.push_back(Message{fd, conn_id, std::move(text)});
+    }
+    uint64_t one = 1;
+    if (write(efd_, &one, sizeof(one)) < 0) {
+        // as above
+    }
+}
+
+void Loop::drain() {
+    uint64_t count;
+    std::vector<std::unique_ptr<Job>> done;
+    std::vector<Message> messages;
+
+    if (read(efd_, &count, sizeof(count)) < 0) {
+        // spurious wakeup
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done.swap(done_);
+        messages.swap(messages_);
+    }
+    for (auto &job : done) finish(*job);
+    for (auto &m : messages) {
+        Conn *c = find(m.fd, m.conn_id);
+        if (c == nullptr || !c->authenticated) continue;
+        if (c->binary) {
+            std::string env = envelope_seal_binary(c->session, m.text);
+            emit_binary(*c, "message", sio_placeholder_object(0), env.data(), env.size());
+        } else {
+            emit(*c, "message", envelope_seal(c->session, m.text));
+        }
+    }
+}
+
+void Loop::finish(Job &job) {
+    Conn *cp = find(job.fd, job.conn_id);
+    if (cp == nullptr) return;
+    Conn &c = *cp;
+    c.busy = false;
+
+    if (job.kind == Job::KEYGEN) {
+        std::memcpy(c.sk, job.sk, job.kem->secretkeybytes);
+        send_challenge(c, job.pk);
+        return;
+    }
+
+    if (job.error != nullptr) {
+        stat_failures++;
+        c.closing = true;
+        emit(c, "auth:failed", JsonObject{{"reason", job.error, true}});
+        return;
+    }
+
+    if (c.session_v1) {
+        c.session.begin(SessionCrypto::SERVER, job.ss, c.nonce);
+    } else {
+        c.session.begin_legacy(job.ss);
+    }
+    c.authenticated = true;
+    stat_handshakes++;
+    {
+        std::lock_guard<std::mutex> lock(directory_mutex);
+        directory[c.mac] = DirectoryEntry{this, c.fd, c.id};
+    }
+    // Published before auth:success is sent: if sending it closes the
+    // connection, the offline line follows this one
+    std::string line = "{\"type\":\"session\",\"mac\":";
+    json_append_string(line, c.mac.data(), c.mac.size());
+    line += ",\"paramSet\":" + std::to_string(c.kem->id) + ",\"sessionKey\":\"" + hex_encode(job.ss, sizeof(job.ss)) +
+            "\",\"sid\":\"" + c.sid + "\"}";
+    bridge.publish(std::move(line));
+
+    JsonObject success{{"token", "session-active", true}};
+    if (c.session_v1) success.push_back(JsonField{"session", std::to_string(SESSION_VERSION), false});
+    emit(c, "auth:success", success);
+}
+
+void Loop::tick() {
+    auto now = Clock::now();
+    last_tick_ = now;
+    for (auto &cp : conns_) {
+        if (!cp || !cp->upgraded) continue;
+        Conn &c = *cp;
+        auto since = std::chrono::duration_cast<std::chrono::milliseconds>(now - c.last_ping).count();
+        if (c.awaiting_pong && since > ping_timeout_ms) {
+            close_conn(c);
+        } else if (!c.awaiting_pong && since >= ping_interval_ms) {
+            c.awaiting_pong = true;
+            c.last_ping = now;
+            send_text(c, "2");
+            flush(c);
+        }
+    }
+}
+
+void Loop::send_text(Conn &c, const std::string &text) {
+    ws_append_frame(c.out, WS_TEXT, text.data(), text.size(), nullptr);
+}
+
+void Loop::emit(Conn &c, const char *event, const JsonObject &args) {
+    send_text(c, sio_event(c.nsp, event, args));
+    flush(c);
+}
+
+void Loop::emit_binary(Conn &c, const char *event, const JsonObject &args, const void *data, size_t len) {
+    send_text(c, sio_event(c.nsp, event, args, 1));
+    ws_append_frame(c.out, WS_BINARY, (const char *)data, len, nullptr);
+    flush(c);
+}
+
+void Loop::flush(Conn &c) {
+    while (!c.out.empty()) {
+        ssize_t n = write(c.fd, c.out.data(), c.out.size());
+        if (n > 0) {
+            c.out.erase(0, (size_t)n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) break;
+        close_conn(c);
+        return;
+    }
+    if (c.out.empty() && c.closing) {
+        close_conn(c);
+        return;
+    }
+    bool want = !c.out.empty();
+    if (want != c.writing) {
+        struct epoll_event ev;
+        ev.events = want ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        ev.data.fd = c.fd;
+        epoll_ctl(epfd_, EPOLL_CTL_MOD, c.fd, &ev);
+        c.writing = want;
+    }
+}
+
+void Loop::close_conn(Conn &c) {
+    int fd = c.fd;
+    if (c.authenticated) {
+        bool current;
+        {
+            std::lock_guard<std::mutex> lock(directory_mutex);
+            auto it = directory.find(c.mac);
+            current = it != directory.end() && it->second.conn_id == c.id;
+            if (current) directory.erase(it);
+        }
+        if (current) {
+            std::string line = "{\"type\":\"offline\",\"mac\":";
+            json_append_string(line, c.mac.data(), c.mac.size());
+            line += "}";
+            bridge.publish(std::move(line));
+        }
+    }
+    epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    conns_[fd].reset();
+}
+
+Conn *Loop::find(int fd, uint64_t id) {
+    if (fd < 0 || (size_t)fd >= conns_.size() || !conns_[fd] || conns_[fd]->id != id) return nullptr;
+    return conns_[fd].get();
+}
+
+bool Bridge::listen(const char *path) {
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (std::strlen(path) >= sizeof(addr.sun_path)) return false;
+    std::strcpy(addr.sun_path, path);
+    unlink(path);
+
+    lfd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    efd_ = eventfd(0, EFD_NONBLOCK);
+    epfd_ = epoll_create1(0);
+    // Session keys go over this socket: owner only
+    mode_t old_mask = umask(077);
+    bool ok = lfd_ >= 0 && efd_ >= 0 && epfd_ >= 0 && bind(lfd_, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+              ::listen(lfd_, 16) == 0;
+    umask(old_mask);
+    if (!ok) return false;
+    set_nonblocking(lfd_);
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = lfd_;
+    epoll_ctl(epfd_, EPOLL_CTL_ADD, lfd_, &ev);
+    ev.data.fd = efd_;
+    epoll_ctl(epfd_, EPOLL_CTL_ADD, efd_, &ev);
+    return true;
+}
+
+void Bridge::publish(std::string line) {
+    if (!connected_.load(std::memory_order_relaxed)) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ += line;
+        pending_ += '\n';
+    }
+    uint64_t one = 1;
+    if (write(efd_, &one, sizeof(one)) < 0) {
+        // already signalled
+    }
+}
+
+void Bridge::handle_line(const std::string &line) {
+    JsonObject obj;
+    if (!json_parse_object(line.data(), line.size(), obj)) return;
+    const std::string *type = json_get(obj, "type");
+    const std::string *mac = json_get(obj, "mac");
+    if (type == nullptr) return;
+
+    if (*type == "secret") {
+        const std::string *secret = json_get(obj, "secret");
+        if (secret != nullptr) secrets.set(mac != nullptr ? *mac : "", *secret);
+    } else if (*type == "message" && mac != nullptr) {
+        const std::string *text = json_get(obj, "text");
+        DirectoryEntry e;
+        {
+            std::lock_guard<std::mutex> lock(directory_mutex);
+            auto it = directory.find(*mac);
+            if (it == directory.end() || text == nullptr) return;
+            e = it->second;
+        }
+        e.loop->post_message(e.fd, e.conn_id, *text);
+    }
+}
+
+void Bridge::flush(Client &c) {
+    while (!c.out.empty()) {
+        ssize_t n = write(c.fd, c.out.data(), c.out.size());
+        if (n > 0) {
+            c.out.erase(0, (size_t)n);
+        } else {
+            break;
+        }
+    }
+    struct epoll_event ev;
+    ev.events = c.out.empty() ? EPOLLIN : EPOLLIN | EPOLLOUT;
+    ev.data.fd = c.fd;
+    epoll_ctl(epfd_, EPOLL_CTL_MOD, c.fd, &ev);
+}
+
+void Bridge::run() {
+    // A Node process that stops reading is dropped rather than buffered for
+    static const size_t max_backlog = 64u << 20;
+    struct epoll_event events[16];
+
+    for (;;) {
+        int n = epoll_wait(epfd_, events, 16, -1);
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == lfd_) {
+                int cfd;
+                while ((cfd = accept4(lfd_, nullptr, nullptr, SOCK_NONBLOCK)) >= 0) {
+                    clients_[cfd] = Client{cfd, "", ""};
+                    struct epoll_event ev;
+                    ev.events = EPOLLIN;
+                    ev.data.fd = cfd;
+                    epoll_ctl(epfd_, EPOLL_CTL_ADD, cfd, &ev);
+                }
+                connected_ = !clients_.empty();
+                continue;
+            }
+            if (fd == efd_) {
+                uint64_t count;
+                std::string out;
+                if (read(efd_, &count, sizeof(count)) < 0) {
+                    // spurious
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    out.swap(pending_);
+                }
+                for (auto &kv : clients_) {
+                    kv.second.out += out;
+                    flush(kv.second);
+                }
+                continue;
+            }
+            auto it = clients_.find(fd);
+            if (it == clients_.end()) continue;
+            Client &c = it->second;
+            bool drop = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+            if (events[i].events & EPOLLOUT) flush(c);
+            if (!drop && (events[i].events & EPOLLIN)) {
+                char buf[8192];
+                ssize_t r;
+                while ((r = read(fd, buf, sizeof(buf))) > 0) c.in.append(buf, (size_t)r);
+                if (r == 0 || (r < 0 && errno != EAGAIN && errno != EINTR)) drop = true;
+                size_t pos = 0, nl;
+                while ((nl = c.in.find('\n', pos)) != std::string::npos) {
+                    handle_line(c.in.substr(pos, nl - pos));
+                    pos = nl + 1;
+                }
+                c.in.erase(0, pos);
+            }
+            if (drop || c.out.size() > max_backlog) {
+                close(fd);
+                clients_.erase(it);
+                connected_ = !clients_.empty();
+            }
+        }
+    }
+}
+
+static const char *bridge_path = "/tmp/mlkem-edge.sock";
+
+static void on_signal(int) {
+    unlink(bridge_path);
+    _exit(0);
+}
+
+static void usage(const char *argv0) {
+    std::fprintf(stderr,
+                 "usage: %s [--port N] [--io-threads N] [--workers N] [--bridge PATH] [--secrets FILE]\n"
+                 "          [--sets 512,768,1024] [--pool N] [--ping-interval MS] [--ping-timeout MS]\n",
+                 argv0);
+    std::exit(2);
+}
+
+int main(int argc, char **argv) {
+    int port = 5001;
+    unsigned int io_threads = 1;
+    unsigned int nworkers = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+    size_t pool_capacity = 4096;
+    std::string sets = "512,768,1024";
+    const char *secrets_path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) usage(argv[0]);
+        if (arg == "--port") port = std::atoi(argv[++i]);
+        else if (arg == "--io-threads") io_threads = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--workers") nworkers = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--bridge") bridge_path = argv[++i];
+        else if (arg == "--secrets") secrets_path = argv[++i];
+        else if (arg == "--sets") sets = argv[++i];
+        else if (arg == "--pool") pool_capacity = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--ping-interval") ping_interval_ms = std::atoi(argv[++i]);
+        else if (arg == "--ping-timeout") ping_timeout_ms = std::atoi(argv[++i]);
+        else usage(argv[0]);
+    }
+    if (io_threads == 0 || nworkers == 0 || port <= 0) usage(argv[0]);
+
+    for (size_t pos = 0; pos < sets.size();) {
+        size_t end = sets.find(',', pos);
+        if (end == std::string::npos) end = sets.size();
+        const mlkem_params *p = PQCLEAN_MLKEM_CLEAN_params((unsigned int)std::strtoul(sets.substr(pos, end - pos).c_str(), nullptr, 10));
+        if (p == nullptr) usage(argv[0]);
+        enabled_sets.push_back(p);
+        if (pool_capacity > 0) pools.emplace_back(new KeyPool(p, pool_capacity, pool_capacity / 4, 1));
+        pos = end + 1;
+    }
+    if (secrets_path != nullptr && !secrets.load(secrets_path)) {
+        std::fprintf(stderr, "cannot read %s\n", secrets_path);
+        return 1;
+    }
+
+    // One descriptor per device
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    if (!bridge.listen(bridge_path)) {
+        std::perror("bridge");
+        return 1;
+    }
+    workers.reset(new Workers(nworkers));
+    std::vector<std::unique_ptr<Loop>> loops;
+    for (unsigned int i = 0; i < io_threads; i++) {
+        loops.emplace_back(new Loop());
+        if (!loops.back()->start(port)) {
+            std::perror("listen");
+            return 1;
+        }
+    }
+
+    std::printf("edge: port %d, %u I/O threads, %u workers, bridge %s, sets %s, pool %zu\n", port, io_threads,
+                nworkers, bridge_path, sets.c_str(), pool_capacity);
+    std::fflush(stdout);
+
+    std::thread(&Bridge::run, &bridge).detach();
+    for (auto &loop : loops) std::thread(&Loop::run, loop.get()).detach();
+
+    unsigned long last[4] = {0, 0, 0, 0};
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::seconds(10));
+        unsigned long now[4] = {stat_connections.load(), stat_handshakes.load(), stat_failures.load(),
+                                stat_telemetry.load()};
+        if (std::memcmp(now, last, sizeof(now)) == 0) continue;
+        std::printf("edge: %lu connections, %lu handshakes, %lu failed, %lu telemetry\n", now[0], now[1], now[2],
+                    now[3]);
+        std::fflush(stdout);
+        std::memcpy(last, now, sizeof(now));
+    }
+}
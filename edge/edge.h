@@ -0,0 +1,26 @@
+#ifndef EDGE_EDGE_H
+#define EDGE_EDGE_H
+
+/*
+ * Bridge between the edge server and the Node app: a Unix socket on which
+ * the edge server listens, carrying one JSON object per line each way.
+ *
+ * Edge to Node:
+ *   {"type":"session","mac":M,"paramSet":N,"sessionKey":HEX,"sid":S}
+ *       a device passed auth:response; sessionKey is the ML-KEM shared
+ *       secret that keys its AES-256-GCM envelopes
+ *   {"type":"telemetry","event":E,"mac":M,"payload":TEXT,"ts":MS}
+ *       a decrypted pulse (or other encrypted event) of an authenticated
+ *       device, TEXT being the plaintext the device sealed
+ *   {"type":"offline","mac":M}
+ *       an authenticated device disconnected
+ *
+ * Node to edge:
+ *   {"type":"message","mac":M,"text":T}
+ *       seal T under the device's session key and emit it as "message"
+ *   {"type":"secret","mac":M,"secret":S}
+ *       the HMAC secret of a device; without "mac" it is the default used
+ *       for devices that have none (org:default_secret)
+ */
+
+#endif
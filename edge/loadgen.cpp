@@ -0,0 +1,429 @@
+/*
+ * Simulated devices for mlkem-edge. Each one does what src/main.cpp does:
+ * opens /socket.io/?EIO=4&transport=websocket, sends auth:init, answers
+ * auth:challenge with an ML-KEM encapsulation to the challenge key and the
+ * HMAC of nonce || macAddress, waits for auth:success, then stays connected
+ * (answering pings) and optionally sends sealed pulses.
+ *
+ * At most INFLIGHT devices are mid-handshake at a time; once DEVICES have
+ * authenticated they are all held open together. Latency is measured from
+ * auth:init to auth:success, and from the TCP connect. With --binary 1 the
+ * devices ask for binary attachments in auth:init, as WIRE_BINARY firmware
+ * does, and with --session 1 (the default) they negotiate the version 1
+ * session keys as current firmware does. Bytes on the wire are counted per handshake, from the upgrade
+ * request to auth:success, and per pulse, WebSocket framing included.
+ *
+ *   loadgen [--host 127.0.0.1] [--port 5001] [--devices 10000]
+ *           [--inflight 256] [--threads 1] [--set 768]
+ *           [--secret loadgen-secret] [--pulses 0] [--hold 0] [--binary 0]
+ *           [--session 1]
+ */
+#include "devicecrypto.h"
+#include "socketio.h"
+#include "websocket.h"
+
+extern "C" {
+#include "mlkem.h"
+}
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/evp.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static struct sockaddr_in server;
+static const mlkem_params *kem;
+static std::string secret = "loadgen-secret";
+static unsigned int pulses = 0;
+static bool binary = false;
+static bool session = true;
+
+static std::atomic<unsigned int> started{0}, authenticated{0}, failed{0};
+static unsigned int total_devices = 10000, max_inflight = 256;
+
+struct Device {
+    enum State { IDLE, CONNECTING, UPGRADING, OPEN, CHALLENGE, RESPONSE, AUTHED, DEAD } state = IDLE;
+    int fd = -1;
+    unsigned int index;
+    std::string mac;
+    std::string in, out;
+    std::string ws_accept;
+    Clock::time_point t_connect, t_init;
+    uint8_t key[32];
+    std::string nonce;
+    SessionCrypto session;
+    bool bin = false;           // the server sent the challenge as an attachment
+    size_t up = 0, down = 0;
+
+    // A BINARY_EVENT waiting for its attachments
+    unsigned int pending = 0;
+    std::string pending_name;
+    JsonObject pending_args;
+    std::vector<std::string> attachments;
+};
+
+struct Worker {
+    int epfd;
+    std::vector<Device> devices;
+    std::vector<double> init_us, connect_us;
+    uint64_t handshake_up = 0, handshake_down = 0, pulse_bytes = 0;
+    size_t next_idle = 0;
+    uint32_t mask_state;
+
+    void mask(uint8_t m[4]) {
+        mask_state = mask_state * 1103515245u + 12345u;
+        std::memcpy(m, &mask_state, 4);
+    }
+
+    void send_text(Device &d, const std::string &text) {
+        uint8_t m[4];
+        mask(m);
+        ws_append_frame(d.out, WS_TEXT, text.data(), text.size(), m);
+    }
+
+    void emit(Device &d, const char *event, const JsonObject &args) {
+        send_text(d, sio_event("", event, args));
+    }
+
+    void emit_binary(Device &d, const char *event, const JsonObject &args, const void *data, size_t len) {
+        uint8_t m[4];
+        send_text(d, sio_event("", event, args, 1));
+        mask(m);
+        ws_append_frame(d.out, WS_BINARY, (const char *)data, len, m);
+    }
+
+    void flush(Device &d) {
+        while (!d.out.empty()) {
+            ssize_t n = write(d.fd, d.out.data(), d.out.size());
+            if (n > 0) {
+                d.up += (size_t)n;
+                d.out.erase(0, (size_t)n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                break;
+            }
+        }
+        struct epoll_event ev;
+        ev.events = d.out.empty() ? EPOLLIN : EPOLLIN | EPOLLOUT;
+        ev.data.u32 = d.index;
+        epoll_ctl(epfd, EPOLL_CTL_MOD, d.fd, &ev);
+    }
+
+    void fail(Device &d, const char *why) {
+        if (failed++ < 5) std::fprintf(stderr, "%s: %s\n", d.mac.c_str(), why);
+        if (d.fd >= 0) close(d.fd);
+        d.fd = -1;
+        d.state = Device::DEAD;
+        start_next();
+    }
+
+    // Starts devices until the in-flight limit is reached or all have started
+    void start_next() {
+        while (next_idle < devices.size() &&
+                started.load() - authenticated.load() - failed.load() < max_inflight) {
+            started++;
+            connect_device(devices[next_idle++]);
+        }
+    }
+
+    void connect_device(Device &d) {
+        d.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        int one = 1;
+        setsockopt(d.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        d.t_connect = Clock::now();
+        d.state = Device::CONNECTING;
+        if (connect(d.fd, (struct sockaddr *)&server, sizeof(server)) < 0 && errno != EINPROGRESS) {
+            fail(d, "connect");
+            return;
+        }
+        uint8_t key[16];
+        unsigned char b64[32];
+        random_bytes(key, sizeof(key));
+        int n = EVP_EncodeBlock(b64, key, sizeof(key));
+        std::string wskey((const char *)b64, (size_t)n);
+        d.ws_accept = ws_accept_key(wskey);
+        d.out = ws_upgrade_request("localhost", "/socket.io/?EIO=4&transport=websocket", wskey);
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT;
+        ev.data.u32 = d.index;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, d.fd, &ev);
+    }
+
+    void on_event(Device &d, const std::string &name, const JsonObject &args,
+                  const std::vector<std::string> &attachments) {
+        if (name == "auth:challenge" && d.state == Device::CHALLENGE) {
+            const std::string *nonce = json_get(args, "nonce"), *pk_field = json_get(args, "pk");
+            uint8_t pk[PQCLEAN_MLKEM_CLEAN_MAX_PUBLICKEYBYTES], ct[PQCLEAN_MLKEM_CLEAN_MAX_CIPHERTEXTBYTES];
+            int num = sio_placeholder(pk_field);
+            d.bin = num >= 0;
+            if (d.bin && (size_t)num < attachments.size() && attachments[(size_t)num].size() == kem->publickeybytes) {
+                std::memcpy(pk, attachments[(size_t)num].data(), kem->publickeybytes);
+            } else if (d.bin || pk_field == nullptr || !hex_decode(*pk_field, pk, kem->publickeybytes)) {
+                fail(d, "bad challenge");
+                return;
+            }
+            if (nonce == nullptr) {
+                fail(d, "bad challenge");
+                return;
+            }
+            kem->enc(ct, d.key, pk);
+            d.nonce = *nonce;
+            JsonObject resp{{"signature", hmac_hex(secret, *nonce + d.mac), true},
+                            {"paramSet", std::to_string(kem->id), false}};
+            if (d.bin) {
+                resp.push_back(sio_placeholder_field("ciphertext", 0));
+                emit_binary(d, "auth:response", resp, ct, kem->ciphertextbytes);
+            } else {
+                resp.push_back(JsonField{"ciphertext", hex_encode(ct, kem->ciphertextbytes), true});
+                emit(d, "auth:response", resp);
+            }
+            d.state = Device::RESPONSE;
+        } else if (name == "auth:success" && d.state == Device::RESPONSE) {
+            auto now = Clock::now();
+            init_us.push_back(std::chrono::duration<double, std::micro>(now - d.t_init).count());
+            connect_us.push_back(std::chrono::duration<double, std::micro>(now - d.t_connect).count());
+            d.state = Device::AUTHED;
+            handshake_up += d.up + d.out.size();
+            handshake_down += d.down;
+            const std::string *version = json_get(args, "session");
+            if (version != nullptr && *version == std::to_string(SESSION_VERSION)) {
+                d.session.begin(SessionCrypto::DEVICE, d.key, d.nonce);
+            } else {
+                d.session.begin_legacy(d.key);
+            }
+            size_t before = d.out.size();
+            for (unsigned int i = 0; i < pulses; i++) {
+                std::string plain = "{\"status\":\"online\",\"ts\":" + std::to_string(i) + "}";
+                if (d.bin) {
+                    std::string env = envelope_seal_binary(d.session, plain);
+                    emit_binary(d, "pulse", sio_placeholder_object(0), env.data(), env.size());
+                } else {
+                    emit(d, "pulse", envelope_seal(d.session, plain));
+                }
+            }
+            pulse_bytes += d.out.size() - before;
+            authenticated++;
+            start_next();
+        } else if (name == "auth:failed") {
+            fail(d, "auth:failed");
+        }
+    }
+
+    void on_readable(Device &d) {
+        char buf[16384];
+        for (;;) {
+            ssize_t n = read(d.fd, buf, sizeof(buf));
+            if (n > 0) {
+                d.down += (size_t)n;
+                d.in.append(buf, (size_t)n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && errno == EAGAIN) break;
+            fail(d, "closed by server");
+            return;
+        }
+
+        if (d.state == Device::UPGRADING) {
+            size_t end = d.in.find("\r\n\r\n");
+            if (end == std::string::npos) return;
+            if (d.in.compare(0, 12, "HTTP/1.1 101") != 0 || d.in.find(d.ws_accept) == std::string::npos) {
+                fail(d, "upgrade refused");
+                return;
+            }
+            d.in.erase(0, end + 4);
+            d.state = Device::OPEN;
+        }
+
+        size_t pos = 0;
+        while (pos < d.in.size() && d.state != Device::DEAD) {
+            WsFrame f;
+            long used = ws_parse_frame(&d.in[pos], d.in.size() - pos, false, f);
+            if (used == 0) break;
+            if (used < 0) {
+                fail(d, "bad frame");
+                return;
+            }
+            pos += (size_t)used;
+            if (f.opcode == WS_BINARY && d.pending > 0) {
+                d.attachments.emplace_back(f.payload, f.len);
+                if (d.attachments.size() == d.pending) {
+                    d.pending = 0;
+                    on_event(d, d.pending_name, d.pending_args, d.attachments);
+                    d.attachments.clear();
+                }
+                continue;
+            }
+            if (f.opcode != WS_TEXT || f.len == 0) continue;
+
+            if (f.payload[0] == EIO_OPEN && d.state == Device::OPEN) {
+                // As the firmware: auth:init straight away, no namespace CONNECT
+                d.t_init = Clock::now();
+                JsonObject init{{"macAddress", d.mac, true}, {"paramSet", std::to_string(kem->id), false}};
+                if (binary) init.push_back(JsonField{"binary", "true", false});
+                if (session) init.push_back(JsonField{"session", std::to_string(SESSION_VERSION), false});
+                emit(d, "auth:init", init);
+                d.state = Device::CHALLENGE;
+            } else if (f.payload[0] == EIO_PING) {
+                send_text(d, "3");
+            } else if (f.payload[0] == EIO_MESSAGE) {
+                SioPacket pkt;
+                std::string name;
+                JsonObject args;
+                if (!sio_parse(f.payload + 1, f.len - 1, pkt)) continue;
+                if (pkt.type == SIO_EVENT && sio_parse_event(pkt.data, pkt.len, name, args)) {
+                    on_event(d, name, args, std::vector<std::string>());
+                } else if (pkt.type == SIO_BINARY_EVENT && pkt.attachments > 0 &&
+                           sio_parse_event(pkt.data, pkt.len, d.pending_name, d.pending_args)) {
+                    d.pending = pkt.attachments;
+                    d.attachments.clear();
+                }
+            }
+        }
+        if (d.state == Device::DEAD) return;
+        d.in.erase(0, pos);
+        flush(d);
+    }
+
+    void run(Clock::time_point deadline) {
+        struct epoll_event events[256];
+        start_next();
+        while (Clock::now() < deadline) {
+            if (authenticated.load() + failed.load() >= total_devices && deadline == Clock::time_point::max()) return;
+            int n = epoll_wait(epfd, events, 256, 100);
+            for (int i = 0; i < n; i++) {
+                Device &d = devices[events[i].data.u32];
+                if (d.state == Device::DEAD) continue;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    fail(d, "connection error");
+                    continue;
+                }
+                if (d.state == Device::CONNECTING && (events[i].events & EPOLLOUT)) d.state = Device::UPGRADING;
+                if (events[i].events & EPOLLOUT) flush(d);
+                if (d.state != Device::DEAD && (events[i].events & EPOLLIN)) on_readable(d);
+            }
+            start_next();
+        }
+    }
+};
+
+static double percentile(std::vector<double> v, double q) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(q * (double)v.size()))];
+}
+
+int main(int argc, char **argv) {
+    const char *host = "127.0.0.1";
+    int port = 5001;
+    unsigned int nthreads = 1, set = 768, hold = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "usage: %s [--host H] [--port N] [--devices N] [--inflight N] [--threads N] "
+                                 "[--set N] [--secret S] [--pulses N] [--hold SECS] [--binary 0|1] [--session 0|1]\n",
+                         argv[0]);
+            return 2;
+        }
+        if (arg == "--host") host = argv[++i];
+        else if (arg == "--port") port = std::atoi(argv[++i]);
+        else if (arg == "--devices") total_devices = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--inflight") max_inflight = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--threads") nthreads = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--set") set = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--secret") secret = argv[++i];
+        else if (arg == "--pulses") pulses = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--hold") hold = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--binary") binary = std::atoi(argv[++i]) != 0;
+        else if (arg == "--session") session = std::atoi(argv[++i]) != 0;
+        else return 2;
+    }
+    kem = PQCLEAN_MLKEM_CLEAN_params(set);
+    if (kem == nullptr || nthreads == 0 || max_inflight == 0) return 2;
+
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    std::memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_port = htons((uint16_t)port);
+    inet_pton(AF_INET, host, &server.sin_addr);
+
+    std::vector<Worker> workers(nthreads);
+    for (unsigned int t = 0; t < nthreads; t++) {
+        Worker &w = workers[t];
+        w.epfd = epoll_create1(0);
+        w.mask_state = 0x9e3779b9u * (t + 1);
+        for (unsigned int i = t; i < total_devices; i += nthreads) {
+            w.devices.emplace_back();
+            Device &d = w.devices.back();
+            d.index = (unsigned int)w.devices.size() - 1;
+            char mac[16];
+            std::snprintf(mac, sizeof(mac), "SIM%06u", i);
+            d.mac = mac;
+        }
+    }
+
+    auto t0 = Clock::now();
+    std::vector<std::thread> threads;
+    for (auto &w : workers) threads.emplace_back([&w] { w.run(Clock::time_point::max()); });
+    for (auto &t : threads) t.join();
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    std::vector<double> init_us, connect_us;
+    uint64_t handshake_up = 0, handshake_down = 0, pulse_bytes = 0;
+    for (auto &w : workers) {
+        init_us.insert(init_us.end(), w.init_us.begin(), w.init_us.end());
+        connect_us.insert(connect_us.end(), w.connect_us.begin(), w.connect_us.end());
+        handshake_up += w.handshake_up;
+        handshake_down += w.handshake_down;
+        pulse_bytes += w.pulse_bytes;
+    }
+    std::printf("%s, %u devices, %u in flight, %u threads: %u authenticated, %u failed in %.2f s, %.0f handshakes/s\n",
+                kem->algname, total_devices, max_inflight, nthreads, authenticated.load(), failed.load(), secs,
+                authenticated.load() / secs);
+    std::printf("auth:init to auth:success us: p50 %.0f  p90 %.0f  p99 %.0f  max %.0f\n", percentile(init_us, 0.5),
+                percentile(init_us, 0.9), percentile(init_us, 0.99), percentile(init_us, 1.0));
+    std::printf("connect to auth:success us:   p50 %.0f  p90 %.0f  p99 %.0f  max %.0f\n", percentile(connect_us, 0.5),
+                percentile(connect_us, 0.9), percentile(connect_us, 0.99), percentile(connect_us, 1.0));
+    unsigned int n = authenticated.load() > 0 ? authenticated.load() : 1;
+    std::printf("bytes per handshake: %.0f up, %.0f down", (double)handshake_up / n, (double)handshake_down / n);
+    if (pulses > 0) std::printf("; per pulse: %.0f up", (double)pulse_bytes / n / pulses);
+    std::printf(" (%s)\n", binary ? "binary" : "hex");
+    std::fflush(stdout);
+
+    if (hold > 0) {
+        // All devices stay connected, answering pings
+        threads.clear();
+        auto until = Clock::now() + std::chrono::seconds(hold);
+        for (auto &w : workers) threads.emplace_back([&w, until] { w.run(until); });
+        for (auto &t : threads) t.join();
+        unsigned int open = 0;
+        for (auto &w : workers) {
+            for (auto &d : w.devices) open += d.state == Device::AUTHED;
+        }
+        std::printf("after %u s held: %u devices still connected\n", hold, open);
+    }
+    return failed.load() == 0 ? 0 : 1;
+}
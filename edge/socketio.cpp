@@ -0,0 +1,302 @@
+#include "socketio.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Deepest nesting of arrays and objects accepted in a value. Events come
+// from devices before they authenticate, and skip() recurses once a level.
+const unsigned int JSON_MAX_DEPTH = 32;
+
+struct Parser {
+    const char *p;
+    const char *end;
+
+    void ws() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+    }
+
+    bool eat(char c) {
+        ws();
+        if (p < end && *p == c) {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    static void put_utf8(std::string &out, unsigned int cp) {
+        if (cp < 0x80) {
+            out += (char)cp;
+        } else if (cp < 0x800) {
+            out += (char)(0xc0 | cp >> 6);
+            out += (char)(0x80 | (cp & 0x3f));
+        } else if (cp < 0x10000) {
+            out += (char)(0xe0 | cp >> 12);
+            out += (char)(0x80 | (cp >> 6 & 0x3f));
+            out += (char)(0x80 | (cp & 0x3f));
+        } else {
+            out += (char)(0xf0 | cp >> 18);
+            out += (char)(0x80 | (cp >> 12 & 0x3f));
+            out += (char)(0x80 | (cp >> 6 & 0x3f));
+            out += (char)(0x80 | (cp & 0x3f));
+        }
+    }
+
+    bool hex4(unsigned int &v) {
+        if (end - p < 4) return false;
+        v = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = *p++;
+            v <<= 4;
+            if (c >= '0' && c <= '9') v |= (unsigned int)(c - '0');
+            else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') v |= (unsigned int)((c | 0x20) - 'a' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    bool string(std::string &out) {
+        if (!eat('"')) return false;
+        out.clear();
+        while (p < end) {
+            const char *run = p;
+            while (p < end && *p != '"' && *p != '\\') p++;
+            out.append(run, (size_t)(p - run));
+            if (p == end) return false;
+            if (*p++ == '"') return true;
+            if (p == end) return false;
+            char c = *p++;
+            switch (c) {
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned int cp;
+                    if (!hex4(cp)) return false;
+                    if (cp >= 0xd800 && cp < 0xdc00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                        unsigned int lo;
+                        p += 2;
+                        if (!hex4(lo) || lo < 0xdc00 || lo >= 0xe000) return false;
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                    }
+                    put_utf8(out, cp);
+                    break;
+                }
+                default: out += c; break;
+            }
+        }
+        return false;
+    }
+
+    // Skips any value; used to keep non-string values as their source text.
+    // depth is the number of arrays and objects the value is inside of.
+    bool skip(unsigned int depth = 0) {
+        ws();
+        if (p == end) return false;
+        if (*p == '"') {
+            std::string tmp;
+            return string(tmp);
+        }
+        if (*p == '{' || *p == '[') {
+            if (depth >= JSON_MAX_DEPTH) return false;
+            char close = *p == '{' ? '}' : ']';
+            p++;
+            if (eat(close)) return true;
+            do {
+                if (close == '}') {
+                    std::string k;
+                    if (!string(k) || !eat(':')) return false;
+                }
+                if (!skip(depth + 1)) return false;
+            } while (eat(','));
+            return eat(close);
+        }
+        const char *start = p;
+        while (p < end && (std::strchr("+-.eE", *p) != nullptr || (*p >= '0' && *p <= '9') ||
+                           (*p >= 'a' && *p <= 'z'))) {
+            p++;
+        }
+        return p > start;
+    }
+
+    bool value(JsonField &f) {
+        ws();
+        if (p < end && *p == '"') {
+            f.is_string = true;
+            return string(f.value);
+        }
+        const char *start = p;
+        if (!skip(1)) return false;
+        f.is_string = false;
+        f.value.assign(start, (size_t)(p - start));
+        return true;
+    }
+
+    bool object(JsonObject &obj) {
+        obj.clear();
+        if (!eat('{')) return false;
+        if (eat('}')) return true;
+        do {
+            JsonField f;
+            if (!string(f.key) || !eat(':') || !value(f)) return false;
+            obj.push_back(std::move(f));
+        } while (eat(','));
+        return eat('}');
+    }
+};
+
+} // namespace
+
+const std::string *json_get(const JsonObject &obj, const char *key) {
+    for (const auto &f : obj) {
+        if (f.key == key) return &f.value;
+    }
+    return nullptr;
+}
+
+void json_append_string(std::string &out, const char *s, size_t len) {
+    static const char digits[] = "0123456789abcdef";
+    out += '"';
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        } else if (c < 0x20) {
+            out += "\\u00";
+            out += digits[c >> 4];
+            out += digits[c & 15];
+        } else {
+            out += (char)c;
+        }
+    }
+    out += '"';
+}
+
+void json_append_object(std::string &out, const JsonObject &obj) {
+    out += '{';
+    for (size_t i = 0; i < obj.size(); i++) {
+        if (i > 0) out += ',';
+        json_append_string(out, obj[i].key.data(), obj[i].key.size());
+        out += ':';
+        if (obj[i].is_string) json_append_string(out, obj[i].value.data(), obj[i].value.size());
+        else out += obj[i].value;
+    }
+    out += '}';
+}
+
+bool json_parse_object(const char *s, size_t len, JsonObject &obj) {
+    Parser ps{s, s + len};
+    if (!ps.object(obj)) return false;
+    ps.ws();
+    return ps.p == ps.end;
+}
+
+bool sio_parse(const char *p, size_t len, SioPacket &pkt) {
+    const char *end = p + len;
+    if (len == 0 || *p < '0' || *p > '6') return false;
+    pkt.type = *p++;
+
+    pkt.attachments = 0;
+    if (pkt.type == SIO_BINARY_EVENT) {
+        const char *dash = p;
+        while (dash < end && *dash >= '0' && *dash <= '9') dash++;
+        if (dash == p || dash == end || *dash != '-' || dash - p > 3) return false;
+        pkt.attachments = (unsigned int)std::strtoul(p, nullptr, 10);
+        p = dash + 1;
+    }
+
+    pkt.nsp.clear();
+    if (p < end && *p == '/') {
+        const char *comma = (const char *)std::memchr(p, ',', (size_t)(end - p));
+        if (comma == nullptr) {
+            // "40/devices" with no payload
+            pkt.nsp.assign(p, (size_t)(end - p));
+            p = end;
+        } else {
+            pkt.nsp.assign(p, (size_t)(comma - p));
+            p = comma + 1;
+        }
+    }
+    while (p < end && *p >= '0' && *p <= '9') p++;     // ack id, unused
+    pkt.data = p;
+    pkt.len = (size_t)(end - p);
+    return true;
+}
+
+bool sio_parse_event(const char *data, size_t len, std::string &name, JsonObject &args) {
+    Parser ps{data, data + len};
+    if (!ps.eat('[') || !ps.string(name)) return false;
+    args.clear();
+    if (ps.eat(',')) {
+        ps.ws();
+        if (ps.p < ps.end && *ps.p == '{') {
+            if (!ps.object(args)) return false;
+        } else if (!ps.skip(1)) {
+            return false;
+        }
+        while (ps.eat(',')) {
+            if (!ps.skip(1)) return false;
+        }
+    }
+    return ps.eat(']');
+}
+
+int sio_placeholder(const JsonObject &obj) {
+    const std::string *placeholder = json_get(obj, "_placeholder"), *num = json_get(obj, "num");
+    if (placeholder == nullptr || *placeholder != "true" || num == nullptr || num->empty() || num->size() > 3 ||
+            num->find_first_not_of("0123456789") != std::string::npos) {
+        return -1;
+    }
+    return std::atoi(num->c_str());
+}
+
+int sio_placeholder(const std::string *json) {
+    JsonObject obj;
+    if (json == nullptr || !json_parse_object(json->data(), json->size(), obj)) return -1;
+    return sio_placeholder(obj);
+}
+
+JsonField sio_placeholder_field(const char *key, unsigned int num) {
+    return JsonField{key, "{\"_placeholder\":true,\"num\":" + std::to_string(num) + "}", false};
+}
+
+JsonObject sio_placeholder_object(unsigned int num) {
+    return JsonObject{{"_placeholder", "true", false}, {"num", std::to_string(num), false}};
+}
+
+static void append_nsp(std::string &out, const std::string &nsp) {
+    if (!nsp.empty() && nsp != "/") {
+        out += nsp;
+        out += ',';
+    }
+}
+
+std::string sio_event(const std::string &nsp, const char *name, const JsonObject &args, unsigned int attachments) {
+    std::string out = "42";
+    if (attachments > 0) {
+        out[1] = SIO_BINARY_EVENT;
+        out += std::to_string(attachments);
+        out += '-';
+    }
+    append_nsp(out, nsp);
+    out += '[';
+    json_append_string(out, name, std::strlen(name));
+    out += ',';
+    json_append_object(out, args);
+    out += ']';
+    return out;
+}
+
+std::string sio_connect(const std::string &nsp, const std::string &sid) {
+    std::string out = "40";
+    append_nsp(out, nsp);
+    out += "{\"sid\":";
+    json_append_string(out, sid.data(), sid.size());
+    out += '}';
+    return out;
+}
@@ -0,0 +1,74 @@
+#ifndef EDGE_SOCKETIO_H
+#define EDGE_SOCKETIO_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+ * Engine.IO v4 and Socket.IO v5 packets over a WebSocket transport, and the
+ * small subset of JSON their event arguments use.
+ *
+ * An Engine.IO packet is one text frame: a type digit and its data. A
+ * Socket.IO packet is the data of an EIO_MESSAGE: a type digit, then an
+ * optional "/namespace," and ack id, then JSON. The devices send events on
+ * the default namespace without connecting to it first, so both are
+ * accepted here.
+ *
+ * A BINARY_EVENT ("451-[...]") is followed by that many binary frames, its
+ * attachments, which the JSON refers to as {"_placeholder":true,"num":N}.
+ */
+#define EIO_OPEN    '0'
+#define EIO_CLOSE   '1'
+#define EIO_PING    '2'
+#define EIO_PONG    '3'
+#define EIO_MESSAGE '4'
+
+#define SIO_CONNECT    '0'
+#define SIO_DISCONNECT '1'
+#define SIO_EVENT      '2'
+#define SIO_BINARY_EVENT '5'
+
+/*
+ * A JSON object with the values kept as text: strings unescaped, anything
+ * else (numbers, literals, nested objects and arrays) as written.
+ */
+struct JsonField {
+    std::string key;
+    std::string value;
+    bool is_string;
+};
+typedef std::vector<JsonField> JsonObject;
+
+const std::string *json_get(const JsonObject &obj, const char *key);
+void json_append_string(std::string &out, const char *s, size_t len);
+void json_append_object(std::string &out, const JsonObject &obj);
+bool json_parse_object(const char *s, size_t len, JsonObject &obj);
+
+struct SioPacket {
+    char type;
+    unsigned int attachments;   // binary frames that follow a BINARY_EVENT
+    std::string nsp;        // "" for the default namespace
+    const char *data;       // JSON, not copied
+    size_t len;
+};
+
+// Parses the data of an Engine.IO message; false if malformed
+bool sio_parse(const char *p, size_t len, SioPacket &pkt);
+
+// Splits the JSON of an event, ["name", {args}], into its parts
+bool sio_parse_event(const char *data, size_t len, std::string &name, JsonObject &args);
+
+// Attachment number of a placeholder object, or -1 if obj is not one
+int sio_placeholder(const JsonObject &obj);
+int sio_placeholder(const std::string *json);
+// The placeholder for attachment num, as a field value or as the whole argument
+JsonField sio_placeholder_field(const char *key, unsigned int num);
+JsonObject sio_placeholder_object(unsigned int num);
+
+// Engine.IO message text of a Socket.IO event, a BINARY_EVENT if it has
+// attachments, or of a CONNECT packet
+std::string sio_event(const std::string &nsp, const char *name, const JsonObject &args, unsigned int attachments = 0);
+std::string sio_connect(const std::string &nsp, const std::string &sid);
+
+#endif
@@ -0,0 +1,59 @@
+#include "socketio.h"
+
+#include <cstdio>
+#include <string>
+
+/*
+ * Checks of the Socket.IO event parser against what devices may send
+ * before they authenticate: well-formed events, and nesting far deeper
+ * than any event uses, which must be refused rather than overflow the
+ * stack. Exits non-zero and names the case if one fails.
+ */
+
+static int failed = 0;
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        std::printf("socketio: %s\n", what);
+        failed = 1;
+    }
+}
+
+static bool parses(const std::string &event) {
+    std::string name;
+    JsonObject args;
+    return sio_parse_event(event.data(), event.size(), name, args);
+}
+
+// ["auth:init", then depth arrays, closed if closed is set
+static std::string nested(size_t depth, bool closed) {
+    std::string event = "[\"auth:init\",{\"mac\":\"00:11:22:33:44:55\",\"v\":";
+    event.append(depth, '[');
+    if (closed) event.append(depth, ']');
+    event += closed ? "}]" : "";
+    return event;
+}
+
+int main() {
+    std::string name;
+    JsonObject args;
+    const std::string init = "[\"auth:init\",{\"mac\":\"00:11:22:33:44:55\",\"paramSet\":768,\"a\":[1,{\"b\":[]}]}]";
+    check(sio_parse_event(init.data(), init.size(), name, args), "auth:init does not parse");
+    check(name == "auth:init" && args.size() == 3, "auth:init parses to the wrong fields");
+    const std::string *a = json_get(args, "a");
+    check(a != nullptr && *a == "[1,{\"b\":[]}]", "nested value not kept as written");
+
+    check(parses(nested(31, true)), "31 levels in an argument refused");
+    check(!parses(nested(32, true)), "32 levels in an argument accepted");
+    check(!parses("[\"auth:init\"," + std::string(40, '[') + std::string(40, ']') + "]"),
+          "40 levels in a non-object argument accepted");
+
+    // The frame that took the server down: 900k unclosed arrays
+    std::string deep = "[\"auth:init\",";
+    deep.append(900000, '[');
+    check(!parses(deep), "900000 unclosed levels accepted");
+    check(!parses(nested(900000, true)), "900000 closed levels accepted");
+
+    if (!failed) std::printf("socketio: events parse, deep nesting refused\n");
+    return failed;
+}
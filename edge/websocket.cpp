@@ -0,0 +1,141 @@
+#include "websocket.h"
+
+#include <cstring>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <strings.h>
+
+static const char ws_guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static bool header_is(const char *line, size_t len, const char *name) {
+    size_t n = std::strlen(name);
+    return len > n && line[n] == ':' && strncasecmp(line, name, n) == 0;
+}
+
+static std::string header_value(const char *line, size_t len, size_t namelen) {
+    size_t i = namelen + 1;
+    while (i < len && (line[i] == ' ' || line[i] == '\t')) i++;
+    size_t end = len;
+    while (end > i && (line[end - 1] == ' ' || line[end - 1] == '\t')) end--;
+    return std::string(line + i, end - i);
+}
+
+long ws_parse_upgrade(const std::string &in, std::string &path, std::string &key) {
+    size_t end = in.find("\r\n\r\n");
+    if (end == std::string::npos) return in.size() > 8192 ? -1 : 0;
+
+    const char *p = in.data();
+    size_t eol = in.find("\r\n");
+    if (eol < 14 || std::strncmp(p, "GET ", 4) != 0) return -1;
+    size_t sp = in.find(' ', 4);
+    if (sp == std::string::npos || sp > eol) return -1;
+    path.assign(p + 4, sp - 4);
+
+    bool upgrade = false;
+    key.clear();
+    for (size_t pos = eol + 2; pos < end;) {
+        size_t next = in.find("\r\n", pos);
+        const char *line = p + pos;
+        size_t len = next - pos;
+        if (header_is(line, len, "Upgrade")) {
+            upgrade = strcasecmp(header_value(line, len, 7).c_str(), "websocket") == 0;
+        } else if (header_is(line, len, "Sec-WebSocket-Key")) {
+            key = header_value(line, len, 17);
+        }
+        pos = next + 2;
+    }
+    if (!upgrade || key.empty()) return -1;
+    return (long)(end + 4);
+}
+
+std::string ws_accept_key(const std::string &key) {
+    uint8_t digest[SHA_DIGEST_LENGTH];
+    unsigned char b64[4 * ((SHA_DIGEST_LENGTH + 2) / 3) + 1];
+    std::string s = key + ws_guid;
+
+    SHA1((const unsigned char *)s.data(), s.size(), digest);
+    int n = EVP_EncodeBlock(b64, digest, SHA_DIGEST_LENGTH);
+    return std::string((const char *)b64, (size_t)n);
+}
+
+std::string ws_accept_response(const std::string &key) {
+    return "HTTP/1.1 101 Switching Protocols\r\n"
+           "Upgrade: websocket\r\n"
+           "Connection: Upgrade\r\n"
+           "Sec-WebSocket-Accept: " + ws_accept_key(key) + "\r\n\r\n";
+}
+
+std::string ws_upgrade_request(const std::string &host, const std::string &path, const std::string &key) {
+    return "GET " + path + " HTTP/1.1\r\n"
+           "Host: " + host + "\r\n"
+           "Upgrade: websocket\r\n"
+           "Connection: Upgrade\r\n"
+           "Sec-WebSocket-Key: " + key + "\r\n"
+           "Sec-WebSocket-Version: 13\r\n\r\n";
+}
+
+long ws_parse_frame(char *buf, size_t len, bool require_mask, WsFrame &frame) {
+    const uint8_t *b = (const uint8_t *)buf;
+    if (len < 2) return 0;
+
+    bool fin = b[0] & 0x80;
+    bool masked = b[1] & 0x80;
+    uint64_t plen = b[1] & 0x7f;
+    size_t hdr = 2;
+
+    if ((b[0] & 0x70) != 0 || !fin || (b[0] & 0x0f) == 0 || masked != require_mask) return -1;
+    if (plen == 126) {
+        if (len < 4) return 0;
+        plen = (uint64_t)b[2] << 8 | b[3];
+        hdr = 4;
+    } else if (plen == 127) {
+        if (len < 10) return 0;
+        plen = 0;
+        for (int i = 0; i < 8; i++) plen = plen << 8 | b[2 + i];
+        hdr = 10;
+    }
+    if (plen > WS_MAX_PAYLOAD) return -1;
+    size_t maskpos = hdr;
+    if (masked) hdr += 4;
+    if (len < hdr + plen) return 0;
+
+    frame.opcode = b[0] & 0x0f;
+    frame.payload = buf + hdr;
+    frame.len = (size_t)plen;
+    if (masked) {
+        uint8_t mask[4];
+        std::memcpy(mask, b + maskpos, 4);
+        for (size_t i = 0; i < frame.len; i++) frame.payload[i] ^= (char)mask[i & 3];
+    }
+    return (long)(hdr + plen);
+}
+
+void ws_append_frame(std::string &out, int opcode, const char *data, size_t len, const uint8_t *mask) {
+    char hdr[14];
+    size_t n = 2;
+
+    hdr[0] = (char)(0x80 | opcode);
+    if (len < 126) {
+        hdr[1] = (char)len;
+    } else if (len < 65536) {
+        hdr[1] = 126;
+        hdr[2] = (char)(len >> 8);
+        hdr[3] = (char)len;
+        n = 4;
+    } else {
+        hdr[1] = 127;
+        for (int i = 0; i < 8; i++) hdr[2 + i] = (char)((uint64_t)len >> (56 - 8 * i));
+        n = 10;
+    }
+    if (mask != nullptr) {
+        hdr[1] = (char)(hdr[1] | 0x80);
+        std::memcpy(hdr + n, mask, 4);
+        n += 4;
+    }
+    out.append(hdr, n);
+    size_t start = out.size();
+    out.append(data, len);
+    if (mask != nullptr) {
+        for (size_t i = 0; i < len; i++) out[start + i] ^= (char)mask[i & 3];
+    }
+}
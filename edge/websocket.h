@@ -0,0 +1,54 @@
+#ifndef EDGE_WEBSOCKET_H
+#define EDGE_WEBSOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * The parts of RFC 6455 the device protocol needs: the HTTP upgrade, and
+ * frames. Messages are single frames; fragmented frames are rejected, as
+ * neither the devices nor the Engine.IO server ever send them.
+ */
+#define WS_TEXT  0x1
+#define WS_BINARY 0x2
+#define WS_CLOSE 0x8
+#define WS_PING  0x9
+#define WS_PONG  0xA
+
+// Largest frame payload accepted; Engine.IO's default maxPayload
+#define WS_MAX_PAYLOAD 1000000
+
+struct WsFrame {
+    int opcode;
+    char *payload;      // unmasked in place
+    size_t len;
+};
+
+/*
+ * Parses the HTTP upgrade request at the start of in. Returns the number of
+ * bytes it takes up, 0 if it is not complete yet, or -1 if it is not a
+ * WebSocket upgrade. path and key receive the request target and
+ * Sec-WebSocket-Key.
+ */
+long ws_parse_upgrade(const std::string &in, std::string &path, std::string &key);
+
+// The 101 response accepting key
+std::string ws_accept_response(const std::string &key);
+
+/*
+ * Parses one frame at buf. Returns the number of bytes it takes up, 0 if it
+ * is not complete yet, or -1 on a protocol error. Masked payloads are
+ * unmasked in place; require_mask is set on the server side, where every
+ * client frame must be masked.
+ */
+long ws_parse_frame(char *buf, size_t len, bool require_mask, WsFrame &frame);
+
+// Appends a frame; mask is 4 bytes for a client frame and NULL for a server one
+void ws_append_frame(std::string &out, int opcode, const char *data, size_t len, const uint8_t *mask);
+
+// Client side: the upgrade request and the Sec-WebSocket-Accept it expects
+std::string ws_upgrade_request(const std::string &host, const std::string &path, const std::string &key);
+std::string ws_accept_key(const std::string &key);
+
+#endif
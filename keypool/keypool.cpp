@@ -0,0 +1,87 @@
+#include "keypool.h"
+
+#include <cstring>
+
+KeyPool::KeyPool(const mlkem_params *params, size_t capacity, size_t low_water, unsigned int nthreads)
+    : params_(params),
+      capacity_(capacity),
+      low_water_(low_water < capacity ? low_water : capacity - 1),
+      slot_bytes_(params->publickeybytes + params->secretkeybytes),
+      slots_(capacity * slot_bytes_) {
+    for (unsigned int i = 0; i < nthreads; i++) {
+        threads_.emplace_back(&KeyPool::refill, this);
+    }
+}
+
+KeyPool::~KeyPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    refill_.notify_all();
+    full_.notify_all();
+    for (auto &t : threads_) t.join();
+    std::memset(slots_.data(), 0, slots_.size());
+}
+
+bool KeyPool::try_take(uint8_t *pk, uint8_t *sk) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (count_ == 0) return false;
+
+    uint8_t *s = slot(head_);
+    std::memcpy(pk, s, params_->publickeybytes);
+    std::memcpy(sk, s + params_->publickeybytes, params_->secretkeybytes);
+    std::memset(s, 0, slot_bytes_);
+    head_ = (head_ + 1) % capacity_;
+    count_--;
+    if (count_ <= low_water_ && !filling_) {
+        filling_ = true;
+        refill_.notify_all();
+    }
+    hits_++;
+    return true;
+}
+
+bool KeyPool::take(uint8_t *pk, uint8_t *sk) {
+    if (try_take(pk, sk)) return true;
+    // Empty: the refill threads are already busy, so do not wait for them
+    params_->keypair(pk, sk);
+    misses_++;
+    return false;
+}
+
+void KeyPool::wait_full() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    full_.wait(lock, [this] { return stop_ || count_ == capacity_; });
+}
+
+size_t KeyPool::size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+void KeyPool::refill() {
+    std::vector<uint8_t> kp(slot_bytes_);
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            refill_.wait(lock, [this] { return stop_ || filling_; });
+            if (stop_) break;
+        }
+
+        // Generate outside the lock; takes and other refill threads go on
+        params_->keypair(kp.data(), kp.data() + params_->publickeybytes);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ < capacity_) {
+            std::memcpy(slot((head_ + count_) % capacity_), kp.data(), slot_bytes_);
+            count_++;
+        }
+        if (count_ == capacity_) {
+            filling_ = false;
+            full_.notify_all();
+        }
+    }
+    std::memset(kp.data(), 0, kp.size());
+}
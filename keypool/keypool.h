@@ -0,0 +1,77 @@
+#ifndef KEYPOOL_H
+#define KEYPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "mlkem.h"
+}
+
+/*
+ * Wire format of the Unix socket service. A client sends the parameter set
+ * it wants as a 2-byte big-endian id (512, 768 or 1024) and gets back one
+ * status byte, followed for KEYPOOL_OK by pk || sk in the PQClean layout of
+ * that set. Requests on one connection are answered in order.
+ */
+#define KEYPOOL_OK          0
+#define KEYPOOL_UNSUPPORTED 1
+
+/*
+ * Bounded queue of pregenerated key pairs for one parameter set. Once it
+ * drops to the low-water mark, the refill threads generate key pairs until
+ * it is full again. take() never waits for them: if the queue is empty it
+ * generates the key pair itself.
+ *
+ * The queue is one preallocated buffer of capacity slots; a slot is wiped
+ * as soon as its key pair is handed out.
+ */
+class KeyPool {
+public:
+    KeyPool(const mlkem_params *params, size_t capacity, size_t low_water, unsigned int nthreads);
+    ~KeyPool();
+
+    KeyPool(const KeyPool &) = delete;
+    KeyPool &operator=(const KeyPool &) = delete;
+
+    // Writes a key pair to pk and sk. Returns true if it came from the queue.
+    bool take(uint8_t *pk, uint8_t *sk);
+
+    // As take(), but returns false and writes nothing if the queue is empty.
+    bool try_take(uint8_t *pk, uint8_t *sk);
+
+    // Blocks until the queue is full, or stop.
+    void wait_full();
+
+    const mlkem_params *params() const { return params_; }
+    size_t size();
+    unsigned long hits() const { return hits_.load(); }
+    unsigned long misses() const { return misses_.load(); }
+
+private:
+    void refill();
+    uint8_t *slot(size_t i) { return &slots_[i * slot_bytes_]; }
+
+    const mlkem_params *params_;
+    size_t capacity_;
+    size_t low_water_;
+    size_t slot_bytes_;
+    std::vector<uint8_t> slots_;
+    size_t head_ = 0;   // oldest key pair
+    size_t count_ = 0;
+    bool filling_ = true;
+    bool stop_ = false;
+    std::mutex mutex_;
+    std::condition_variable refill_;
+    std::condition_variable full_;
+    std::vector<std::thread> threads_;
+    std::atomic<unsigned long> hits_{0};
+    std::atomic<unsigned long> misses_{0};
+};
+
+#endif
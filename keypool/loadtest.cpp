@@ -0,0 +1,145 @@
+/*
+ * Burst load test. One thread plays the backend's event loop: REQUESTS
+ * auth:init arrive at RATE per second (0: all at once, as when a fleet
+ * reconnects after an outage), and for each one the loop gets a key pair,
+ * either from the pool service or, with --inline, by running keypair
+ * itself as the backend does without the pool. Pool requests are
+ * pipelined over CONNECTIONS sockets, so the loop never waits on a reply.
+ *
+ * The latency of a request is the time from its arrival to its key pair,
+ * so it includes the time spent queued behind earlier requests.
+ *
+ *   loadtest [--socket PATH] [--set 768] [--requests 10000] [--rate 0]
+ *            [--connections 4] [--inline]
+ */
+#include "keypool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+static double since(Clock::time_point t0) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+}
+
+static int connect_to(const char *path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        std::perror("connect");
+        std::exit(1);
+    }
+    return fd;
+}
+
+static double percentile(std::vector<double> v, double q) {
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(q * (double)v.size()))];
+}
+
+int main(int argc, char **argv) {
+    const char *path = "/tmp/mlkem-keypool.sock";
+    unsigned int set = 768, nconn = 4;
+    size_t requests = 10000;
+    double rate = 0;
+    bool inline_keygen = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--inline") inline_keygen = true;
+        else if (i + 1 < argc && arg == "--socket") path = argv[++i];
+        else if (i + 1 < argc && arg == "--set") set = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && arg == "--requests") requests = std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && arg == "--rate") rate = std::strtod(argv[++i], nullptr);
+        else if (i + 1 < argc && arg == "--connections") nconn = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: %s [--socket PATH] [--set N] [--requests N] [--rate R] [--connections N] [--inline]\n",
+                         argv[0]);
+            return 2;
+        }
+    }
+    const mlkem_params *p = PQCLEAN_MLKEM_CLEAN_params(set);
+    if (p == nullptr || nconn == 0 || requests == 0) return 2;
+
+    const size_t resp_bytes = 1 + p->publickeybytes + p->secretkeybytes;
+    std::vector<double> arrival(requests), latency(requests);
+    for (size_t i = 0; i < requests; i++) {
+        arrival[i] = rate > 0 ? 1e6 * (double)i / rate : 0;
+    }
+
+    std::vector<int> fds;
+    std::vector<std::thread> readers;
+    std::atomic<bool> failed{false};
+    Clock::time_point start;
+    std::atomic<bool> go{false};
+
+    if (!inline_keygen) {
+        // Reader j gets the replies to requests j, j + nconn, ... in order
+        for (unsigned int j = 0; j < nconn; j++) fds.push_back(connect_to(path));
+        for (unsigned int j = 0; j < nconn; j++) {
+            readers.emplace_back([&, j] {
+                std::vector<uint8_t> buf(resp_bytes);
+                while (!go.load()) std::this_thread::yield();
+                for (size_t i = j; i < requests; i += nconn) {
+                    size_t got = 0;
+                    while (got < resp_bytes) {
+                        ssize_t n = read(fds[j], buf.data() + got, resp_bytes - got);
+                        if (n <= 0) {
+                            failed = true;
+                            return;
+                        }
+                        got += (size_t)n;
+                    }
+                    if (buf[0] != KEYPOOL_OK) failed = true;
+                    latency[i] = since(start) - arrival[i];
+                }
+            });
+        }
+    }
+
+    std::vector<uint8_t> kp(p->publickeybytes + p->secretkeybytes);
+    uint8_t req[2] = {(uint8_t)(p->id >> 8), (uint8_t)p->id};
+    start = Clock::now();
+    go = true;
+    for (size_t i = 0; i < requests; i++) {
+        while (since(start) < arrival[i]) std::this_thread::yield();
+        if (inline_keygen) {
+            p->keypair(kp.data(), kp.data() + p->publickeybytes);
+            latency[i] = since(start) - arrival[i];
+        } else if (write(fds[i % nconn], req, 2) != 2) {
+            failed = true;
+            break;
+        }
+    }
+    for (auto &t : readers) t.join();
+    double wall = since(start) / 1e6;
+    for (int fd : fds) close(fd);
+    if (failed) {
+        std::fprintf(stderr, "request failed\n");
+        return 1;
+    }
+
+    std::printf("%s, %s, %zu requests", p->algname, inline_keygen ? "inline keygen" : "key pool", requests);
+    if (rate > 0) std::printf(" at %.0f/s", rate);
+    else std::printf(" at once");
+    std::printf(", done in %.3f s\n", wall);
+    std::printf("latency us: p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n", percentile(latency, 0.5),
+                percentile(latency, 0.9), percentile(latency, 0.99), percentile(latency, 1.0));
+    std::printf("p50 / max per tenth of the burst, in arrival order:\n");
+    for (int d = 0; d < 10; d++) {
+        std::vector<double> part(latency.begin() + (long)(requests * d / 10), latency.begin() + (long)(requests * (d + 1) / 10));
+        std::printf("  %3d%%  %10.1f  %10.1f\n", (d + 1) * 10, percentile(part, 0.5), percentile(part, 1.0));
+    }
+    return 0;
+}
@@ -0,0 +1,19 @@
+// Linux randombytes for the host build of lib/kyber
+#include "randombytes.h"
+#include <errno.h>
+#include <sys/random.h>
+
+int randombytes(uint8_t *out, size_t outlen) {
+    while (outlen > 0) {
+        ssize_t n = getrandom(out, outlen, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        out += n;
+        outlen -= (size_t)n;
+    }
+    return 0;
+}
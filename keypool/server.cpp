@@ -0,0 +1,151 @@
+/*
+ * mlkem-keypool: serves pregenerated ML-KEM key pairs over a Unix socket,
+ * so that the backend does not run key generation on the auth:init path.
+ *
+ *   mlkem-keypool [--socket PATH] [--sets 512,768,1024] [--capacity N]
+ *                 [--low-water N] [--threads N]
+ */
+#include "keypool.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const char *socket_path = "/tmp/mlkem-keypool.sock";
+static std::vector<std::unique_ptr<KeyPool>> pools;
+
+static KeyPool *pool_for(unsigned int id) {
+    for (auto &p : pools) {
+        if (p->params()->id == id) return p.get();
+    }
+    return nullptr;
+}
+
+static bool read_full(int fd, uint8_t *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = read(fd, buf, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool write_full(int fd, const uint8_t *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static void serve(int fd) {
+    uint8_t req[2];
+    uint8_t resp[1 + PQCLEAN_MLKEM_CLEAN_MAX_PUBLICKEYBYTES + PQCLEAN_MLKEM_CLEAN_MAX_SECRETKEYBYTES];
+
+    while (read_full(fd, req, sizeof(req))) {
+        KeyPool *pool = pool_for((unsigned int)req[0] << 8 | req[1]);
+        size_t len = 1;
+        if (pool == nullptr) {
+            resp[0] = KEYPOOL_UNSUPPORTED;
+        } else {
+            const mlkem_params *p = pool->params();
+            resp[0] = KEYPOOL_OK;
+            pool->take(resp + 1, resp + 1 + p->publickeybytes);
+            len += p->publickeybytes + p->secretkeybytes;
+        }
+        bool ok = write_full(fd, resp, len);
+        std::memset(resp, 0, len);
+        if (!ok) break;
+    }
+    close(fd);
+}
+
+static void on_signal(int) {
+    unlink(socket_path);
+    _exit(0);
+}
+
+static void usage(const char *argv0) {
+    std::fprintf(stderr,
+                 "usage: %s [--socket PATH] [--sets 512,768,1024] [--capacity N] [--low-water N] [--threads N]\n",
+                 argv0);
+    std::exit(2);
+}
+
+int main(int argc, char **argv) {
+    std::string sets = "512,768,1024";
+    size_t capacity = 4096;
+    size_t low_water = 0;
+    unsigned int nthreads = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) usage(argv[0]);
+        if (arg == "--socket") socket_path = argv[++i];
+        else if (arg == "--sets") sets = argv[++i];
+        else if (arg == "--capacity") capacity = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--low-water") low_water = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--threads") nthreads = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else usage(argv[0]);
+    }
+    if (capacity == 0 || nthreads == 0) usage(argv[0]);
+    if (low_water == 0) low_water = capacity / 4;
+
+    for (size_t pos = 0; pos < sets.size();) {
+        size_t end = sets.find(',', pos);
+        if (end == std::string::npos) end = sets.size();
+        const mlkem_params *p = PQCLEAN_MLKEM_CLEAN_params((unsigned int)std::strtoul(sets.substr(pos, end - pos).c_str(), nullptr, 10));
+        if (p == nullptr) usage(argv[0]);
+        pools.emplace_back(new KeyPool(p, capacity, low_water, nthreads));
+        pos = end + 1;
+    }
+
+    int srv = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (std::strlen(socket_path) >= sizeof(addr.sun_path)) {
+        std::fprintf(stderr, "socket path too long\n");
+        return 1;
+    }
+    std::strcpy(addr.sun_path, socket_path);
+    unlink(socket_path);
+    // Secret keys go over this socket: owner only
+    mode_t old_mask = umask(077);
+    if (srv < 0 || bind(srv, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(srv, 128) < 0) {
+        std::perror("keypool");
+        return 1;
+    }
+    umask(old_mask);
+
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    std::printf("keypool: %s, sets %s, capacity %zu, low-water %zu, %u refill threads per set\n",
+                socket_path, sets.c_str(), capacity, low_water, nthreads);
+    std::fflush(stdout);
+
+    for (;;) {
+        int fd = accept(srv, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            std::perror("accept");
+            continue;
+        }
+        std::thread(serve, fd).detach();
+    }
+}